@@ -0,0 +1,228 @@
+#include <errno.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <alsa/asoundlib.h>
+
+#define LOG_LEVEL 4
+#include "debug_log.h"
+#include "pcm_ring.h"
+#include "runtime_config.h"
+
+#define TAG "MIXER"
+
+/* 音乐与 TTS 的唯一输出：两路写端把 48 kHz 双声道 PCM 放进共享内存环形缓冲区，
+ * 本进程每次取两路都已到的部分（最多一个周期）饱和相加后写进 ALSA，不为凑满周期补零。
+ * 两路都空时先等写端，ALSA 缓冲快见底才补一个周期静音；持续空闲一段时间后停掉 PCM，
+ * 阻塞在门铃 futex 上等新数据，只按心跳间隔醒来。设备由 client.toml 的 gst_alsa_device 决定。 */
+#define MIXER_PERIOD_FRAMES     256         // 约 5.3 ms
+#define MIXER_BUFFER_PERIODS    4
+#define MIXER_IDLE_STOP_MS      2000        // 两路都没数据超过该时间才停 PCM，句间停顿不反复启停
+#define MIXER_REOPEN_DELAY_S    1
+
+static volatile sig_atomic_t g_running = 1;
+
+static void on_signal(int sig)
+{
+    (void)sig;
+    g_running = 0;
+}
+
+static snd_pcm_t *mixer_open_output(const char *device)
+{
+    snd_pcm_t *pcm = NULL;
+    snd_pcm_hw_params_t *params;
+    unsigned int rate = PCM_RING_RATE;
+    snd_pcm_uframes_t period = MIXER_PERIOD_FRAMES;
+    snd_pcm_uframes_t buffer = MIXER_PERIOD_FRAMES * MIXER_BUFFER_PERIODS;
+    int ret;
+
+    ret = snd_pcm_open(&pcm, device, SND_PCM_STREAM_PLAYBACK, 0);
+    if (ret < 0) {
+        LOGE(TAG, "打开输出设备 %s 失败: %s", device, snd_strerror(ret));
+        return NULL;
+    }
+    snd_pcm_hw_params_alloca(&params);
+    if (snd_pcm_hw_params_any(pcm, params) < 0 ||
+        snd_pcm_hw_params_set_access(pcm, params, SND_PCM_ACCESS_RW_INTERLEAVED) < 0 ||
+        snd_pcm_hw_params_set_format(pcm, params, SND_PCM_FORMAT_S16_LE) < 0 ||
+        snd_pcm_hw_params_set_channels(pcm, params, PCM_RING_CHANNELS) < 0 ||
+        snd_pcm_hw_params_set_rate_near(pcm, params, &rate, 0) < 0 ||
+        snd_pcm_hw_params_set_period_size_near(pcm, params, &period, 0) < 0 ||
+        snd_pcm_hw_params_set_buffer_size_near(pcm, params, &buffer) < 0 ||
+        snd_pcm_hw_params(pcm, params) < 0) {
+        LOGE(TAG, "设置输出参数失败: %s", device);
+        snd_pcm_close(pcm);
+        return NULL;
+    }
+    if (rate != PCM_RING_RATE) {
+        // 写端都按 PCM_RING_RATE 送数据，设备给不了这个采样率就会变调，宁可让写端退回各自直连
+        LOGE(TAG, "设备不支持 %u Hz（就近为 %u Hz）", PCM_RING_RATE, rate);
+        snd_pcm_close(pcm);
+        return NULL;
+    }
+    LOGI(TAG, "输出设备 %s：%u Hz，周期 %lu 帧，缓冲 %lu 帧",
+         device, rate, (unsigned long)period, (unsigned long)buffer);
+    return pcm;
+}
+
+static int mixer_write(snd_pcm_t *pcm, const int16_t *buf, snd_pcm_uframes_t frames)
+{
+    while (frames > 0) {
+        snd_pcm_sframes_t n = snd_pcm_writei(pcm, buf, frames);
+        if (n < 0) {
+            if (n == -EPIPE) {
+                LOGD(TAG, "输出欠载，重新 prepare");
+            }
+            n = snd_pcm_recover(pcm, (int)n, 1);
+            if (n < 0) return (int)n;
+            continue;
+        }
+        buf += n * PCM_RING_CHANNELS;
+        frames -= (snd_pcm_uframes_t)n;
+    }
+    return 0;
+}
+
+static uint32_t mixer_out_delay(snd_pcm_t *pcm, int active)
+{
+    snd_pcm_sframes_t delay = 0;
+    if (!active || snd_pcm_delay(pcm, &delay) < 0 || delay < 0) {
+        return 0;
+    }
+    return (uint32_t)delay;
+}
+
+// 音乐在 out 里，TTS 叠加上去
+static void mix_into(int16_t *out, const int16_t *in, uint32_t frames)
+{
+    uint32_t i;
+    for (i = 0; i < frames * PCM_RING_CHANNELS; i++) {
+        int32_t v = (int32_t)out[i] + in[i];
+        if (v > 32767) v = 32767;
+        else if (v < -32768) v = -32768;
+        out[i] = (int16_t)v;
+    }
+}
+
+// 取 frames 帧；期间写端 flush 导致不足的部分补零
+static void mixer_take(PcmRing *ring, int16_t *buf, uint32_t frames)
+{
+    uint32_t got = pcm_ring_read(ring, buf, frames);
+    memset(buf + (size_t)got * PCM_RING_CHANNELS, 0,
+           (size_t)(frames - got) * PCM_RING_CHANNELS * sizeof(int16_t));
+}
+
+// 输出在跑而两路都空：还能等写端多久，留一个周期余量再补静音
+static int mixer_underrun_wait_ms(snd_pcm_t *pcm)
+{
+    uint32_t delay = mixer_out_delay(pcm, 1);
+    if (delay <= MIXER_PERIOD_FRAMES) {
+        return 0;
+    }
+    return (int)((delay - MIXER_PERIOD_FRAMES) * 1000 / PCM_RING_RATE);
+}
+
+int main(void)
+{
+    PcmRing music;
+    PcmRing tts;
+    PcmRing *const rings[2] = { &music, &tts };
+    snd_pcm_t *pcm = NULL;
+    int16_t out[MIXER_PERIOD_FRAMES * PCM_RING_CHANNELS];
+    int16_t tts_buf[MIXER_PERIOD_FRAMES * PCM_RING_CHANNELS];
+    const char *device;
+    int active = 0;
+    uint32_t idle_periods = 0;
+    const uint32_t idle_stop_periods = MIXER_IDLE_STOP_MS * PCM_RING_RATE / 1000 / MIXER_PERIOD_FRAMES;
+
+    app_log_init("audio_mixer");
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+
+    if (pcm_ring_create(&music, PCM_RING_MUSIC) != 0 || pcm_ring_create(&tts, PCM_RING_TTS) != 0) {
+        LOGE(TAG, "创建共享内存失败: %s", strerror(errno));
+        return 1;
+    }
+    device = player_runtime_gst_alsa_device();
+    LOGI(TAG, "混音进程启动，输出设备 %s", device);
+
+    while (g_running) {
+        uint32_t m;
+        uint32_t t;
+        uint32_t n;
+
+        // 设备打不开时不刷新心跳，写端照旧直连 ALSA
+        if (pcm == NULL) {
+            pcm = mixer_open_output(device);
+            if (pcm == NULL) {
+                sleep(MIXER_REOPEN_DELAY_S);
+                continue;
+            }
+            active = 0;
+        }
+        pcm_ring_heartbeat(&music, mixer_out_delay(pcm, active));
+        pcm_ring_heartbeat(&tts, mixer_out_delay(pcm, active));
+
+        m = pcm_ring_available(&music);
+        t = pcm_ring_available(&tts);
+        if (m == 0 && t == 0) {
+            int wait_ms;
+            if (!active) {
+                pcm_ring_wait_readable(rings, 2, PCM_RING_HEARTBEAT_MS);
+                continue;
+            }
+            // 写端可能只是稍慢：等到 ALSA 缓冲快见底，来了数据就接着混，不插静音
+            wait_ms = mixer_underrun_wait_ms(pcm);
+            if (wait_ms > 0 && pcm_ring_wait_readable(rings, 2, wait_ms)) {
+                continue;
+            }
+            if (++idle_periods >= idle_stop_periods) {
+                snd_pcm_drain(pcm);
+                active = 0;
+                LOGD(TAG, "两路空闲，停止输出");
+                continue;
+            }
+            n = MIXER_PERIOD_FRAMES;
+            memset(out, 0, sizeof(out));
+        } else {
+            // 两路都有数据时只混都已到的部分，快的一路留到下次；空着的一路不参与
+            idle_periods = 0;
+            n = MIXER_PERIOD_FRAMES;
+            if (m > 0 && m < n) n = m;
+            if (t > 0 && t < n) n = t;
+            if (m > 0) {
+                mixer_take(&music, out, n);
+            } else {
+                memset(out, 0, (size_t)n * PCM_RING_CHANNELS * sizeof(int16_t));
+            }
+            if (t > 0) {
+                mixer_take(&tts, tts_buf, n);
+                mix_into(out, tts_buf, n);
+            }
+        }
+
+        if (!active) {
+            snd_pcm_prepare(pcm);
+            active = 1;
+        }
+        if (mixer_write(pcm, out, n) < 0) {
+            LOGE(TAG, "写入输出设备失败，重新打开");
+            snd_pcm_close(pcm);
+            pcm = NULL;
+            active = 0;
+        }
+    }
+
+    LOGI(TAG, "混音进程退出");
+    if (pcm != NULL) {
+        snd_pcm_drop(pcm);
+        snd_pcm_close(pcm);
+    }
+    pcm_ring_close(&music);
+    pcm_ring_close(&tts);
+    return 0;
+}
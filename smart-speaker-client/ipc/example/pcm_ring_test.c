@@ -0,0 +1,182 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "pcm_ring.h"
+
+/* pcm_ring 回归：读写端在同一进程里各开一份映射，
+ * 覆盖回绕、欠载（不补静音）、写满后的 stop / 阻塞唤醒、flush 与读端门铃。全部通过返回 0。 */
+
+#define TEST_RING "/pcm_ring_test"
+
+static int g_failed = 0;
+static uint32_t g_write_seq = 0;
+static uint32_t g_read_seq = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { printf("FAIL %s:%d ", __func__, __LINE__); printf(__VA_ARGS__); printf("\n"); g_failed++; } \
+} while (0)
+
+// 每帧两个声道写入递增序号的低 16 位与取反值，读出时逐帧核对
+static void fill(int16_t *buf, uint32_t frames)
+{
+    uint32_t i;
+    for (i = 0; i < frames; i++, g_write_seq++) {
+        buf[i * 2] = (int16_t)(g_write_seq & 0xffff);
+        buf[i * 2 + 1] = (int16_t)~(g_write_seq & 0xffff);
+    }
+}
+
+static int verify(const int16_t *buf, uint32_t frames)
+{
+    uint32_t i;
+    for (i = 0; i < frames; i++, g_read_seq++) {
+        if (buf[i * 2] != (int16_t)(g_read_seq & 0xffff) || buf[i * 2 + 1] != (int16_t)~(g_read_seq & 0xffff)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static int stop_always(void *arg)
+{
+    (void)arg;
+    return 1;
+}
+
+static int64_t now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+static void test_wrap(PcmRing *r, PcmRing *w)
+{
+    static int16_t buf[PCM_RING_FRAMES * PCM_RING_CHANNELS];
+    uint32_t round;
+
+    // 每轮写 3000 帧再分块读完，几轮下来 head/tail 多次跨过缓冲区末尾
+    for (round = 0; round < 8; round++) {
+        uint32_t left = 3000;
+        fill(buf, 3000);
+        CHECK(pcm_ring_write_all(w, buf, 3000, NULL, NULL) == 0, "round %u write", round);
+        CHECK(pcm_ring_available(r) == 3000, "round %u available=%u", round, pcm_ring_available(r));
+        while (left > 0) {
+            uint32_t got = pcm_ring_read(r, buf, 700);
+            CHECK(got == (left < 700 ? left : 700), "round %u got=%u left=%u", round, got, left);
+            CHECK(verify(buf, got) == 0, "round %u data mismatch", round);
+            if (got == 0) break;
+            left -= got;
+        }
+    }
+}
+
+static void test_underrun(PcmRing *r, PcmRing *w)
+{
+    int16_t buf[256 * PCM_RING_CHANNELS];
+    int16_t out[256 * PCM_RING_CHANNELS];
+
+    CHECK(pcm_ring_read(r, out, 256) == 0, "empty ring returned data");
+    fill(buf, 100);
+    pcm_ring_write_all(w, buf, 100, NULL, NULL);
+    // 不足一个周期只返回已有的帧，读端不补零
+    CHECK(pcm_ring_read(r, out, 256) == 100, "short read");
+    CHECK(verify(out, 100) == 0, "short read data mismatch");
+    CHECK(pcm_ring_read(r, out, 256) == 0, "read past head");
+}
+
+static void test_full_and_flush(PcmRing *r, PcmRing *w)
+{
+    static int16_t buf[PCM_RING_FRAMES * PCM_RING_CHANNELS];
+    int16_t one[PCM_RING_CHANNELS] = { 0, 0 };
+
+    fill(buf, PCM_RING_FRAMES);
+    CHECK(pcm_ring_write_all(w, buf, PCM_RING_FRAMES, NULL, NULL) == 0, "fill ring");
+    CHECK(pcm_ring_available(r) == PCM_RING_FRAMES, "full available=%u", pcm_ring_available(r));
+    CHECK(pcm_ring_write_all(w, one, 1, stop_always, NULL) == 1, "full write not stopped");
+    pcm_ring_flush(w);
+    CHECK(pcm_ring_available(r) == 0, "flush left %u frames", pcm_ring_available(r));
+    CHECK(pcm_ring_read(r, buf, 256) == 0, "read after flush");
+    g_read_seq = g_write_seq;
+}
+
+typedef struct {
+    PcmRing *ring;
+    uint32_t frames;
+    int ret;
+} WriterArg;
+
+static void *writer_thread(void *arg)
+{
+    WriterArg *a = (WriterArg *)arg;
+    static int16_t buf[PCM_RING_FRAMES * 2 * PCM_RING_CHANNELS];
+    fill(buf, a->frames);
+    a->ret = pcm_ring_write_all(a->ring, buf, a->frames, NULL, NULL);
+    return NULL;
+}
+
+// 写端在满环上阻塞，读端读走后应被唤醒写完，数据连续
+static void test_blocking_writer(PcmRing *r, PcmRing *w)
+{
+    static int16_t buf[PCM_RING_FRAMES * PCM_RING_CHANNELS];
+    WriterArg a = { w, PCM_RING_FRAMES + 1500, -2 };
+    pthread_t th;
+    uint32_t total = 0;
+    int64_t deadline = now_ms() + 2000;
+
+    pthread_create(&th, NULL, writer_thread, &a);
+    while (total < a.frames && now_ms() < deadline) {
+        uint32_t got;
+        pcm_ring_heartbeat(r, 0);
+        if (!pcm_ring_wait_readable(&r, 1, 50)) continue;
+        got = pcm_ring_read(r, buf, 512);
+        CHECK(verify(buf, got) == 0, "blocking writer data mismatch");
+        total += got;
+    }
+    pthread_join(th, NULL);
+    CHECK(a.ret == 0, "writer ret=%d", a.ret);
+    CHECK(total == a.frames, "read %u of %u", total, a.frames);
+}
+
+static void test_doorbell(PcmRing *r, PcmRing *w)
+{
+    PcmRing *const rings[1] = { r };
+    int16_t buf[16 * PCM_RING_CHANNELS];
+    int64_t t0 = now_ms();
+
+    CHECK(pcm_ring_wait_readable(rings, 1, 30) == 0, "empty ring reported readable");
+    CHECK(now_ms() - t0 >= 25, "wait returned after %lld ms", (long long)(now_ms() - t0));
+    fill(buf, 16);
+    pcm_ring_write_all(w, buf, 16, NULL, NULL);
+    CHECK(pcm_ring_wait_readable(rings, 1, 1000) == 1, "data not reported");
+    pcm_ring_read(r, buf, 16);
+    CHECK(verify(buf, 16) == 0, "doorbell data mismatch");
+}
+
+int main(void)
+{
+    PcmRing reader;
+    PcmRing writer;
+
+    shm_unlink(TEST_RING);
+    if (pcm_ring_create(&reader, TEST_RING) != 0 || pcm_ring_attach(&writer, TEST_RING) != 0) {
+        printf("FAIL 创建/打开共享内存\n");
+        return 1;
+    }
+    test_wrap(&reader, &writer);
+    test_underrun(&reader, &writer);
+    test_full_and_flush(&reader, &writer);
+    test_blocking_writer(&reader, &writer);
+    test_doorbell(&reader, &writer);
+
+    pcm_ring_close(&writer);
+    pcm_ring_close(&reader);
+    shm_unlink(TEST_RING);
+    shm_unlink(PCM_RING_DOORBELL);
+    printf("%s\n", g_failed == 0 ? "all passed" : "failed");
+    return g_failed == 0 ? 0 : 1;
+}
@@ -0,0 +1,330 @@
+#define _GNU_SOURCE
+#include "ipc_bus.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+
+#define IPC_BUS_PREFIX "smart_speaker/"
+#define IPC_BUS_BACKLOG 8
+
+// 抽象命名空间地址：sun_path[0] 为 '\0'，进程退出即释放，无需清理套接字文件，也不受工作目录影响
+static socklen_t bus_addr(const char *name, struct sockaddr_un *addr) {
+    int n;
+    memset(addr, 0, sizeof(*addr));
+    addr->sun_family = AF_UNIX;
+    n = snprintf(addr->sun_path + 1, sizeof(addr->sun_path) - 1, IPC_BUS_PREFIX "%s", name);
+    if (n < 0 || (size_t)n >= sizeof(addr->sun_path) - 1) {
+        return 0;
+    }
+    return (socklen_t)(offsetof(struct sockaddr_un, sun_path) + 1 + (size_t)n);
+}
+
+int ipc_bus_send(int fd, uint16_t type, uint32_t seq, const void *body, uint32_t body_len) {
+    IPCHeader h;
+    struct iovec iov[2];
+    struct msghdr msg;
+    ssize_t ret;
+
+    if (fd < 0 || body_len > IPC_MAX_BODY || (body_len > 0 && body == NULL)) {
+        errno = EINVAL;
+        return -1;
+    }
+    memset(&h, 0, sizeof(h));
+    h.magic = IPC_MAGIC;
+    h.version = IPC_VERSION;
+    h.type = type;
+    h.seq = seq;
+    h.body_len = body_len;
+
+    iov[0].iov_base = &h;
+    iov[0].iov_len = sizeof(h);
+    iov[1].iov_base = (void *)body;
+    iov[1].iov_len = body_len;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = body_len > 0 ? 2 : 1;
+
+    do {
+        ret = sendmsg(fd, &msg, MSG_DONTWAIT | MSG_NOSIGNAL);
+    } while (ret < 0 && errno == EINTR);
+    return ret < 0 ? -1 : 0;
+}
+
+int ipc_bus_recv(int fd, IPCHeader *header, uint8_t *buf, uint32_t cap) {
+    struct iovec iov[2];
+    struct msghdr msg;
+    ssize_t ret;
+
+    if (header == NULL || buf == NULL || cap == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    iov[0].iov_base = header;
+    iov[0].iov_len = sizeof(*header);
+    iov[1].iov_base = buf;
+    iov[1].iov_len = cap - 1;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = 2;
+
+    do {
+        ret = recvmsg(fd, &msg, MSG_DONTWAIT);
+    } while (ret < 0 && errno == EINTR);
+    if (ret < 0) {
+        return (errno == EAGAIN || errno == EWOULDBLOCK) ? 2 : -1;
+    }
+    if (ret == 0) {
+        return 1;
+    }
+    // 一个包即一条消息，截断或长度不符的包整个丢弃，不会影响后续消息的边界
+    if ((msg.msg_flags & MSG_TRUNC) || (size_t)ret < sizeof(*header) ||
+        header->magic != IPC_MAGIC || header->version != IPC_VERSION ||
+        header->body_len != (uint32_t)((size_t)ret - sizeof(*header))) {
+        errno = EBADMSG;
+        return -1;
+    }
+    buf[header->body_len] = '\0';
+    return 0;
+}
+
+int ipc_bus_reply(int fd, const IPCHeader *request, uint16_t type, const void *body, uint32_t body_len) {
+    if (request == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    return ipc_bus_send(fd, type, request->seq, body, body_len);
+}
+
+void ipc_bus_link_init(IPCBusLink *link, const char *name) {
+    link->name = name;
+    link->fd = -1;
+    link->seq = 0;
+}
+
+static int link_connect(IPCBusLink *link) {
+    struct sockaddr_un addr;
+    socklen_t len = bus_addr(link->name, &addr);
+    int fd;
+
+    if (len == 0) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    // Unix 域连接在对端 backlog 未满时立即完成，满了返回 EAGAIN，不会阻塞
+    if (connect(fd, (struct sockaddr *)&addr, len) != 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
+    }
+    link->fd = fd;
+    return 0;
+}
+
+int ipc_bus_link_send(IPCBusLink *link, uint16_t type, const void *body, uint32_t body_len, uint32_t *seq_out) {
+    uint32_t seq;
+    int attempt;
+
+    if (link == NULL || link->name == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    // seq 从 1 开始，0 留给「无请求」
+    seq = ++link->seq;
+    if (seq == 0) {
+        seq = ++link->seq;
+    }
+    for (attempt = 0; attempt < 2; attempt++) {
+        if (link->fd < 0 && link_connect(link) != 0) {
+            return -1;
+        }
+        if (ipc_bus_send(link->fd, type, seq, body, body_len) == 0) {
+            if (seq_out != NULL) {
+                *seq_out = seq;
+            }
+            return 0;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINVAL) {
+            return -1;
+        }
+        // EPIPE / ECONNRESET / ENOTCONN：对端重启过，旧连接作废，重连后再发一次
+        ipc_bus_link_close(link);
+    }
+    return -1;
+}
+
+void ipc_bus_link_close(IPCBusLink *link) {
+    if (link != NULL && link->fd >= 0) {
+        close(link->fd);
+        link->fd = -1;
+    }
+}
+
+int ipc_bus_server_open(IPCBusServer *server, const char *name) {
+    struct sockaddr_un addr;
+    socklen_t len;
+    int i;
+
+    server->listen_fd = -1;
+    for (i = 0; i < IPC_BUS_MAX_CONNS; i++) {
+        server->conns[i] = -1;
+    }
+    server->rx = (uint8_t *)malloc(IPC_MAX_BODY + 1);
+    if (server->rx == NULL) {
+        return -1;
+    }
+    len = bus_addr(name, &addr);
+    if (len == 0) {
+        errno = ENAMETOOLONG;
+        goto fail;
+    }
+    server->listen_fd = socket(AF_UNIX, SOCK_SEQPACKET | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (server->listen_fd < 0) {
+        goto fail;
+    }
+    // 同名进程仍在运行时 bind 返回 EADDRINUSE
+    if (bind(server->listen_fd, (struct sockaddr *)&addr, len) != 0 ||
+        listen(server->listen_fd, IPC_BUS_BACKLOG) != 0) {
+        goto fail;
+    }
+    return 0;
+
+fail:
+    {
+        int saved = errno;
+        ipc_bus_server_close(server);
+        errno = saved;
+    }
+    return -1;
+}
+
+int ipc_bus_server_accept(IPCBusServer *server) {
+    int fd;
+    int i;
+
+    fd = accept4(server->listen_fd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+    for (i = 0; i < IPC_BUS_MAX_CONNS; i++) {
+        if (server->conns[i] < 0) {
+            server->conns[i] = fd;
+            return fd;
+        }
+    }
+    close(fd);
+    errno = EMFILE;
+    return -1;
+}
+
+int ipc_bus_server_owns(const IPCBusServer *server, int fd) {
+    int i;
+    if (fd < 0) {
+        return 0;
+    }
+    if (fd == server->listen_fd) {
+        return 1;
+    }
+    for (i = 0; i < IPC_BUS_MAX_CONNS; i++) {
+        if (server->conns[i] == fd) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static void server_drop(IPCBusServer *server, int fd) {
+    int i;
+    for (i = 0; i < IPC_BUS_MAX_CONNS; i++) {
+        if (server->conns[i] == fd) {
+            server->conns[i] = -1;
+        }
+    }
+    close(fd);
+}
+
+int ipc_bus_server_read(IPCBusServer *server, int fd, ipc_bus_handler handler, void *arg) {
+    for (;;) {
+        IPCHeader header;
+        int ret = ipc_bus_recv(fd, &header, server->rx, IPC_MAX_BODY + 1);
+        if (ret == 0) {
+            if (handler != NULL) {
+                handler(fd, &header, server->rx, arg);
+            }
+            continue;
+        }
+        if (ret == 2) {
+            return 0;
+        }
+        if (ret == -1 && errno == EBADMSG) {
+            continue;
+        }
+        server_drop(server, fd);
+        return 1;
+    }
+}
+
+int ipc_bus_server_poll(IPCBusServer *server, int timeout_ms, ipc_bus_handler handler, void *arg) {
+    struct pollfd pfds[IPC_BUS_MAX_CONNS + 1];
+    int n = 0;
+    int handled = 0;
+    int ret;
+    int i;
+
+    pfds[n].fd = server->listen_fd;
+    pfds[n].events = POLLIN;
+    n++;
+    for (i = 0; i < IPC_BUS_MAX_CONNS; i++) {
+        if (server->conns[i] >= 0) {
+            pfds[n].fd = server->conns[i];
+            pfds[n].events = POLLIN;
+            n++;
+        }
+    }
+    ret = poll(pfds, (nfds_t)n, timeout_ms);
+    if (ret <= 0) {
+        return (ret < 0 && errno != EINTR) ? -1 : 0;
+    }
+    for (i = 1; i < n; i++) {
+        if (pfds[i].revents != 0) {
+            ipc_bus_server_read(server, pfds[i].fd, handler, arg);
+            handled++;
+        }
+    }
+    if (pfds[0].revents & POLLIN) {
+        int fd;
+        while ((fd = ipc_bus_server_accept(server)) >= 0) {
+            // 连接后紧跟着发的消息可能已经到达，不等下一轮 poll
+            ipc_bus_server_read(server, fd, handler, arg);
+        }
+    }
+    return handled;
+}
+
+void ipc_bus_server_close(IPCBusServer *server) {
+    int i;
+    for (i = 0; i < IPC_BUS_MAX_CONNS; i++) {
+        if (server->conns[i] >= 0) {
+            close(server->conns[i]);
+            server->conns[i] = -1;
+        }
+    }
+    if (server->listen_fd >= 0) {
+        close(server->listen_fd);
+        server->listen_fd = -1;
+    }
+    free(server->rx);
+    server->rx = NULL;
+}
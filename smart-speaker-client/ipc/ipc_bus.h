@@ -0,0 +1,53 @@
+#ifndef IPC_BUS_H
+#define IPC_BUS_H
+
+#include <stdint.h>
+
+#include "ipc_message.h"
+
+/* 进程间消息总线：每个进程在抽象命名空间（"\0smart_speaker/<name>"）监听一个 SOCK_SEQPACKET 套接字，
+ * 一个包就是一条完整的 IPCHeader + body，收发都不需要按长度拼帧。
+ * 发送方保持长连接并以 MSG_DONTWAIT 发送，对端积压时丢弃而不阻塞，对端重启后下次发送自动重连一次；
+ * 应答沿请求所在的连接返回，header.seq 与请求相同。 */
+
+#define IPC_BUS_MAX_CONNS 8
+
+// 到某个对端的长连接，fd 为 -1 时下次发送再连
+typedef struct {
+    const char *name;
+    int fd;
+    uint32_t seq;
+} IPCBusLink;
+
+// 监听端：listen_fd 与已接受的连接，rx 为收包的 body 缓冲区（IPC_MAX_BODY + 结尾 '\0'）
+typedef struct {
+    int listen_fd;
+    int conns[IPC_BUS_MAX_CONNS];
+    uint8_t *rx;
+} IPCBusServer;
+
+// 收到一条消息；body 以 '\0' 结尾，仅在回调内有效；fd 可用于 ipc_bus_reply
+typedef void (*ipc_bus_handler)(int fd, const IPCHeader *header, const uint8_t *body, void *arg);
+
+/* 单包收发：send 成功 0，失败 -1（errno 为 EAGAIN 表示对端积压）；
+ * recv 返回 0 收到一条，2 暂无数据，1 对端关闭，-1 出错或包不合法 */
+int ipc_bus_send(int fd, uint16_t type, uint32_t seq, const void *body, uint32_t body_len);
+int ipc_bus_recv(int fd, IPCHeader *header, uint8_t *buf, uint32_t cap);
+int ipc_bus_reply(int fd, const IPCHeader *request, uint16_t type, const void *body, uint32_t body_len);
+
+void ipc_bus_link_init(IPCBusLink *link, const char *name);
+// 发送一条消息，*seq_out 为本条的 seq（可为 NULL）；0 成功，-1 对端不在或积压
+int ipc_bus_link_send(IPCBusLink *link, uint16_t type, const void *body, uint32_t body_len, uint32_t *seq_out);
+void ipc_bus_link_close(IPCBusLink *link);
+
+int ipc_bus_server_open(IPCBusServer *server, const char *name);
+// 接受一个新连接，返回其 fd（已加入 conns），无新连接或已满返回 -1
+int ipc_bus_server_accept(IPCBusServer *server);
+int ipc_bus_server_owns(const IPCBusServer *server, int fd);
+// 读完连接上已到达的消息并逐条回调；返回 0 连接仍在，1 对端关闭（fd 已关闭并移出 conns）
+int ipc_bus_server_read(IPCBusServer *server, int fd, ipc_bus_handler handler, void *arg);
+// 等待最多 timeout_ms，接受新连接并处理所有就绪连接上的消息；返回有事件的连接数（0 为超时），-1 出错
+int ipc_bus_server_poll(IPCBusServer *server, int timeout_ms, ipc_bus_handler handler, void *arg);
+void ipc_bus_server_close(IPCBusServer *server);
+
+#endif
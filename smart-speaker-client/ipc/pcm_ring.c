@@ -0,0 +1,358 @@
+#include "pcm_ring.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#define PCM_RING_MAGIC      0x50434d52u     // "PCMR"
+#define PCM_RING_VERSION    2
+#define PCM_RING_BELL_MAGIC 0x50434d42u     // "PCMB"
+#define PCM_RING_DATA_OFF   ((sizeof(PcmRingShared) + 63) & ~(size_t)63)
+
+static int64_t monotonic_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/* 共享内存跨进程映射，不能用 FUTEX_PRIVATE；超时或被唤醒都直接返回，调用方自己复查条件 */
+static void futex_wait(_Atomic uint32_t *addr, uint32_t val, int timeout_ms)
+{
+    struct timespec ts;
+    ts.tv_sec = timeout_ms / 1000;
+    ts.tv_nsec = (long)(timeout_ms % 1000) * 1000000L;
+    syscall(SYS_futex, (uint32_t *)addr, FUTEX_WAIT, val, &ts, NULL, 0);
+}
+
+static void futex_wake(_Atomic uint32_t *addr)
+{
+    syscall(SYS_futex, (uint32_t *)addr, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+static size_t ring_map_len(void)
+{
+    return PCM_RING_DATA_OFF + (size_t)PCM_RING_FRAMES * PCM_RING_CHANNELS * sizeof(int16_t);
+}
+
+static int ring_map(PcmRing *ring, int fd)
+{
+    void *p = mmap(NULL, ring_map_len(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        return -1;
+    }
+    ring->shm = (PcmRingShared *)p;
+    ring->data = (int16_t *)((char *)p + PCM_RING_DATA_OFF);
+    ring->mask = PCM_RING_FRAMES - 1;
+    ring->map_len = ring_map_len();
+    return 0;
+}
+
+// 门铃由读端创建，写端只打开；读端重启不重建，写端已有的映射照常可用
+static PcmRingDoorbell *bell_map(int create)
+{
+    PcmRingDoorbell *bell;
+    void *p;
+    int fd = shm_open(PCM_RING_DOORBELL, create ? (O_RDWR | O_CREAT) : O_RDWR, 0666);
+
+    if (fd < 0) {
+        return NULL;
+    }
+    if (create) {
+        fchmod(fd, 0666);
+        if (ftruncate(fd, (off_t)sizeof(PcmRingDoorbell)) != 0) {
+            close(fd);
+            return NULL;
+        }
+    }
+    p = mmap(NULL, sizeof(PcmRingDoorbell), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) {
+        return NULL;
+    }
+    bell = (PcmRingDoorbell *)p;
+    if (__atomic_load_n(&bell->magic, __ATOMIC_ACQUIRE) != PCM_RING_BELL_MAGIC) {
+        if (!create) {
+            munmap(p, sizeof(PcmRingDoorbell));
+            return NULL;
+        }
+        atomic_store_explicit(&bell->seq, 0, memory_order_relaxed);
+        atomic_store_explicit(&bell->reader_waiting, 0, memory_order_relaxed);
+        __atomic_store_n(&bell->magic, PCM_RING_BELL_MAGIC, __ATOMIC_RELEASE);
+    }
+    return bell;
+}
+
+int pcm_ring_create(PcmRing *ring, const char *name)
+{
+    PcmRingShared *s;
+    int fd;
+
+    memset(ring, 0, sizeof(*ring));
+    fd = shm_open(name, O_RDWR | O_CREAT, 0666);
+    if (fd < 0) {
+        return -1;
+    }
+    // 各进程可能以不同用户运行，umask 不应收窄权限
+    fchmod(fd, 0666);
+    if (ftruncate(fd, (off_t)ring_map_len()) != 0 || ring_map(ring, fd) != 0) {
+        close(fd);
+        return -1;
+    }
+    close(fd);
+    ring->bell = bell_map(1);
+    if (ring->bell == NULL) {
+        pcm_ring_close(ring);
+        return -1;
+    }
+
+    /* 不 unlink 重建：写端的映射在混音进程重启后仍然有效。
+     * 布局一致时保留 head（写端在用），只把 tail 追上去丢弃残留；否则整体重置 */
+    s = ring->shm;
+    if (s->magic != PCM_RING_MAGIC || s->version != PCM_RING_VERSION || s->frames != PCM_RING_FRAMES ||
+        s->rate != PCM_RING_RATE || s->channels != PCM_RING_CHANNELS) {
+        memset(s, 0, sizeof(*s));
+        s->version = PCM_RING_VERSION;
+        s->rate = PCM_RING_RATE;
+        s->channels = PCM_RING_CHANNELS;
+        s->frames = PCM_RING_FRAMES;
+        atomic_store_explicit(&s->head, 0, memory_order_relaxed);
+        atomic_store_explicit(&s->flush_to, 0, memory_order_relaxed);
+        __atomic_store_n(&s->magic, PCM_RING_MAGIC, __ATOMIC_RELEASE);
+    }
+    atomic_store_explicit(&s->tail, atomic_load_explicit(&s->head, memory_order_acquire), memory_order_release);
+    atomic_store_explicit(&s->out_delay_frames, 0, memory_order_relaxed);
+    pcm_ring_heartbeat(ring, 0);
+    return 0;
+}
+
+int pcm_ring_attach(PcmRing *ring, const char *name)
+{
+    struct stat st;
+    int fd;
+
+    memset(ring, 0, sizeof(*ring));
+    fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < ring_map_len() || ring_map(ring, fd) != 0) {
+        close(fd);
+        memset(ring, 0, sizeof(*ring));
+        return -1;
+    }
+    close(fd);
+    if (__atomic_load_n(&ring->shm->magic, __ATOMIC_ACQUIRE) != PCM_RING_MAGIC ||
+        ring->shm->version != PCM_RING_VERSION || ring->shm->frames != PCM_RING_FRAMES) {
+        pcm_ring_close(ring);
+        errno = EPROTO;
+        return -1;
+    }
+    ring->bell = bell_map(0);
+    if (ring->bell == NULL) {
+        pcm_ring_close(ring);
+        return -1;
+    }
+    return 0;
+}
+
+void pcm_ring_close(PcmRing *ring)
+{
+    if (ring->shm != NULL) {
+        munmap(ring->shm, ring->map_len);
+    }
+    if (ring->bell != NULL) {
+        munmap(ring->bell, sizeof(PcmRingDoorbell));
+    }
+    memset(ring, 0, sizeof(*ring));
+}
+
+int pcm_ring_reader_alive(const PcmRing *ring)
+{
+    int64_t beat;
+
+    if (ring->shm == NULL) {
+        return 0;
+    }
+    beat = atomic_load_explicit(&ring->shm->heartbeat_ms, memory_order_relaxed);
+    return beat != 0 && monotonic_ms() - beat < PCM_RING_ALIVE_MS;
+}
+
+/* 写端阻塞到 tail 推进到 need_tail 或超时。先登记 writer_waiting 再复查 tail，
+ * 与读端「推进 tail → 查 writer_waiting」配对，两边各有一次全序栅栏，不会漏唤醒 */
+static void ring_wait_tail(PcmRing *ring, uint64_t need_tail, int timeout_ms)
+{
+    PcmRingShared *s = ring->shm;
+    uint32_t seq = atomic_load_explicit(&s->space_seq, memory_order_acquire);
+
+    atomic_store_explicit(&s->writer_waiting, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&s->tail, memory_order_acquire) < need_tail) {
+        futex_wait(&s->space_seq, seq, timeout_ms);
+    }
+    atomic_store_explicit(&s->writer_waiting, 0, memory_order_relaxed);
+}
+
+static void ring_ring_bell(PcmRing *ring)
+{
+    PcmRingDoorbell *bell = ring->bell;
+
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&bell->reader_waiting, memory_order_relaxed)) {
+        atomic_fetch_add_explicit(&bell->seq, 1, memory_order_release);
+        futex_wake(&bell->seq);
+    }
+}
+
+int pcm_ring_write_all(PcmRing *ring, const int16_t *buf, uint32_t frames, pcm_ring_stop_fn stop, void *arg)
+{
+    PcmRingShared *s = ring->shm;
+    uint64_t head = atomic_load_explicit(&s->head, memory_order_relaxed);
+
+    while (frames > 0) {
+        uint64_t tail = atomic_load_explicit(&s->tail, memory_order_acquire);
+        uint32_t space = PCM_RING_FRAMES - (uint32_t)(head - tail);
+        uint32_t count;
+        uint32_t pos;
+        uint32_t first;
+
+        if (space == 0) {
+            if (stop != NULL && stop(arg)) return 1;
+            if (!pcm_ring_reader_alive(ring)) return -1;
+            ring_wait_tail(ring, head - PCM_RING_FRAMES + 1, PCM_RING_WAIT_MS);
+            continue;
+        }
+        count = frames < space ? frames : space;
+        pos = (uint32_t)(head & ring->mask);
+        first = PCM_RING_FRAMES - pos < count ? PCM_RING_FRAMES - pos : count;
+        memcpy(ring->data + (size_t)pos * PCM_RING_CHANNELS, buf,
+               (size_t)first * PCM_RING_CHANNELS * sizeof(int16_t));
+        memcpy(ring->data, buf + (size_t)first * PCM_RING_CHANNELS,
+               (size_t)(count - first) * PCM_RING_CHANNELS * sizeof(int16_t));
+        head += count;
+        atomic_store_explicit(&s->head, head, memory_order_release);
+        ring_ring_bell(ring);
+        buf += (size_t)count * PCM_RING_CHANNELS;
+        frames -= count;
+    }
+    return 0;
+}
+
+void pcm_ring_flush(PcmRing *ring)
+{
+    if (ring->shm == NULL) {
+        return;
+    }
+    atomic_store_explicit(&ring->shm->flush_to,
+                          atomic_load_explicit(&ring->shm->head, memory_order_relaxed), memory_order_release);
+}
+
+int pcm_ring_drain(PcmRing *ring, pcm_ring_stop_fn stop, void *arg)
+{
+    PcmRingShared *s = ring->shm;
+    uint64_t head = atomic_load_explicit(&s->head, memory_order_relaxed);
+    int64_t deadline;
+    int64_t left;
+
+    while (atomic_load_explicit(&s->tail, memory_order_acquire) < head) {
+        if (stop != NULL && stop(arg)) return 1;
+        if (!pcm_ring_reader_alive(ring)) return -1;
+        ring_wait_tail(ring, head, PCM_RING_WAIT_MS);
+    }
+    // 最后一段已交给 ALSA，按读端报告的输出延迟再等它播完；分段睡以便及时响应 stop
+    deadline = monotonic_ms() +
+               (int64_t)atomic_load_explicit(&s->out_delay_frames, memory_order_relaxed) * 1000 / PCM_RING_RATE;
+    while ((left = deadline - monotonic_ms()) > 0) {
+        if (stop != NULL && stop(arg)) return 1;
+        usleep((useconds_t)(left < PCM_RING_WAIT_MS ? left : PCM_RING_WAIT_MS) * 1000);
+    }
+    return 0;
+}
+
+// 读端视角的 tail：写端请求过 flush 时先推到 flush_to
+static uint64_t ring_read_tail(const PcmRingShared *s, uint64_t head)
+{
+    uint64_t tail = atomic_load_explicit(&s->tail, memory_order_relaxed);
+    uint64_t flush_to = atomic_load_explicit(&s->flush_to, memory_order_acquire);
+
+    if (flush_to > tail) {
+        tail = flush_to < head ? flush_to : head;
+    }
+    return tail;
+}
+
+uint32_t pcm_ring_available(const PcmRing *ring)
+{
+    const PcmRingShared *s = ring->shm;
+    uint64_t head = atomic_load_explicit(&s->head, memory_order_acquire);
+
+    return (uint32_t)(head - ring_read_tail(s, head));
+}
+
+uint32_t pcm_ring_read(PcmRing *ring, int16_t *out, uint32_t max_frames)
+{
+    PcmRingShared *s = ring->shm;
+    uint64_t head = atomic_load_explicit(&s->head, memory_order_acquire);
+    uint64_t tail = ring_read_tail(s, head);
+    uint32_t count;
+    uint32_t pos;
+    uint32_t first;
+
+    count = (uint32_t)(head - tail);
+    if (count > max_frames) count = max_frames;
+    pos = (uint32_t)(tail & ring->mask);
+    first = PCM_RING_FRAMES - pos < count ? PCM_RING_FRAMES - pos : count;
+    memcpy(out, ring->data + (size_t)pos * PCM_RING_CHANNELS, (size_t)first * PCM_RING_CHANNELS * sizeof(int16_t));
+    memcpy(out + (size_t)first * PCM_RING_CHANNELS, ring->data,
+           (size_t)(count - first) * PCM_RING_CHANNELS * sizeof(int16_t));
+    if (tail + count == atomic_load_explicit(&s->tail, memory_order_relaxed)) {
+        return count;
+    }
+    atomic_store_explicit(&s->tail, tail + count, memory_order_release);
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&s->writer_waiting, memory_order_relaxed)) {
+        atomic_fetch_add_explicit(&s->space_seq, 1, memory_order_release);
+        futex_wake(&s->space_seq);
+    }
+    return count;
+}
+
+int pcm_ring_wait_readable(PcmRing *const *rings, int count, int timeout_ms)
+{
+    PcmRingDoorbell *bell;
+    uint32_t seq;
+    int i;
+    int ready = 0;
+
+    if (count <= 0) {
+        return 0;
+    }
+    bell = rings[0]->bell;
+    seq = atomic_load_explicit(&bell->seq, memory_order_acquire);
+    atomic_store_explicit(&bell->reader_waiting, 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    for (i = 0; i < count && !ready; i++) {
+        ready = pcm_ring_available(rings[i]) > 0;
+    }
+    if (!ready && timeout_ms > 0) {
+        futex_wait(&bell->seq, seq, timeout_ms);
+        for (i = 0; i < count && !ready; i++) {
+            ready = pcm_ring_available(rings[i]) > 0;
+        }
+    }
+    atomic_store_explicit(&bell->reader_waiting, 0, memory_order_relaxed);
+    return ready;
+}
+
+void pcm_ring_heartbeat(PcmRing *ring, uint32_t out_delay_frames)
+{
+    atomic_store_explicit(&ring->shm->out_delay_frames, out_delay_frames, memory_order_relaxed);
+    atomic_store_explicit(&ring->shm->heartbeat_ms, monotonic_ms(), memory_order_relaxed);
+}
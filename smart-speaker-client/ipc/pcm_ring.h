@@ -0,0 +1,87 @@
+#ifndef PCM_RING_H
+#define PCM_RING_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* 进程间 PCM 环形缓冲区：/dev/shm 上的共享内存，一个写端（tts / 播放管道）一个读端（audio_mixer）。
+ * 样本固定为交错双声道 S16LE、PCM_RING_RATE，写端自己负责转换；
+ * head/tail 为单调递增的帧计数，head 只由写端写、tail 只由读端写，release/acquire 保证样本先于位置可见。
+ * 读端每个周期刷新 heartbeat_ms，写端据此判断混音进程是否在线，不在线时退回直接写 ALSA。
+ * 等待不轮询：写端等空间挂在本环的 space_seq futex 上，读端每读走一段就唤醒；
+ * 读端要同时等两个环，挂在所有环共用的门铃（单独一块共享内存）上，写端写入后按门铃。
+ * 超时只用来复查写端的 stop 回调与读端心跳。 */
+
+#define PCM_RING_RATE       48000
+#define PCM_RING_CHANNELS   2
+#define PCM_RING_FRAMES     4096            // 2 的幂，约 85 ms，也是音乐经过混音进程多出的最大延迟
+#define PCM_RING_ALIVE_MS   500             // 心跳超过该时间未刷新视为混音进程不在
+#define PCM_RING_WAIT_MS    20              // 写端单次阻塞上限，到时复查 stop 与读端心跳
+#define PCM_RING_HEARTBEAT_MS 200           // 读端空闲阻塞上限，须明显小于 PCM_RING_ALIVE_MS
+
+#define PCM_RING_MUSIC      "/smart_speaker_pcm_music"
+#define PCM_RING_TTS        "/smart_speaker_pcm_tts"
+#ifndef PCM_RING_DOORBELL
+#define PCM_RING_DOORBELL   "/smart_speaker_pcm_doorbell"
+#endif
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t rate;
+    uint32_t channels;
+    uint32_t frames;
+    uint32_t reserved;
+    _Atomic uint64_t head;
+    _Atomic uint64_t tail;
+    _Atomic uint64_t flush_to;              // 写端请求丢弃此前写入的帧，读端下次读取时把 tail 推到这里
+    _Atomic int64_t heartbeat_ms;           // CLOCK_MONOTONIC 毫秒
+    _Atomic uint32_t out_delay_frames;      // 读端送进 ALSA 后尚未播出的帧数，drain 时多等这么久
+    _Atomic uint32_t space_seq;             // futex：读端推进 tail 后递增
+    _Atomic uint32_t writer_waiting;        // 写端挂在 space_seq 上时置 1，读端据此决定是否 FUTEX_WAKE
+} PcmRingShared;
+
+typedef struct {
+    uint32_t magic;
+    _Atomic uint32_t seq;                   // futex：写端写入新数据后递增
+    _Atomic uint32_t reader_waiting;
+} PcmRingDoorbell;
+
+typedef struct {
+    PcmRingShared *shm;
+    int16_t *data;
+    uint32_t mask;
+    size_t map_len;
+    PcmRingDoorbell *bell;
+} PcmRing;
+
+// 写端返回 1 表示应放弃等待（被打断、管道退出等）
+typedef int (*pcm_ring_stop_fn)(void *arg);
+
+// 读端：创建或接管已有的共享内存，残留未播数据一并丢弃；0 成功，-1 失败
+int pcm_ring_create(PcmRing *ring, const char *name);
+// 写端：打开混音进程建好的共享内存，不存在返回 -1
+int pcm_ring_attach(PcmRing *ring, const char *name);
+void pcm_ring_close(PcmRing *ring);
+
+int pcm_ring_reader_alive(const PcmRing *ring);
+
+/* 写端：写完 frames 帧才返回，缓冲区满时阻塞等读端腾出空间。
+ * 返回 0 写完，1 被 stop 打断，-1 读端心跳超时（剩余数据未写） */
+int pcm_ring_write_all(PcmRing *ring, const int16_t *buf, uint32_t frames, pcm_ring_stop_fn stop, void *arg);
+// 写端：丢弃已写入但还未被读走的数据
+void pcm_ring_flush(PcmRing *ring);
+// 写端：等已写入的数据全部播出（含读端的 ALSA 缓冲）；返回值同 pcm_ring_write_all
+int pcm_ring_drain(PcmRing *ring, pcm_ring_stop_fn stop, void *arg);
+
+// 读端：当前可读帧数（已计入写端的 flush）
+uint32_t pcm_ring_available(const PcmRing *ring);
+// 读端：取出最多 max_frames 帧，不等待、不补静音；返回实际帧数
+uint32_t pcm_ring_read(PcmRing *ring, int16_t *out, uint32_t max_frames);
+/* 读端：阻塞到任一环有数据或超时；rings 须都由本进程 pcm_ring_create。
+ * 返回 1 有数据，0 超时 */
+int pcm_ring_wait_readable(PcmRing *const *rings, int count, int timeout_ms);
+void pcm_ring_heartbeat(PcmRing *ring, uint32_t out_delay_frames);
+
+#endif
@@ -9,6 +9,7 @@
 
 #include "select.h"
 #include "music_server_async.h"
+#include "select_music_llm.h"
 #include "link.h"
 #include "shm.h"
 #include "socket.h"
@@ -98,66 +99,44 @@ int main(int argc, char const *argv[])
     (void)argc;
     (void)argv;
     run_init_script();
-    if (access("./fifo/asr_fifo", F_OK) != 0 && access("../fifo/asr_fifo", F_OK) == 0) {
+    if (access("./fifo/cmd_fifo", F_OK) != 0 && access("../fifo/cmd_fifo", F_OK) == 0) {
         chdir("..");
-    } else if (access("./fifo/asr_fifo", F_OK) != 0 && access("../../fifo/asr_fifo", F_OK) == 0) {
+    } else if (access("./fifo/cmd_fifo", F_OK) != 0 && access("../../fifo/cmd_fifo", F_OK) == 0) {
         chdir("../..");
     }
 
     app_log_init("player");
 
-    /* SA_RESTART 默认会重启阻塞的 select，导致 EOF 后无法及时处理 g_playlist_eof_flag */
+    /* SA_RESTART 默认会重启阻塞的 epoll_wait，导致 EOF 后无法及时处理 g_playlist_eof_flag */
     install_no_restart_handler(SIGUSR1, player_handle_playlist_eof);
     install_no_restart_handler(SIGCHLD, player_handle_sigchld);
     signal(SIGINT, handle_exit_signal);
     signal(SIGTERM, handle_exit_signal);
     signal(SIGHUP, handle_exit_signal);
-    // 注册信号处理函数， 用于处理定时器到期信号
-	signal(SIGALRM, button_handler);
 
     if(select_init() != 0)
     {
-        LOGE(TAG, "select初始化失败");
+        LOGE(TAG, "事件循环初始化失败");
         return -1;
     }
-    LOGI(TAG, "select初始化成功！");
+    LOGI(TAG, "事件循环初始化成功！");
 
     if (music_server_async_init() != 0) {
         LOGE(TAG, "music_server_async 初始化失败");
         return -1;
     }
-
-    // 打开并监听asr模型的管道文件
-    if(init_asr_fifo() != 0)
-    {
-        LOGE(TAG, "打开asr语音识别管道失败");
-        return -1;
-    }
-    LOGI(TAG, "打开asr语音识别管道成功！");
-
-    if (init_kws_fifo() == 0)
-    {
-        LOGI(TAG, "打开kws关键词识别管道成功！");
-    }
-    else
-    {
-        LOGW(TAG, "打开kws关键词识别管道失败，继续启动");
-    }
-
-    // 打开tts模型的管道文件
-    if(init_tts_fifo() != 0)
-    {
-        LOGE(TAG, "打开tts语音合成管道失败");
+    if (llm_async_init() != 0) {
+        LOGE(TAG, "LLM 工作线程初始化失败");
         return -1;
     }
-    LOGI(TAG, "打开tts语音合成管道成功！");
 
-    if(init_player_ctrl_fifo() != 0)
+    // 监听 asr_kws / TTS 的事件，到二者的连接在首次发送时建立
+    if(player_ipc_init() != 0)
     {
-        LOGE(TAG, "打开player控制管道失败");
+        LOGE(TAG, "消息总线初始化失败");
         return -1;
     }
-    LOGI(TAG, "打开player控制管道成功！");
+    LOGI(TAG, "消息总线初始化成功！");
 
 
     if(link_init() != 0)
@@ -191,6 +170,9 @@ int main(int argc, char const *argv[])
         }
     }
 
+    if (device_mixer_init() != 0) {
+        LOGW(TAG, "混音器常驻打开失败，音量读写退回按次打开");
+    }
     device_set_volume(player_runtime_startup_volume());
 
     if (player_env_forces_offline()) {
@@ -202,7 +184,7 @@ int main(int argc, char const *argv[])
             LOGW(TAG, "离线模式初始化失败，本地曲库可能不可用");
         }
     } else {
-        LOGI(TAG, "TCP 长连成功，已注册 select 与定时上报");
+        LOGI(TAG, "TCP 长连成功，已注册事件循环与定时上报");
     }
 
     // // 初始化按键
@@ -215,6 +197,8 @@ int main(int argc, char const *argv[])
     select_run();   // 启动事件监听
     player_stop_play();
     player_cmd_fifo_close();
+    player_ipc_close();
+    device_mixer_close();
     shm_detach();
 
     return 0;
@@ -21,10 +21,12 @@
 #include "music_lib_bridge.h"
 #include "music_source.h"
 #include "music_source_server.h"
+#include "music_source_local_index.h"
 #include "socket.h"
 #include "debug_log.h"
 #include "runtime_config.h"
 #include "player_constants.h"
+#include "voice-assistant/common/ipc_protocol.h"
 
 #define TAG "PLAYER"
 
@@ -35,10 +37,6 @@ volatile sig_atomic_t g_audio_focus_state = AUDIO_FOCUS_IDLE;
 int g_current_online_mode = ONLINE_MODE_YES;
 static int g_env_forces_offline = 0;
 
-int g_asr_fd = -1;
-int g_kws_fd = -1;
-int g_tts_fd = -1;
-int g_player_ctrl_fd = -1;
 
 static player_playlist_ctx_t g_playlist_ctx = {
     .keyword = "",
@@ -53,7 +51,9 @@ static volatile sig_atomic_t g_eof_autostart_suppressed = 0;
 static volatile sig_atomic_t g_voice_intro_defer = PLAYER_VOICE_DEFER_NONE;
 static volatile sig_atomic_t g_voice_cmd_followup_expected = 0;
 static int g_gst_cmd_fifo_fd = -1;
+static int g_music_ducked = 0;      // 已向播放管道发过 duck，尚未恢复
 static int player_write_fifo(const char *cmd);
+static void player_pause_current_output(void);
 static void asr_kws_switch_offline_mode(void);
 static void player_commit_offline_runtime_state(void);
 static void player_sync_shm_to_first_playable_local_song(void);
@@ -83,6 +83,7 @@ int player_get_audio_focus(void)
 int player_audio_focus_should_resume(void)
 {
     return g_audio_focus_state == AUDIO_FOCUS_MUSIC_PAUSED_FOR_TTS ||
+           g_audio_focus_state == AUDIO_FOCUS_MUSIC_DUCKED_FOR_TTS ||
            g_audio_focus_state == AUDIO_FOCUS_MUSIC_RESUMING;
 }
 
@@ -96,6 +97,10 @@ void player_audio_focus_prepare_resume(void)
 void player_audio_focus_cancel_resume(void)
 {
     if (player_audio_focus_should_resume()) {
+        /* 压低中的音乐不再恢复时，与暂停方案结果一致：停在暂停，继续播放时再恢复音量 */
+        if (g_music_ducked && g_current_state == PLAY_STATE_PLAY && g_current_suspend == PLAY_SUSPEND_NO) {
+            player_pause_current_output();
+        }
         g_audio_focus_state = AUDIO_FOCUS_MUSIC_PAUSED_MANUAL;
     } else if (g_audio_focus_state == AUDIO_FOCUS_TTS_PLAYING) {
         g_audio_focus_state = AUDIO_FOCUS_IDLE;
@@ -521,6 +526,18 @@ static void player_pause_current_output(void)
     g_current_suspend = PLAY_SUSPEND_YES;
 }
 
+// 通知播放管道把音量渐变回原值
+static void player_unduck_output(void)
+{
+    char cmd[32];
+    if (!g_music_ducked) {
+        return;
+    }
+    g_music_ducked = 0;
+    snprintf(cmd, sizeof(cmd), "duck 0 %d\n", player_runtime_tts_duck_ramp_ms());
+    (void)player_write_fifo(cmd);
+}
+
 static int player_ensure_gst_cmd_fifo_wr(void)
 {
     if (g_gst_cmd_fifo_fd >= 0) {
@@ -774,6 +791,7 @@ void player_stop_play(void)
     }
     g_current_state = PLAY_STATE_STOP;
     g_current_suspend = PLAY_SUSPEND_YES;
+    g_music_ducked = 0;
     player_set_audio_focus(AUDIO_FOCUS_IDLE);
     s.child_pid = 0;
     s.grand_pid = 0;
@@ -795,6 +813,7 @@ void player_continue_play()
         } else {
             (void)player_write_fifo("cycle pause\n");
         }
+        player_unduck_output();
         g_current_state = PLAY_STATE_PLAY;
         g_current_suspend = PLAY_SUSPEND_NO;
         player_set_audio_focus(AUDIO_FOCUS_MUSIC_PLAYING);
@@ -805,6 +824,11 @@ void player_continue_play()
         LOGI(TAG, "继续播放");
         return;
     }
+    if (g_music_ducked) {
+        player_unduck_output();
+        player_set_audio_focus(AUDIO_FOCUS_MUSIC_PLAYING);
+        LOGI(TAG, "恢复音乐音量");
+    }
     if (!pid_is_alive(s.child_pid)) {
         player_start_play();
     }
@@ -818,6 +842,26 @@ void player_suspend_play()
     LOGI(TAG, "暂停播放");
 }
 
+/* TTS 开始时让音乐在播放管道里渐变压低而不是暂停，解码与时钟不中断；
+ * 配置为 0 dB 或管道不可写时返回 -1，调用方退回 player_suspend_for_tts */
+int player_duck_for_tts(void)
+{
+    char cmd[32];
+    int duck_db = player_runtime_tts_duck_db();
+
+    if (g_current_state == PLAY_STATE_STOP || g_current_suspend == PLAY_SUSPEND_YES || duck_db <= 0) {
+        return -1;
+    }
+    snprintf(cmd, sizeof(cmd), "duck %d %d\n", duck_db, player_runtime_tts_duck_ramp_ms());
+    if (player_write_fifo(cmd) != 0) {
+        return -1;
+    }
+    g_music_ducked = 1;
+    player_set_audio_focus(AUDIO_FOCUS_MUSIC_DUCKED_FOR_TTS);
+    LOGI(TAG, "TTS 播报，音乐压低 %d dB", duck_db);
+    return 0;
+}
+
 void player_suspend_for_tts(void)
 {
     if (g_current_state == PLAY_STATE_STOP || g_current_suspend == PLAY_SUSPEND_YES) return;
@@ -1593,10 +1637,9 @@ static void player_sync_shm_to_first_playable_local_song(void)
 
 static void asr_kws_switch_offline_mode(void)
 {
-    int fd = open(ASR_CTRL_PIPE_PATH, O_WRONLY | O_NONBLOCK);
-    if (fd == -1) return;
-    write(fd, "mode:offline\n", 13);
-    close(fd);
+    if (player_ipc_send_asr_kws(IPC_CMD_SWITCH_OFFLINE) != 0) {
+        LOGW(TAG, "通知asr_kws切换离线模式失败: %s", strerror(errno));
+    }
 }
 
 static int detect_storage_device(char *out, size_t out_size)
@@ -1683,6 +1726,7 @@ static void player_unmount_sdcard_if_mounted(void)
     if (!path_is_mounted_at(SDCARD_MOUNT_PATH)) {
         return;
     }
+    local_index_watch_stop();
     sync();
     if (umount(SDCARD_MOUNT_PATH) != 0) {
         LOGW(TAG, "卸载存储设备失败: %s", strerror(errno));
@@ -1711,6 +1755,7 @@ int player_offline_init_storage_and_library(int reset_player)
         return -1;
     }
     }
+    local_index_watch_start();
     player_sync_shm_to_first_playable_local_song();
     player_commit_offline_runtime_state();
     LOGI(TAG, "离线模式初始化完成（存储与曲库）");
@@ -1761,6 +1806,7 @@ int player_switch_offline_mode(void)
         tts_play_audio_file(MODE_OFFLINE_SWITCH_FAILED_WAV);
         return -1;
     }
+    local_index_watch_start();
     player_sync_shm_to_first_playable_local_song();
     socket_close_connection();
     sync();
@@ -1771,10 +1817,9 @@ int player_switch_offline_mode(void)
 
 static void asr_kws_switch_online_mode(void)
 {
-    int fd = open(ASR_CTRL_PIPE_PATH, O_WRONLY | O_NONBLOCK);
-    if (fd == -1) return;
-    write(fd, "mode:online\n", 12);
-    close(fd);
+    if (player_ipc_send_asr_kws(IPC_CMD_SWITCH_ONLINE) != 0) {
+        LOGW(TAG, "通知asr_kws切换在线模式失败: %s", strerror(errno));
+    }
 }
 
 int player_switch_online_mode(void)
@@ -2,6 +2,7 @@
 #define __PLAYER_H__
 
 #include <signal.h>
+#include <stdint.h>
 
 #include "link.h"
 #include "music_source.h"
@@ -20,11 +21,6 @@ extern volatile sig_atomic_t g_player_shutdown_requested;
 extern volatile sig_atomic_t g_audio_focus_state;
 extern int g_current_online_mode;
 
-extern int g_asr_fd;
-extern int g_kws_fd;
-extern int g_tts_fd;
-extern int g_player_ctrl_fd;
-
 void player_start_play();
 void player_jump_to_first_queued_song(void);
 void player_stop_play(void);
@@ -68,16 +64,21 @@ int player_audio_focus_should_resume(void);
 void player_audio_focus_prepare_resume(void);
 void player_audio_focus_cancel_resume(void);
 void player_audio_focus_mark_tts_standalone(void);
+int player_duck_for_tts(void);
 void player_suspend_for_tts(void);
 
 void player_voice_cmd_expect_followup(void);
 void player_voice_cmd_clear_followup(void);
 int player_voice_cmd_followup_pending(void);
 
-int init_asr_fifo();
-int init_kws_fifo();
-int init_tts_fifo();
-int init_player_ctrl_fifo();
+/* 进程间消息总线（core/player_ipc.c）：监听 asr_kws / TTS 发来的事件，向二者发命令；
+ * 发送非阻塞，0 成功，-1 对端未启动或积压 */
+int player_ipc_init(void);
+void player_ipc_close(void);
+int player_ipc_owns_fd(int fd);
+void player_ipc_on_readable(int fd);
+int player_ipc_send_tts(uint16_t type, const char *payload);
+int player_ipc_send_asr_kws(uint16_t type);
 
 int player_switch_offline_mode(void);
 int player_switch_online_mode(void);
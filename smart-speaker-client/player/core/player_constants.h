@@ -12,12 +12,8 @@
 #define GST_CMD_FIFO       "./fifo/cmd_fifo"
 #define GST_ALSA_DEVICE   "dmix:CARD=rockchipes8388,DEV=0"
 #define DEFAULT_VOLUME 60
-
-#define ASR_PIPE_PATH "./fifo/asr_fifo"
-#define KWS_PIPE_PATH "./fifo/kws_fifo"
-#define TTS_PIPE_PATH "/tmp/tts_fifo"
-#define ASR_CTRL_PIPE_PATH "./fifo/asr_ctrl_fifo"
-#define PLAYER_CTRL_PIPE_PATH "./fifo/player_ctrl_fifo"
+#define TTS_DUCK_DB 18          // TTS 播报时音乐压低的分贝数
+#define TTS_DUCK_RAMP_MS 250    // 压低 / 恢复的渐变时长
 
 #define UDISK_PATH_YES1 "/dev/sdb1"
 #define UDISK_PATH_YES2 "/dev/sdc1"
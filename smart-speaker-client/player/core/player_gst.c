@@ -1,6 +1,7 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <limits.h>
+#include <math.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -10,6 +11,7 @@
 #include "player.h"
 #include "debug_log.h"
 #include "runtime_config.h"
+#include "ipc/pcm_ring.h"
 
 #define TAG "GST"
 #define FIFO_LINE_MAX 4096
@@ -25,13 +27,27 @@
 #include <glib.h>
 #include <gst/gst.h>
 
+/* 音量渐变的步进间隔；volume 元素按 buffer 生效，再细也听不出差别 */
+#define GST_RAMP_STEP_MS 10
+
 typedef struct {
     GMainLoop *loop;
     GstElement *playbin;
+    GstElement *volume;     // playbin 的 audio-filter，TTS 压低音乐用；创建失败为 NULL
     int fifo_fd;
     gboolean paused;
     char line_buf[FIFO_LINE_MAX];
     size_t line_len;
+    double gain_db;         // 当前增益（dB，0 为原音量）
+    double ramp_from_db;
+    double ramp_to_db;
+    gint64 ramp_start_us;
+    gint64 ramp_len_us;
+    guint ramp_source;
+    PcmRing mix_ring;       // 混音进程在线时音乐写进这里，不再自己占一路 alsasink
+    gboolean use_mixer;
+    gboolean mix_lost;      // 混音进程中途消失，本曲余下的数据丢弃；仅流线程读写
+    gint mix_stopping;      // 管道要退出，阻塞在共享内存上的流线程立即返回
 } GstPlayerData;
 
 static const char *gst_system_plugin_dir(void)
@@ -184,6 +200,76 @@ static void on_playbin_source_setup(GstElement *playbin, GstElement *source, gpo
     g_free(uri);
 }
 
+static int mix_should_stop(void *arg)
+{
+    GstPlayerData *d = (GstPlayerData *)arg;
+    return g_atomic_int_get(&d->mix_stopping);
+}
+
+static void on_mix_handoff(GstElement *sink, GstBuffer *buf, GstPad *pad, gpointer data)
+{
+    GstPlayerData *d = (GstPlayerData *)data;
+    GstMapInfo map;
+
+    (void)sink;
+    (void)pad;
+    if (d->mix_lost || !gst_buffer_map(buf, &map, GST_MAP_READ)) {
+        return;
+    }
+    if (pcm_ring_write_all(&d->mix_ring, (const int16_t *)map.data,
+                           (uint32_t)(map.size / (PCM_RING_CHANNELS * sizeof(int16_t))),
+                           mix_should_stop, d) < 0) {
+        LOGW(TAG, "混音进程无响应，本曲余下部分不再输出");
+        d->mix_lost = TRUE;
+    }
+    gst_buffer_unmap(buf, &map);
+}
+
+/* 混音进程在线时的 audio-sink：转成环形缓冲区的格式，由 fakesink 的 handoff 写进共享内存。
+ * sync=FALSE，节奏由缓冲区满时的等待决定，也就是跟着混音进程的 ALSA 输出走 */
+static GstElement *make_mixer_sink(GstPlayerData *d)
+{
+    GstElement *elems[4];
+    GstElement *bin;
+    GstCaps *caps;
+    GstPad *pad;
+    size_t i;
+
+    elems[0] = gst_element_factory_make("audioconvert", NULL);
+    elems[1] = gst_element_factory_make("audioresample", NULL);
+    elems[2] = gst_element_factory_make("capsfilter", NULL);
+    elems[3] = gst_element_factory_make("fakesink", NULL);
+    for (i = 0; i < 4; i++) {
+        if (elems[i] == NULL) {
+            for (i = 0; i < 4; i++) {
+                if (elems[i] != NULL) gst_object_unref(gst_object_ref_sink(elems[i]));
+            }
+            return NULL;
+        }
+    }
+    caps = gst_caps_new_simple("audio/x-raw",
+                               "format", G_TYPE_STRING, "S16LE",
+                               "layout", G_TYPE_STRING, "interleaved",
+                               "rate", G_TYPE_INT, PCM_RING_RATE,
+                               "channels", G_TYPE_INT, PCM_RING_CHANNELS,
+                               NULL);
+    g_object_set(elems[2], "caps", caps, NULL);
+    gst_caps_unref(caps);
+    g_object_set(elems[3], "sync", FALSE, "signal-handoffs", TRUE, NULL);
+    g_signal_connect(elems[3], "handoff", G_CALLBACK(on_mix_handoff), d);
+
+    bin = gst_bin_new("mixsink");
+    gst_bin_add_many(GST_BIN(bin), elems[0], elems[1], elems[2], elems[3], NULL);
+    if (!gst_element_link_many(elems[0], elems[1], elems[2], elems[3], NULL)) {
+        gst_object_unref(gst_object_ref_sink(bin));
+        return NULL;
+    }
+    pad = gst_element_get_static_pad(elems[0], "sink");
+    gst_element_add_pad(bin, gst_ghost_pad_new("sink", pad));
+    gst_object_unref(pad);
+    return bin;
+}
+
 static GstBusSyncReply bus_sync(GstBus *bus, GstMessage *msg, gpointer data)
 {
     GstPlayerData *d = (GstPlayerData *)data;
@@ -217,10 +303,59 @@ static GstBusSyncReply bus_sync(GstBus *bus, GstMessage *msg, gpointer data)
     return GST_BUS_PASS;
 }
 
+static void volume_apply_db(GstPlayerData *d, double db)
+{
+    d->gain_db = db;
+    g_object_set(d->volume, "volume", pow(10.0, db / 20.0), NULL);
+}
+
+/* 按 dB 线性插值，听感上是匀速的淡入淡出 */
+static gboolean volume_ramp_step(gpointer data)
+{
+    GstPlayerData *d = (GstPlayerData *)data;
+    gint64 elapsed = g_get_monotonic_time() - d->ramp_start_us;
+
+    if (elapsed >= d->ramp_len_us) {
+        volume_apply_db(d, d->ramp_to_db);
+        d->ramp_source = 0;
+        return G_SOURCE_REMOVE;
+    }
+    volume_apply_db(d, d->ramp_from_db +
+                       (d->ramp_to_db - d->ramp_from_db) * (double)elapsed / (double)d->ramp_len_us);
+    return G_SOURCE_CONTINUE;
+}
+
+// 从当前增益渐变到 target_db；进行中的渐变被接续，不会跳变
+static void volume_ramp_to(GstPlayerData *d, double target_db, int ramp_ms)
+{
+    if (d->volume == NULL) {
+        LOGW(TAG, "volume 元素不可用，忽略 duck");
+        return;
+    }
+    if (d->ramp_source != 0) {
+        g_source_remove(d->ramp_source);
+        d->ramp_source = 0;
+    }
+    if (ramp_ms <= 0) {
+        volume_apply_db(d, target_db);
+        return;
+    }
+    d->ramp_from_db = d->gain_db;
+    d->ramp_to_db = target_db;
+    d->ramp_start_us = g_get_monotonic_time();
+    d->ramp_len_us = (gint64)ramp_ms * 1000;
+    d->ramp_source = g_timeout_add(GST_RAMP_STEP_MS, volume_ramp_step, d);
+}
+
 static gboolean process_line(GstPlayerData *d, char *line)
 {
     while (*line == ' ' || *line == '\n') line++;
     if (strncmp(line, "quit", 4) == 0) {
+        // 切歌/停止：混音进程里还没播的这一段一并丢弃
+        if (d->use_mixer) {
+            g_atomic_int_set(&d->mix_stopping, 1);
+            pcm_ring_flush(&d->mix_ring);
+        }
         g_main_loop_quit(d->loop);
         return FALSE;
     }
@@ -229,10 +364,23 @@ static gboolean process_line(GstPlayerData *d, char *line)
         gst_element_set_state(d->playbin, d->paused ? GST_STATE_PAUSED : GST_STATE_PLAYING);
         return TRUE;
     }
+    // duck <衰减dB> <渐变ms>：衰减 0 即恢复原音量
+    if (strncmp(line, "duck ", 5) == 0) {
+        int atten_db = 0;
+        int ramp_ms = 0;
+        if (sscanf(line + 5, "%d %d", &atten_db, &ramp_ms) >= 1) {
+            if (atten_db < 0) atten_db = -atten_db;
+            volume_ramp_to(d, -(double)atten_db, ramp_ms);
+        }
+        return TRUE;
+    }
     if (strncmp(line, "loadfile ", 9) == 0) {
         char *path = line + 9;
         while (*path == ' ') path++;
         if (*path == '\'') { path++; char *end = strrchr(path, '\''); if (end) *end = '\0'; }
+        if (d->use_mixer) {
+            pcm_ring_flush(&d->mix_ring);
+        }
         g_object_set(d->playbin, "uri", path, NULL);
         gst_element_set_state(d->playbin, GST_STATE_PLAYING);
         d->paused = FALSE;
@@ -271,13 +419,28 @@ int run_gst_player(const char *initial_uri)
     setenv("DISPLAY", "", 1);
     setup_local_gst_plugin_path();
     gst_init(NULL, NULL);
-    GstElement *asink = gst_element_factory_make("alsasink", "asink");
-    if (asink) {
-        g_object_set(asink, "device", gst_alsa_device_string(), NULL);
-        LOGI(TAG, "使用 alsasink device=%s", gst_alsa_device_string());
-    } else {
-        LOGW(TAG, "alsasink 不可用，回退到 autoaudiosink");
-        asink = gst_element_factory_make("autoaudiosink", "asink");
+    GstElement *asink = NULL;
+    // 混音进程（audio_mixer）在线就与 TTS 合成一路输出；每首歌开始时判断一次
+    if (pcm_ring_attach(&data.mix_ring, PCM_RING_MUSIC) == 0) {
+        if (pcm_ring_reader_alive(&data.mix_ring)) {
+            asink = make_mixer_sink(&data);
+        }
+        if (asink) {
+            data.use_mixer = TRUE;
+            LOGI(TAG, "音乐经混音进程输出");
+        } else {
+            pcm_ring_close(&data.mix_ring);
+        }
+    }
+    if (asink == NULL) {
+        asink = gst_element_factory_make("alsasink", "asink");
+        if (asink) {
+            g_object_set(asink, "device", gst_alsa_device_string(), NULL);
+            LOGI(TAG, "使用 alsasink device=%s", gst_alsa_device_string());
+        } else {
+            LOGW(TAG, "alsasink 不可用，回退到 autoaudiosink");
+            asink = gst_element_factory_make("autoaudiosink", "asink");
+        }
     }
     GstElement *vsink = gst_element_factory_make("fakesink", "vsink");
     data.playbin = gst_element_factory_make("playbin", "player");
@@ -289,6 +452,12 @@ int run_gst_player(const char *initial_uri)
         g_object_set(data.playbin, "audio-sink", asink, NULL);
     if (vsink)
         g_object_set(data.playbin, "video-sink", vsink, NULL);
+    data.volume = gst_element_factory_make("volume", "duck");
+    if (data.volume) {
+        g_object_set(data.playbin, "audio-filter", data.volume, NULL);
+    } else {
+        LOGW(TAG, "volume 元素不可用，TTS 期间无法压低音乐");
+    }
     g_signal_connect(data.playbin, "source-setup", G_CALLBACK(on_playbin_source_setup), NULL);
     g_object_set(data.playbin, "uri", initial_uri, NULL);
     GstBus *bus = gst_element_get_bus(data.playbin);
@@ -304,9 +473,16 @@ int run_gst_player(const char *initial_uri)
     data.loop = g_main_loop_new(NULL, FALSE);
     gst_element_set_state(data.playbin, GST_STATE_PLAYING);
     g_main_loop_run(data.loop);
+    if (data.ramp_source != 0) {
+        g_source_remove(data.ramp_source);
+    }
+    g_atomic_int_set(&data.mix_stopping, 1);
     gst_element_set_state(data.playbin, GST_STATE_NULL);
     gst_object_unref(data.playbin);
     g_main_loop_unref(data.loop);
+    if (data.use_mixer) {
+        pcm_ring_close(&data.mix_ring);
+    }
     if (data.fifo_fd >= 0) close(data.fifo_fd);
     return 0;
 }
@@ -0,0 +1,86 @@
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include "player.h"
+#include "select.h"
+#include "debug_log.h"
+#include "ipc/ipc_bus.h"
+#include "voice-assistant/common/ipc_protocol.h"
+
+#define TAG "PLAYER"
+
+/* player 在总线上监听 IPC_BUS_PLAYER，接收 asr_kws 的识别 / 唤醒事件和 TTS 的开始 / 结束事件；
+ * 到 TTS 和 asr_kws 的命令走各自的长连接，对端未启动时发送失败，不阻塞事件循环 */
+static IPCBusServer g_bus = { .listen_fd = -1 };
+static IPCBusLink g_tts_link = { .name = IPC_BUS_TTS, .fd = -1 };
+static IPCBusLink g_asr_kws_link = { .name = IPC_BUS_ASR_KWS, .fd = -1 };
+
+int player_ipc_init(void)
+{
+    if (ipc_bus_server_open(&g_bus, IPC_BUS_PLAYER) != 0) {
+        LOGE(TAG, "打开消息总线失败（player 是否已在运行？）: %s", strerror(errno));
+        return -1;
+    }
+    ipc_bus_link_init(&g_tts_link, IPC_BUS_TTS);
+    ipc_bus_link_init(&g_asr_kws_link, IPC_BUS_ASR_KWS);
+    if (select_watch_fd(g_bus.listen_fd) != 0) {
+        ipc_bus_server_close(&g_bus);
+        return -1;
+    }
+    return 0;
+}
+
+void player_ipc_close(void)
+{
+    int i;
+    for (i = 0; i < IPC_BUS_MAX_CONNS; i++) {
+        select_unwatch_fd(g_bus.conns[i]);
+    }
+    select_unwatch_fd(g_bus.listen_fd);
+    ipc_bus_server_close(&g_bus);
+    ipc_bus_link_close(&g_tts_link);
+    ipc_bus_link_close(&g_asr_kws_link);
+}
+
+int player_ipc_owns_fd(int fd)
+{
+    return g_bus.listen_fd >= 0 && ipc_bus_server_owns(&g_bus, fd);
+}
+
+static void on_bus_message(int fd, const IPCHeader *header, const uint8_t *body, void *arg)
+{
+    (void)fd;
+    (void)arg;
+    select_on_bus_message(header->type, (const char *)body);
+}
+
+void player_ipc_on_readable(int fd)
+{
+    if (fd == g_bus.listen_fd) {
+        int conn;
+        while ((conn = ipc_bus_server_accept(&g_bus)) >= 0) {
+            select_watch_fd(conn);
+        }
+        return;
+    }
+    // 对端关闭时连接在 read 内被 close，close 同时把它移出 epoll 集合
+    if (ipc_bus_server_read(&g_bus, fd, on_bus_message, NULL) != 0) {
+        LOGD(TAG, "总线连接 fd=%d 已断开", fd);
+    }
+}
+
+static int send_on_link(IPCBusLink *link, uint16_t type, const char *payload)
+{
+    uint32_t len = (payload != NULL) ? (uint32_t)(strlen(payload) + 1) : 0;
+    return ipc_bus_link_send(link, type, payload, len, NULL);
+}
+
+int player_ipc_send_tts(uint16_t type, const char *payload)
+{
+    return send_on_link(&g_tts_link, type, payload);
+}
+
+int player_ipc_send_asr_kws(uint16_t type)
+{
+    return send_on_link(&g_asr_kws_link, type, NULL);
+}
@@ -27,7 +27,8 @@ enum {
     AUDIO_FOCUS_MUSIC_PAUSED_MANUAL,
     AUDIO_FOCUS_MUSIC_PAUSED_FOR_TTS,
     AUDIO_FOCUS_TTS_PLAYING,
-    AUDIO_FOCUS_MUSIC_RESUMING
+    AUDIO_FOCUS_MUSIC_RESUMING,
+    AUDIO_FOCUS_MUSIC_DUCKED_FOR_TTS    // TTS 期间音乐继续播放但压低音量
 };
 
 typedef struct {
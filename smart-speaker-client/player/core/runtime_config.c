@@ -18,6 +18,8 @@ typedef struct {
     int startup_volume;
     char player_mode[32];
     char gst_alsa_device[128];
+    int tts_duck_db;
+    int tts_duck_ramp_ms;
     char music_search_source[16];
     char device_id[64];
     int music_link_debug;
@@ -28,7 +30,7 @@ typedef struct {
 /* main.c 会 chdir 到含 fifo/ 的客户端根；此时配置应在 ./data。若 CWD 仍在 player/（如从 build/bin 启动），则为 ../data */
 static const char *client_config_path(void)
 {
-    if (access("./fifo/asr_fifo", F_OK) == 0) {
+    if (access("./fifo/cmd_fifo", F_OK) == 0) {
         return "./data/config/client.toml";
     }
     return "../data/config/client.toml";
@@ -36,7 +38,7 @@ static const char *client_config_path(void)
 
 static const char *client_data_dir(void)
 {
-    if (access("./fifo/asr_fifo", F_OK) == 0) {
+    if (access("./fifo/cmd_fifo", F_OK) == 0) {
         return "./data";
     }
     return "../data";
@@ -44,7 +46,7 @@ static const char *client_data_dir(void)
 
 static const char *client_config_dir(void)
 {
-    if (access("./fifo/asr_fifo", F_OK) == 0) {
+    if (access("./fifo/cmd_fifo", F_OK) == 0) {
         return "./data/config";
     }
     return "../data/config";
@@ -57,6 +59,8 @@ static PlayerRuntimeConfig g_runtime_config = {
     .startup_volume = DEFAULT_VOLUME,
     .player_mode = "auto",
     .gst_alsa_device = GST_ALSA_DEVICE,
+    .tts_duck_db = TTS_DUCK_DB,
+    .tts_duck_ramp_ms = TTS_DUCK_RAMP_MS,
     .music_search_source = "all",
     .device_id = DEFAULT_DEVICE_ID,
     .music_link_debug = 0,
@@ -223,6 +227,9 @@ static void write_default_client_config_if_missing(void)
             "player_mode = \"%s\"\n"
             "# GStreamer alsasink 的 device，与 gst-inspect-1.0 alsasink 一致，例 dmix: / plughw:\n"
             "gst_alsa_device = \"%s\"\n"
+            "# TTS 播报时音乐压低的分贝数，0 表示改为暂停音乐；压低与恢复的渐变时长（毫秒）\n"
+            "tts_duck_db = %d\n"
+            "tts_duck_ramp_ms = %d\n"
             "\n"
             "# 在线搜歌/歌单默认 source（语音未指定平台时）；可选：\n"
             "# tx/wy/kw/kg/mg 单源；auto 顺序（单次 HTTP 3s、全程≤10s）；all 并发（单次 HTTP 3s）\n"
@@ -230,9 +237,18 @@ static void write_default_client_config_if_missing(void)
             "\n"
             "# 歌单链表调试：true 时写入 music_link_debug_path\n"
             "music_link_debug = false\n"
-            "music_link_debug_path = \"data/player/music_link_debug.txt\"\n",
+            "music_link_debug_path = \"data/player/music_link_debug.txt\"\n"
+            "\n"
+            "# 语音进程推理线程数与绑核（voice-assistant/common/infer_config.c 读取）\n"
+            "# *_cpus 为核列表或掩码，例 \"4-7\" / \"0,2\" / \"0xf0\"，留空不绑核；RK3588 上 0-3 为 A55 小核，4-7 为 A76 大核\n"
+            "asr_threads = 4\n"
+            "asr_cpus = \"4-7\"\n"
+            "kws_threads = 1\n"
+            "kws_cpus = \"0\"\n"
+            "tts_threads = 4\n"
+            "tts_cpus = \"4-7\"\n",
             SERVER_IP, SERVER_PORT, DEFAULT_DEVICE_ID, SDCARD_MOUNT_PATH,
-            DEFAULT_VOLUME, "auto", GST_ALSA_DEVICE);
+            DEFAULT_VOLUME, "auto", GST_ALSA_DEVICE, TTS_DUCK_DB, TTS_DUCK_RAMP_MS);
     fclose(fp);
 }
 
@@ -303,6 +319,16 @@ static void load_client_runtime_config(void)
             if (value[0] != '\0') {
                 copy_text(g_runtime_config.gst_alsa_device, sizeof(g_runtime_config.gst_alsa_device), value);
             }
+        } else if (strcmp(key, "tts_duck_db") == 0) {
+            int duck_db;
+            if (parse_int_in_range(value, 0, 60, &duck_db) == 0) {
+                g_runtime_config.tts_duck_db = duck_db;
+            }
+        } else if (strcmp(key, "tts_duck_ramp_ms") == 0) {
+            int ramp_ms;
+            if (parse_int_in_range(value, 0, 2000, &ramp_ms) == 0) {
+                g_runtime_config.tts_duck_ramp_ms = ramp_ms;
+            }
         } else if (strcmp(key, "music_search_source") == 0) {
             unquote_text(value);
             if (music_search_source_apply(value, g_runtime_config.music_search_source,
@@ -369,6 +395,18 @@ const char *player_runtime_gst_alsa_device(void)
     return g_runtime_config.gst_alsa_device;
 }
 
+int player_runtime_tts_duck_db(void)
+{
+    ensure_loaded();
+    return g_runtime_config.tts_duck_db;
+}
+
+int player_runtime_tts_duck_ramp_ms(void)
+{
+    ensure_loaded();
+    return g_runtime_config.tts_duck_ramp_ms;
+}
+
 const char *player_runtime_music_search_source(void)
 {
     ensure_loaded();
@@ -392,3 +430,8 @@ const char *player_runtime_music_link_debug_path(void)
     ensure_loaded();
     return g_runtime_config.music_link_debug_path;
 }
+
+const char *player_runtime_data_dir(void)
+{
+    return client_data_dir();
+}
@@ -7,9 +7,12 @@ const char *player_runtime_local_music_root(void);
 int player_runtime_startup_volume(void);
 const char *player_runtime_player_mode(void);
 const char *player_runtime_gst_alsa_device(void);
+int player_runtime_tts_duck_db(void);
+int player_runtime_tts_duck_ramp_ms(void);
 const char *player_runtime_music_search_source(void);
 const char *player_runtime_device_id(void);
 int player_runtime_music_link_debug(void);
 const char *player_runtime_music_link_debug_path(void);
+const char *player_runtime_data_dir(void);
 
 #endif
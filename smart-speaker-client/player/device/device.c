@@ -9,6 +9,10 @@
 #include <linux/input.h>
 #include <signal.h>
 #include <sys/time.h>
+#include <sys/timerfd.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <poll.h>
 #include <dirent.h>
 #include <fcntl.h>
 #include <linux/input.h>
@@ -24,8 +28,16 @@
 int g_button_fd = -1;   // 按键文件描述符
 BUTTON_STATE state = STATE_IDLE;    // 按键状态
 unsigned long old, new;     // 用于判断长按和短按
-struct itimerval tv;        // 按键定时器结构体
-int g_current_vol = 0;      // 当前音量
+static int g_button_timer_fd = -1;  // 单击判定定时器（timerfd，由事件循环分发）
+static atomic_int g_current_vol = 0;    // 当前音量缓存，上报线程也会读
+
+/* 常驻混音器：只在事件循环线程打开、读写、关闭；其他线程只看 g_mixer_ready 与 g_current_vol */
+#define MIXER_MAX_POLL_FDS 4
+static snd_mixer_t *g_mixer = NULL;
+static snd_mixer_elem_t *g_mixer_elem = NULL;
+static struct pollfd g_mixer_pfds[MIXER_MAX_POLL_FDS];
+static int g_mixer_nfds = 0;
+static atomic_int g_mixer_ready = 0;
 
 /* 设置与读回共用同一套 UI%→ALSA 步进，读回用枚举反推，避免 dB/线性混用导致偏差或响度异常 */
 static int ui_percent_to_alsa_step(snd_mixer_elem_t *elem, int volume, long *target_vol)
@@ -103,7 +115,7 @@ static int alsa_step_to_ui_percent(snd_mixer_elem_t *elem, long current_alsa, in
         return -1;
     }
     if (vol_max <= vol_min) {
-        *volume = g_current_vol;
+        *volume = atomic_load(&g_current_vol);
         return 0;
     }
     if (current_alsa <= vol_min) {
@@ -194,57 +206,161 @@ static int get_mixer_elem(snd_mixer_t** snd_mixer, snd_mixer_elem_t** mixer_elem
     return 0;
 }
 
-//设置系统音量（0-100范围）
+// 混音器缓存里的值已由 snd_mixer_handle_events 更新，这里只做换算，不进内核
+static void mixer_refresh_cached_volume(void)
+{
+    long current_alsa = 0;
+    int volume = 0;
+    int old_volume = atomic_load(&g_current_vol);
+
+    if (snd_mixer_selem_get_playback_volume(g_mixer_elem, SND_MIXER_SCHN_FRONT_LEFT, &current_alsa) < 0) {
+        return;
+    }
+    if (alsa_step_to_ui_percent(g_mixer_elem, current_alsa, &volume, old_volume) != 0) {
+        return;
+    }
+    if (volume != old_volume) {
+        LOGD(TAG, "音量缓存 %d%% -> %d%%", old_volume, volume);
+    }
+    atomic_store(&g_current_vol, volume);
+}
+
+static void mixer_close(void)
+{
+    int i;
+    atomic_store(&g_mixer_ready, 0);
+    for (i = 0; i < g_mixer_nfds; i++) {
+        select_unwatch_fd(g_mixer_pfds[i].fd);
+    }
+    g_mixer_nfds = 0;
+    if (g_mixer != NULL) {
+        snd_mixer_close(g_mixer);
+    }
+    g_mixer = NULL;
+    g_mixer_elem = NULL;
+}
+
+int device_mixer_init(void)
+{
+    int i;
+    int n;
+
+    if (g_mixer != NULL) {
+        return 0;
+    }
+    if (get_mixer_elem(&g_mixer, &g_mixer_elem) != 0) {
+        g_mixer = NULL;
+        g_mixer_elem = NULL;
+        return -1;
+    }
+    n = snd_mixer_poll_descriptors_count(g_mixer);
+    if (n > MIXER_MAX_POLL_FDS) {
+        LOGW(TAG, "混音器事件fd共 %d 个，只监听前 %d 个", n, MIXER_MAX_POLL_FDS);
+        n = MIXER_MAX_POLL_FDS;
+    }
+    if (n > 0) {
+        n = snd_mixer_poll_descriptors(g_mixer, g_mixer_pfds, (unsigned int)n);
+    }
+    g_mixer_nfds = (n > 0) ? n : 0;
+    for (i = 0; i < g_mixer_nfds; i++) {
+        if (select_watch_fd(g_mixer_pfds[i].fd) != 0) {
+            LOGW(TAG, "混音器事件fd=%d 加入事件循环失败，外部改音量将不会同步", g_mixer_pfds[i].fd);
+        }
+    }
+    mixer_refresh_cached_volume();
+    atomic_store(&g_mixer_ready, 1);
+    LOGI(TAG, "混音器常驻打开，监听 %d 个事件fd，当前音量 %d%%", g_mixer_nfds, atomic_load(&g_current_vol));
+    return 0;
+}
+
+void device_mixer_close(void)
+{
+    mixer_close();
+}
+
+int device_mixer_owns_fd(int fd)
+{
+    int i;
+    for (i = 0; i < g_mixer_nfds; i++) {
+        if (g_mixer_pfds[i].fd == fd) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// 混音器事件（本进程或 amixer 等外部改了音量）：刷新 alsa-lib 的元素缓存后重算百分比
+void device_mixer_on_readable(void)
+{
+    int err;
+    if (g_mixer == NULL) {
+        return;
+    }
+    err = snd_mixer_handle_events(g_mixer);
+    if (err < 0) {
+        LOGW(TAG, "混音器事件处理失败: %s，关闭常驻句柄，之后按次打开", snd_strerror(err));
+        mixer_close();
+        return;
+    }
+    mixer_refresh_cached_volume();
+}
+
+//设置系统音量（0-100范围），仅在事件循环线程调用
 int device_set_volume(int volume)
 {
-    snd_mixer_t* mixer = NULL;
-    snd_mixer_elem_t* elem = NULL;
+    snd_mixer_t* mixer = NULL;      // 非 NULL 表示常驻句柄不可用、本次临时打开
+    snd_mixer_elem_t* elem = g_mixer_elem;
     long target_vol = 0; // 转换后的目标音量（ALSA原生值）
+    int ret = -1;
 
     // 输入音量范围检查（0-100）
     if(volume < 0) volume = 0;
     if(volume > 100) volume = 100;
 
-
-    // 获取混音器元素（失败直接返回）
-    if (get_mixer_elem(&mixer, &elem) != 0) {
+    if (elem == NULL && get_mixer_elem(&mixer, &elem) != 0) {
         LOGE(TAG, "device_set_volume error: 获取混音器元素失败");
         return -1;
     }
-    if (ui_percent_to_alsa_step(elem, volume, &target_vol) != 0) {
-        snd_mixer_close(mixer);
-        return -1;
+    if (ui_percent_to_alsa_step(elem, volume, &target_vol) == 0) {
+        // 设置所有声道音量（保证立体声平衡）
+        if (snd_mixer_selem_set_playback_volume_all(elem, target_vol) < 0) {
+            LOGE(TAG, "snd_mixer_selem_set_playback_volume_all error");
+        } else {
+            atomic_store(&g_current_vol, volume);
+            ret = 0;
+        }
     }
-    // 设置所有声道音量（保证立体声平衡）
-    if (snd_mixer_selem_set_playback_volume_all(elem, target_vol) < 0) {
-        LOGE(TAG, "snd_mixer_selem_set_playback_volume_all error");
+    if (mixer != NULL) {
         snd_mixer_close(mixer);
-        return -1;
     }
-    // 关闭混音器
-    snd_mixer_close(mixer);
-
-    g_current_vol = volume;
-    return 0; // 成功返回
+    return ret;
 }
 
+// 常驻混音器可用时直接返回缓存（由混音器事件维护），任何线程可调用
 int device_get_volume(int *volume)
 {
     snd_mixer_t *mixer = NULL;
     snd_mixer_elem_t *elem = NULL;
     long current_alsa = 0;
+
+    if (volume == NULL)
+        return -1;
+    if (atomic_load(&g_mixer_ready)) {
+        *volume = atomic_load(&g_current_vol);
+        return 0;
+    }
     if (get_mixer_elem(&mixer, &elem) != 0)
         return -1;
     if (snd_mixer_selem_get_playback_volume(elem, SND_MIXER_SCHN_FRONT_LEFT, &current_alsa) < 0) {
         snd_mixer_close(mixer);
         return -1;
     }
-    if (alsa_step_to_ui_percent(elem, current_alsa, volume, g_current_vol) != 0) {
+    if (alsa_step_to_ui_percent(elem, current_alsa, volume, atomic_load(&g_current_vol)) != 0) {
         snd_mixer_close(mixer);
         return -1;
     }
     snd_mixer_close(mixer);
-    g_current_vol = *volume;
+    atomic_store(&g_current_vol, *volume);
     return 0;
 }
 
@@ -354,14 +470,48 @@ int key_init()
         LOGE(TAG, "查找设备节点失败，请检查路径信息是否正确!");
         return -1;
     }
-    // 将文件描述符添加到select监听集合中
-    FD_SET(g_button_fd, &READSET);
-    // 更新select监听的文件描述符集合中的最大文件描述符值
-    update_max_fd();
+    // 单击/双击判定用 timerfd，替代 SIGALRM，回调在主循环里执行
+    g_button_timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (g_button_timer_fd < 0) {
+        LOGE(TAG, "创建按键定时器失败");
+        close(g_button_fd);
+        g_button_fd = -1;
+        return -1;
+    }
+    // 将文件描述符添加到事件循环监听集合中
+    select_watch_fd(g_button_fd);
+    select_watch_fd(g_button_timer_fd);
 
     return 0;
 }
 
+int device_button_timer_fd(void)
+{
+    return g_button_timer_fd;
+}
+
+// 启动（ms > 0）或取消（ms == 0）单击判定定时器
+static void button_timer_arm(int ms)
+{
+    struct itimerspec its;
+    if (g_button_timer_fd < 0) {
+        return;
+    }
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = ms / 1000;
+    its.it_value.tv_nsec = (long)(ms % 1000) * 1000000L;
+    timerfd_settime(g_button_timer_fd, 0, &its, NULL);
+}
+
+void device_on_button_timer(void)
+{
+    uint64_t expirations;
+    if (read(g_button_timer_fd, &expirations, sizeof(expirations)) != (ssize_t)sizeof(expirations)) {
+        return;
+    }
+    button_handler(0);
+}
+
 // 获取时间 
 static unsigned long get_time(void)
 {
@@ -401,11 +551,7 @@ void device_read_button(void)
             player_next_song();
 
             //取消定时器
-            tv.it_value.tv_sec = 0;
-            tv.it_value.tv_usec = 0;
-            tv.it_interval.tv_sec = 0;
-            tv.it_interval.tv_usec = 0;
-            setitimer(ITIMER_REAL, &tv, NULL);
+            button_timer_arm(0);
         }
     }
     // 按键松开
@@ -427,14 +573,8 @@ void device_read_button(void)
             {
                 state = STATE_FIRST_RELEASE;
 
-                tv.it_value.tv_sec = 0;
-                tv.it_value.tv_usec = 300 * 1000;   // 300ms后触发定时器
-
-                tv.it_interval.tv_sec = 0;
-                tv.it_interval.tv_usec = 0;     // 不需要重复触发
-
-                //启动定时器
-                setitimer(ITIMER_REAL, &tv, NULL);
+                //启动定时器，300ms后触发，不需要重复触发
+                button_timer_arm(300);
             }
         }
     }
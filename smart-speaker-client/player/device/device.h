@@ -25,10 +25,22 @@ typedef enum{
 }BUTTON_STATE;
 
 
-//设置系统音量（0-100范围）
+// 常驻打开混音器并把其事件fd加入事件循环，之后读音量不再进内核；失败时各接口退回按次打开
+int device_mixer_init(void);
+
+// 关闭常驻混音器并移出事件循环
+void device_mixer_close(void);
+
+// fd 是否为混音器事件fd
+int device_mixer_owns_fd(int fd);
+
+// 混音器事件fd可读：处理事件并刷新音量缓存
+void device_mixer_on_readable(void);
+
+//设置系统音量（0-100范围），仅事件循环线程调用
 int device_set_volume(int volume);
 
-//获取当前系统音量（0-100范围）
+//获取当前系统音量（0-100范围），任何线程可调用
 int device_get_volume(int *volume);
 
 // 调整音量
@@ -42,5 +54,11 @@ void button_handler(int sig);
 
 // 处理按键事件
 void device_read_button(void);
+
+// 单击判定定时器 fd（未初始化按键时为 -1）
+int device_button_timer_fd(void);
+
+// 单击判定定时器到期
+void device_on_button_timer(void);
 #endif
 
@@ -0,0 +1,207 @@
+/* 本地曲库检索基准：合成 2 万首曲目，对比逐条 strstr 扫描与 n-gram 倒排表。
+ * 用法：./bin/music_search_bench [曲目数] [查询数] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "music_search_index.h"
+
+#define BENCH_DEFAULT_TRACKS 20000
+#define BENCH_DEFAULT_QUERIES 2000
+#define BENCH_SINGERS 800
+#define BENCH_TOP_K 10
+
+typedef struct {
+    char singer[64];
+    char song_name[128];
+    char song_id[256];
+} BenchTrack;
+
+/* 常用汉字，每个 3 字节 UTF-8 */
+static const char k_pool[] =
+    "爱你我的是不了在人有这他中大来上个们到说和地也子时道出而要于就下得可能过对生"
+    "后年自多天心想家看起还好里作开会去着成面用方么没日水情如事风花月光夜雨雪云山"
+    "海星梦春秋冬夏歌声远回忘记离别走听等思念泪笑城路晴空红蓝白黑青色深浅长短新旧"
+    "明暗温柔轻重快慢真假爸妈朋友青春少女孩男王李张刘陈杨黄赵吴周徐孙马朱胡郭何林";
+
+static int pool_chars(void)
+{
+    return (int)(sizeof(k_pool) - 1) / 3;
+}
+
+static void append_char(char *dst, size_t dst_size, int idx)
+{
+    size_t len = strlen(dst);
+    if (len + 3 >= dst_size) return;
+    memcpy(dst + len, k_pool + idx * 3, 3);
+    dst[len + 3] = '\0';
+}
+
+static void random_text(char *dst, size_t dst_size, int min_chars, int max_chars)
+{
+    int n = min_chars + rand() % (max_chars - min_chars + 1);
+    int i;
+    dst[0] = '\0';
+    for (i = 0; i < n; ++i) {
+        append_char(dst, dst_size, rand() % pool_chars());
+    }
+}
+
+/* 把第 pos 个字换成另一个字，模拟 ASR 同音字错误 */
+static void substitute_char(char *text, int pos)
+{
+    int idx = rand() % pool_chars();
+    if (memcmp(text + pos * 3, k_pool + idx * 3, 3) == 0) {
+        idx = (idx + 1) % pool_chars();
+    }
+    memcpy(text + pos * 3, k_pool + idx * 3, 3);
+}
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec / 1e3;
+}
+
+static int cmp_double(const void *a, const void *b)
+{
+    double da = *(const double *)a;
+    double db = *(const double *)b;
+    return (da > db) - (da < db);
+}
+
+/* 与 music_source_local 原逐条匹配等价的基线 */
+static int linear_scan(const BenchTrack *tracks, int count, const char *keyword, int target)
+{
+    int i;
+    int found = 0;
+    for (i = 0; i < count; ++i) {
+        if (strstr(tracks[i].song_name, keyword) != NULL ||
+            strstr(tracks[i].singer, keyword) != NULL ||
+            strstr(tracks[i].song_id, keyword) != NULL) {
+            if (i == target) found = 1;
+        }
+    }
+    return found;
+}
+
+static void report(const char *name, double *lat, int n, int hit)
+{
+    double sum = 0;
+    int i;
+    for (i = 0; i < n; ++i) sum += lat[i];
+    qsort(lat, (size_t)n, sizeof(double), cmp_double);
+    printf("%-22s avg=%8.1fus p50=%8.1fus p99=%8.1fus recall=%5.1f%%\n",
+           name, sum / n, lat[n / 2], lat[(n * 99) / 100], 100.0 * hit / n);
+}
+
+int main(int argc, char **argv)
+{
+    int track_count = (argc > 1) ? atoi(argv[1]) : BENCH_DEFAULT_TRACKS;
+    int query_count = (argc > 2) ? atoi(argv[2]) : BENCH_DEFAULT_QUERIES;
+    BenchTrack *tracks;
+    char (*singers)[64];
+    MusicSearchIndex *index;
+    MusicSearchHit hits[BENCH_TOP_K];
+    double *lat_scan;
+    double *lat_exact;
+    double *lat_fuzzy;
+    int hit_scan = 0;
+    int hit_exact = 0;
+    int hit_fuzzy = 0;
+    int hit_fuzzy_scan = 0;
+    double t0;
+    int i;
+    int j;
+
+    if (track_count <= 0 || query_count <= 0) {
+        printf("usage: %s [tracks] [queries]\n", argv[0]);
+        return 1;
+    }
+    srand(20240601);
+    tracks = (BenchTrack *)calloc((size_t)track_count, sizeof(BenchTrack));
+    singers = calloc(BENCH_SINGERS, sizeof(*singers));
+    lat_scan = (double *)calloc((size_t)query_count, sizeof(double));
+    lat_exact = (double *)calloc((size_t)query_count, sizeof(double));
+    lat_fuzzy = (double *)calloc((size_t)query_count, sizeof(double));
+    index = music_search_index_create();
+    if (tracks == NULL || singers == NULL || lat_scan == NULL || lat_exact == NULL || lat_fuzzy == NULL || index == NULL) {
+        printf("out of memory\n");
+        return 1;
+    }
+
+    for (i = 0; i < BENCH_SINGERS; ++i) {
+        random_text(singers[i], sizeof(singers[i]), 2, 3);
+    }
+    for (i = 0; i < track_count; ++i) {
+        snprintf(tracks[i].singer, sizeof(tracks[i].singer), "%s", singers[rand() % BENCH_SINGERS]);
+        random_text(tracks[i].song_name, sizeof(tracks[i].song_name), 3, 6);
+        snprintf(tracks[i].song_id, sizeof(tracks[i].song_id), "%s/%s.mp3", tracks[i].singer, tracks[i].song_name);
+    }
+
+    t0 = now_us();
+    for (i = 0; i < track_count; ++i) {
+        const char *fields[3];
+        fields[0] = tracks[i].singer;
+        fields[1] = tracks[i].song_name;
+        fields[2] = tracks[i].song_id;
+        if (music_search_index_add(index, i, fields, 3) != 0) {
+            printf("index add failed\n");
+            return 1;
+        }
+    }
+    if (music_search_index_build(index) != 0) {
+        printf("index build failed\n");
+        return 1;
+    }
+    printf("tracks=%d queries=%d build=%.1fms\n", track_count, query_count, (now_us() - t0) / 1000.0);
+
+    for (i = 0; i < query_count; ++i) {
+        int target = rand() % track_count;
+        char fuzzy[128];
+        int n;
+        int chars;
+
+        t0 = now_us();
+        hit_scan += linear_scan(tracks, track_count, tracks[target].song_name, target);
+        lat_scan[i] = now_us() - t0;
+
+        t0 = now_us();
+        n = music_search_index_query(index, tracks[target].song_name, hits, BENCH_TOP_K);
+        lat_exact[i] = now_us() - t0;
+        for (j = 0; j < n; ++j) {
+            if (hits[j].doc_id == target) {
+                hit_exact++;
+                break;
+            }
+        }
+
+        snprintf(fuzzy, sizeof(fuzzy), "%s", tracks[target].song_name);
+        chars = (int)strlen(fuzzy) / 3;
+        substitute_char(fuzzy, rand() % chars);
+        hit_fuzzy_scan += linear_scan(tracks, track_count, fuzzy, target);
+        t0 = now_us();
+        n = music_search_index_query(index, fuzzy, hits, BENCH_TOP_K);
+        lat_fuzzy[i] = now_us() - t0;
+        for (j = 0; j < n; ++j) {
+            if (hits[j].doc_id == target) {
+                hit_fuzzy++;
+                break;
+            }
+        }
+    }
+
+    report("strstr scan (exact)", lat_scan, query_count, hit_scan);
+    report("index top10 (exact)", lat_exact, query_count, hit_exact);
+    report("index top10 (1 typo)", lat_fuzzy, query_count, hit_fuzzy);
+    printf("strstr scan recall with 1 typo: %.1f%%\n", 100.0 * hit_fuzzy_scan / query_count);
+
+    music_search_index_destroy(index);
+    free(tracks);
+    free(singers);
+    free(lat_scan);
+    free(lat_exact);
+    free(lat_fuzzy);
+    return 0;
+}
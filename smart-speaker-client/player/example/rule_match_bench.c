@@ -0,0 +1,75 @@
+/* rule_match 基准：对语料逐句反复匹配，输出每句平均耗时。
+ * 用法：./bin/rule_match_bench [语料文件，每行一句] [轮数] */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "rule_match.h"
+
+#define BENCH_MAX_LINES 4096
+#define BENCH_DEFAULT_ROUNDS 2000
+
+static const char *const k_default_corpus[] = {
+    "停止播放", "暂停一下", "继续播放", "下一首", "上一首歌",
+    "把音量调到50", "音量设置为80", "音 量 调 到 70", "声音小一点", "把声音调高一点",
+    "单曲循环", "顺序播放", "切换到离线模式", "没事了吧", "播放音乐",
+    "我想听周杰伦的晴天", "来一首七里香", "播放我的歌单", "给我放一首陈奕迅的十年吧", "今天天气怎么样",
+};
+
+static double now_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e6 + (double)ts.tv_nsec / 1e3;
+}
+
+int main(int argc, char **argv)
+{
+    static char storage[BENCH_MAX_LINES][256];
+    const char *lines[BENCH_MAX_LINES];
+    int line_count = 0;
+    int rounds = (argc > 2) ? atoi(argv[2]) : BENCH_DEFAULT_ROUNDS;
+    rule_match_result_t result;
+    unsigned long matched = 0;
+    double t0;
+    double elapsed;
+    int r;
+    int i;
+
+    if (argc > 1) {
+        FILE *fp = fopen(argv[1], "r");
+        if (fp == NULL) {
+            printf("open %s failed\n", argv[1]);
+            return 1;
+        }
+        while (line_count < BENCH_MAX_LINES && fgets(storage[line_count], sizeof(storage[0]), fp) != NULL) {
+            storage[line_count][strcspn(storage[line_count], "\n")] = '\0';
+            lines[line_count] = storage[line_count];
+            line_count++;
+        }
+        fclose(fp);
+    } else {
+        for (i = 0; i < (int)(sizeof(k_default_corpus) / sizeof(k_default_corpus[0])); ++i) {
+            lines[line_count++] = k_default_corpus[i];
+        }
+    }
+    if (line_count == 0 || rounds <= 0) {
+        printf("empty corpus\n");
+        return 1;
+    }
+
+    /* 预热：首次调用会建自动机 */
+    rule_match_text(lines[0], &result);
+
+    t0 = now_us();
+    for (r = 0; r < rounds; ++r) {
+        for (i = 0; i < line_count; ++i) {
+            rule_match_text(lines[i], &result);
+            matched += (unsigned long)result.matched;
+        }
+    }
+    elapsed = now_us() - t0;
+    printf("utterances=%d rounds=%d matched=%lu avg=%.2fus/utterance\n",
+           line_count, rounds, matched / (unsigned long)rounds, elapsed / ((double)rounds * line_count));
+    return 0;
+}
@@ -0,0 +1,96 @@
+/* rule_match 表驱动回归：每行「文本 → 期望命令/音量」，全部通过返回 0 */
+#include <stdio.h>
+#include <string.h>
+#include "rule_match.h"
+
+typedef struct {
+    const char *text;
+    rule_cmd_t cmd;
+    int vol_set_target;
+} rule_case_t;
+
+static const rule_case_t k_cases[] = {
+    {"停止播放", RULE_CMD_STOP, -1},
+    {"停", RULE_CMD_STOP, -1},
+    {" 停 ", RULE_CMD_STOP, -1},
+    {"暂停一下", RULE_CMD_PAUSE, -1},
+    {"等一下再说", RULE_CMD_PAUSE, -1},
+    {"继续播放", RULE_CMD_RESUME, -1},
+    {"下一首", RULE_CMD_NEXT, -1},
+    {"换一首歌", RULE_CMD_NEXT, -1},
+    {"上一首歌", RULE_CMD_PREV, -1},
+    {"前一首", RULE_CMD_PREV, -1},
+    {"把音量调到50", RULE_CMD_VOL_SET, 50},
+    {"帮我把音量设置到百分之三十", RULE_CMD_NONE, -1},
+    {"音量设置为80", RULE_CMD_VOL_SET, 80},
+    {"音量设置 为 20", RULE_CMD_VOL_SET, 20},
+    {"音 量 调 到 70", RULE_CMD_VOL_SET, 70},
+    {"声音调至１００", RULE_CMD_VOL_SET, 100},
+    {"把音量开到200", RULE_CMD_VOL_SET, 100},
+    {"音量太大了", RULE_CMD_VOL_DOWN, -1},
+    {"声音小一点", RULE_CMD_VOL_DOWN, -1},
+    {"调低音量", RULE_CMD_VOL_DOWN, -1},
+    {"把声音调高一点", RULE_CMD_VOL_UP, -1},
+    {"音量大点", RULE_CMD_VOL_UP, -1},
+    {"单曲循环", RULE_CMD_MODE_SINGLE, -1},
+    {"顺序播放", RULE_CMD_MODE_ORDER, -1},
+    {"切换到离线模式", RULE_CMD_SWITCH_OFFLINE, -1},
+    {"切换到在线模式", RULE_CMD_SWITCH_ONLINE, -1},
+    {"没事", RULE_CMD_NOOP, -1},
+    {"没事了吧", RULE_CMD_NOOP, -1},
+    {"算了没事。", RULE_CMD_NOOP, -1},
+    {"播放音乐", RULE_CMD_PLAY_START, -1},
+    {"开始播放", RULE_CMD_PLAY_START, -1},
+    {"播放", RULE_CMD_PLAY_START, -1},
+    {"放首歌", RULE_CMD_PLAY_START, -1},
+    {"我想听周杰伦的晴天", RULE_CMD_PLAY_QUERY, -1},
+    {"播放稻香", RULE_CMD_PLAY_QUERY, -1},
+    {"来一首七里香", RULE_CMD_PLAY_QUERY, -1},
+    {"我想听歌", RULE_CMD_NONE, -1},
+    {"我想听纯音乐", RULE_CMD_PLAY_QUERY, -1},
+    {"播放我的歌单", RULE_CMD_PLAY_PLAYLIST, -1},
+    {"我想听周杰伦的歌单", RULE_CMD_PLAY_PLAYLIST, -1},
+    {"听听这首", RULE_CMD_PLAY_QUERY, -1},
+    {"给我放一首陈奕迅的十年吧", RULE_CMD_PLAY_QUERY, -1},
+    {"今天天气怎么样", RULE_CMD_NONE, -1},
+    {"你好", RULE_CMD_NONE, -1},
+    {"把音量调到五十", RULE_CMD_NONE, -1},
+    {"我想听歌然后暂停", RULE_CMD_PAUSE, -1},
+    {"停止播放下一首", RULE_CMD_STOP, -1},
+    {"网易云音乐的晴天", RULE_CMD_NONE, -1},
+    {"我要听一首刘德华的冰雨", RULE_CMD_PLAY_QUERY, -1},
+    {"音量", RULE_CMD_NONE, -1},
+    {"结束吧", RULE_CMD_STOP, -1},
+    {"退出", RULE_CMD_STOP, -1},
+    {"关掉音乐", RULE_CMD_STOP, -1},
+    {"继续", RULE_CMD_RESUME, -1},
+    {"接着播放", RULE_CMD_RESUME, -1},
+    {"切歌", RULE_CMD_NEXT, -1},
+    {"放大声音", RULE_CMD_VOL_UP, -1},
+    {"声音放低", RULE_CMD_VOL_DOWN, -1},
+    {"播放的请周杰伦的晴天吧", RULE_CMD_PLAY_QUERY, -1},
+    {"我想听 请 稻香 这首歌", RULE_CMD_PLAY_QUERY, -1},
+    {"来首 的吧十年呀。", RULE_CMD_PLAY_QUERY, -1},
+    {"给我放一首周杰伦的歌", RULE_CMD_PLAY_PLAYLIST, -1},
+    {"我想听晴天 ！", RULE_CMD_PLAY_QUERY, -1},
+};
+
+int main(void)
+{
+    size_t i;
+    int failed = 0;
+    rule_match_result_t result;
+
+    for (i = 0; i < sizeof(k_cases) / sizeof(k_cases[0]); ++i) {
+        if (rule_match_text(k_cases[i].text, &result) != 0 ||
+            result.cmd != k_cases[i].cmd || result.vol_set_target != k_cases[i].vol_set_target) {
+            printf("FAIL [%s] want=%s/%d got=%s/%d\n", k_cases[i].text,
+                   rule_cmd_to_string(k_cases[i].cmd), k_cases[i].vol_set_target,
+                   rule_cmd_to_string(result.cmd), result.vol_set_target);
+            failed++;
+        }
+    }
+    printf("%d/%d passed\n", (int)(sizeof(k_cases) / sizeof(k_cases[0])) - failed,
+           (int)(sizeof(k_cases) / sizeof(k_cases[0])));
+    return failed == 0 ? 0 : 1;
+}
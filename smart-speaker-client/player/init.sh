@@ -5,8 +5,6 @@ SHM_KEY="1234"
 SEM_KEY="1235"
 SCRIPT_DIR="$(cd "$(dirname "$0")" && pwd)"
 PIPE_PATH="$SCRIPT_DIR/../fifo"      # 管道路径
-TTS_PIPE_PATH="/tmp/tts_fifo"
-TTS_WAKE_DONE_FIFO_PATH="/tmp/tts_wake_done_fifo"
 # ====================================================================
 
 # 1. 删除旧的共享内存
@@ -32,38 +30,7 @@ if [ ! -p "$PIPE_PATH/cmd_fifo" ]; then
     chmod 777 $PIPE_PATH/cmd_fifo
     echo "创建播放控制管道: $PIPE_PATH/cmd_fifo"
 fi
-if [ ! -p "$PIPE_PATH/asr_fifo" ]; then
-    mkfifo $PIPE_PATH/asr_fifo
-    chmod 777 $PIPE_PATH/asr_fifo
-    echo "创建asr语音识别管道成功：$PIPE_PATH/asr_fifo"
-fi
-
-if [ ! -p "$PIPE_PATH/kws_fifo" ]; then
-    mkfifo $PIPE_PATH/kws_fifo
-    chmod 777 $PIPE_PATH/kws_fifo
-    echo "创建kws关键词识别管道成功：$PIPE_PATH/kws_fifo"
-fi
-
-if [ ! -p "$TTS_PIPE_PATH" ]; then
-    mkfifo "$TTS_PIPE_PATH"
-    chmod 777 "$TTS_PIPE_PATH"
-    echo "创建tts语音合成管道成功：$TTS_PIPE_PATH"
-fi
-
-if [ ! -p "$PIPE_PATH/asr_ctrl_fifo" ]; then
-    mkfifo $PIPE_PATH/asr_ctrl_fifo
-    chmod 777 $PIPE_PATH/asr_ctrl_fifo
-    echo "创建asr控制管道成功：$PIPE_PATH/asr_ctrl_fifo"
-fi
-
-if [ ! -p "$PIPE_PATH/player_ctrl_fifo" ]; then
-    mkfifo $PIPE_PATH/player_ctrl_fifo
-    chmod 777 $PIPE_PATH/player_ctrl_fifo
-    echo "创建player控制管道成功：$PIPE_PATH/player_ctrl_fifo"
-fi
-
-if [ ! -p "$TTS_WAKE_DONE_FIFO_PATH" ]; then
-    mkfifo "$TTS_WAKE_DONE_FIFO_PATH"
-    chmod 777 "$TTS_WAKE_DONE_FIFO_PATH"
-    echo "创建tts唤醒完成管道成功：$TTS_WAKE_DONE_FIFO_PATH"
-fi
+# asr_kws / tts / player 之间的消息走抽象命名空间的 Unix 套接字（ipc/ipc_bus.h），不再需要 FIFO；
+# 清掉旧版本遗留的管道，避免误以为仍在使用
+rm -f $PIPE_PATH/asr_fifo $PIPE_PATH/kws_fifo $PIPE_PATH/asr_ctrl_fifo $PIPE_PATH/player_ctrl_fifo \
+      /tmp/tts_fifo /tmp/tts_wake_done_fifo
@@ -0,0 +1,333 @@
+#include "music_search_index.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MSI_MAX_QUERY_CHARS 64
+#define MSI_UNIGRAM_WEIGHT 1
+#define MSI_BIGRAM_WEIGHT 4
+#define MSI_FULL_COVER_BONUS 8
+#define MSI_LEN_SLOTS 64
+
+/* gram 键：高 32 位首字符，低 32 位次字符（1-gram 为 0） */
+typedef struct {
+    uint64_t key;
+    int doc_id;
+} MsiPosting;
+
+typedef struct {
+    uint64_t key;
+    int offset;
+    int count;
+} MsiTerm;
+
+struct MusicSearchIndex {
+    MsiPosting *pairs;       /* build 前收集，build 后释放 */
+    int pair_count;
+    int pair_capacity;
+
+    MsiTerm *terms;          /* 按 key 升序 */
+    int term_count;
+    int *postings;           /* 各 term 的 doc_id 连续存放，升序去重 */
+    int posting_count;
+
+    int *doc_len;            /* 字符数，同分时短的优先 */
+    int doc_count;
+    int doc_capacity;
+
+    /* 查询累加缓冲 */
+    uint16_t *acc_uni;
+    uint16_t *acc_bi;
+    int *touched;
+    MusicSearchHit *scratch;
+    int built;
+};
+
+/* 解码一个 UTF-8 字符，非法字节按单字节跳过 */
+static uint32_t msi_next_cp(const unsigned char **pp)
+{
+    const unsigned char *p = *pp;
+    uint32_t cp;
+    int extra;
+    int i;
+
+    if (p[0] < 0x80) {
+        *pp = p + 1;
+        return p[0];
+    }
+    if ((p[0] & 0xe0) == 0xc0) {
+        cp = p[0] & 0x1f;
+        extra = 1;
+    } else if ((p[0] & 0xf0) == 0xe0) {
+        cp = p[0] & 0x0f;
+        extra = 2;
+    } else if ((p[0] & 0xf8) == 0xf0) {
+        cp = p[0] & 0x07;
+        extra = 3;
+    } else {
+        *pp = p + 1;
+        return 0;
+    }
+    for (i = 1; i <= extra; ++i) {
+        if ((p[i] & 0xc0) != 0x80) {
+            *pp = p + i;
+            return 0;
+        }
+        cp = (cp << 6) | (p[i] & 0x3f);
+    }
+    *pp = p + extra + 1;
+    return cp;
+}
+
+/* 只保留字母数字和 CJK 等非 ASCII 字符，ASCII 转小写；空白与标点不参与匹配 */
+static int msi_normalize(const char *text, uint32_t *out, int out_max)
+{
+    const unsigned char *p = (const unsigned char *)text;
+    int n = 0;
+
+    if (text == NULL) return 0;
+    while (*p != '\0' && n < out_max) {
+        uint32_t cp = msi_next_cp(&p);
+        if (cp == 0) continue;
+        if (cp < 0x80) {
+            if (cp >= 'A' && cp <= 'Z') {
+                cp = cp - 'A' + 'a';
+            } else if (!((cp >= 'a' && cp <= 'z') || (cp >= '0' && cp <= '9'))) {
+                continue;
+            }
+        } else if (cp == 0x3000 || (cp >= 0x3001 && cp <= 0x303f) || (cp >= 0xff00 && cp <= 0xff0f)) {
+            /* 全角空格与中文标点 */
+            continue;
+        }
+        out[n++] = cp;
+    }
+    return n;
+}
+
+static uint64_t msi_key(uint32_t a, uint32_t b)
+{
+    return ((uint64_t)a << 32) | (uint64_t)b;
+}
+
+static int msi_push_pair(MusicSearchIndex *index, uint64_t key, int doc_id)
+{
+    if (index->pair_count >= index->pair_capacity) {
+        int cap = (index->pair_capacity == 0) ? 1024 : index->pair_capacity * 2;
+        MsiPosting *np = (MsiPosting *)realloc(index->pairs, sizeof(*np) * (size_t)cap);
+        if (np == NULL) return -1;
+        index->pairs = np;
+        index->pair_capacity = cap;
+    }
+    index->pairs[index->pair_count].key = key;
+    index->pairs[index->pair_count].doc_id = doc_id;
+    index->pair_count++;
+    return 0;
+}
+
+static int msi_cmp_posting(const void *a, const void *b)
+{
+    const MsiPosting *pa = (const MsiPosting *)a;
+    const MsiPosting *pb = (const MsiPosting *)b;
+    if (pa->key != pb->key) return (pa->key < pb->key) ? -1 : 1;
+    return (pa->doc_id > pb->doc_id) - (pa->doc_id < pb->doc_id);
+}
+
+static const MsiTerm *msi_find_term(const MusicSearchIndex *index, uint64_t key)
+{
+    int lo = 0;
+    int hi = index->term_count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        if (index->terms[mid].key == key) return &index->terms[mid];
+        if (index->terms[mid].key < key) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return NULL;
+}
+
+MusicSearchIndex *music_search_index_create(void)
+{
+    return (MusicSearchIndex *)calloc(1, sizeof(MusicSearchIndex));
+}
+
+void music_search_index_clear(MusicSearchIndex *index)
+{
+    if (index == NULL) return;
+    free(index->pairs);
+    free(index->terms);
+    free(index->postings);
+    free(index->doc_len);
+    free(index->acc_uni);
+    free(index->acc_bi);
+    free(index->touched);
+    free(index->scratch);
+    memset(index, 0, sizeof(*index));
+}
+
+void music_search_index_destroy(MusicSearchIndex *index)
+{
+    if (index == NULL) return;
+    music_search_index_clear(index);
+    free(index);
+}
+
+int music_search_index_add(MusicSearchIndex *index, int doc_id, const char *const *fields, int field_count)
+{
+    uint32_t cps[256];
+    int total = 0;
+    int f;
+    int i;
+
+    if (index == NULL || index->built || doc_id != index->doc_count) return -1;
+    if (index->doc_count >= index->doc_capacity) {
+        int cap = (index->doc_capacity == 0) ? 256 : index->doc_capacity * 2;
+        int *nl = (int *)realloc(index->doc_len, sizeof(int) * (size_t)cap);
+        if (nl == NULL) return -1;
+        index->doc_len = nl;
+        index->doc_capacity = cap;
+    }
+    for (f = 0; f < field_count; ++f) {
+        int n = msi_normalize(fields[f], cps, (int)(sizeof(cps) / sizeof(cps[0])));
+        for (i = 0; i < n; ++i) {
+            if (msi_push_pair(index, msi_key(cps[i], 0), doc_id) != 0) return -1;
+            if (i + 1 < n && msi_push_pair(index, msi_key(cps[i], cps[i + 1]), doc_id) != 0) return -1;
+        }
+        total += n;
+    }
+    index->doc_len[index->doc_count++] = total;
+    return 0;
+}
+
+int music_search_index_build(MusicSearchIndex *index)
+{
+    int i;
+
+    if (index == NULL || index->built) return -1;
+    qsort(index->pairs, (size_t)index->pair_count, sizeof(MsiPosting), msi_cmp_posting);
+
+    index->postings = (int *)malloc(sizeof(int) * (size_t)(index->pair_count > 0 ? index->pair_count : 1));
+    index->terms = (MsiTerm *)malloc(sizeof(MsiTerm) * (size_t)(index->pair_count > 0 ? index->pair_count : 1));
+    index->acc_uni = (uint16_t *)calloc((size_t)(index->doc_count > 0 ? index->doc_count : 1), sizeof(uint16_t));
+    index->acc_bi = (uint16_t *)calloc((size_t)(index->doc_count > 0 ? index->doc_count : 1), sizeof(uint16_t));
+    index->touched = (int *)malloc(sizeof(int) * (size_t)(index->doc_count > 0 ? index->doc_count : 1));
+    index->scratch = (MusicSearchHit *)malloc(sizeof(MusicSearchHit) * (size_t)(index->doc_count > 0 ? index->doc_count : 1));
+    if (index->postings == NULL || index->terms == NULL || index->acc_uni == NULL ||
+        index->acc_bi == NULL || index->touched == NULL || index->scratch == NULL) {
+        return -1;
+    }
+
+    for (i = 0; i < index->pair_count; ++i) {
+        const MsiPosting *p = &index->pairs[i];
+        MsiTerm *t = (index->term_count > 0) ? &index->terms[index->term_count - 1] : NULL;
+        if (t == NULL || t->key != p->key) {
+            t = &index->terms[index->term_count++];
+            t->key = p->key;
+            t->offset = index->posting_count;
+            t->count = 0;
+        } else if (index->postings[t->offset + t->count - 1] == p->doc_id) {
+            continue;
+        }
+        index->postings[index->posting_count++] = p->doc_id;
+        t->count++;
+    }
+    free(index->pairs);
+    index->pairs = NULL;
+    index->pair_count = 0;
+    index->pair_capacity = 0;
+    index->built = 1;
+    return 0;
+}
+
+int music_search_index_doc_count(const MusicSearchIndex *index)
+{
+    return (index == NULL) ? 0 : index->doc_count;
+}
+
+static int msi_cmp_hit(const void *a, const void *b)
+{
+    const MusicSearchHit *ha = (const MusicSearchHit *)a;
+    const MusicSearchHit *hb = (const MusicSearchHit *)b;
+    if (ha->score != hb->score) return hb->score - ha->score;
+    return ha->doc_id - hb->doc_id;
+}
+
+/* 累加一个 gram 的倒排表，首次命中的 doc 记入 touched */
+static void msi_accumulate(MusicSearchIndex *index, const MsiTerm *t, uint16_t *acc, int *touched_count)
+{
+    int i;
+    for (i = 0; i < t->count; ++i) {
+        int doc = index->postings[t->offset + i];
+        if (index->acc_uni[doc] == 0 && index->acc_bi[doc] == 0) {
+            index->touched[(*touched_count)++] = doc;
+        }
+        acc[doc]++;
+    }
+}
+
+int music_search_index_query(MusicSearchIndex *index, const char *keyword, MusicSearchHit *hits, int max_hits)
+{
+    uint32_t cps[MSI_MAX_QUERY_CHARS];
+    uint64_t uni_keys[MSI_MAX_QUERY_CHARS];
+    uint64_t bi_keys[MSI_MAX_QUERY_CHARS];
+    int n;
+    int n_uni = 0;
+    int n_bi = 0;
+    int min_uni;
+    int touched_count = 0;
+    int out = 0;
+    int i;
+    int j;
+
+    if (index == NULL || !index->built || hits == NULL || max_hits <= 0) return 0;
+    n = msi_normalize(keyword, cps, MSI_MAX_QUERY_CHARS);
+    if (n == 0 || index->doc_count == 0) return 0;
+
+    /* 关键词内重复的 gram 只算一次，保证命中计数不超过 n_uni / n_bi */
+    for (i = 0; i < n; ++i) {
+        uint64_t k = msi_key(cps[i], 0);
+        for (j = 0; j < n_uni && uni_keys[j] != k; ++j) {
+        }
+        if (j == n_uni) uni_keys[n_uni++] = k;
+        if (i + 1 < n) {
+            k = msi_key(cps[i], cps[i + 1]);
+            for (j = 0; j < n_bi && bi_keys[j] != k; ++j) {
+            }
+            if (j == n_bi) bi_keys[n_bi++] = k;
+        }
+    }
+
+    for (i = 0; i < n_bi; ++i) {
+        const MsiTerm *t = msi_find_term(index, bi_keys[i]);
+        if (t != NULL) msi_accumulate(index, t, index->acc_bi, &touched_count);
+    }
+    for (i = 0; i < n_uni; ++i) {
+        const MsiTerm *t = msi_find_term(index, uni_keys[i]);
+        if (t != NULL) msi_accumulate(index, t, index->acc_uni, &touched_count);
+    }
+
+    /* 至少覆盖一半字符；同分时字符数少的（更贴近关键词）排前 */
+    min_uni = (n_uni + 1) / 2;
+    for (i = 0; i < touched_count; ++i) {
+        int doc = index->touched[i];
+        int uni = index->acc_uni[doc];
+        int bi = index->acc_bi[doc];
+        int len = index->doc_len[doc];
+        MusicSearchHit *h;
+        index->acc_uni[doc] = 0;
+        index->acc_bi[doc] = 0;
+        if (uni < min_uni) continue;
+        h = &index->scratch[out++];
+        h->doc_id = doc;
+        h->full_cover = (uni == n_uni && bi == n_bi);
+        h->score = uni * MSI_UNIGRAM_WEIGHT + bi * MSI_BIGRAM_WEIGHT + (h->full_cover ? MSI_FULL_COVER_BONUS : 0);
+        h->score = h->score * MSI_LEN_SLOTS + (MSI_LEN_SLOTS - 1 - (len < MSI_LEN_SLOTS - 1 ? len : MSI_LEN_SLOTS - 1));
+    }
+    qsort(index->scratch, (size_t)out, sizeof(MusicSearchHit), msi_cmp_hit);
+    if (out > max_hits) out = max_hits;
+    memcpy(hits, index->scratch, sizeof(MusicSearchHit) * (size_t)out);
+    return out;
+}
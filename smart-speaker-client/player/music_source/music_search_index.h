@@ -0,0 +1,32 @@
+#ifndef MUSIC_SEARCH_INDEX_H
+#define MUSIC_SEARCH_INDEX_H
+
+/* 曲目模糊检索：按 Unicode 字符切 1-gram / 2-gram 建倒排表。
+ * ASR 同音字错一个字时 2-gram 会丢、1-gram 仍能命中，按覆盖度打分排序。
+ * 不依赖曲库来源，doc_id 由调用方分配（需从 0 递增添加）。 */
+
+typedef struct MusicSearchIndex MusicSearchIndex;
+
+typedef struct {
+    int doc_id;
+    int score;          /* 仅用于排序 */
+    int full_cover;     /* 关键词所有 gram 都命中（精确子串匹配的必要条件） */
+} MusicSearchHit;
+
+MusicSearchIndex *music_search_index_create(void);
+void music_search_index_destroy(MusicSearchIndex *index);
+void music_search_index_clear(MusicSearchIndex *index);
+
+/* fields 中任一字段可为 NULL；返回 0 成功，-1 失败 */
+int music_search_index_add(MusicSearchIndex *index, int doc_id, const char *const *fields, int field_count);
+
+/* 添加完成后调用一次，之后才能查询 */
+int music_search_index_build(MusicSearchIndex *index);
+
+int music_search_index_doc_count(const MusicSearchIndex *index);
+
+/* 返回命中数（<= max_hits），按得分降序；未覆盖到关键词一半字符的曲目不返回。
+ * 复用内部累加缓冲，同一索引的查询需由调用方串行化 */
+int music_search_index_query(MusicSearchIndex *index, const char *keyword, MusicSearchHit *hits, int max_hits);
+
+#endif
@@ -17,16 +17,52 @@
 
 #define TAG "MUSIC-ASYNC"
 
+/* 常驻 worker 数：一个跑主查询，其余供 resolve/search 投机并发使用 */
+#define MAS_WORKER_COUNT 3
+/* 队列容量；新请求会先清掉所有过期 token 的任务，满时丢最旧 */
+#define MAS_QUEUE_CAP 8
+
+typedef enum {
+    MAS_JOB_PLAY_QUERY,
+    MAS_JOB_SPEC_SEARCH,
+} MasJobKind;
+
+typedef enum {
+    MAS_SPEC_QUEUED,
+    MAS_SPEC_RUNNING,
+    MAS_SPEC_DONE,
+    MAS_SPEC_CANCELLED,
+} MasSpecState;
+
+/* resolve 与 search 兜底投机并发：主查询 worker 跑 resolve，search 作为子任务投给另一 worker */
+typedef struct MasSpec {
+    pthread_mutex_t mu;
+    pthread_cond_t cv;
+    MasSpecState state;
+    int refs;
+    int ret;
+    int page_size;
+    MusicSourceResult sr;
+} MasSpec;
+
 typedef struct MasJob {
+    MasJobKind kind;
     char q[256];
     char source[16];
     uint32_t token;
+    MasSpec *spec;
 } MasJob;
 
 static int g_mas_pipe[2] = {-1, -1};
 static pthread_mutex_t g_mas_mu = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_mas_queue_cv = PTHREAD_COND_INITIALIZER;
 static uint32_t g_latest_token;
 
+static MasJob g_mas_queue[MAS_QUEUE_CAP];
+static int g_mas_queue_head;
+static int g_mas_queue_len;
+static int g_mas_worker_count;
+
 static char g_query[256];
 static char g_source[16];
 static music_async_out_t g_pending_out;
@@ -78,6 +114,110 @@ static void mas_publish_or_drop(uint32_t job_tok, music_async_out_t out, const M
     mas_notify_write();
 }
 
+static int mas_token_stale(uint32_t tok)
+{
+    int stale;
+    pthread_mutex_lock(&g_mas_mu);
+    stale = (tok != g_latest_token);
+    pthread_mutex_unlock(&g_mas_mu);
+    return stale;
+}
+
+static MasSpec *mas_spec_new(int page_size)
+{
+    MasSpec *spec = (MasSpec *)calloc(1, sizeof(*spec));
+    if (spec == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&spec->mu, NULL);
+    pthread_cond_init(&spec->cv, NULL);
+    spec->state = MAS_SPEC_QUEUED;
+    spec->refs = 1;
+    spec->ret = -1;
+    spec->page_size = page_size;
+    return spec;
+}
+
+static void mas_spec_release(MasSpec *spec)
+{
+    int refs;
+    if (spec == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&spec->mu);
+    refs = --spec->refs;
+    pthread_mutex_unlock(&spec->mu);
+    if (refs > 0) {
+        return;
+    }
+    music_source_free_result(&spec->sr);
+    pthread_cond_destroy(&spec->cv);
+    pthread_mutex_destroy(&spec->mu);
+    free(spec);
+}
+
+/* 尚未开跑的投机任务直接作废；已在跑的让它跑完，结果随最后一个引用释放 */
+static void mas_spec_cancel(MasSpec *spec)
+{
+    if (spec == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&spec->mu);
+    if (spec->state == MAS_SPEC_QUEUED) {
+        spec->state = MAS_SPEC_CANCELLED;
+    }
+    pthread_cond_broadcast(&spec->cv);
+    pthread_mutex_unlock(&spec->mu);
+}
+
+/* 调用方持 g_mas_mu */
+static void mas_queue_drop_at_locked(int pos)
+{
+    int idx = (g_mas_queue_head + pos) % MAS_QUEUE_CAP;
+    int n;
+    MasJob *job = &g_mas_queue[idx];
+
+    if (job->kind == MAS_JOB_SPEC_SEARCH) {
+        mas_spec_cancel(job->spec);
+        mas_spec_release(job->spec);
+    }
+    for (n = pos; n + 1 < g_mas_queue_len; ++n) {
+        g_mas_queue[(g_mas_queue_head + n) % MAS_QUEUE_CAP] =
+            g_mas_queue[(g_mas_queue_head + n + 1) % MAS_QUEUE_CAP];
+    }
+    g_mas_queue_len--;
+}
+
+/* 调用方持 g_mas_mu；被新请求取代的任务在出网前就被移出队列 */
+static void mas_queue_drop_stale_locked(void)
+{
+    int pos = 0;
+    while (pos < g_mas_queue_len) {
+        if (g_mas_queue[(g_mas_queue_head + pos) % MAS_QUEUE_CAP].token != g_latest_token) {
+            mas_queue_drop_at_locked(pos);
+            continue;
+        }
+        pos++;
+    }
+}
+
+/* 调用方持 g_mas_mu；front 用于投机子任务，避免排在别的主查询后面 */
+static void mas_queue_push_locked(const MasJob *job, int front)
+{
+    if (g_mas_queue_len == MAS_QUEUE_CAP) {
+        LOGW(TAG, "任务队列已满，丢弃最旧任务");
+        mas_queue_drop_at_locked(0);
+    }
+    if (front) {
+        g_mas_queue_head = (g_mas_queue_head + MAS_QUEUE_CAP - 1) % MAS_QUEUE_CAP;
+        g_mas_queue[g_mas_queue_head] = *job;
+    } else {
+        g_mas_queue[(g_mas_queue_head + g_mas_queue_len) % MAS_QUEUE_CAP] = *job;
+    }
+    g_mas_queue_len++;
+    pthread_cond_signal(&g_mas_queue_cv);
+}
+
 void music_server_async_cancel_pending(void)
 {
     char drain[256];
@@ -85,6 +225,7 @@ void music_server_async_cancel_pending(void)
 
     pthread_mutex_lock(&g_mas_mu);
     g_latest_token++;
+    mas_queue_drop_stale_locked();
     if ((g_pending_out == MUSIC_ASYNC_OK_SEARCH || g_pending_out == MUSIC_ASYNC_OK_PLAYLIST) &&
         g_pending_search.items != NULL) {
         music_source_free_result(&g_pending_search);
@@ -103,27 +244,85 @@ void music_server_async_cancel_pending(void)
     }
 }
 
-static void *mas_play_query_thread(void *arg)
+static int mas_run_search(const char *q, uint32_t tok, int page_size, MusicSourceResult *sr)
 {
-    MasJob *job = (MasJob *)arg;
-    char q[256];
-    char source[16];
-    uint32_t tok;
-    MusicSourceItem it;
+    memset(sr, 0, sizeof(*sr));
+    if (mas_token_stale(tok)) {
+        return -1;
+    }
+    return music_source_search(q, 1, page_size, sr);
+}
+
+static void mas_spec_search_job(const MasJob *job)
+{
+    MasSpec *spec = job->spec;
     MusicSourceResult sr;
-    player_playlist_ctx_t pl;
+    int ret;
 
-    if (job == NULL) {
-        return NULL;
+    pthread_mutex_lock(&spec->mu);
+    if (spec->state != MAS_SPEC_QUEUED) {
+        pthread_mutex_unlock(&spec->mu);
+        mas_spec_release(spec);
+        return;
     }
-    snprintf(q, sizeof(q), "%s", job->q);
-    snprintf(source, sizeof(source), "%s", job->source);
-    tok = job->token;
-    free(job);
-    job = NULL;
+    spec->state = MAS_SPEC_RUNNING;
+    pthread_mutex_unlock(&spec->mu);
+
+    ret = mas_run_search(job->q, job->token, spec->page_size, &sr);
+
+    pthread_mutex_lock(&spec->mu);
+    spec->ret = ret;
+    spec->sr = sr;
+    spec->state = MAS_SPEC_DONE;
+    pthread_cond_broadcast(&spec->cv);
+    pthread_mutex_unlock(&spec->mu);
+    mas_spec_release(spec);
+}
+
+/* resolve 失败后取 search 结果：子任务没被 worker 拿走就收回自己跑，避免 worker 全部互等 */
+static int mas_spec_take_search(MasSpec *spec, const char *q, uint32_t tok, int page_size, MusicSourceResult *sr)
+{
+    int ret;
+
+    if (spec == NULL) {
+        return mas_run_search(q, tok, page_size, sr);
+    }
+    pthread_mutex_lock(&spec->mu);
+    if (spec->state == MAS_SPEC_QUEUED) {
+        spec->state = MAS_SPEC_CANCELLED;
+        pthread_mutex_unlock(&spec->mu);
+        return mas_run_search(q, tok, page_size, sr);
+    }
+    while (spec->state == MAS_SPEC_RUNNING) {
+        pthread_cond_wait(&spec->cv, &spec->mu);
+    }
+    ret = spec->ret;
+    *sr = spec->sr;
+    memset(&spec->sr, 0, sizeof(spec->sr));
+    pthread_mutex_unlock(&spec->mu);
+    return ret;
+}
+
+static void mas_play_query_job(const MasJob *job)
+{
+    const char *q = job->q;
+    const char *source = job->source;
+    uint32_t tok = job->token;
+    MusicSourceItem it;
+    MusicSourceResult sr;
+    player_playlist_ctx_t pl;
+    MasSpec *spec = NULL;
+    int page_size;
+    int ret;
 
     memset(&it, 0, sizeof(it));
     memset(&sr, 0, sizeof(sr));
+    if (mas_token_stale(tok)) {
+        return;
+    }
+
+    player_get_playlist_ctx(&pl);
+    page_size = pl.page_size > 0 ? pl.page_size : PLAYER_ONLINE_PLAYLIST_PAGE_SIZE;
 
     if (g_current_online_mode == ONLINE_MODE_YES) {
         if (select_text_is_playlist_query(q)) {
@@ -132,37 +331,100 @@ static void *mas_play_query_thread(void *arg)
             LOGI(TAG, "歌单检索 source=%s raw=%s norm=%s", source, q, playlist_kw);
             if (music_source_server_resolve_playlist_keyword(playlist_kw, source, &sr) == 0 && sr.count > 0) {
                 mas_publish_or_drop(tok, MUSIC_ASYNC_OK_PLAYLIST, NULL, &sr, q, source);
-                return NULL;
+                return;
             }
             music_source_free_result(&sr);
             memset(&sr, 0, sizeof(sr));
             mas_publish_or_drop(tok, MUSIC_ASYNC_FAIL, NULL, NULL, q, source);
-            return NULL;
-        } else if (music_source_server_resolve_keyword(q, source, &it) == 0) {
+            return;
+        }
+
+        spec = mas_spec_new(page_size);
+        if (spec != NULL) {
+            MasJob sub;
+            memset(&sub, 0, sizeof(sub));
+            sub.kind = MAS_JOB_SPEC_SEARCH;
+            sub.token = tok;
+            sub.spec = spec;
+            snprintf(sub.q, sizeof(sub.q), "%s", q);
+            pthread_mutex_lock(&g_mas_mu);
+            if (tok == g_latest_token) {
+                spec->refs++;
+                mas_queue_push_locked(&sub, 1);
+            } else {
+                spec->state = MAS_SPEC_CANCELLED;
+            }
+            pthread_mutex_unlock(&g_mas_mu);
+        }
+
+        if (!mas_token_stale(tok) && music_source_server_resolve_keyword(q, source, &it) == 0) {
+            mas_spec_cancel(spec);
+            mas_spec_release(spec);
             mas_publish_or_drop(tok, MUSIC_ASYNC_OK_RESOLVE, &it, NULL, q, source);
-            return NULL;
+            return;
+        }
+        if (mas_token_stale(tok)) {
+            mas_spec_cancel(spec);
+            mas_spec_release(spec);
+            return;
         }
+        ret = mas_spec_take_search(spec, q, tok, page_size, &sr);
+        mas_spec_release(spec);
+    } else {
+        ret = mas_run_search(q, tok, page_size, &sr);
     }
 
-    player_get_playlist_ctx(&pl);
-    if (music_source_search(q, 1, pl.page_size > 0 ? pl.page_size : PLAYER_ONLINE_PLAYLIST_PAGE_SIZE, &sr) != 0 ||
-        sr.count <= 0) {
+    if (ret != 0 || sr.count <= 0) {
         if (sr.count <= 0 && sr.online_search_disabled) {
             music_source_set_online_search_blocked(1);
         }
         music_source_free_result(&sr);
         memset(&sr, 0, sizeof(sr));
         mas_publish_or_drop(tok, MUSIC_ASYNC_FAIL, NULL, NULL, q, source);
-        return NULL;
+        return;
     }
 
     mas_publish_or_drop(tok, MUSIC_ASYNC_OK_SEARCH, NULL, &sr, q, source);
+}
+
+static void *mas_worker_thread(void *arg)
+{
+    MasJob job;
+    int stale;
+
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&g_mas_mu);
+        while (g_mas_queue_len == 0) {
+            pthread_cond_wait(&g_mas_queue_cv, &g_mas_mu);
+        }
+        job = g_mas_queue[g_mas_queue_head];
+        g_mas_queue_head = (g_mas_queue_head + 1) % MAS_QUEUE_CAP;
+        g_mas_queue_len--;
+        stale = (job.token != g_latest_token);
+        pthread_mutex_unlock(&g_mas_mu);
+
+        if (job.kind == MAS_JOB_SPEC_SEARCH) {
+            if (stale) {
+                mas_spec_cancel(job.spec);
+                mas_spec_release(job.spec);
+                continue;
+            }
+            mas_spec_search_job(&job);
+        } else if (!stale) {
+            mas_play_query_job(&job);
+        }
+    }
     return NULL;
 }
 
 int music_server_async_init(void)
 {
     int fl;
+    int i;
+    pthread_t th;
+    pthread_attr_t attr;
+
     if (g_mas_pipe[0] >= 0) {
         return 0;
     }
@@ -177,8 +439,27 @@ int music_server_async_init(void)
         g_mas_pipe[0] = g_mas_pipe[1] = -1;
         return -1;
     }
-    FD_SET(g_mas_pipe[0], &READSET);
-    update_max_fd();
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    for (i = 0; i < MAS_WORKER_COUNT; ++i) {
+        int r = pthread_create(&th, &attr, mas_worker_thread, NULL);
+        if (r != 0) {
+            LOGE(TAG, "pthread_create: %s", strerror(r));
+            break;
+        }
+        g_mas_worker_count++;
+    }
+    pthread_attr_destroy(&attr);
+    if (g_mas_worker_count == 0) {
+        close(g_mas_pipe[0]);
+        close(g_mas_pipe[1]);
+        g_mas_pipe[0] = g_mas_pipe[1] = -1;
+        return -1;
+    }
+    LOGI(TAG, "worker 池就绪 workers=%d queue=%d", g_mas_worker_count, MAS_QUEUE_CAP);
+
+    select_watch_fd(g_mas_pipe[0]);
     return 0;
 }
 
@@ -225,35 +506,23 @@ void music_server_async_on_readable(void)
 
 int music_server_async_start_play_query(const char *query, const char *source)
 {
-    pthread_t th;
-    pthread_attr_t attr;
-    int r;
-    MasJob *job;
+    MasJob job;
     if (query == NULL || query[0] == '\0') {
         return -1;
     }
-    if (g_mas_pipe[0] < 0) {
-        return -1;
-    }
-    job = (MasJob *)malloc(sizeof(*job));
-    if (job == NULL) {
+    if (g_mas_pipe[0] < 0 || g_mas_worker_count == 0) {
         return -1;
     }
+    memset(&job, 0, sizeof(job));
+    job.kind = MAS_JOB_PLAY_QUERY;
+    snprintf(job.q, sizeof(job.q), "%s", query);
+    snprintf(job.source, sizeof(job.source), "%s", source != NULL ? source : "");
+
     pthread_mutex_lock(&g_mas_mu);
     g_latest_token++;
-    job->token = g_latest_token;
-    snprintf(job->q, sizeof(job->q), "%s", query);
-    snprintf(job->source, sizeof(job->source), "%s", source != NULL ? source : "");
+    job.token = g_latest_token;
+    mas_queue_drop_stale_locked();
+    mas_queue_push_locked(&job, 0);
     pthread_mutex_unlock(&g_mas_mu);
-
-    pthread_attr_init(&attr);
-    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
-    r = pthread_create(&th, &attr, mas_play_query_thread, job);
-    pthread_attr_destroy(&attr);
-    if (r != 0) {
-        free(job);
-        LOGE(TAG, "pthread_create: %s", strerror(r));
-        return -1;
-    }
     return 0;
 }
@@ -1,16 +1,17 @@
 #include "music_source_manager.h"
 
-#include <dirent.h>
 #include <errno.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
-#include <strings.h>
-#include <sys/stat.h>
 
+#include "music_source_local_index.h"
 #include "player_constants.h"
 #include "runtime_config.h"
 
+/* 精确匹配为空时，模糊结果最多返回这么多首，避免只命中一两个字的曲目刷屏 */
+#define LOCAL_FUZZY_MAX_HITS 50
+
 typedef struct {
     MusicSourceItem *items;
     int count;
@@ -56,73 +57,6 @@ static void local_trim_spaces(char *text)
     }
 }
 
-static void local_parse_song_meta(const char *filename, const char *fallback_singer,
-                                  char *song_name, size_t song_name_size,
-                                  char *singer, size_t singer_size)
-{
-    char base[MUSIC_MAX_NAME];
-    char parsed_singer[SINGER_MAX_NAME];
-    char *ext;
-    char *sep;
-
-    if (song_name == NULL || song_name_size == 0 || singer == NULL || singer_size == 0) return;
-    song_name[0] = '\0';
-    singer[0] = '\0';
-
-    local_copy_text(base, sizeof(base), filename);
-    ext = strrchr(base, '.');
-    if (ext != NULL) {
-        *ext = '\0';
-    }
-
-    sep = strstr(base, " - ");
-    if (sep != NULL && sep != base && sep[3] != '\0') {
-        *sep = '\0';
-        local_copy_text(song_name, song_name_size, base);
-        local_copy_text(parsed_singer, sizeof(parsed_singer), sep + 3);
-        local_trim_spaces(song_name);
-        local_trim_spaces(parsed_singer);
-        if (parsed_singer[0] != '\0') {
-            local_copy_text(singer, singer_size, parsed_singer);
-        }
-    } else {
-        local_copy_text(song_name, song_name_size, base);
-        local_trim_spaces(song_name);
-    }
-
-    if (singer[0] == '\0') {
-        local_copy_text(singer, singer_size, fallback_singer);
-        local_trim_spaces(singer);
-    }
-}
-
-static int local_has_audio_ext(const char *filename)
-{
-    const char *ext;
-    if (filename == NULL) return 0;
-    ext = strrchr(filename, '.');
-    if (ext == NULL) return 0;
-    return strcasecmp(ext, ".mp3") == 0 ||
-           strcasecmp(ext, ".wav") == 0 ||
-           strcasecmp(ext, ".flac") == 0;
-}
-
-static void local_pick_singer(const char *relative_path, char *singer, size_t singer_size)
-{
-    const char *sep;
-    if (singer == NULL || singer_size == 0) return;
-    singer[0] = '\0';
-    if (relative_path == NULL) return;
-    sep = strchr(relative_path, '/');
-    if (sep == NULL) return;
-    {
-        size_t len = (size_t)(sep - relative_path);
-        if (len >= singer_size) len = singer_size - 1;
-        memcpy(singer, relative_path, len);
-        singer[len] = '\0';
-    }
-}
-
 static int utf8_is_de_zh(const char *p)
 {
     if (p == NULL || p[0] == '\0' || p[1] == '\0' || p[2] == '\0') {
@@ -223,141 +157,94 @@ static int local_push_item(LocalCollectContext *ctx, const MusicSourceItem *item
     return 0;
 }
 
-static int local_scan_dir(const char *root_path, const char *relative_path, const char *keyword, LocalCollectContext *ctx)
+typedef struct {
+    const char *keyword;
+    const char *singer_kw;
+    const char *song_kw;
+    LocalCollectContext *ctx;
+    LocalCollectContext *dual_match_ctx;
+    LocalCollectContext *song_only_ctx;
+    int failed;
+} LocalVisitContext;
+
+static void local_item_from_entry(const LocalIndexEntry *entry, MusicSourceItem *item)
+{
+    memset(item, 0, sizeof(*item));
+    local_copy_text(item->source, sizeof(item->source), "local");
+    local_copy_text(item->song_id, sizeof(item->song_id), entry->song_id);
+    local_copy_text(item->singer, sizeof(item->singer), entry->singer);
+    local_copy_text(item->song_name, sizeof(item->song_name), entry->song_name);
+}
+
+static int local_visit_keyword(const LocalIndexEntry *entry, void *arg)
 {
-    DIR *dir;
-    struct dirent *entry;
-    dir = opendir(root_path);
-    if (dir == NULL) {
-        return -1;
+    LocalVisitContext *vc = (LocalVisitContext *)arg;
+    MusicSourceItem item;
+    local_item_from_entry(entry, &item);
+    if (!local_match_keyword(vc->keyword, &item)) {
+        return 0;
     }
-    while ((entry = readdir(dir)) != NULL) {
-        struct stat st;
-        char child_abs[1024];
-        char child_rel[MUSIC_ID_MAX];
-        MusicSourceItem item;
-        if (entry->d_name[0] == '.') continue;
-        if (snprintf(child_abs, sizeof(child_abs), "%s/%s", root_path, entry->d_name) >= (int)sizeof(child_abs)) {
-            continue;
-        }
-        if (relative_path != NULL && relative_path[0] != '\0') {
-            if (snprintf(child_rel, sizeof(child_rel), "%s/%s", relative_path, entry->d_name) >= (int)sizeof(child_rel)) {
-                continue;
-            }
-        } else {
-            if (snprintf(child_rel, sizeof(child_rel), "%s", entry->d_name) >= (int)sizeof(child_rel)) {
-                continue;
-            }
-        }
-        if (stat(child_abs, &st) != 0) {
-            continue;
-        }
-        if (S_ISDIR(st.st_mode)) {
-            if (local_scan_dir(child_abs, child_rel, keyword, ctx) != 0 && errno != ENOENT) {
-                closedir(dir);
-                return -1;
-            }
-            continue;
-        }
-        if (!S_ISREG(st.st_mode) || !local_has_audio_ext(entry->d_name)) {
-            continue;
-        }
-        memset(&item, 0, sizeof(item));
-        local_copy_text(item.source, sizeof(item.source), "local");
-        local_copy_text(item.song_id, sizeof(item.song_id), child_rel);
-        local_pick_singer(child_rel, item.singer, sizeof(item.singer));
-        local_parse_song_meta(entry->d_name, item.singer,
-                              item.song_name, sizeof(item.song_name),
-                              item.singer, sizeof(item.singer));
-        if (!local_match_keyword(keyword, &item)) {
-            continue;
+    if (local_push_item(vc->ctx, &item) != 0) {
+        vc->failed = 1;
+        return 1;
+    }
+    return 0;
+}
+
+static int local_visit_tiered(const LocalIndexEntry *entry, void *arg)
+{
+    LocalVisitContext *vc = (LocalVisitContext *)arg;
+    MusicSourceItem item;
+    local_item_from_entry(entry, &item);
+    if (local_dual_match_singer_song(vc->singer_kw, vc->song_kw, &item)) {
+        if (local_push_item(vc->dual_match_ctx, &item) != 0) {
+            vc->failed = 1;
+            return 1;
         }
-        if (local_push_item(ctx, &item) != 0) {
-            closedir(dir);
-            free(ctx->items);
-            ctx->items = NULL;
-            ctx->count = 0;
-            ctx->capacity = 0;
-            return -1;
+    } else if (local_match_song_kw_only(vc->song_kw, &item)) {
+        if (local_push_item(vc->song_only_ctx, &item) != 0) {
+            vc->failed = 1;
+            return 1;
         }
     }
-    closedir(dir);
     return 0;
 }
 
-static int local_scan_dir_tiered(const char *root_path, const char *relative_path, const char *singer_kw,
-                                 const char *song_kw, LocalCollectContext *dual_match_ctx,
-                                 LocalCollectContext *song_only_ctx)
+/* 倒排表命中里 full_cover 的才可能是子串匹配，再用原规则校验 */
+static int local_visit_exact_hit(const LocalIndexEntry *entry, int full_cover, void *arg)
 {
-    DIR *dir;
-    struct dirent *entry;
-    dir = opendir(root_path);
-    if (dir == NULL) {
-        return -1;
+    LocalVisitContext *vc = (LocalVisitContext *)arg;
+    if (!full_cover) {
+        return 1;
     }
-    while ((entry = readdir(dir)) != NULL) {
-        struct stat st;
-        char child_abs[1024];
-        char child_rel[MUSIC_ID_MAX];
-        MusicSourceItem item;
-        if (entry->d_name[0] == '.') continue;
-        if (snprintf(child_abs, sizeof(child_abs), "%s/%s", root_path, entry->d_name) >= (int)sizeof(child_abs)) {
-            continue;
-        }
-        if (relative_path != NULL && relative_path[0] != '\0') {
-            if (snprintf(child_rel, sizeof(child_rel), "%s/%s", relative_path, entry->d_name) >= (int)sizeof(child_rel)) {
-                continue;
-            }
-        } else {
-            if (snprintf(child_rel, sizeof(child_rel), "%s", entry->d_name) >= (int)sizeof(child_rel)) {
-                continue;
-            }
-        }
-        if (stat(child_abs, &st) != 0) {
-            continue;
-        }
-        if (S_ISDIR(st.st_mode)) {
-            if (local_scan_dir_tiered(child_abs, child_rel, singer_kw, song_kw, dual_match_ctx, song_only_ctx) != 0 &&
-                errno != ENOENT) {
-                closedir(dir);
-                return -1;
-            }
-            continue;
-        }
-        if (!S_ISREG(st.st_mode) || !local_has_audio_ext(entry->d_name)) {
-            continue;
-        }
-        memset(&item, 0, sizeof(item));
-        local_copy_text(item.source, sizeof(item.source), "local");
-        local_copy_text(item.song_id, sizeof(item.song_id), child_rel);
-        local_pick_singer(child_rel, item.singer, sizeof(item.singer));
-        local_parse_song_meta(entry->d_name, item.singer,
-                              item.song_name, sizeof(item.song_name),
-                              item.singer, sizeof(item.singer));
-        if (local_dual_match_singer_song(singer_kw, song_kw, &item)) {
-            if (local_push_item(dual_match_ctx, &item) != 0) {
-                closedir(dir);
-                free(dual_match_ctx->items);
-                dual_match_ctx->items = NULL;
-                dual_match_ctx->count = 0;
-                dual_match_ctx->capacity = 0;
-                return -1;
-            }
-        } else if (local_match_song_kw_only(song_kw, &item)) {
-            if (local_push_item(song_only_ctx, &item) != 0) {
-                closedir(dir);
-                free(song_only_ctx->items);
-                song_only_ctx->items = NULL;
-                song_only_ctx->count = 0;
-                song_only_ctx->capacity = 0;
-                return -1;
-            }
-        }
+    return local_visit_keyword(entry, arg) != 0 || vc->failed;
+}
+
+static int local_visit_fuzzy_hit(const LocalIndexEntry *entry, int full_cover, void *arg)
+{
+    LocalVisitContext *vc = (LocalVisitContext *)arg;
+    MusicSourceItem item;
+    (void)full_cover;
+    local_item_from_entry(entry, &item);
+    if (local_push_item(vc->ctx, &item) != 0) {
+        vc->failed = 1;
+        return 1;
     }
-    closedir(dir);
     return 0;
 }
 
+/* 关键词里没有可命中的原文时（ASR 同音字、漏字），按 n-gram 覆盖度取最相近的若干首 */
+static int local_fuzzy_collect(const char *keyword, LocalCollectContext *ctx)
+{
+    LocalVisitContext vc;
+    memset(&vc, 0, sizeof(vc));
+    vc.ctx = ctx;
+    if (local_index_query(keyword, LOCAL_FUZZY_MAX_HITS, local_visit_fuzzy_hit, &vc) != 0 && errno != ENOENT) {
+        return -1;
+    }
+    return vc.failed ? -1 : 0;
+}
+
 static void local_shuffle_items(MusicSourceItem *items, int count)
 {
     int i;
@@ -398,19 +285,24 @@ static int music_source_local_search(const char *keyword, int page, int page_siz
     LocalCollectContext ctx;
     LocalCollectContext dual_match_ctx;
     LocalCollectContext song_only_ctx;
+    LocalVisitContext vc;
     char singer_kw[256];
     char song_kw[256];
-    const char *root = local_music_root();
     int ret;
     memset(&ctx, 0, sizeof(ctx));
     memset(&dual_match_ctx, 0, sizeof(dual_match_ctx));
     memset(&song_only_ctx, 0, sizeof(song_only_ctx));
+    memset(&vc, 0, sizeof(vc));
     if (page <= 0 || page_size <= 0 || result == NULL) return -1;
     local_result_reset(result);
     if (keyword != NULL &&
         local_try_split_singer_song_keyword(keyword, singer_kw, sizeof(singer_kw), song_kw, sizeof(song_kw))) {
-        ret = local_scan_dir_tiered(root, "", singer_kw, song_kw, &dual_match_ctx, &song_only_ctx);
-        if (ret != 0 && errno != ENOENT) {
+        vc.singer_kw = singer_kw;
+        vc.song_kw = song_kw;
+        vc.dual_match_ctx = &dual_match_ctx;
+        vc.song_only_ctx = &song_only_ctx;
+        ret = local_index_foreach(local_visit_tiered, &vc);
+        if (vc.failed || (ret != 0 && errno != ENOENT)) {
             free(dual_match_ctx.items);
             free(song_only_ctx.items);
             return -1;
@@ -422,9 +314,32 @@ static int music_source_local_search(const char *keyword, int page, int page_siz
             free(dual_match_ctx.items);
             ctx = song_only_ctx;
         }
+        if (ctx.count == 0) {
+            char joined[512];
+            snprintf(joined, sizeof(joined), "%s %s", singer_kw, song_kw);
+            if (local_fuzzy_collect(joined, &ctx) != 0) {
+                free(ctx.items);
+                return -1;
+            }
+        }
+    } else if (keyword == NULL || keyword[0] == '\0' || strcmp(keyword, "热门") == 0) {
+        vc.keyword = keyword;
+        vc.ctx = &ctx;
+        ret = local_index_foreach(local_visit_keyword, &vc);
+        if (vc.failed || (ret != 0 && errno != ENOENT)) {
+            free(ctx.items);
+            return -1;
+        }
     } else {
-        ret = local_scan_dir(root, "", keyword, &ctx);
-        if (ret != 0 && errno != ENOENT) {
+        /* 先取倒排表里覆盖全部 gram 的候选做精确校验（按相关度排序），为空再退到模糊结果 */
+        vc.keyword = keyword;
+        vc.ctx = &ctx;
+        ret = local_index_query(keyword, 0, local_visit_exact_hit, &vc);
+        if (vc.failed || (ret != 0 && errno != ENOENT)) {
+            free(ctx.items);
+            return -1;
+        }
+        if (ctx.count == 0 && local_fuzzy_collect(keyword, &ctx) != 0) {
             free(ctx.items);
             return -1;
         }
@@ -0,0 +1,841 @@
+#include "music_source_local_index.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "debug_log.h"
+#include "link.h"
+#include "music_search_index.h"
+#include "runtime_config.h"
+#include "select.h"
+
+#define TAG "LOCAL-INDEX"
+
+#define LOCAL_INDEX_MAGIC "LLIDX1"
+#define LOCAL_INDEX_FILE "local_library.idx"
+#define LOCAL_INDEX_WATCH_MASK (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | \
+                                IN_DELETE_SELF | IN_UNMOUNT | IN_ONLYDIR)
+
+typedef struct {
+    char *rel;          /* 相对曲库根，根目录为 "" */
+    long long mtime_ns;
+    int parent;         /* 父目录下标，根为 -1 */
+    int first_file;     /* 本目录曲目在 files 中连续存放 */
+    int file_count;
+    int borrowed;       /* 增量扫描时曲目字符串与另一份索引共用，释放时跳过，由扫描结果决定归属 */
+} LocalIndexDir;
+
+typedef struct {
+    char *song_id;
+    char *singer;
+    char *song_name;
+    long long mtime_ns;
+} LocalIndexFile;
+
+typedef struct {
+    LocalIndexDir *dirs;
+    int dir_count;
+    int dir_capacity;
+    LocalIndexFile *files;
+    int file_count;
+    int file_capacity;
+} LocalIndexData;
+
+static pthread_mutex_t g_index_mu = PTHREAD_MUTEX_INITIALIZER;
+static LocalIndexData g_index;
+static char g_index_root[256];
+static int g_index_loaded;
+static int g_index_dirty = 1;
+static unsigned g_index_gen;            /* g_index 内容变化时递增 */
+static MusicSearchIndex *g_search;     /* 对 g_index.files 建的倒排表，doc_id 即下标 */
+static unsigned g_search_gen;
+static int g_search_valid;
+static int g_inotify_fd = -1;
+
+static void index_copy_text(char *dst, size_t dst_size, const char *src)
+{
+    if (dst == NULL || dst_size == 0) return;
+    dst[0] = '\0';
+    if (src == NULL) return;
+    strncpy(dst, src, dst_size - 1);
+    dst[dst_size - 1] = '\0';
+}
+
+static void index_trim_spaces(char *text)
+{
+    char *start;
+    size_t len;
+
+    if (text == NULL || text[0] == '\0') return;
+    start = text;
+    while (*start == ' ' || *start == '\t') {
+        start++;
+    }
+    if (start != text) {
+        memmove(text, start, strlen(start) + 1);
+    }
+    len = strlen(text);
+    while (len > 0 && (text[len - 1] == ' ' || text[len - 1] == '\t')) {
+        text[--len] = '\0';
+    }
+}
+
+/* 文件名「歌名 - 歌手.ext」；否则歌手取一级目录名 */
+static void index_parse_song_meta(const char *filename, const char *fallback_singer,
+                                  char *song_name, size_t song_name_size,
+                                  char *singer, size_t singer_size)
+{
+    char base[MUSIC_MAX_NAME];
+    char parsed_singer[SINGER_MAX_NAME];
+    char *ext;
+    char *sep;
+
+    song_name[0] = '\0';
+    singer[0] = '\0';
+
+    index_copy_text(base, sizeof(base), filename);
+    ext = strrchr(base, '.');
+    if (ext != NULL) {
+        *ext = '\0';
+    }
+
+    sep = strstr(base, " - ");
+    if (sep != NULL && sep != base && sep[3] != '\0') {
+        *sep = '\0';
+        index_copy_text(song_name, song_name_size, base);
+        index_copy_text(parsed_singer, sizeof(parsed_singer), sep + 3);
+        index_trim_spaces(song_name);
+        index_trim_spaces(parsed_singer);
+        if (parsed_singer[0] != '\0') {
+            index_copy_text(singer, singer_size, parsed_singer);
+        }
+    } else {
+        index_copy_text(song_name, song_name_size, base);
+        index_trim_spaces(song_name);
+    }
+
+    if (singer[0] == '\0') {
+        index_copy_text(singer, singer_size, fallback_singer);
+        index_trim_spaces(singer);
+    }
+}
+
+static int index_has_audio_ext(const char *filename)
+{
+    const char *ext;
+    if (filename == NULL) return 0;
+    ext = strrchr(filename, '.');
+    if (ext == NULL) return 0;
+    return strcasecmp(ext, ".mp3") == 0 ||
+           strcasecmp(ext, ".wav") == 0 ||
+           strcasecmp(ext, ".flac") == 0;
+}
+
+static void index_pick_singer(const char *relative_path, char *singer, size_t singer_size)
+{
+    const char *sep;
+    size_t len;
+
+    singer[0] = '\0';
+    if (relative_path == NULL) return;
+    sep = strchr(relative_path, '/');
+    if (sep == NULL) return;
+    len = (size_t)(sep - relative_path);
+    if (len >= singer_size) len = singer_size - 1;
+    memcpy(singer, relative_path, len);
+    singer[len] = '\0';
+}
+
+/* 索引文件以 \t 分列、\n 分行，含这两个字符的名字不入索引 */
+static int index_name_storable(const char *name)
+{
+    return strpbrk(name, "\t\n\r") == NULL;
+}
+
+static long long index_stat_mtime_ns(const struct stat *st)
+{
+    return (long long)st->st_mtim.tv_sec * 1000000000LL + (long long)st->st_mtim.tv_nsec;
+}
+
+static void index_data_free(LocalIndexData *data)
+{
+    int i;
+    int k;
+    for (i = 0; i < data->dir_count; ++i) {
+        const LocalIndexDir *d = &data->dirs[i];
+        free(d->rel);
+        if (d->borrowed) {
+            continue;
+        }
+        for (k = 0; k < d->file_count; ++k) {
+            free(data->files[d->first_file + k].song_id);
+            free(data->files[d->first_file + k].singer);
+            free(data->files[d->first_file + k].song_name);
+        }
+    }
+    free(data->dirs);
+    free(data->files);
+    memset(data, 0, sizeof(*data));
+}
+
+static int index_push_dir(LocalIndexData *data, const char *rel, long long mtime_ns, int parent)
+{
+    LocalIndexDir *d;
+    if (data->dir_count >= data->dir_capacity) {
+        int cap = (data->dir_capacity == 0) ? 16 : data->dir_capacity * 2;
+        LocalIndexDir *nd = (LocalIndexDir *)realloc(data->dirs, sizeof(*nd) * (size_t)cap);
+        if (nd == NULL) return -1;
+        data->dirs = nd;
+        data->dir_capacity = cap;
+    }
+    d = &data->dirs[data->dir_count];
+    memset(d, 0, sizeof(*d));
+    d->rel = strdup(rel);
+    if (d->rel == NULL) return -1;
+    d->mtime_ns = mtime_ns;
+    d->parent = parent;
+    d->first_file = data->file_count;
+    return data->dir_count++;
+}
+
+/* 成功后字符串所有权归 data；失败时调用方负责释放 */
+static int index_push_file(LocalIndexData *data, int dir_idx, const LocalIndexFile *file)
+{
+    if (data->file_count >= data->file_capacity) {
+        int cap = (data->file_capacity == 0) ? 64 : data->file_capacity * 2;
+        LocalIndexFile *nf = (LocalIndexFile *)realloc(data->files, sizeof(*nf) * (size_t)cap);
+        if (nf == NULL) return -1;
+        data->files = nf;
+        data->file_capacity = cap;
+    }
+    data->files[data->file_count++] = *file;
+    data->dirs[dir_idx].file_count++;
+    return 0;
+}
+
+static int index_push_file_meta(LocalIndexData *data, int dir_idx, const char *song_id,
+                                const char *singer, const char *song_name, long long mtime_ns)
+{
+    LocalIndexFile f;
+    f.song_id = strdup(song_id);
+    f.singer = strdup(singer);
+    f.song_name = strdup(song_name);
+    f.mtime_ns = mtime_ns;
+    if (f.song_id == NULL || f.singer == NULL || f.song_name == NULL ||
+        index_push_file(data, dir_idx, &f) != 0) {
+        free(f.song_id);
+        free(f.singer);
+        free(f.song_name);
+        return -1;
+    }
+    return 0;
+}
+
+static void index_clear_borrowed(LocalIndexData *data)
+{
+    int i;
+    for (i = 0; i < data->dir_count; ++i) {
+        data->dirs[i].borrowed = 0;
+    }
+}
+
+static int index_find_dir(const LocalIndexData *data, const char *rel)
+{
+    int i;
+    for (i = 0; i < data->dir_count; ++i) {
+        if (data->dirs[i].rel != NULL && strcmp(data->dirs[i].rel, rel) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+typedef struct {
+    char **names;
+    int count;
+    int capacity;
+} IndexNameList;
+
+static int index_name_list_push(IndexNameList *list, const char *name)
+{
+    if (list->count >= list->capacity) {
+        int cap = (list->capacity == 0) ? 8 : list->capacity * 2;
+        char **nn = (char **)realloc(list->names, sizeof(char *) * (size_t)cap);
+        if (nn == NULL) return -1;
+        list->names = nn;
+        list->capacity = cap;
+    }
+    list->names[list->count] = strdup(name);
+    if (list->names[list->count] == NULL) return -1;
+    list->count++;
+    return 0;
+}
+
+static void index_name_list_free(IndexNameList *list)
+{
+    int i;
+    for (i = 0; i < list->count; ++i) {
+        free(list->names[i]);
+    }
+    free(list->names);
+    memset(list, 0, sizeof(*list));
+}
+
+/* 增量扫描一个目录：mtime 未变则直接搬运旧索引里的曲目，只对子目录做 stat；变了才 readdir + stat。
+ * 搬运只拷结构体、不动旧索引，两边目录都标 borrowed；扫描中途失败时旧索引原样保留 */
+static int index_scan_dir(const char *root, LocalIndexData *old, const char *rel, int parent,
+                          LocalIndexData *out, int *changed)
+{
+    char abs_path[1024];
+    struct stat st;
+    int old_idx;
+    int my_idx;
+    int i;
+
+    if (rel[0] == '\0') {
+        snprintf(abs_path, sizeof(abs_path), "%s", root);
+    } else if (snprintf(abs_path, sizeof(abs_path), "%s/%s", root, rel) >= (int)sizeof(abs_path)) {
+        return 0;
+    }
+    if (stat(abs_path, &st) != 0) {
+        return -1;
+    }
+    if (!S_ISDIR(st.st_mode)) {
+        errno = ENOTDIR;
+        return -1;
+    }
+
+    old_idx = index_find_dir(old, rel);
+    my_idx = index_push_dir(out, rel, index_stat_mtime_ns(&st), parent);
+    if (my_idx < 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+
+    if (old_idx >= 0 && old->dirs[old_idx].mtime_ns == index_stat_mtime_ns(&st)) {
+        LocalIndexDir *od = &old->dirs[old_idx];
+        od->borrowed = 1;
+        out->dirs[my_idx].borrowed = 1;
+        for (i = 0; i < od->file_count; ++i) {
+            if (index_push_file(out, my_idx, &old->files[od->first_file + i]) != 0) {
+                errno = ENOMEM;
+                return -1;
+            }
+        }
+        for (i = 0; i < old->dir_count; ++i) {
+            if (old->dirs[i].parent != old_idx) {
+                continue;
+            }
+            if (index_scan_dir(root, old, old->dirs[i].rel, my_idx, out, changed) != 0) {
+                if (errno == ENOMEM) {
+                    return -1;
+                }
+                *changed = 1;
+            }
+        }
+        return 0;
+    }
+
+    {
+        DIR *dir;
+        struct dirent *entry;
+        IndexNameList subdirs;
+
+        *changed = 1;
+        memset(&subdirs, 0, sizeof(subdirs));
+        dir = opendir(abs_path);
+        if (dir == NULL) {
+            return -1;
+        }
+        while ((entry = readdir(dir)) != NULL) {
+            char child_abs[1024];
+            char child_rel[MUSIC_ID_MAX];
+            struct stat cst;
+            char dir_singer[SINGER_MAX_NAME];
+            char singer[SINGER_MAX_NAME];
+            char song_name[MUSIC_MAX_NAME];
+
+            if (entry->d_name[0] == '.' || !index_name_storable(entry->d_name)) continue;
+            if (snprintf(child_abs, sizeof(child_abs), "%s/%s", abs_path, entry->d_name) >= (int)sizeof(child_abs)) {
+                continue;
+            }
+            if (rel[0] != '\0') {
+                if (snprintf(child_rel, sizeof(child_rel), "%s/%s", rel, entry->d_name) >= (int)sizeof(child_rel)) {
+                    continue;
+                }
+            } else if (snprintf(child_rel, sizeof(child_rel), "%s", entry->d_name) >= (int)sizeof(child_rel)) {
+                continue;
+            }
+            if (entry->d_type == DT_DIR) {
+                if (index_name_list_push(&subdirs, child_rel) != 0) {
+                    closedir(dir);
+                    index_name_list_free(&subdirs);
+                    errno = ENOMEM;
+                    return -1;
+                }
+                continue;
+            }
+            if (entry->d_type != DT_UNKNOWN && entry->d_type != DT_REG && entry->d_type != DT_LNK) {
+                continue;
+            }
+            if (entry->d_type != DT_UNKNOWN && !index_has_audio_ext(entry->d_name)) {
+                continue;
+            }
+            if (stat(child_abs, &cst) != 0) {
+                continue;
+            }
+            if (S_ISDIR(cst.st_mode)) {
+                if (index_name_list_push(&subdirs, child_rel) != 0) {
+                    closedir(dir);
+                    index_name_list_free(&subdirs);
+                    errno = ENOMEM;
+                    return -1;
+                }
+                continue;
+            }
+            if (!S_ISREG(cst.st_mode) || !index_has_audio_ext(entry->d_name)) {
+                continue;
+            }
+            index_pick_singer(child_rel, dir_singer, sizeof(dir_singer));
+            index_parse_song_meta(entry->d_name, dir_singer, song_name, sizeof(song_name), singer, sizeof(singer));
+            if (index_push_file_meta(out, my_idx, child_rel, singer, song_name, index_stat_mtime_ns(&cst)) != 0) {
+                closedir(dir);
+                index_name_list_free(&subdirs);
+                errno = ENOMEM;
+                return -1;
+            }
+        }
+        closedir(dir);
+
+        for (i = 0; i < subdirs.count; ++i) {
+            if (index_scan_dir(root, old, subdirs.names[i], my_idx, out, changed) != 0 && errno == ENOMEM) {
+                index_name_list_free(&subdirs);
+                return -1;
+            }
+        }
+        index_name_list_free(&subdirs);
+    }
+    return 0;
+}
+
+static int index_file_path(char *out, size_t out_size)
+{
+    char dir_path[512];
+    snprintf(dir_path, sizeof(dir_path), "%s/player", player_runtime_data_dir());
+    if (mkdir(player_runtime_data_dir(), 0755) != 0 && errno != EEXIST) return -1;
+    if (mkdir(dir_path, 0755) != 0 && errno != EEXIST) return -1;
+    if (snprintf(out, out_size, "%s/%s", dir_path, LOCAL_INDEX_FILE) >= (int)out_size) return -1;
+    return 0;
+}
+
+/* 写临时文件再 rename，断电时不留半截索引 */
+static void index_save_locked(void)
+{
+    char path[640];
+    char tmp_path[660];
+    FILE *fp;
+    int d;
+    int i;
+
+    if (index_file_path(path, sizeof(path)) != 0) {
+        return;
+    }
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+    fp = fopen(tmp_path, "w");
+    if (fp == NULL) {
+        LOGW(TAG, "写索引失败: %s", strerror(errno));
+        return;
+    }
+    fprintf(fp, "%s\t%s\n", LOCAL_INDEX_MAGIC, g_index_root);
+    for (d = 0; d < g_index.dir_count; ++d) {
+        const LocalIndexDir *dir = &g_index.dirs[d];
+        fprintf(fp, "D\t%lld\t%d\t%s\n", dir->mtime_ns, dir->parent, dir->rel);
+        for (i = 0; i < dir->file_count; ++i) {
+            const LocalIndexFile *f = &g_index.files[dir->first_file + i];
+            fprintf(fp, "F\t%lld\t%s\t%s\t%s\n", f->mtime_ns, f->song_id, f->singer, f->song_name);
+        }
+    }
+    if (fclose(fp) != 0 || rename(tmp_path, path) != 0) {
+        LOGW(TAG, "写索引失败: %s", strerror(errno));
+        unlink(tmp_path);
+    }
+}
+
+/* 按 \t 切下一列，返回列起点并推进 *cursor */
+static char *index_next_field(char **cursor)
+{
+    char *start = *cursor;
+    char *tab;
+    if (start == NULL) return NULL;
+    tab = strchr(start, '\t');
+    if (tab != NULL) {
+        *tab = '\0';
+        *cursor = tab + 1;
+    } else {
+        *cursor = NULL;
+    }
+    return start;
+}
+
+static void index_load_locked(void)
+{
+    char path[640];
+    FILE *fp;
+    char *line = NULL;
+    size_t line_cap = 0;
+    ssize_t n;
+    LocalIndexData data;
+    int ok = 1;
+
+    if (index_file_path(path, sizeof(path)) != 0) {
+        return;
+    }
+    fp = fopen(path, "r");
+    if (fp == NULL) {
+        return;
+    }
+    memset(&data, 0, sizeof(data));
+    n = getline(&line, &line_cap, fp);
+    if (n <= 0) {
+        ok = 0;
+    } else {
+        char *cursor = line;
+        char *magic;
+        char *root;
+        line[strcspn(line, "\n")] = '\0';
+        magic = index_next_field(&cursor);
+        root = index_next_field(&cursor);
+        if (magic == NULL || root == NULL || strcmp(magic, LOCAL_INDEX_MAGIC) != 0 ||
+            strcmp(root, g_index_root) != 0) {
+            ok = 0;
+        }
+    }
+    while (ok && (n = getline(&line, &line_cap, fp)) > 0) {
+        char *cursor = line;
+        char *kind;
+        char *mtime;
+        line[strcspn(line, "\n")] = '\0';
+        kind = index_next_field(&cursor);
+        mtime = index_next_field(&cursor);
+        if (kind == NULL || mtime == NULL) {
+            ok = 0;
+        } else if (strcmp(kind, "D") == 0) {
+            char *parent = index_next_field(&cursor);
+            char *rel = index_next_field(&cursor);
+            int p = (parent != NULL) ? atoi(parent) : -2;
+            if (rel == NULL || p < -1 || p >= data.dir_count ||
+                index_push_dir(&data, rel, atoll(mtime), p) < 0) {
+                ok = 0;
+            }
+        } else if (strcmp(kind, "F") == 0) {
+            char *song_id = index_next_field(&cursor);
+            char *singer = index_next_field(&cursor);
+            char *song_name = index_next_field(&cursor);
+            if (data.dir_count == 0 || song_id == NULL || singer == NULL || song_name == NULL ||
+                index_push_file_meta(&data, data.dir_count - 1, song_id, singer, song_name, atoll(mtime)) != 0) {
+                ok = 0;
+            }
+        } else {
+            ok = 0;
+        }
+    }
+    free(line);
+    fclose(fp);
+    if (!ok) {
+        LOGW(TAG, "索引文件无效或曲库根已变更，将重建: %s", path);
+        index_data_free(&data);
+        return;
+    }
+    index_data_free(&g_index);
+    g_index = data;
+    g_index_gen++;
+    LOGI(TAG, "载入本地曲库索引: %d 目录 %d 首", g_index.dir_count, g_index.file_count);
+}
+
+static void index_watch_all_locked(void)
+{
+    int i;
+    if (g_inotify_fd < 0) {
+        return;
+    }
+    for (i = 0; i < g_index.dir_count; ++i) {
+        char abs_path[1024];
+        if (g_index.dirs[i].rel[0] == '\0') {
+            snprintf(abs_path, sizeof(abs_path), "%s", g_index_root);
+        } else {
+            snprintf(abs_path, sizeof(abs_path), "%s/%s", g_index_root, g_index.dirs[i].rel);
+        }
+        if (inotify_add_watch(g_inotify_fd, abs_path, LOCAL_INDEX_WATCH_MASK) < 0) {
+            LOGD(TAG, "inotify 监听失败 %s: %s", abs_path, strerror(errno));
+        }
+    }
+}
+
+static int index_refresh_locked(void)
+{
+    LocalIndexData out;
+    int changed = 0;
+    int saved_errno;
+
+    memset(&out, 0, sizeof(out));
+    if (index_scan_dir(g_index_root, &g_index, "", -1, &out, &changed) != 0) {
+        // 搬运过来的曲目仍归旧索引，丢掉本次结果即可
+        saved_errno = errno;
+        index_data_free(&out);
+        index_clear_borrowed(&g_index);
+        if (saved_errno == ENOENT || saved_errno == ENOTDIR) {
+            index_data_free(&g_index);
+            g_index_gen++;
+        }
+        errno = saved_errno;
+        return -1;
+    }
+    if (out.dir_count != g_index.dir_count || out.file_count != g_index.file_count) {
+        changed = 1;
+    }
+    index_data_free(&g_index);
+    index_clear_borrowed(&out);
+    g_index = out;
+    if (changed) {
+        g_index_gen++;
+        LOGI(TAG, "本地曲库索引已更新: %d 目录 %d 首", g_index.dir_count, g_index.file_count);
+        index_save_locked();
+        index_watch_all_locked();
+    }
+    return 0;
+}
+
+/* 曲库根变更、首次载入、标脏时刷新索引；调用方持锁 */
+static int index_prepare_locked(void)
+{
+    const char *root = player_runtime_local_music_root();
+
+    if (strcmp(root, g_index_root) != 0) {
+        index_data_free(&g_index);
+        g_index_gen++;
+        index_copy_text(g_index_root, sizeof(g_index_root), root);
+        g_index_loaded = 0;
+        g_index_dirty = 1;
+    }
+    if (!g_index_loaded) {
+        index_load_locked();
+        g_index_loaded = 1;
+        g_index_dirty = 1;
+    }
+    /* 有 inotify 时只在标脏后重扫；没有时每次都按目录 mtime 校验一遍（仅 stat 目录） */
+    if (g_index_dirty || g_inotify_fd < 0) {
+        if (index_refresh_locked() != 0) {
+            return -1;
+        }
+        g_index_dirty = 0;
+    }
+    return 0;
+}
+
+static void index_fill_entry(int i, LocalIndexEntry *e)
+{
+    const LocalIndexFile *f = &g_index.files[i];
+    e->song_id = f->song_id;
+    e->singer = f->singer;
+    e->song_name = f->song_name;
+    e->mtime_ns = f->mtime_ns;
+}
+
+int local_index_foreach(local_index_visit_fn visit, void *arg)
+{
+    int i;
+    int saved_errno;
+
+    if (visit == NULL) {
+        return -1;
+    }
+    pthread_mutex_lock(&g_index_mu);
+    if (index_prepare_locked() != 0) {
+        saved_errno = errno;
+        pthread_mutex_unlock(&g_index_mu);
+        errno = saved_errno;
+        return -1;
+    }
+    for (i = 0; i < g_index.file_count; ++i) {
+        LocalIndexEntry e;
+        if (g_index.files[i].song_id == NULL) {
+            continue;
+        }
+        index_fill_entry(i, &e);
+        if (visit(&e, arg) != 0) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_index_mu);
+    return 0;
+}
+
+/* 曲库变化后首次查询时重建倒排表（2 万首在 x86 上约 0.2 秒，只在变化后发生一次） */
+static int index_search_prepare_locked(void)
+{
+    int i;
+
+    if (g_search_valid && g_search_gen == g_index_gen) {
+        return 0;
+    }
+    if (g_search == NULL) {
+        g_search = music_search_index_create();
+        if (g_search == NULL) {
+            return -1;
+        }
+    }
+    music_search_index_clear(g_search);
+    g_search_valid = 0;
+    for (i = 0; i < g_index.file_count; ++i) {
+        const LocalIndexFile *f = &g_index.files[i];
+        const char *fields[3];
+        fields[0] = f->singer;
+        fields[1] = f->song_name;
+        fields[2] = f->song_id;
+        if (music_search_index_add(g_search, i, fields, 3) != 0) {
+            music_search_index_clear(g_search);
+            return -1;
+        }
+    }
+    if (music_search_index_build(g_search) != 0) {
+        music_search_index_clear(g_search);
+        return -1;
+    }
+    g_search_gen = g_index_gen;
+    g_search_valid = 1;
+    return 0;
+}
+
+int local_index_query(const char *keyword, int max_hits, local_index_hit_fn visit, void *arg)
+{
+    MusicSearchHit *hits;
+    int count;
+    int i;
+    int saved_errno;
+
+    if (keyword == NULL || visit == NULL) {
+        return -1;
+    }
+    pthread_mutex_lock(&g_index_mu);
+    if (index_prepare_locked() != 0) {
+        saved_errno = errno;
+        pthread_mutex_unlock(&g_index_mu);
+        errno = saved_errno;
+        return -1;
+    }
+    if (g_index.file_count == 0) {
+        pthread_mutex_unlock(&g_index_mu);
+        return 0;
+    }
+    if (max_hits <= 0 || max_hits > g_index.file_count) {
+        max_hits = g_index.file_count;
+    }
+    hits = (MusicSearchHit *)malloc(sizeof(MusicSearchHit) * (size_t)max_hits);
+    if (hits == NULL || index_search_prepare_locked() != 0) {
+        free(hits);
+        pthread_mutex_unlock(&g_index_mu);
+        errno = ENOMEM;
+        return -1;
+    }
+    count = music_search_index_query(g_search, keyword, hits, max_hits);
+    for (i = 0; i < count; ++i) {
+        LocalIndexEntry e;
+        index_fill_entry(hits[i].doc_id, &e);
+        if (visit(&e, hits[i].full_cover, arg) != 0) {
+            break;
+        }
+    }
+    free(hits);
+    pthread_mutex_unlock(&g_index_mu);
+    return 0;
+}
+
+void local_index_invalidate(void)
+{
+    pthread_mutex_lock(&g_index_mu);
+    g_index_dirty = 1;
+    pthread_mutex_unlock(&g_index_mu);
+}
+
+int local_index_watch_start(void)
+{
+    pthread_mutex_lock(&g_index_mu);
+    if (g_inotify_fd >= 0) {
+        pthread_mutex_unlock(&g_index_mu);
+        return 0;
+    }
+    g_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (g_inotify_fd < 0) {
+        LOGW(TAG, "inotify_init1 失败: %s", strerror(errno));
+        pthread_mutex_unlock(&g_index_mu);
+        return -1;
+    }
+    if (select_watch_fd(g_inotify_fd) != 0) {
+        close(g_inotify_fd);
+        g_inotify_fd = -1;
+        pthread_mutex_unlock(&g_index_mu);
+        return -1;
+    }
+    index_watch_all_locked();
+    /* 开始监听前的变更 inotify 看不到，先按 mtime 校验一次 */
+    g_index_dirty = 1;
+    pthread_mutex_unlock(&g_index_mu);
+    return 0;
+}
+
+void local_index_watch_stop(void)
+{
+    pthread_mutex_lock(&g_index_mu);
+    if (g_inotify_fd >= 0) {
+        select_unwatch_fd(g_inotify_fd);
+        close(g_inotify_fd);
+        g_inotify_fd = -1;
+    }
+    g_index_dirty = 1;
+    pthread_mutex_unlock(&g_index_mu);
+}
+
+int local_index_watch_fd(void)
+{
+    return g_inotify_fd;
+}
+
+void local_index_on_readable(void)
+{
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    ssize_t n;
+    int unmounted = 0;
+    int events = 0;
+
+    if (g_inotify_fd < 0) {
+        return;
+    }
+    while ((n = read(g_inotify_fd, buf, sizeof(buf))) > 0) {
+        char *p = buf;
+        while (p < buf + n) {
+            const struct inotify_event *ev = (const struct inotify_event *)p;
+            if (ev->mask & IN_UNMOUNT) {
+                unmounted = 1;
+            }
+            events++;
+            p += sizeof(struct inotify_event) + ev->len;
+        }
+    }
+    if (events == 0) {
+        return;
+    }
+    LOGD(TAG, "曲库目录变更事件 %d 个，下次搜索前增量刷新", events);
+    if (unmounted) {
+        local_index_watch_stop();
+        return;
+    }
+    local_index_invalidate();
+}
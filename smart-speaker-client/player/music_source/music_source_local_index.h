@@ -0,0 +1,35 @@
+#ifndef __MUSIC_SOURCE_LOCAL_INDEX_H__
+#define __MUSIC_SOURCE_LOCAL_INDEX_H__
+
+/* 本地曲库索引：内存常驻 + 持久化到 data/player/local_library.idx；
+ * 仅重扫 mtime 变化的目录，挂载期间用 inotify 标脏，搜索直接走内存 */
+
+typedef struct {
+    const char *song_id;     /* 相对曲库根的路径 */
+    const char *singer;
+    const char *song_name;
+    long long mtime_ns;
+} LocalIndexEntry;
+
+/* 返回非 0 时提前结束遍历 */
+typedef int (*local_index_visit_fn)(const LocalIndexEntry *entry, void *arg);
+
+/* 必要时增量刷新后，在锁内按扫描顺序遍历所有曲目；返回 0 成功，-1 曲库根不可用 */
+int local_index_foreach(local_index_visit_fn visit, void *arg);
+
+/* 模糊检索回调：按相关度降序；full_cover 表示关键词的每个字/相邻字对都出现在该曲目里 */
+typedef int (*local_index_hit_fn)(const LocalIndexEntry *entry, int full_cover, void *arg);
+
+/* 走 n-gram 倒排表检索，至少覆盖关键词一半字符才返回；max_hits<=0 不限；返回 0 成功，-1 失败 */
+int local_index_query(const char *keyword, int max_hits, local_index_hit_fn visit, void *arg);
+
+/* 标记需要刷新（下次遍历前按目录 mtime 增量重扫） */
+void local_index_invalidate(void);
+
+/* 挂载后开始 inotify 监听已索引目录；卸载前停止 */
+int local_index_watch_start(void);
+void local_index_watch_stop(void);
+int local_index_watch_fd(void);
+void local_index_on_readable(void);
+
+#endif
@@ -7,6 +7,7 @@
 #include <sys/wait.h>
 #include <pthread.h>
 #include <sys/select.h>
+#include <poll.h>
 #include <fcntl.h>
 #include <string.h>
 #include <errno.h>
@@ -29,10 +30,30 @@
 
 #define TAG "SOCKET"
 
+/* 同步等待一帧应答（socket_recv_data）的最长时间 */
+#define SOCKET_SYNC_RECV_TIMEOUT_MS 3000
+
 int g_socket_fd = -1;       // socket文件描述符
 pthread_t g_report_tid;     // 定时上报数据线程的线程id
 static int g_socket_report_thread_started;
 
+/* 非阻塞拼帧状态：4 字节长度头 + JSON 负载，跨多次可读事件累积 */
+typedef struct {
+    unsigned char hdr[sizeof(int)];
+    size_t hdr_got;
+    char *payload;
+    size_t payload_len;
+    size_t payload_got;
+} SocketRxState;
+
+static SocketRxState g_socket_rx;
+
+static void socket_rx_reset(void)
+{
+    free(g_socket_rx.payload);
+    memset(&g_socket_rx, 0, sizeof(g_socket_rx));
+}
+
 void socket_close_connection(void)
 {
     int fd;
@@ -41,7 +62,7 @@ void socket_close_connection(void)
         return;
     }
     fd = g_socket_fd;
-    FD_CLR(fd, &READSET);
+    select_unwatch_fd(fd);
     if (g_socket_report_thread_started) {
         socket_report_stop_thread(fd, g_report_tid);
         g_socket_report_thread_started = 0;
@@ -49,7 +70,7 @@ void socket_close_connection(void)
     shutdown(fd, SHUT_RDWR);
     close(fd);
     g_socket_fd = -1;
-    update_max_fd();
+    socket_rx_reset();
 }
 
 static int socket_connect_with_timeout(int fd, const struct sockaddr_in *server_info, int timeout_ms)
@@ -216,17 +237,31 @@ int socket_init()
             link_clear_list();
         }
 
-        // 把服务器套接字加入到select中
-        FD_SET(g_socket_fd, &READSET);
+        // 读侧改为非阻塞，由事件循环增量拼帧；写侧在 socket_send_data 中处理 EAGAIN
+        {
+            int flags = fcntl(g_socket_fd, F_GETFL, 0);
+            if (flags < 0 || fcntl(g_socket_fd, F_SETFL, flags | O_NONBLOCK) != 0) {
+                LOGE(TAG, "设置非阻塞失败: %s", strerror(errno));
+                close(g_socket_fd);
+                g_socket_fd = -1;
+                return -1;
+            }
+        }
+        socket_rx_reset();
+
+        // 把服务器套接字加入到事件循环中
+        if (select_watch_fd(g_socket_fd) != 0) {
+            close(g_socket_fd);
+            g_socket_fd = -1;
+            return -1;
+        }
 
-        g_max_fd = (g_max_fd > g_socket_fd ? g_max_fd : g_socket_fd);
         // 每隔五秒上报一次次数据 （当前歌曲、模式、音量、状态'暂停播放停止'）
         // 创建一个线程用于上报
         if (socket_report_start_thread(&g_report_tid) != 0) {
-            FD_CLR(g_socket_fd, &READSET);
+            select_unwatch_fd(g_socket_fd);
             close(g_socket_fd);
             g_socket_fd = -1;
-            update_max_fd();
             return -1;
         }
         g_socket_report_thread_started = 1;
@@ -245,49 +280,106 @@ int socket_init()
     return -1;
 }
 
-int socket_recv_data(char *buf)
+int socket_recv_frame_nonblock(char **out_frame)
 {
-    int len;
-    size_t recv_len;
     ssize_t rcv;
+    int len;
 
-    if (buf == NULL || g_socket_fd < 0) {
+    if (out_frame == NULL || g_socket_fd < 0) {
         return -1;
     }
+    *out_frame = NULL;
 
-    recv_len = 0;
-    while (recv_len < sizeof(int)) {
-        rcv = recv(g_socket_fd, buf + recv_len, sizeof(int) - recv_len, 0);
+    while (g_socket_rx.hdr_got < sizeof(g_socket_rx.hdr)) {
+        rcv = recv(g_socket_fd, g_socket_rx.hdr + g_socket_rx.hdr_got,
+                   sizeof(g_socket_rx.hdr) - g_socket_rx.hdr_got, 0);
         if (rcv > 0) {
-            recv_len += (size_t)rcv;
+            g_socket_rx.hdr_got += (size_t)rcv;
+            continue;
+        }
+        if (rcv < 0 && errno == EINTR) {
             continue;
         }
-        if (rcv == 0 || (rcv < 0 && errno != EINTR)) {
+        if (rcv < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 0;
+        }
+        socket_handle_disconnect();
+        return -1;
+    }
+
+    if (g_socket_rx.payload == NULL) {
+        memcpy(&len, g_socket_rx.hdr, sizeof(len));
+        if (len < 0 || len > SOCKET_JSON_BUF_MAX) {
+            LOGE(TAG, "非法报文长度: %d", len);
             socket_handle_disconnect();
             return -1;
         }
+        g_socket_rx.payload = malloc((size_t)len + 1u);
+        if (g_socket_rx.payload == NULL) {
+            LOGE(TAG, "分配接收缓冲失败: %d", len);
+            socket_handle_disconnect();
+            return -1;
+        }
+        g_socket_rx.payload_len = (size_t)len;
+        g_socket_rx.payload_got = 0;
     }
-    len = *(int *)buf;
-    if (len < 0 || len > SOCKET_JSON_BUF_MAX) {
-        LOGE(TAG, "非法报文长度: %d", len);
+
+    while (g_socket_rx.payload_got < g_socket_rx.payload_len) {
+        rcv = recv(g_socket_fd, g_socket_rx.payload + g_socket_rx.payload_got,
+                   g_socket_rx.payload_len - g_socket_rx.payload_got, 0);
+        if (rcv > 0) {
+            g_socket_rx.payload_got += (size_t)rcv;
+            continue;
+        }
+        if (rcv < 0 && errno == EINTR) {
+            continue;
+        }
+        if (rcv < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 0;
+        }
         socket_handle_disconnect();
         return -1;
     }
 
-    memset(buf, 0, sizeof(int));
-    recv_len = 0;
-    while (recv_len < (size_t)len) {
-        rcv = recv(g_socket_fd, buf + recv_len, (size_t)len - recv_len, 0);
-        if (rcv > 0) {
-            recv_len += (size_t)rcv;
+    g_socket_rx.payload[g_socket_rx.payload_len] = '\0';
+    *out_frame = g_socket_rx.payload;
+    g_socket_rx.payload = NULL;
+    memset(&g_socket_rx, 0, sizeof(g_socket_rx));
+    return 1;
+}
+
+int socket_recv_data(char *buf)
+{
+    char *frame = NULL;
+    int ret;
+
+    if (buf == NULL || g_socket_fd < 0) {
+        return -1;
+    }
+
+    for (;;) {
+        struct pollfd pfd;
+        ret = socket_recv_frame_nonblock(&frame);
+        if (ret == 1) {
+            break;
+        }
+        if (ret < 0 || g_socket_fd < 0) {
+            return -1;
+        }
+        pfd.fd = g_socket_fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        ret = poll(&pfd, 1, SOCKET_SYNC_RECV_TIMEOUT_MS);
+        if (ret < 0 && errno == EINTR) {
             continue;
         }
-        if (rcv == 0 || (rcv < 0 && errno != EINTR)) {
-            socket_handle_disconnect();
+        if (ret <= 0) {
+            LOGE(TAG, "等待服务器应答超时");
             return -1;
         }
     }
-    buf[len] = '\0';
+    memcpy(buf, frame, strlen(frame) + 1);
+    free(frame);
     return 0;
 }
 
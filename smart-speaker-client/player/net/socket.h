@@ -11,9 +11,12 @@ extern pthread_t g_report_tid;        // 定时上报数据线程的线程id
 // 初始化网络
 int socket_init();
 
-// 接收服务器发送的数据
+// 接收服务器发送的数据（同步等待一帧，buf 至少 SOCKET_JSON_BUF_MAX + 1 字节）
 int socket_recv_data(char *buf);
 
+// 非阻塞拼帧：返回 1 表示收齐一帧（*out_frame 由调用方 free），0 表示数据未到齐，-1 表示连接已断开
+int socket_recv_frame_nonblock(char **out_frame);
+
 // 从服务器获取歌手singer的音乐
 int socket_get_music(const char *singer);
 
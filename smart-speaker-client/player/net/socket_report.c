@@ -12,13 +12,49 @@
 #include <stdint.h>
 #include <unistd.h>
 #include <json-c/json.h>
+#include <poll.h>
+#include <pthread.h>
 #include "debug_log.h"
 #include "player_constants.h"
 #include <stdlib.h>
 
 #define TAG "SOCKET"
 
+/* 长连 fd 为非阻塞，发送缓冲满时等待可写的最长时间 */
+#define SOCKET_SEND_WAIT_MS 1000
+
 static volatile sig_atomic_t g_report_stop;
+/* 主循环与上报线程都会发帧，整帧发送需串行，避免半帧交错 */
+static pthread_mutex_t g_send_mu = PTHREAD_MUTEX_INITIALIZER;
+
+static int socket_send_all(int fd, const char *buf, size_t total)
+{
+    size_t sent = 0;
+    while (sent < total) {
+        ssize_t n = send(fd, buf + sent, total - sent, MSG_NOSIGNAL);
+        if (n > 0) {
+            sent += (size_t)n;
+            continue;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            struct pollfd pfd;
+            int pr;
+            pfd.fd = fd;
+            pfd.events = POLLOUT;
+            pfd.revents = 0;
+            pr = poll(&pfd, 1, SOCKET_SEND_WAIT_MS);
+            if (pr > 0 || (pr < 0 && errno == EINTR)) {
+                continue;
+            }
+            errno = (pr == 0) ? ETIMEDOUT : errno;
+        }
+        return -1;
+    }
+    return 0;
+}
 
 static void socket_report_add_queue_snapshot_fields(json_object *json, const Shm_Data *data)
 {
@@ -65,12 +101,15 @@ int socket_send_data(json_object *data)
     }
     memcpy(buf, &len, sizeof(len));
     memcpy(buf + sizeof(len), json_str, (size_t)len);
-    if (-1 == send(g_socket_fd, buf, total, MSG_NOSIGNAL)) {
+    pthread_mutex_lock(&g_send_mu);
+    if (socket_send_all(g_socket_fd, buf, total) != 0) {
+        pthread_mutex_unlock(&g_send_mu);
         LOGE(TAG, "发送失败: %s", strerror(errno));
         free(buf);
         json_object_put(data);
         return -1;
     }
+    pthread_mutex_unlock(&g_send_mu);
     free(buf);
     json_object_put(data);
     return 0;
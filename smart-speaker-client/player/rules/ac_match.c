@@ -0,0 +1,212 @@
+#include "ac_match.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+    unsigned char byte;
+    int next;
+} ac_edge_t;
+
+typedef struct {
+    ac_edge_t *edges;           /* 按 byte 升序 */
+    int edge_count;
+    int fail;
+    unsigned int out;           /* 本节点及失败链上所有关键词的组掩码 */
+} ac_node_t;
+
+struct ac_matcher {
+    ac_node_t *nodes;
+    int node_count;
+    int node_capacity;
+    int root_next[256];         /* 根节点直接查表，失配时回到根不必再找 */
+};
+
+static int ac_child(const ac_matcher_t *m, int node, unsigned char c)
+{
+    const ac_node_t *n = &m->nodes[node];
+    int lo = 0;
+    int hi = n->edge_count - 1;
+    if (node == 0) {
+        return m->root_next[c];
+    }
+    while (lo <= hi) {
+        int mid = (lo + hi) / 2;
+        if (n->edges[mid].byte == c) {
+            return n->edges[mid].next;
+        }
+        if (n->edges[mid].byte < c) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return -1;
+}
+
+static int ac_new_node(ac_matcher_t *m)
+{
+    if (m->node_count >= m->node_capacity) {
+        int cap = (m->node_capacity == 0) ? 256 : m->node_capacity * 2;
+        ac_node_t *nn = (ac_node_t *)realloc(m->nodes, sizeof(ac_node_t) * (size_t)cap);
+        if (nn == NULL) {
+            return -1;
+        }
+        m->nodes = nn;
+        m->node_capacity = cap;
+    }
+    memset(&m->nodes[m->node_count], 0, sizeof(ac_node_t));
+    return m->node_count++;
+}
+
+static int ac_add_edge(ac_matcher_t *m, int node, unsigned char c)
+{
+    ac_node_t *n;
+    ac_edge_t *ne;
+    int child;
+    int pos;
+
+    child = ac_new_node(m);
+    if (child < 0) {
+        return -1;
+    }
+    if (node == 0) {
+        m->root_next[c] = child;
+        return child;
+    }
+    n = &m->nodes[node];
+    ne = (ac_edge_t *)realloc(n->edges, sizeof(ac_edge_t) * (size_t)(n->edge_count + 1));
+    if (ne == NULL) {
+        return -1;
+    }
+    n->edges = ne;
+    pos = n->edge_count;
+    while (pos > 0 && ne[pos - 1].byte > c) {
+        ne[pos] = ne[pos - 1];
+        --pos;
+    }
+    ne[pos].byte = c;
+    ne[pos].next = child;
+    n->edge_count++;
+    return child;
+}
+
+/* BFS 求失败指针，并把失败链上的输出合并到节点上 */
+static int ac_link(ac_matcher_t *m)
+{
+    int *queue;
+    int head = 0;
+    int tail = 0;
+    int c;
+
+    queue = (int *)malloc(sizeof(int) * (size_t)m->node_count);
+    if (queue == NULL) {
+        return -1;
+    }
+    for (c = 0; c < 256; ++c) {
+        int child = m->root_next[c];
+        if (child > 0) {
+            m->nodes[child].fail = 0;
+            queue[tail++] = child;
+        }
+    }
+    while (head < tail) {
+        int node = queue[head++];
+        int i;
+        for (i = 0; i < m->nodes[node].edge_count; ++i) {
+            unsigned char b = m->nodes[node].edges[i].byte;
+            int child = m->nodes[node].edges[i].next;
+            int f = m->nodes[node].fail;
+            int target;
+            while (f != 0 && ac_child(m, f, b) < 0) {
+                f = m->nodes[f].fail;
+            }
+            target = ac_child(m, f, b);
+            m->nodes[child].fail = (target > 0 && target != child) ? target : 0;
+            m->nodes[child].out |= m->nodes[m->nodes[child].fail].out;
+            queue[tail++] = child;
+        }
+    }
+    free(queue);
+    return 0;
+}
+
+ac_matcher_t *ac_matcher_build(const ac_pattern_t *patterns, int count)
+{
+    ac_matcher_t *m;
+    int i;
+
+    m = (ac_matcher_t *)calloc(1, sizeof(ac_matcher_t));
+    if (m == NULL) {
+        return NULL;
+    }
+    if (ac_new_node(m) != 0) {
+        ac_matcher_free(m);
+        return NULL;
+    }
+    for (i = 0; i < count; ++i) {
+        const unsigned char *p = (const unsigned char *)patterns[i].pattern;
+        int node = 0;
+        if (p == NULL || p[0] == '\0') {
+            continue;
+        }
+        for (; *p != '\0'; ++p) {
+            int next = ac_child(m, node, *p);
+            if (next <= 0) {
+                next = ac_add_edge(m, node, *p);
+                if (next < 0) {
+                    ac_matcher_free(m);
+                    return NULL;
+                }
+            }
+            node = next;
+        }
+        m->nodes[node].out |= patterns[i].groups;
+    }
+    if (ac_link(m) != 0) {
+        ac_matcher_free(m);
+        return NULL;
+    }
+    return m;
+}
+
+void ac_matcher_free(ac_matcher_t *m)
+{
+    int i;
+    if (m == NULL) {
+        return;
+    }
+    for (i = 0; i < m->node_count; ++i) {
+        free(m->nodes[i].edges);
+    }
+    free(m->nodes);
+    free(m);
+}
+
+unsigned int ac_matcher_scan(const ac_matcher_t *m, const char *text,
+                             unsigned int notify_groups, ac_hit_fn on_hit, void *arg)
+{
+    const unsigned char *p;
+    unsigned int mask = 0;
+    int state = 0;
+
+    if (m == NULL || text == NULL) {
+        return 0;
+    }
+    for (p = (const unsigned char *)text; *p != '\0'; ++p) {
+        int next = 0;
+        while (state != 0 && (next = ac_child(m, state, *p)) < 0) {
+            state = m->nodes[state].fail;
+        }
+        if (state == 0) {
+            next = m->root_next[*p];
+        }
+        state = next;
+        if (m->nodes[state].out != 0) {
+            mask |= m->nodes[state].out;
+            if (on_hit != NULL && (m->nodes[state].out & notify_groups) != 0) {
+                on_hit(m->nodes[state].out & notify_groups, (const char *)p + 1, arg);
+            }
+        }
+    }
+    return mask;
+}
@@ -0,0 +1,24 @@
+#ifndef __AC_MATCH_H__
+#define __AC_MATCH_H__
+
+/* Aho-Corasick 多模式匹配（按字节，UTF-8 关键词直接可用）。
+ * 每个关键词带一个组掩码，扫描一遍即得到文本里出现过的所有组。 */
+
+typedef struct {
+    const char *pattern;
+    unsigned int groups;        /* 该词所属组的位掩码，可属于多个组 */
+} ac_pattern_t;
+
+typedef struct ac_matcher ac_matcher_t;
+
+/* end 指向命中关键词的下一个字节 */
+typedef void (*ac_hit_fn)(unsigned int groups, const char *end, void *arg);
+
+ac_matcher_t *ac_matcher_build(const ac_pattern_t *patterns, int count);
+void ac_matcher_free(ac_matcher_t *m);
+
+/* 返回文本中命中的组掩码；命中 notify_groups 内的组时回调 on_hit（每个结束位置一次） */
+unsigned int ac_matcher_scan(const ac_matcher_t *m, const char *text,
+                             unsigned int notify_groups, ac_hit_fn on_hit, void *arg);
+
+#endif
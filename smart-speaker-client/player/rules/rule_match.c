@@ -2,9 +2,42 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include "ac_match.h"
 #include "select_text.h"
 
-typedef int (*rule_match_fn)(const char *text);
+/* 关键词组：所有组的词编进一个 Aho-Corasick 自动机，一遍扫描得到命中组掩码 */
+enum {
+    RG_STOP           = 1u << 0,
+    RG_PAUSE          = 1u << 1,
+    RG_RESUME         = 1u << 2,
+    RG_NEXT           = 1u << 3,
+    RG_PREV           = 1u << 4,
+    RG_VOL_NOUN       = 1u << 5,
+    RG_VOL_DOWN_VERB  = 1u << 6,
+    RG_VOL_DOWN_ADJ   = 1u << 7,
+    RG_VOL_UP_VERB    = 1u << 8,
+    RG_VOL_UP_ADJ     = 1u << 9,
+    RG_MODE_SINGLE    = 1u << 10,
+    RG_MODE_ORDER     = 1u << 11,
+    RG_OFFLINE        = 1u << 12,
+    RG_ONLINE         = 1u << 13,
+    RG_PLAY_START     = 1u << 14,
+    RG_PLAY_SHOU      = 1u << 15,
+    RG_PLAY_TINGTING  = 1u << 16,
+    RG_PLAY_DENY      = 1u << 17,
+    RG_CONTROL        = 1u << 18,
+    RG_VOL_SET_PFX    = 1u << 19,      /* 「把音量调到」等，紧跟数值 */
+    RG_VOL_SET_FLEX   = 1u << 20       /* 「音量设置」后还需 到/成/为 */
+};
+
+typedef struct {
+    unsigned int hits;          /* 命中组掩码 */
+    const char *vol_suffix;     /* 最靠前的可解析音量数值起点 */
+    int query_state;            /* -1 未提取；0 无点歌词；1 已提取到 query */
+    char query[256];
+} rule_scan_t;
+
+typedef int (*rule_match_fn)(const char *text, rule_scan_t *scan);
 
 typedef struct {
     rule_cmd_t cmd;
@@ -12,29 +45,32 @@ typedef struct {
     rule_match_fn match_fn;
 } rule_def_t;
 
-static int has_any(const char *text, const char *const *keywords)
-{
-    int i = 0;
-    while (keywords[i] != NULL) {
-        if (strstr(text, keywords[i]) != NULL) {
-            return 1;
-        }
-        ++i;
-    }
-    return 0;
-}
-
-static int has_all(const char *text, const char *const *keywords)
-{
-    int i = 0;
-    while (keywords[i] != NULL) {
-        if (strstr(text, keywords[i]) == NULL) {
-            return 0;
-        }
-        ++i;
-    }
-    return 1;
-}
+static const char *const k_stop_kw[] = {"停止播放", "结束", "退出", "关闭", "关掉", "停止", "我不想听了", "别放了", "不要放了", NULL};
+static const char *const k_pause_kw[] = {"暂停", "停一下", "等一下", "先停下", NULL};
+static const char *const k_resume_kw[] = {"继续播放", "继续", "接着播放", NULL};
+static const char *const k_next_kw[] = {"下一首", "换一首", "切歌", "切换歌曲", "下一曲", "下一首歌", NULL};
+static const char *const k_prev_kw[] = {"上一首", "上一曲", "上一首歌", "前一首", NULL};
+static const char *const k_vol_noun_kw[] = {"音量", "声音", NULL};
+static const char *const k_vol_down_verb_kw[] = {"减", "降低", "调低", "放低", NULL};
+static const char *const k_vol_down_adj_kw[] = {
+    "太大", "有点大", "小点", "小一点", "轻一点", "再小点", "再轻点", "调小", "轻点", NULL
+};
+static const char *const k_vol_up_verb_kw[] = {"增大", "增加", "提高", "调高", "放大", NULL};
+static const char *const k_vol_up_adj_kw[] = {
+    "太小", "有点小", "大点", "大一点", "响一点", "再大点", "再响点", "调大", "响点", NULL
+};
+static const char *const k_mode_single_kw[] = {"单曲循环", "循环播放", "单曲循环播放", NULL};
+static const char *const k_mode_order_kw[] = {"顺序播放", "列表顺序", "按顺序播放", NULL};
+static const char *const k_offline_kw[] = {"离线模式", NULL};
+static const char *const k_online_kw[] = {"在线模式", NULL};
+static const char *const k_play_start_kw[] = {"开始播放", "播放音乐", "播放", "开始", "放首歌", "唱首歌", NULL};
+static const char *const k_play_shou_kw[] = {"首", NULL};
+static const char *const k_play_tingting_kw[] = {"听听", NULL};
+static const char *const k_play_deny_kw[] = {"结束", "停止", "暂停", NULL};
+static const char *const k_control_kw[] = {
+    "停止", "暂停", "继续", "下一首", "上一首", "音量", "声音",
+    "单曲循环", "顺序播放", "在线模式", "离线模式", NULL
+};
 
 static int is_trimmed_equal(const char *text, const char *target)
 {
@@ -74,16 +110,21 @@ static void strip_tail_particles(char *s)
         "吧", "呀", "啊", "呢",
         NULL
     };
+    size_t len;
     int changed = 1;
+    trim_ascii_blank(s);
+    len = strlen(s);
     while (changed) {
         int i = 0;
         changed = 0;
         while (suffixes[i] != NULL) {
-            size_t len = strlen(s);
             size_t slen = strlen(suffixes[i]);
-            if (len >= slen && strcmp(s + len - slen, suffixes[i]) == 0) {
-                s[len - slen] = '\0';
-                trim_ascii_blank(s);
+            if (len >= slen && memcmp(s + len - slen, suffixes[i], slen) == 0) {
+                len -= slen;
+                while (len > 0 && (s[len - 1] == ' ' || s[len - 1] == '\t' || s[len - 1] == '\n' || s[len - 1] == '\r')) {
+                    --len;
+                }
+                s[len] = '\0';
                 changed = 1;
                 break;
             }
@@ -92,54 +133,45 @@ static void strip_tail_particles(char *s)
     }
 }
 
-static int match_stop(const char *text)
+static int match_stop(const char *text, rule_scan_t *scan)
 {
-    static const char *const k[] = {"停止播放", "结束", "退出", "关闭", "关掉", "停止", "我不想听了", "别放了", "不要放了", NULL};
-    return has_any(text, k) || is_trimmed_equal(text, "停");
+    return (scan->hits & RG_STOP) != 0 || is_trimmed_equal(text, "停");
 }
 
-static int match_pause(const char *text)
+static int match_pause(const char *text, rule_scan_t *scan)
 {
-    static const char *const k[] = {"暂停", "停一下", "等一下", "先停下", NULL};
-    return has_any(text, k);
+    (void)text;
+    return (scan->hits & RG_PAUSE) != 0;
 }
 
-static int match_resume(const char *text)
+static int match_resume(const char *text, rule_scan_t *scan)
 {
-    static const char *const k[] = {"继续播放", "继续", "接着播放", NULL};
-    return has_any(text, k);
+    (void)text;
+    return (scan->hits & RG_RESUME) != 0;
 }
 
-static int match_next(const char *text)
+static int match_next(const char *text, rule_scan_t *scan)
 {
-    static const char *const k[] = {"下一首", "换一首", "切歌", "切换歌曲", "下一曲", "下一首歌", NULL};
-    return has_any(text, k);
+    (void)text;
+    return (scan->hits & RG_NEXT) != 0;
 }
 
-static int match_prev(const char *text)
+static int match_prev(const char *text, rule_scan_t *scan)
 {
-    static const char *const k[] = {"上一首", "上一曲", "上一首歌", "前一首", NULL};
-    return has_any(text, k);
+    (void)text;
+    return (scan->hits & RG_PREV) != 0;
 }
 
-static int match_vol_down(const char *text)
+static int match_vol_down(const char *text, rule_scan_t *scan)
 {
-    static const char *const k1[] = {"减", "降低", "调低", "放低", NULL};
-    static const char *const k2[] = {"音量", "声音", NULL};
-    static const char *const k3[] = {
-        "太大", "有点大", "小点", "小一点", "轻一点", "再小点", "再轻点", "调小", "轻点", NULL
-    };
-    return (has_any(text, k1) && has_any(text, k2)) || (has_any(text, k2) && has_any(text, k3));
+    (void)text;
+    return (scan->hits & RG_VOL_NOUN) != 0 && (scan->hits & (RG_VOL_DOWN_VERB | RG_VOL_DOWN_ADJ)) != 0;
 }
 
-static int match_vol_up(const char *text)
+static int match_vol_up(const char *text, rule_scan_t *scan)
 {
-    static const char *const k1[] = {"增大", "增加", "提高", "调高", "放大", NULL};
-    static const char *const k2[] = {"音量", "声音", NULL};
-    static const char *const k3[] = {
-        "太小", "有点小", "大点", "大一点", "响一点", "再大点", "再响点", "调大", "响点", NULL
-    };
-    return (has_any(text, k1) && has_any(text, k2)) || (has_any(text, k2) && has_any(text, k3));
+    (void)text;
+    return (scan->hits & RG_VOL_NOUN) != 0 && (scan->hits & (RG_VOL_UP_VERB | RG_VOL_UP_ADJ)) != 0;
 }
 
 static void skip_ws_vol_sep(const char **pp)
@@ -278,138 +310,232 @@ static void copy_strip_ascii_spaces(const char *text, char *out, size_t out_sz)
     out[o] = '\0';
 }
 
-static const char *vol_set_value_start_in(const char *text)
-{
-    static const char *const pfx[] = {
-        "帮我把音量设置到",
-        "帮我把音量调到",
-        "帮我把音量设置成",
-        "帮我把音量调整成",
-        "帮我把音量调整到",
-        "把音量给我设置到",
-        "把音量给我调到",
-        "把音量给我设置成",
-        "把音量给我调整成",
-        "把音量给我调整到",
-        "帮我把声音设置到",
-        "帮我把声音调到",
-        "帮我把声音设置成",
-        "帮我把声音调整成",
-        "帮我把声音调整到",
-        "把音量设置到",
-        "把声音设置到",
-        "把音量设置成",
-        "把声音设置成",
-        "把音量调整到",
-        "把声音调整到",
-        "把音量调整成",
-        "把声音调整成",
-        "把音量调到",
-        "把声音调到",
-        "把音量开到",
-        "把声音开到",
-        "将音量设置到",
-        "将音量调到",
-        "将音量设置成",
-        "将音量调整到",
-        "将音量调整成",
-        "将声音设置到",
-        "将声音调到",
-        "将声音设置成",
-        "将声音调整到",
-        "将声音调整成",
-        "帮我把音量调至",
-        "帮我把声音调至",
-        "把音量调至",
-        "把声音调至",
-        "将音量调至",
-        "将声音调至",
-        "音量调至",
-        "声音调至",
-        "帮我把音量改为",
-        "帮我把声音改为",
-        "把音量改为",
-        "把声音改为",
-        "将音量改为",
-        "将声音改为",
-        "音量改为",
-        "声音改为",
-        "设置音量到",
-        "设置声音到",
-        "设置音量成",
-        "设置声音成",
-        "调节音量到",
-        "调节声音到",
-        "调整音量到",
-        "调整声音到",
-        "调整音量成",
-        "调整声音成",
-        "调音量到",
-        "调声音到",
-        "音量给我调到",
-        "音量给我设置到",
-        "音量给我设置成",
-        "音量给我调整到",
-        "声音给我调到",
-        "声音给我设置到",
-        "声音给我设置成",
-        "声音给我调整到",
-        "声音给我调整成",
-        "音量设置到",
-        "声音设置到",
-        "音量设置成",
-        "声音设置成",
-        "音量调整到",
-        "声音调整到",
-        "音量调整成",
-        "声音调整成",
-        "音量调到",
-        "声音调到",
-        "音量开到",
-        "声音开到",
-        "音量调节到",
-        "声音调节到",
-        "音量设为",
-        "声音设为",
-        "音量设成",
-        "声音设成",
-        "音量调成",
-        "声音调成",
-        NULL
-    };
-    static const char *const flex_kw[] = {
-        "音量设置",
-        "声音设置",
-        "音量调整",
-        "声音调整",
-        NULL
-    };
-    const char *best_suff = NULL;
+static const char *const k_vol_set_prefixes[] = {
+    "帮我把音量设置到",
+    "帮我把音量调到",
+    "帮我把音量设置成",
+    "帮我把音量调整成",
+    "帮我把音量调整到",
+    "把音量给我设置到",
+    "把音量给我调到",
+    "把音量给我设置成",
+    "把音量给我调整成",
+    "把音量给我调整到",
+    "帮我把声音设置到",
+    "帮我把声音调到",
+    "帮我把声音设置成",
+    "帮我把声音调整成",
+    "帮我把声音调整到",
+    "把音量设置到",
+    "把声音设置到",
+    "把音量设置成",
+    "把声音设置成",
+    "把音量调整到",
+    "把声音调整到",
+    "把音量调整成",
+    "把声音调整成",
+    "把音量调到",
+    "把声音调到",
+    "把音量开到",
+    "把声音开到",
+    "将音量设置到",
+    "将音量调到",
+    "将音量设置成",
+    "将音量调整到",
+    "将音量调整成",
+    "将声音设置到",
+    "将声音调到",
+    "将声音设置成",
+    "将声音调整到",
+    "将声音调整成",
+    "帮我把音量调至",
+    "帮我把声音调至",
+    "把音量调至",
+    "把声音调至",
+    "将音量调至",
+    "将声音调至",
+    "音量调至",
+    "声音调至",
+    "帮我把音量改为",
+    "帮我把声音改为",
+    "把音量改为",
+    "把声音改为",
+    "将音量改为",
+    "将声音改为",
+    "音量改为",
+    "声音改为",
+    "设置音量到",
+    "设置声音到",
+    "设置音量成",
+    "设置声音成",
+    "调节音量到",
+    "调节声音到",
+    "调整音量到",
+    "调整声音到",
+    "调整音量成",
+    "调整声音成",
+    "调音量到",
+    "调声音到",
+    "音量给我调到",
+    "音量给我设置到",
+    "音量给我设置成",
+    "音量给我调整到",
+    "声音给我调到",
+    "声音给我设置到",
+    "声音给我设置成",
+    "声音给我调整到",
+    "声音给我调整成",
+    "音量设置到",
+    "声音设置到",
+    "音量设置成",
+    "声音设置成",
+    "音量调整到",
+    "声音调整到",
+    "音量调整成",
+    "声音调整成",
+    "音量调到",
+    "声音调到",
+    "音量开到",
+    "声音开到",
+    "音量调节到",
+    "声音调节到",
+    "音量设为",
+    "声音设为",
+    "音量设成",
+    "声音设成",
+    "音量调成",
+    "声音调成",
+    NULL
+};
+static const char *const k_vol_set_flex_kw[] = {
+    "音量设置",
+    "声音设置",
+    "音量调整",
+    "声音调整",
+    NULL
+};
+
+static const struct {
+    const char *const *keywords;
+    unsigned int group;
+} k_keyword_sets[] = {
+    {k_stop_kw, RG_STOP},
+    {k_pause_kw, RG_PAUSE},
+    {k_resume_kw, RG_RESUME},
+    {k_next_kw, RG_NEXT},
+    {k_prev_kw, RG_PREV},
+    {k_vol_noun_kw, RG_VOL_NOUN},
+    {k_vol_down_verb_kw, RG_VOL_DOWN_VERB},
+    {k_vol_down_adj_kw, RG_VOL_DOWN_ADJ},
+    {k_vol_up_verb_kw, RG_VOL_UP_VERB},
+    {k_vol_up_adj_kw, RG_VOL_UP_ADJ},
+    {k_mode_single_kw, RG_MODE_SINGLE},
+    {k_mode_order_kw, RG_MODE_ORDER},
+    {k_offline_kw, RG_OFFLINE},
+    {k_online_kw, RG_ONLINE},
+    {k_play_start_kw, RG_PLAY_START},
+    {k_play_shou_kw, RG_PLAY_SHOU},
+    {k_play_tingting_kw, RG_PLAY_TINGTING},
+    {k_play_deny_kw, RG_PLAY_DENY},
+    {k_control_kw, RG_CONTROL},
+    {k_vol_set_prefixes, RG_VOL_SET_PFX},
+    {k_vol_set_flex_kw, RG_VOL_SET_FLEX},
+};
+
+static ac_matcher_t *g_rule_ac;
+static int g_rule_ac_tried;
+
+/* 首次匹配时建自动机（仅主线程调用）；失败时退回逐词 strstr */
+static const ac_matcher_t *rule_ac_get(void)
+{
+    ac_pattern_t *patterns;
+    size_t set;
+    int count = 0;
     int i;
-    const char *q;
 
-    for (i = 0; pfx[i] != NULL; ++i) {
-        q = text;
-        while ((q = strstr(q, pfx[i])) != NULL) {
-            vol_set_try_suffix(q + strlen(pfx[i]), &best_suff);
-            ++q;
+    if (g_rule_ac_tried) {
+        return g_rule_ac;
+    }
+    g_rule_ac_tried = 1;
+    for (set = 0; set < sizeof(k_keyword_sets) / sizeof(k_keyword_sets[0]); ++set) {
+        for (i = 0; k_keyword_sets[set].keywords[i] != NULL; ++i) {
+            ++count;
         }
     }
-    for (i = 0; flex_kw[i] != NULL; ++i) {
-        size_t L = strlen(flex_kw[i]);
-        q = text;
-        while ((q = strstr(q, flex_kw[i])) != NULL) {
-            const char *s = after_dao_cheng_wei(q + L);
-            if (s != NULL) {
-                vol_set_try_suffix(s, &best_suff);
+    patterns = (ac_pattern_t *)malloc(sizeof(ac_pattern_t) * (size_t)count);
+    if (patterns == NULL) {
+        return NULL;
+    }
+    count = 0;
+    for (set = 0; set < sizeof(k_keyword_sets) / sizeof(k_keyword_sets[0]); ++set) {
+        for (i = 0; k_keyword_sets[set].keywords[i] != NULL; ++i) {
+            patterns[count].pattern = k_keyword_sets[set].keywords[i];
+            patterns[count].groups = k_keyword_sets[set].group;
+            ++count;
+        }
+    }
+    g_rule_ac = ac_matcher_build(patterns, count);
+    free(patterns);
+    return g_rule_ac;
+}
+
+static void rule_scan_on_vol_hit(unsigned int groups, const char *end, void *arg)
+{
+    const char **best_suff = (const char **)arg;
+    if (groups & RG_VOL_SET_PFX) {
+        vol_set_try_suffix(end, best_suff);
+    }
+    if (groups & RG_VOL_SET_FLEX) {
+        vol_set_try_suffix(after_dao_cheng_wei(end), best_suff);
+    }
+}
+
+/* 逐词 strstr 的等价实现，自动机建不起来时使用 */
+static unsigned int rule_scan_fallback(const char *text, const char **best_suff)
+{
+    unsigned int hits = 0;
+    size_t set;
+    int i;
+
+    for (set = 0; set < sizeof(k_keyword_sets) / sizeof(k_keyword_sets[0]); ++set) {
+        unsigned int group = k_keyword_sets[set].group;
+        for (i = 0; k_keyword_sets[set].keywords[i] != NULL; ++i) {
+            const char *kw = k_keyword_sets[set].keywords[i];
+            const char *q = text;
+            if (!(group & (RG_VOL_SET_PFX | RG_VOL_SET_FLEX))) {
+                if (strstr(text, kw) != NULL) {
+                    hits |= group;
+                    break;
+                }
+                continue;
+            }
+            while ((q = strstr(q, kw)) != NULL) {
+                hits |= group;
+                rule_scan_on_vol_hit(group, q + strlen(kw), best_suff);
+                ++q;
             }
-            ++q;
         }
     }
-    return best_suff;
+    return hits;
 }
 
-static int match_vol_set_percent(const char *text, int *out_pct)
+static unsigned int rule_scan_keywords(const char *text, const char **best_suff)
+{
+    const ac_matcher_t *ac = rule_ac_get();
+    if (ac == NULL) {
+        return rule_scan_fallback(text, best_suff);
+    }
+    return ac_matcher_scan(ac, text, RG_VOL_SET_PFX | RG_VOL_SET_FLEX, rule_scan_on_vol_hit, best_suff);
+}
+
+static void rule_scan_text(const char *text, rule_scan_t *scan)
+{
+    memset(scan, 0, sizeof(*scan));
+    scan->query_state = -1;
+    scan->hits = rule_scan_keywords(text, &scan->vol_suffix);
+}
+
+static int match_vol_set_percent(const char *text, rule_scan_t *scan, int *out_pct)
 {
     char compact[384];
     const char *p;
@@ -418,11 +544,11 @@ static int match_vol_set_percent(const char *text, int *out_pct)
     if (text == NULL || text[0] == '\0') {
         return 0;
     }
-    p = vol_set_value_start_in(text);
-    if (p == NULL) {
+    p = scan->vol_suffix;
+    if (p == NULL && strchr(text, ' ') != NULL) {
         copy_strip_ascii_spaces(text, compact, sizeof(compact));
         if (compact[0] != '\0') {
-            p = vol_set_value_start_in(compact);
+            (void)rule_scan_keywords(compact, &p);
         }
     }
     if (p == NULL) {
@@ -436,31 +562,31 @@ static int match_vol_set_percent(const char *text, int *out_pct)
     return 1;
 }
 
-static int match_mode_single(const char *text)
+static int match_mode_single(const char *text, rule_scan_t *scan)
 {
-    static const char *const k[] = {"单曲循环", "循环播放", "单曲循环播放", NULL};
-    return has_any(text, k);
+    (void)text;
+    return (scan->hits & RG_MODE_SINGLE) != 0;
 }
 
-static int match_mode_order(const char *text)
+static int match_mode_order(const char *text, rule_scan_t *scan)
 {
-    static const char *const k[] = {"顺序播放", "列表顺序", "按顺序播放", NULL};
-    return has_any(text, k);
+    (void)text;
+    return (scan->hits & RG_MODE_ORDER) != 0;
 }
 
-static int match_switch_offline(const char *text)
+static int match_switch_offline(const char *text, rule_scan_t *scan)
 {
-    static const char *const k[] = {"离线模式", NULL};
-    return has_any(text, k);
+    (void)text;
+    return (scan->hits & RG_OFFLINE) != 0;
 }
 
-static int match_switch_online(const char *text)
+static int match_switch_online(const char *text, rule_scan_t *scan)
 {
-    static const char *const k[] = {"在线模式", NULL};
-    return has_any(text, k);
+    (void)text;
+    return (scan->hits & RG_ONLINE) != 0;
 }
 
-static int match_noop_dismiss(const char *text)
+static int match_noop_dismiss(const char *text, rule_scan_t *scan)
 {
     char t[256];
     size_t len;
@@ -469,6 +595,7 @@ static int match_noop_dismiss(const char *text)
         "不要紧", "没关系", "不用了", "没事儿啦", "没事啦", "算了没事", NULL,
     };
     int i = 0;
+    (void)scan;
     if (text == NULL) {
         return 0;
     }
@@ -477,7 +604,6 @@ static int match_noop_dismiss(const char *text)
         return 0;
     }
     memcpy(t, text, len + 1);
-    trim_ascii_blank(t);
     strip_tail_particles(t);
     if (t[0] == '\0') {
         return 0;
@@ -491,24 +617,14 @@ static int match_noop_dismiss(const char *text)
     return 0;
 }
 
-static int match_play_start(const char *text)
+static int match_play_start(const char *text, rule_scan_t *scan)
 {
-    static const char *const k[] = {"开始播放", "播放音乐", "播放", "开始", "放首歌", "唱首歌", NULL};
-    static const char *const must_all[] = {"首", "听听", NULL};
-    static const char *const deny[] = {"结束", "停止", "暂停", NULL};
-    if (has_any(text, deny)) {
+    (void)text;
+    if (scan->hits & RG_PLAY_DENY) {
         return 0;
     }
-    return has_any(text, k) || has_all(text, must_all);
-}
-
-static int has_control_words(const char *text)
-{
-    static const char *const k[] = {
-        "停止", "暂停", "继续", "下一首", "上一首", "音量", "声音",
-        "单曲循环", "顺序播放", "在线模式", "离线模式", NULL
-    };
-    return has_any(text, k);
+    return (scan->hits & RG_PLAY_START) != 0 ||
+           (scan->hits & (RG_PLAY_SHOU | RG_PLAY_TINGTING)) == (RG_PLAY_SHOU | RG_PLAY_TINGTING);
 }
 
 static int is_generic_query(const char *q)
@@ -536,7 +652,6 @@ static int is_start_only_request(const char *text)
         return 0;
     }
     memcpy(t, text, len + 1);
-    trim_ascii_blank(t);
     strip_tail_particles(t);
     return strcmp(t, "播放音乐") == 0 ||
            strcmp(t, "播放") == 0 ||
@@ -546,13 +661,23 @@ static int is_start_only_request(const char *text)
            strcmp(t, "唱首歌") == 0;
 }
 
-static int match_play_query(const char *text)
+/* 歌单与点歌两条规则共用一次点歌词提取 */
+static const char *scan_music_query(const char *text, rule_scan_t *scan)
 {
-    char q[256];
-    if (has_control_words(text)) {
+    if (scan->query_state < 0) {
+        scan->query_state = select_text_extract_music_query_source(text, scan->query, sizeof(scan->query), NULL, 0) ? 1 : 0;
+    }
+    return scan->query_state ? scan->query : NULL;
+}
+
+static int match_play_query(const char *text, rule_scan_t *scan)
+{
+    const char *q;
+    if (scan->hits & RG_CONTROL) {
         return 0;
     }
-    if (!select_text_extract_music_query_source(text, q, sizeof(q), NULL, 0)) {
+    q = scan_music_query(text, scan);
+    if (q == NULL) {
         return 0;
     }
     if (q[0] == '\0' || select_text_is_playlist_query(q)) {
@@ -564,13 +689,14 @@ static int match_play_query(const char *text)
     return 1;
 }
 
-static int match_play_playlist(const char *text)
+static int match_play_playlist(const char *text, rule_scan_t *scan)
 {
-    char q[256];
-    if (has_control_words(text)) {
+    const char *q;
+    if (scan->hits & RG_CONTROL) {
         return 0;
     }
-    if (!select_text_extract_music_query_source(text, q, sizeof(q), NULL, 0)) {
+    q = scan_music_query(text, scan);
+    if (q == NULL) {
         return 0;
     }
     if (q[0] == '\0' || !select_text_is_playlist_query(q)) {
@@ -602,6 +728,7 @@ static const rule_def_t k_rules[] = {
 
 int rule_match_text(const char *text, rule_match_result_t *result)
 {
+    rule_scan_t scan;
     size_t i = 0;
     if (result == NULL) {
         return -1;
@@ -613,9 +740,10 @@ int rule_match_text(const char *text, rule_match_result_t *result)
     if (text == NULL || text[0] == '\0') {
         return 0;
     }
+    rule_scan_text(text, &scan);
     {
         int pct = 0;
-        if (match_vol_set_percent(text, &pct)) {
+        if (match_vol_set_percent(text, &scan, &pct)) {
             result->matched = 1;
             result->cmd = RULE_CMD_VOL_SET;
             result->action_desc = "设置音量";
@@ -624,7 +752,7 @@ int rule_match_text(const char *text, rule_match_result_t *result)
         }
     }
     for (i = 0; i < sizeof(k_rules) / sizeof(k_rules[0]); ++i) {
-        if (k_rules[i].match_fn(text)) {
+        if (k_rules[i].match_fn(text, &scan)) {
             result->matched = 1;
             result->cmd = k_rules[i].cmd;
             result->action_desc = k_rules[i].action_desc;
@@ -11,8 +11,8 @@
 #include <json-c/json.h>
 #include <signal.h>
 #include <time.h>
+#include <sys/epoll.h>
 #include "debug_log.h"
-#include "ipc/ipc_message.h"
 #include "voice-assistant/common/ipc_protocol.h"
 #include "voice-assistant/llm/llm.h"
 #include "rule_match.h"
@@ -20,14 +20,16 @@
 #include "select_text.h"
 #include "select_music_llm.h"
 #include "music_server_async.h"
+#include "music_source_local_index.h"
 #include "player_constants.h"
 
 #define TAG "SELECT"
 
-fd_set READSET;         // 读事件集合
-int g_max_fd;           // 最大文件描述符
+#define SELECT_MAX_EVENTS 16
+#define SELECT_ASR_TEXT_MAX 1024  // 与 asr_kws 的 g_last_asr_text 一致
+
+static int g_epoll_fd = -1;    // 事件循环 epoll 句柄
 
-static uint32_t g_tts_seq = 0;
 static const char *FALLBACK_WAV_PATH = "./assets/tts/fallback_unmatched.wav";
 static const char *MODE_ORDER_WAV_PATH = "./assets/tts/mode_order.wav";
 static const char *MODE_SINGLE_WAV_PATH = "./assets/tts/mode_single.wav";
@@ -120,26 +122,47 @@ void select_on_player_stopped(void)
     player_set_audio_focus(AUDIO_FOCUS_IDLE);
 }
 
-static int ensure_tts_fifo_ready(void)
+// 初始化事件循环
+
+int select_init()
 {
-    if (g_tts_fd != -1) {
+    if (g_epoll_fd >= 0) {
         return 0;
     }
-    init_tts_fifo();
-    if (g_tts_fd == -1) {
+    g_epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (g_epoll_fd < 0) {
+        LOGE(TAG, "epoll_create1失败: %s", strerror(errno));
         return -1;
     }
-    return 0;
+    return select_watch_fd(0);  // 添加标准输入(Test)
 }
 
-// 初始化select
+int select_watch_fd(int fd)
+{
+    struct epoll_event ev;
 
-int select_init()
+    if (fd < 0 || g_epoll_fd < 0) {
+        return -1;
+    }
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(g_epoll_fd, EPOLL_CTL_ADD, fd, &ev) == 0) {
+        return 0;
+    }
+    if (errno == EEXIST && epoll_ctl(g_epoll_fd, EPOLL_CTL_MOD, fd, &ev) == 0) {
+        return 0;
+    }
+    LOGE(TAG, "epoll添加fd=%d失败: %s", fd, strerror(errno));
+    return -1;
+}
+
+void select_unwatch_fd(int fd)
 {
-    FD_ZERO(&READSET);      // 清空集合
-    FD_SET(0, &READSET);    // 添加标准输入到文件描述符(Test)
-    g_max_fd = 0;           // 初始化最大fd为0
-    return 0;    
+    if (fd < 0 || g_epoll_fd < 0) {
+        return;
+    }
+    (void)epoll_ctl(g_epoll_fd, EPOLL_CTL_DEL, fd, NULL);
 }
 
 // 显示操作菜单
@@ -226,84 +249,95 @@ static void select_read_stdio(void)
     }
 }
 
-// 辅助函数：更新g_max_fd为当前READSET中最大的fd
-void update_max_fd() {
-    g_max_fd = 0;
-    // 遍历所有可能的fd（FD_SETSIZE是select支持的最大fd数，通常为1024）
-    for (int fd = 0; fd < FD_SETSIZE; fd++) {
-        if (FD_ISSET(fd, &READSET)) {   // 判断fd是否在READSET中
-            g_max_fd = (fd > g_max_fd) ? fd : g_max_fd;
-        }
+int tts_play_text(const char *text)
+{
+    if (text == NULL || text[0] == '\0') {
+        return -1;
     }
+    if (player_ipc_send_tts(IPC_CMD_PLAY_TEXT, text) != 0)
+    {
+        LOGW(TAG, "发送tts播报失败，跳过: %s", strerror(errno));
+        return -1;
+    }
+    LOGI(TAG, "发送tts播报：%s", text);
+    return 0;
 }
 
-int tts_play_text(const char *text)
+/* 流式播报：begin 打断当前播报并开一个会话，append 追加后续片段，end 表示文本已全部送达 */
+static int tts_send_stream(uint32_t cmd, const char *text)
+{
+    const char *payload = (text != NULL) ? text : "";
+
+    if (player_ipc_send_tts((uint16_t)cmd, payload) != 0) {
+        LOGW(TAG, "发送tts流式播报失败: %s", strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+int tts_stream_text_begin(const char *text)
 {
     if (text == NULL || text[0] == '\0') {
         return -1;
     }
-    if (ensure_tts_fifo_ready() != 0) {
-        LOGW(TAG, "tts管道未打开，跳过播报");
+    if (tts_send_stream(IPC_CMD_STREAM_TEXT_BEGIN, text) != 0) {
         return -1;
     }
-    if (ipc_send_message(g_tts_fd, IPC_CMD_PLAY_TEXT, text, (uint32_t)(strlen(text) + 1), &g_tts_seq) != 0)
-    {
-        LOGE(TAG, "写入tts管道失败: %s", strerror(errno));
+    LOGI(TAG, "流式播报开始：%s", text);
+    return 0;
+}
+
+int tts_stream_text_append(const char *text)
+{
+    if (text == NULL || text[0] == '\0') {
+        return 0;
+    }
+    if (tts_send_stream(IPC_CMD_STREAM_TEXT_APPEND, text) != 0) {
         return -1;
     }
-    LOGI(TAG, "写入tts管道：%s", text);
+    LOGD(TAG, "流式播报追加：%s", text);
     return 0;
 }
 
+int tts_stream_text_end(void)
+{
+    return tts_send_stream(IPC_CMD_STREAM_TEXT_END, NULL);
+}
+
 int tts_play_audio_file(const char *path)
 {
     if (path == NULL || path[0] == '\0') {
         return -1;
     }
-    if (ensure_tts_fifo_ready() != 0) {
-        LOGW(TAG, "tts管道未打开，跳过音频文件播报");
-        return -1;
-    }
-    if (ipc_send_message(g_tts_fd, IPC_CMD_PLAY_AUDIO_FILE, (const uint8_t *)path,
-                         (uint32_t)(strlen(path) + 1), &g_tts_seq) != 0)
+    if (player_ipc_send_tts(IPC_CMD_PLAY_AUDIO_FILE, path) != 0)
     {
-        LOGE(TAG, "写入tts音频文件命令失败: %s", strerror(errno));
+        LOGW(TAG, "发送tts音频文件命令失败: %s", strerror(errno));
         return -1;
     }
-    LOGI(TAG, "写入tts音频文件命令：%s", path);
+    LOGI(TAG, "发送tts音频文件命令：%s", path);
     return 0;
 }
 
-// 处理asr管道事件
-static void select_read_asr(void)
+// ASR 超时无结果：只恢复唤醒前被压下的音乐，不做规则匹配
+static void select_on_asr_timeout(void)
 {
-    char buf[256] = {0};
-    ssize_t ret = read(g_asr_fd, buf, sizeof(buf)-1);
-    if(ret == -1)
-    {
-        LOGE(TAG, "读取asr管道失败: %s", strerror(errno));
-        return;
-    }else if(ret == 0)  // 对端关闭
-    {
-        LOGE(TAG, "asr管道对端关闭");
-        FD_CLR(g_asr_fd, &READSET); // 从监听集合中移除
-        close(g_asr_fd);
-        g_asr_fd = -1;
-        init_asr_fifo();
-        update_max_fd();    // 更新最大fd
-        return;
+    LOGI(TAG, "ASR超时无结果");
+    player_voice_cmd_clear_followup();
+    if (player_audio_focus_should_resume()) {
+        player_audio_focus_prepare_resume();
+        player_continue_play();
     }
-    buf[ret] = '\0';
-    if (buf[ret - 1] == '\n') buf[ret - 1] = '\0';
-    LOGI(TAG, "读取asr管道数据[%s]", buf);
-    if (strcmp(buf, ASR_TIMEOUT_SENTINEL) == 0) {
-        player_voice_cmd_clear_followup();
-        if (player_audio_focus_should_resume()) {
-            player_audio_focus_prepare_resume();
-            player_continue_play();
-        }
+}
+
+// 处理ASR识别文本
+static void select_on_asr_text(const char *text)
+{
+    char buf[SELECT_ASR_TEXT_MAX];
+    snprintf(buf, sizeof(buf), "%s", text);
+    if (buf[0] == '\0') {
         return;
     }
+    LOGI(TAG, "收到asr识别文本[%s]", buf);
 
     rule_match_result_t match_result;
     int resume_after_handle = 0;
@@ -439,53 +473,18 @@ static void select_read_asr(void)
     }
 }
 
-static void select_read_kws(void)
+static void select_on_kws_wake(const char *keyword)
 {
-    char buf[256] = {0};
-    ssize_t ret = read(g_kws_fd, buf, sizeof(buf) - 1);
-    if (ret < 0)
-    {
-        LOGE(TAG, "读取kws管道失败: %s", strerror(errno));
-        return;
-    }
-    if (ret == 0)
-    {
-        LOGW(TAG, "kws管道对端关闭");
-        FD_CLR(g_kws_fd, &READSET);
-        close(g_kws_fd);
-        g_kws_fd = -1;
-        init_kws_fifo();
-        update_max_fd();
-        return;
-    }
-
-    buf[ret] = '\0';
-    if (buf[ret - 1] == '\n') buf[ret - 1] = '\0';
-    LOGI(TAG, "读取kws管道数据[%s]", buf);
+    LOGI(TAG, "收到唤醒事件[%s]", keyword);
+    llm_async_cancel();    // 再次唤醒即打断上一轮还没回完的 LLM 问答
     player_voice_cmd_clear_followup();
     player_voice_cmd_expect_followup();
 }
 
 
-static void select_read_player_ctrl(void)
+static void select_on_tts_event(uint16_t type)
 {
-    char buf[256] = {0};
-    ssize_t ret = read(g_player_ctrl_fd, buf, sizeof(buf) - 1);
-    if (ret < 0)
-    {
-        LOGE(TAG, "读取player控制管道失败: %s", strerror(errno));
-        return;
-    }
-    if (ret == 0)
-    {
-        FD_CLR(g_player_ctrl_fd, &READSET);
-        close(g_player_ctrl_fd);
-        g_player_ctrl_fd = -1;
-        init_player_ctrl_fifo();
-        return;
-    }
-
-    if (strstr(buf, "tts:start") != NULL)
+    if (type == IPC_EVT_TTS_START)
     {
         LOGI(TAG, "收到TTS开始事件");
         if (player_voice_intro_defer_pending()) {
@@ -493,14 +492,16 @@ static void select_read_player_ctrl(void)
         }
         if (player_get_audio_focus() == AUDIO_FOCUS_MUSIC_PLAYING)
         {
-            player_suspend_for_tts();
+            if (player_duck_for_tts() != 0) {
+                player_suspend_for_tts();
+            }
         }
         else if (player_get_audio_focus() == AUDIO_FOCUS_IDLE)
         {
             player_audio_focus_mark_tts_standalone();
         }
     }
-    else if (strstr(buf, "tts:done") != NULL)
+    else if (type == IPC_EVT_TTS_DONE)
     {
         int defer = player_voice_intro_consume_deferred_play();
         LOGI(TAG, "收到TTS结束事件");
@@ -527,51 +528,81 @@ static void select_read_player_ctrl(void)
 }
 
 
+void select_on_bus_message(uint16_t type, const char *body)
+{
+    switch (type) {
+    case IPC_EVT_ASR_TEXT:
+        select_on_asr_text(body);
+        break;
+    case IPC_EVT_ASR_TIMEOUT:
+        select_on_asr_timeout();
+        break;
+    case IPC_EVT_KWS_WAKE:
+        select_on_kws_wake(body);
+        break;
+    case IPC_EVT_TTS_START:
+    case IPC_EVT_TTS_DONE:
+        select_on_tts_event(type);
+        break;
+    default:
+        LOGW(TAG, "收到未知总线消息: type=%u", type);
+        break;
+    }
+}
+
+// 分发单个就绪fd
+static void select_dispatch_fd(int fd)
+{
+    if (fd == 0) {
+        select_read_stdio();
+    } else if (g_socket_fd >= 0 && fd == g_socket_fd) {
+        select_read_socket();
+    } else if (g_button_fd >= 0 && fd == g_button_fd) {
+        device_read_button();
+    } else if (device_button_timer_fd() >= 0 && fd == device_button_timer_fd()) {
+        device_on_button_timer();
+    } else if (device_mixer_owns_fd(fd)) {
+        device_mixer_on_readable();
+    } else if (player_ipc_owns_fd(fd)) {
+        player_ipc_on_readable(fd);
+    } else if (music_server_async_fd() >= 0 && fd == music_server_async_fd()) {
+        music_server_async_on_readable();
+    } else if (llm_async_fd() >= 0 && fd == llm_async_fd()) {
+        llm_async_on_readable();
+    } else if (local_index_watch_fd() >= 0 && fd == local_index_watch_fd()) {
+        local_index_on_readable();
+    } else {
+        /* 已关闭但本轮仍在就绪列表里的旧fd */
+        select_unwatch_fd(fd);
+    }
+}
+
 // 运行事件监听
 void select_run(void)
 {
-    fd_set TMPSET;  // 临时文件描述符集合
+    struct epoll_event events[SELECT_MAX_EVENTS];
     show_menu();    // 显示菜单
     
-    LOGI(TAG, "select 监听开始：g_max_fd=%d, g_asr_fd=%d", g_max_fd, g_asr_fd);
+    LOGI(TAG, "epoll 监听开始：epoll_fd=%d", g_epoll_fd);
     
     while (!g_player_shutdown_requested)
     {
         player_process_async_events();
-        TMPSET = READSET;   // 将全局变量赋给临时变量， 防止因为被监听到导致的取消监听
-        int ret = select(g_max_fd+1, &TMPSET, NULL, NULL, NULL);
+        int ret = epoll_wait(g_epoll_fd, events, SELECT_MAX_EVENTS, -1);
         if(-1 == ret)
         {
-            // 排除信号对select的干扰
+            // 排除信号对epoll_wait的干扰
             if(EINTR == errno) {
                 player_process_async_events();
                 continue;
             }
-            LOGE(TAG, "select错误: %s", strerror(errno));
+            LOGE(TAG, "epoll_wait错误: %s", strerror(errno));
             return;
         }
         player_process_async_events();
 
-        if(FD_ISSET(0, &TMPSET)){
-            select_read_stdio();
-        }
-        if(g_socket_fd >= 0 && FD_ISSET(g_socket_fd, &TMPSET)){
-            select_read_socket();
-        }
-        if(g_button_fd >= 0 && FD_ISSET(g_button_fd, &TMPSET)){
-            device_read_button();
-        }
-        if(g_asr_fd >= 0 && FD_ISSET(g_asr_fd, &TMPSET)){
-            select_read_asr();
-        }
-        if(g_kws_fd >= 0 && FD_ISSET(g_kws_fd, &TMPSET)){
-            select_read_kws();
-        }
-        if(g_player_ctrl_fd >= 0 && FD_ISSET(g_player_ctrl_fd, &TMPSET)){
-            select_read_player_ctrl();
-        }
-        if (music_server_async_fd() >= 0 && FD_ISSET(music_server_async_fd(), &TMPSET)) {
-            music_server_async_on_readable();
+        for (int i = 0; i < ret; i++) {
+            select_dispatch_fd(events[i].data.fd);
         }
     }
 }
@@ -614,18 +645,9 @@ static void Parse_server_cmd(char *buf, char *cmd)
 
 
 
-// 处理服务器发送的信息
-void select_read_socket(void)
+// 处理一帧服务器发送的信息
+static void select_handle_server_frame(char *buf)
 {
-    char *buf = malloc((size_t)SOCKET_JSON_BUF_MAX + 1u);
-    if (buf == NULL) {
-        return;
-    }
-    memset(buf, 0, (size_t)SOCKET_JSON_BUF_MAX + 1u);
-    if (socket_recv_data(buf) != 0) {
-        free(buf);
-        return;
-    }
     // 解析服务器命令
     char cmd[128] = {0};
     Parse_server_cmd(buf, cmd);
@@ -707,7 +729,16 @@ void select_read_socket(void)
     } else if (strcmp(cmd, "app_playlist_prev_page") == 0) {
         socket_playlist_page_prev();
     }
-    free(buf);
 }
 
+// 处理服务器发送的信息：非阻塞地拼帧，半包留到下次可读再继续，不阻塞语音/按键
+void select_read_socket(void)
+{
+    char *frame = NULL;
 
+    while (g_socket_fd >= 0 && socket_recv_frame_nonblock(&frame) == 1) {
+        select_handle_server_frame(frame);
+        free(frame);
+        frame = NULL;
+    }
+}
@@ -1,24 +1,31 @@
 #ifndef __SELECT_H__
 #define __SELECT_H__ 
 
-#include <sys/select.h>
+#include <stdint.h>
 
-extern fd_set READSET;  // fd的集合
-extern int g_max_fd;    // 最大文件描述符
-
-// 初始化select
+// 初始化事件循环（epoll）
 int select_init();
 
-// 更新最大文件描述符
-void update_max_fd();
+// 把fd加入事件循环监听（可读事件，水平触发）；重复添加视为成功
+int select_watch_fd(int fd);
+
+// 把fd移出事件循环监听，须在close之前调用
+void select_unwatch_fd(int fd);
 
-// 运行select循环监听
+// 运行事件循环监听
 void select_run();
 
 void select_on_player_stopped(void);
 
+// 处理一条总线事件（ASR 文本 / 超时、唤醒、TTS 开始 / 结束），body 以 '\0' 结尾
+void select_on_bus_message(uint16_t type, const char *body);
+
 
-/* 返回 0 表示已成功写入 TTS 管道（将收到 tts:start / tts:done） */
+/* 返回 0 表示命令已发给 TTS（将收到 tts:start / tts:done 事件） */
 int tts_play_text(const char *text);
 int tts_play_audio_file(const char *path);
+/* 流式播报：begin 成功后同样收到 tts:start / tts:done，done 在 end 之后的内容播完时才发 */
+int tts_stream_text_begin(const char *text);
+int tts_stream_text_append(const char *text);
+int tts_stream_text_end(void);
 #endif
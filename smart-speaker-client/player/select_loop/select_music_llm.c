@@ -1,6 +1,11 @@
 #include "select_music_llm.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
+#include <unistd.h>
 #include "select_text.h"
 #include "player.h"
 #include "select.h"
@@ -185,18 +190,341 @@ int try_music_lib_play(const char *text)
     return 1;
 }
 
+/* LLM 流式回复按标点切段送 TTS：首段一到标点就发出，尽早出声；
+ * 之后每收到增量都把最后一个标点之前的内容发出，没有标点的部分留到下次或结束时发 */
+#define LLM_TTS_PENDING_MAX 1024
+
+typedef struct {
+    char pending[LLM_TTS_PENDING_MAX];
+    size_t len;
+    int started;    // 已发 STREAM_TEXT_BEGIN
+    int failed;     // TTS 管道写失败，中止 LLM 请求
+} LlmTtsStream;
+
+// 返回最后一个断句标点之后的偏移，没有标点返回 0
+static size_t llm_tts_split_point(const char *s, size_t len)
+{
+    static const char *const puncts[] = { "，", "。", "！", "？", "；", "：", ",", ".", "!", "?", ";" };
+    size_t cut = 0;
+    size_t i;
+    size_t k;
+
+    for (i = 0; i < len; i++) {
+        for (k = 0; k < sizeof(puncts) / sizeof(puncts[0]); k++) {
+            size_t plen = strlen(puncts[k]);
+            if (i + plen <= len && memcmp(s + i, puncts[k], plen) == 0) {
+                cut = i + plen;
+                break;
+            }
+        }
+    }
+    return cut;
+}
+
+static void llm_tts_send(LlmTtsStream *st, size_t n)
+{
+    char piece[LLM_TTS_PENDING_MAX];
+
+    if (st->failed) {
+        st->len = 0;    // 已中止，后续增量都不再累积
+        return;
+    }
+    if (n == 0) {
+        return;
+    }
+    memcpy(piece, st->pending, n);
+    piece[n] = '\0';
+    memmove(st->pending, st->pending + n, st->len - n);
+    st->len -= n;
+    select_text_trim(piece);
+    if (piece[0] == '\0') {
+        return;
+    }
+    if (!st->started) {
+        if (tts_stream_text_begin(piece) != 0) {
+            st->failed = 1;
+            st->len = 0;
+            return;
+        }
+        st->started = 1;
+    } else if (tts_stream_text_append(piece) != 0) {
+        st->failed = 1;
+        st->len = 0;
+    }
+}
+
+static int llm_tts_on_delta(const char *delta, void *arg)
+{
+    LlmTtsStream *st = (LlmTtsStream *)arg;
+    const char *p;
+
+    for (p = delta; *p != '\0'; p++) {
+        if (st->failed) {
+            return 1;
+        }
+        if (st->len + 1 >= sizeof(st->pending)) {
+            // 一直没有标点：在 UTF-8 字符边界处强制切一段
+            size_t n = st->len - 1;
+            while (n > 0 && ((unsigned char)st->pending[n] & 0xC0) == 0x80) {
+                n--;
+            }
+            llm_tts_send(st, n > 0 ? n : st->len);
+        }
+        st->pending[st->len++] = (*p == '\n' || *p == '\r' || *p == '\t') ? ' ' : *p;
+    }
+    llm_tts_send(st, llm_tts_split_point(st->pending, st->len));
+    return st->failed ? 1 : 0;
+}
+
+/* LLM 请求放在常驻工作线程里跑，SSE 最长要等 LLM 超时，不能卡住事件循环（唤醒、TTS 事件、按键都在这里）。
+ * 工作线程只把增量原样追加到 g_llm_rx 并写管道通知；切段、发 TTS、兜底音频都在事件循环线程里做。
+ * 每个请求带 token，新请求或唤醒打断后旧请求的增量直接丢弃，工作线程在下一次增量回调时中止 SSE */
+#define LLM_RX_MAX 4096
+
+static int g_llm_pipe[2] = {-1, -1};
+static pthread_mutex_t g_llm_mu = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_llm_cv = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t g_llm_drain_cv = PTHREAD_COND_INITIALIZER;  // 事件循环取走 g_llm_rx 或取消请求
+static uint32_t g_llm_token;        // 最新请求，取消时也递增
+static int g_llm_has_job;
+static char g_llm_question[256];
+static char g_llm_rx[LLM_RX_MAX];   // 属于 g_llm_token 的、事件循环尚未取走的增量
+static size_t g_llm_rx_len;
+static int g_llm_done;
+static int g_llm_ret;
+
+// 以下只在事件循环线程访问
+static LlmTtsStream g_llm_tts;
+static int g_llm_active;
+
+static void llm_notify_write(void)
+{
+    char b = 1;
+    ssize_t w;
+    do {
+        w = write(g_llm_pipe[1], &b, 1);
+    } while (w < 0 && errno == EINTR);
+}
+
+/* 缓冲区满时工作线程停下不再读 SSE，等事件循环取走再继续，文本一个字都不丢；
+ * 请求被取代或取消时立刻返回 1 中止 */
+static int llm_worker_on_delta(const char *delta, void *arg)
+{
+    uint32_t token = *(const uint32_t *)arg;
+    size_t left = strlen(delta);
+
+    pthread_mutex_lock(&g_llm_mu);
+    while (left > 0) {
+        size_t room;
+        size_t n = left;
+
+        if (token != g_llm_token) {
+            pthread_mutex_unlock(&g_llm_mu);
+            return 1;
+        }
+        room = sizeof(g_llm_rx) - 1 - g_llm_rx_len;
+        if (n > room) {
+            // 放不下的部分在 UTF-8 字符边界处留到下一轮
+            n = room;
+            while (n > 0 && ((unsigned char)delta[n] & 0xC0) == 0x80) {
+                n--;
+            }
+        }
+        if (n == 0) {
+            pthread_cond_wait(&g_llm_drain_cv, &g_llm_mu);
+            continue;
+        }
+        memcpy(g_llm_rx + g_llm_rx_len, delta, n);
+        g_llm_rx_len += n;
+        g_llm_rx[g_llm_rx_len] = '\0';
+        delta += n;
+        left -= n;
+        pthread_mutex_unlock(&g_llm_mu);
+        llm_notify_write();
+        pthread_mutex_lock(&g_llm_mu);
+    }
+    pthread_mutex_unlock(&g_llm_mu);
+    return 0;
+}
+
+static void *llm_worker_thread(void *arg)
+{
+    char question[256];
+    char response[4096];
+    uint32_t token;
+    int ret;
+
+    (void)arg;
+    for (;;) {
+        pthread_mutex_lock(&g_llm_mu);
+        while (!g_llm_has_job) {
+            pthread_cond_wait(&g_llm_cv, &g_llm_mu);
+        }
+        g_llm_has_job = 0;
+        token = g_llm_token;
+        snprintf(question, sizeof(question), "%s", g_llm_question);
+        pthread_mutex_unlock(&g_llm_mu);
+
+        response[0] = '\0';
+        ret = query_llm_stream(question, llm_worker_on_delta, &token, response, sizeof(response));
+
+        pthread_mutex_lock(&g_llm_mu);
+        if (token == g_llm_token) {
+            g_llm_done = 1;
+            g_llm_ret = ret;
+        }
+        pthread_mutex_unlock(&g_llm_mu);
+        llm_notify_write();
+    }
+    return NULL;
+}
+
+int llm_async_init(void)
+{
+    int fl;
+    int r;
+    pthread_t th;
+    pthread_attr_t attr;
+
+    if (g_llm_pipe[0] >= 0) {
+        return 0;
+    }
+    if (pipe(g_llm_pipe) != 0) {
+        LOGE(TAG, "pipe: %s", strerror(errno));
+        return -1;
+    }
+    // 写端也设非阻塞：管道满说明已有未处理的通知，丢掉这一字节无妨
+    fl = fcntl(g_llm_pipe[0], F_GETFL, 0);
+    if (fl < 0 || fcntl(g_llm_pipe[0], F_SETFL, fl | O_NONBLOCK) != 0 ||
+        (fl = fcntl(g_llm_pipe[1], F_GETFL, 0)) < 0 || fcntl(g_llm_pipe[1], F_SETFL, fl | O_NONBLOCK) != 0) {
+        close(g_llm_pipe[0]);
+        close(g_llm_pipe[1]);
+        g_llm_pipe[0] = g_llm_pipe[1] = -1;
+        return -1;
+    }
+
+    pthread_attr_init(&attr);
+    pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+    r = pthread_create(&th, &attr, llm_worker_thread, NULL);
+    pthread_attr_destroy(&attr);
+    if (r != 0) {
+        LOGE(TAG, "pthread_create: %s", strerror(r));
+        close(g_llm_pipe[0]);
+        close(g_llm_pipe[1]);
+        g_llm_pipe[0] = g_llm_pipe[1] = -1;
+        return -1;
+    }
+
+    select_watch_fd(g_llm_pipe[0]);
+    return 0;
+}
+
+int llm_async_fd(void)
+{
+    return g_llm_pipe[0];
+}
+
+void llm_async_cancel(void)
+{
+    if (!g_llm_active) {
+        return;
+    }
+    pthread_mutex_lock(&g_llm_mu);
+    g_llm_token++;
+    g_llm_has_job = 0;
+    g_llm_rx_len = 0;
+    g_llm_rx[0] = '\0';
+    g_llm_done = 0;
+    pthread_cond_broadcast(&g_llm_drain_cv);
+    pthread_mutex_unlock(&g_llm_mu);
+    g_llm_active = 0;
+    LOGI(TAG, "取消进行中的 LLM 请求");
+}
+
+static void llm_play_fallback(void)
+{
+    player_voice_cmd_clear_followup();
+    player_audio_focus_cancel_resume();
+    tts_play_audio_file(FALLBACK_UNMATCHED_WAV);
+}
+
+void llm_async_on_readable(void)
+{
+    char drain[64];
+    char text[LLM_RX_MAX];
+    ssize_t n;
+    int done;
+    int ret;
+
+    while ((n = read(g_llm_pipe[0], drain, sizeof(drain))) > 0) {
+    }
+    if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) {
+        return;
+    }
+
+    pthread_mutex_lock(&g_llm_mu);
+    memcpy(text, g_llm_rx, g_llm_rx_len + 1);
+    g_llm_rx_len = 0;
+    g_llm_rx[0] = '\0';
+    done = g_llm_done;
+    ret = g_llm_ret;
+    g_llm_done = 0;
+    pthread_cond_broadcast(&g_llm_drain_cv);
+    pthread_mutex_unlock(&g_llm_mu);
+
+    if (!g_llm_active) {
+        return;
+    }
+    if (text[0] != '\0' && llm_tts_on_delta(text, &g_llm_tts) != 0) {
+        // TTS 管道写失败：让工作线程中止 SSE，已播出的部分就此结束
+        llm_async_cancel();
+        if (g_llm_tts.started) {
+            tts_stream_text_end();
+        } else {
+            llm_play_fallback();
+        }
+        return;
+    }
+    if (!done) {
+        return;
+    }
+    g_llm_active = 0;
+    // 失败但已开始播报时，把已收到的部分念完，不再播兜底音频
+    if (ret != 0 && !g_llm_tts.started) {
+        llm_play_fallback();
+        return;
+    }
+    llm_tts_send(&g_llm_tts, g_llm_tts.len);
+    if (!g_llm_tts.started) {
+        llm_play_fallback();
+        return;
+    }
+    tts_stream_text_end();
+}
+
 int run_llm_and_tts(const char *raw_text)
 {
     char question[256] = {0};
-    char response[4096] = {0};
+
     if (raw_text == NULL || raw_text[0] == '\0') return -1;
+    if (g_llm_pipe[0] < 0) return -1;
     snprintf(question, sizeof(question), "%s", raw_text);
     select_text_trim(question);
     if (question[0] == '\0') return -1;
     player_voice_cmd_clear_followup();
-    if (query_llm(question, response, sizeof(response)) != 0 || response[0] == '\0') {
-        return -1;
-    }
-    tts_play_text(response);
+
+    pthread_mutex_lock(&g_llm_mu);
+    g_llm_token++;
+    snprintf(g_llm_question, sizeof(g_llm_question), "%s", question);
+    g_llm_has_job = 1;
+    g_llm_rx_len = 0;
+    g_llm_rx[0] = '\0';
+    g_llm_done = 0;
+    pthread_cond_signal(&g_llm_cv);
+    pthread_cond_broadcast(&g_llm_drain_cv);
+    pthread_mutex_unlock(&g_llm_mu);
+
+    memset(&g_llm_tts, 0, sizeof(g_llm_tts));
+    g_llm_active = 1;
     return 0;
 }
@@ -3,6 +3,13 @@
 
 int try_music_lib_play(const char *text);
 int try_music_lib_play_playlist(const char *text);
+/* LLM 问答：请求交给工作线程，立即返回；0 表示已提交，回复在事件循环里边收边播，
+ * 失败时由 llm_async_on_readable 播兜底音频。-1 表示问题为空或工作线程不可用 */
 int run_llm_and_tts(const char *raw_text);
+int llm_async_init(void);
+int llm_async_fd(void);
+void llm_async_on_readable(void);
+// 丢弃进行中的请求（唤醒打断等），工作线程在下一次增量时中止
+void llm_async_cancel(void);
 
 #endif
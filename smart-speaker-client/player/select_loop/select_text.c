@@ -292,16 +292,22 @@ static void strip_trailing_particles(char *s)
         "的歌", "歌曲", "这首歌", "这首", "歌", "吧", "呀", "啊", "呢",
         "。", "！", "？", "，", ".", "!", "?", ",", ";", "；", NULL
     };
+    size_t len;
     int changed = 1;
+    trim_text(s);
+    len = strlen(s);
+    /* 只剥尾部：按长度截断，不再每轮整串 trim/memmove */
     while (changed) {
         int i = 0;
         changed = 0;
         while (suffixes[i] != NULL) {
-            size_t len = strlen(s);
             size_t slen = strlen(suffixes[i]);
-            if (len >= slen && strcmp(s + len - slen, suffixes[i]) == 0) {
-                s[len - slen] = '\0';
-                trim_text(s);
+            if (len >= slen && memcmp(s + len - slen, suffixes[i], slen) == 0) {
+                len -= slen;
+                while (len > 0 && is_ascii_blank_char(s[len - 1])) {
+                    --len;
+                }
+                s[len] = '\0';
                 changed = 1;
                 break;
             }
@@ -324,21 +330,29 @@ static void strip_leading_particles(char *s)
     const char *prefixes[] = {
         "的", "吧", "呀", "啊", "呢", "请", NULL
     };
+    size_t start = 0;
     int changed = 1;
+    /* 先累计要跳过的前缀长度，最后只搬移一次 */
     while (changed) {
         int i = 0;
         changed = 0;
+        while (is_ascii_blank_char(s[start])) {
+            ++start;
+        }
         while (prefixes[i] != NULL) {
             size_t len = strlen(prefixes[i]);
-            if (strncmp(s, prefixes[i], len) == 0) {
-                memmove(s, s + len, strlen(s + len) + 1);
-                trim_text(s);
+            if (strncmp(s + start, prefixes[i], len) == 0) {
+                start += len;
                 changed = 1;
                 break;
             }
             ++i;
         }
     }
+    if (start > 0) {
+        memmove(s, s + start, strlen(s + start) + 1);
+    }
+    trim_text(s);
 }
 
 int select_text_has_control_intent(const char *text)
@@ -34,7 +34,9 @@ static int spawn_child(ChildProc *c) {
 }
 
 int main(void) {
+    // 混音进程排在最前，tts / player 启动时它多半已在线；不在线时两者各自直连 ALSA
     ChildProc children[] = {
+        {"audio_mixer", "./audio_mixer_process", -1},
         {"asr_kws", "./asr_kws_process", -1},
         {"tts", "./tts_process", -1},
         {"player", "./player/run", -1},
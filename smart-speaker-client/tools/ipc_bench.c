@@ -0,0 +1,172 @@
+/* 进程间单跳往返延迟：SOCK_SEQPACKET 总线（ipc_bus）对比原先的 FIFO + ipc_message 帧。
+ * 子进程做回显，父进程发一条、等一条，统计 p50 / p99 / max（微秒）。
+ * 用法：ipc_bench [次数] [body 字节数] */
+#include <errno.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+
+#include "../ipc/ipc_bus.h"
+#include "../ipc/ipc_message.h"
+
+#define BENCH_BUS_NAME "ipc_bench"
+
+static double now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e6 + ts.tv_nsec / 1e3;
+}
+
+static int cmp_double(const void *a, const void *b) {
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+static void report(const char *name, double *lat, int n) {
+    qsort(lat, (size_t)n, sizeof(double), cmp_double);
+    printf("%-10s n=%d p50=%.1fus p99=%.1fus max=%.1fus\n",
+           name, n, lat[n / 2], lat[(int)(n * 0.99)], lat[n - 1]);
+}
+
+static void on_echo(int fd, const IPCHeader *header, const uint8_t *body, void *arg) {
+    (void)arg;
+    ipc_bus_reply(fd, header, header->type, body, header->body_len);
+}
+
+static int bench_bus(int rounds, const char *payload, uint32_t len, double *lat) {
+    IPCBusServer server;
+    IPCBusLink link;
+    pid_t pid;
+    int i;
+
+    if (ipc_bus_server_open(&server, BENCH_BUS_NAME) != 0) {
+        fprintf(stderr, "bus open failed: %s\n", strerror(errno));
+        return -1;
+    }
+    pid = fork();
+    if (pid == 0) {
+        for (;;) {
+            ipc_bus_server_poll(&server, -1, on_echo, NULL);
+        }
+    }
+    ipc_bus_server_close(&server);
+    ipc_bus_link_init(&link, BENCH_BUS_NAME);
+
+    for (i = 0; i < rounds; i++) {
+        struct pollfd pfd;
+        IPCHeader header;
+        uint8_t buf[IPC_MAX_BODY + 1];
+        uint32_t seq;
+        double t0 = now_us();
+
+        if (ipc_bus_link_send(&link, 1, payload, len, &seq) != 0) {
+            fprintf(stderr, "bus send failed: %s\n", strerror(errno));
+            break;
+        }
+        pfd.fd = link.fd;
+        pfd.events = POLLIN;
+        if (poll(&pfd, 1, 1000) <= 0 || ipc_bus_recv(link.fd, &header, buf, sizeof(buf)) != 0 ||
+            header.seq != seq) {
+            fprintf(stderr, "bus reply lost at %d\n", i);
+            break;
+        }
+        lat[i] = now_us() - t0;
+    }
+    ipc_bus_link_close(&link);
+    kill(pid, SIGKILL);
+    waitpid(pid, NULL, 0);
+    return i;
+}
+
+// 旧方案：两条 FIFO，发送方按 ipc_message 帧写，接收方 poll 后按帧读
+static int bench_fifo(int rounds, const char *payload, uint32_t len, double *lat) {
+    char req_path[64], rsp_path[64];
+    int req_fd, rsp_fd;
+    pid_t pid;
+    int i;
+
+    snprintf(req_path, sizeof(req_path), "/tmp/ipc_bench_req_%d", (int)getpid());
+    snprintf(rsp_path, sizeof(rsp_path), "/tmp/ipc_bench_rsp_%d", (int)getpid());
+    if (mkfifo(req_path, 0600) != 0 || mkfifo(rsp_path, 0600) != 0) {
+        fprintf(stderr, "mkfifo failed: %s\n", strerror(errno));
+        unlink(req_path);
+        return -1;
+    }
+    pid = fork();
+    if (pid == 0) {
+        int in = open(req_path, O_RDONLY);
+        int out = open(rsp_path, O_WRONLY);
+        for (;;) {
+            IPCHeader header;
+            uint8_t *body = NULL;
+            struct pollfd pfd = { .fd = in, .events = POLLIN };
+            uint32_t seq = 0;
+            if (poll(&pfd, 1, -1) <= 0 || ipc_recv_message(in, &header, &body) != 0) {
+                _exit(0);
+            }
+            ipc_send_message(out, header.type, body, header.body_len, &seq);
+            free(body);
+        }
+    }
+    req_fd = open(req_path, O_WRONLY);
+    rsp_fd = open(rsp_path, O_RDONLY);
+
+    for (i = 0; i < rounds; i++) {
+        IPCHeader header;
+        uint8_t *body = NULL;
+        struct pollfd pfd = { .fd = rsp_fd, .events = POLLIN };
+        uint32_t seq = 0;
+        double t0 = now_us();
+
+        if (ipc_send_message(req_fd, 1, payload, len, &seq) != 0 ||
+            poll(&pfd, 1, 1000) <= 0 || ipc_recv_message(rsp_fd, &header, &body) != 0) {
+            fprintf(stderr, "fifo round trip failed at %d\n", i);
+            break;
+        }
+        free(body);
+        lat[i] = now_us() - t0;
+    }
+    close(req_fd);
+    close(rsp_fd);
+    waitpid(pid, NULL, 0);
+    unlink(req_path);
+    unlink(rsp_path);
+    return i;
+}
+
+int main(int argc, char **argv) {
+    int rounds = (argc > 1) ? atoi(argv[1]) : 10000;
+    int size = (argc > 2) ? atoi(argv[2]) : 64;
+    char *payload;
+    double *lat;
+    int n;
+
+    if (rounds <= 0 || size <= 0 || size > IPC_MAX_BODY) {
+        fprintf(stderr, "usage: %s [rounds] [body_bytes<=%d]\n", argv[0], IPC_MAX_BODY);
+        return 1;
+    }
+    payload = malloc((size_t)size);
+    lat = malloc(sizeof(double) * (size_t)rounds);
+    if (payload == NULL || lat == NULL) {
+        return 1;
+    }
+    memset(payload, 'a', (size_t)size - 1);
+    payload[size - 1] = '\0';
+
+    n = bench_bus(rounds, payload, (uint32_t)size, lat);
+    if (n > 0) report("seqpacket", lat, n);
+    n = bench_fifo(rounds, payload, (uint32_t)size, lat);
+    if (n > 0) report("fifo", lat, n);
+
+    free(payload);
+    free(lat);
+    return 0;
+}
@@ -1,12 +1,12 @@
 #include <errno.h>
-#include <fcntl.h>
+#include <poll.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 
-#include "../ipc/ipc_message.h"
+#include "../ipc/ipc_bus.h"
 #include "../voice-assistant/common/ipc_protocol.h"
 
 static uint16_t parse_type(const char *s) {
@@ -14,12 +14,27 @@ static uint16_t parse_type(const char *s) {
     if (strcmp(s, "file") == 0) return IPC_CMD_PLAY_AUDIO_FILE;
     if (strcmp(s, "stop") == 0) return IPC_CMD_STOP_PLAYING;
     if (strcmp(s, "wake") == 0) return IPC_CMD_PLAY_WAKE_RESPONSE;
+    if (strcmp(s, "stream") == 0) return IPC_CMD_STREAM_TEXT_BEGIN;
+    if (strcmp(s, "append") == 0) return IPC_CMD_STREAM_TEXT_APPEND;
+    if (strcmp(s, "end") == 0) return IPC_CMD_STREAM_TEXT_END;
+    if (strcmp(s, "offline") == 0) return IPC_CMD_SWITCH_OFFLINE;
+    if (strcmp(s, "online") == 0) return IPC_CMD_SWITCH_ONLINE;
+    if (strcmp(s, "asr") == 0) return IPC_EVT_ASR_TEXT;
+    if (strcmp(s, "asr_timeout") == 0) return IPC_EVT_ASR_TIMEOUT;
+    if (strcmp(s, "kws") == 0) return IPC_EVT_KWS_WAKE;
+    if (strcmp(s, "tts_start") == 0) return IPC_EVT_TTS_START;
+    if (strcmp(s, "tts_done") == 0) return IPC_EVT_TTS_DONE;
     return 0xFFFF;
 }
 
 int main(int argc, char **argv) {
     if (argc < 3) {
-        fprintf(stderr, "usage: %s <fifo_path> <text|file|stop|wake> [payload]\n", argv[0]);
+        fprintf(stderr,
+                "usage: %s <%s|%s|%s> <type> [payload]\n"
+                "  tts:     text|file|stop|wake|stream|append|end\n"
+                "  asr_kws: offline|online\n"
+                "  player:  asr|asr_timeout|kws|tts_start|tts_done\n",
+                argv[0], IPC_BUS_TTS, IPC_BUS_ASR_KWS, IPC_BUS_PLAYER);
         return 1;
     }
 
@@ -32,18 +47,27 @@ int main(int argc, char **argv) {
     const char *payload = (argc >= 4) ? argv[3] : NULL;
     uint32_t body_len = payload ? (uint32_t)(strlen(payload) + 1) : 0;
 
-    int fd = open(argv[1], O_WRONLY | O_NONBLOCK);
-    if (fd < 0) {
-        fprintf(stderr, "open fifo failed: %s\n", strerror(errno));
+    IPCBusLink link;
+    uint32_t seq = 0;
+    ipc_bus_link_init(&link, argv[1]);
+    if (ipc_bus_link_send(&link, type, payload, body_len, &seq) != 0) {
+        fprintf(stderr, "send to %s failed: %s\n", argv[1], strerror(errno));
         return 1;
     }
 
-    uint32_t seq = 0;
-    if (ipc_send_message(fd, type, payload, body_len, &seq) != 0) {
-        fprintf(stderr, "send failed: %s\n", strerror(errno));
-        close(fd);
-        return 1;
+    // wake 需要 TTS 沿连接应答，顺便打印往返耗时
+    if (type == IPC_CMD_PLAY_WAKE_RESPONSE) {
+        struct pollfd pfd = { .fd = link.fd, .events = POLLIN };
+        IPCHeader header;
+        uint8_t body[64];
+        if (poll(&pfd, 1, 2000) <= 0 || ipc_bus_recv(link.fd, &header, body, sizeof(body)) != 0 ||
+            header.type != IPC_REPLY_WAKE_RESPONSE || header.seq != seq) {
+            fprintf(stderr, "no wake reply for seq=%u\n", seq);
+            ipc_bus_link_close(&link);
+            return 1;
+        }
+        printf("wake reply seq=%u\n", header.seq);
     }
-    close(fd);
+    ipc_bus_link_close(&link);
     return 0;
 }
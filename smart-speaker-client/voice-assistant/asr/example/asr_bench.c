@@ -0,0 +1,96 @@
+#define LOG_LEVEL 2
+#include "../../../debug_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../sherpa_asr.h"
+
+#define TAG "ASR-BENCH"
+
+/* 录音 WAV 离线回放基准：按 ALSA 周期大小喂给 process_asr_result，
+ * 对比「每次整段重解码」(窗口 0) 与分段定稿两种模式的总 CPU 和句末耗时。
+ * 用法：./asr_bench a.wav [b.wav ...]（16kHz 单声道） */
+
+extern char g_last_asr_text[1024];
+
+#define BENCH_TAIL_SILENCE_MS 1000
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/* 返回总处理耗时；*final_ms 为返回最终结果那一次调用的耗时 */
+static double run_one(const SherpaOnnxWave *wave, double *final_ms)
+{
+    float chunk[PERIOD_SIZE];
+    int32_t total = wave->num_samples + MODEL_SAMPLE_RATE * BENCH_TAIL_SILENCE_MS / 1000;
+    int32_t pos;
+    double sum = 0.0;
+
+    *final_ms = -1.0;
+    g_last_asr_text[0] = '\0';
+    for (pos = 0; pos < total; pos += PERIOD_SIZE) {
+        int32_t n = (total - pos < PERIOD_SIZE) ? total - pos : PERIOD_SIZE;
+        int32_t k;
+        double t0;
+        double cost;
+        for (k = 0; k < n; ++k) {
+            chunk[k] = (pos + k < wave->num_samples) ? wave->samples[pos + k] : 0.0f;
+        }
+        t0 = now_ms();
+        if (process_asr_result(chunk, n) == 0 && *final_ms < 0) {
+            *final_ms = now_ms() - t0;
+        }
+        cost = now_ms() - t0;
+        sum += cost;
+    }
+    return sum;
+}
+
+int main(int argc, char const *argv[])
+{
+    static const int windows[] = {0, 3000};
+    int i;
+    size_t w;
+
+    if (argc < 2) {
+        printf("usage: %s a.wav [b.wav ...]\n", argv[0]);
+        return 1;
+    }
+    if (init_sherpa_asr() != 0) {
+        LOGE(TAG, "初始化ASR模型失败");
+        return -1;
+    }
+
+    printf("%-28s %6s %8s %10s %8s %10s  %s\n", "file", "audio", "window", "cpu_ms", "rtf", "final_ms", "text");
+    for (i = 1; i < argc; ++i) {
+        const SherpaOnnxWave *wave = SherpaOnnxReadWave(argv[i]);
+        double audio_ms;
+        if (wave == NULL) {
+            LOGW(TAG, "读取失败: %s", argv[i]);
+            continue;
+        }
+        if (wave->sample_rate != MODEL_SAMPLE_RATE) {
+            LOGW(TAG, "%s 采样率 %d，需要 %d", argv[i], wave->sample_rate, MODEL_SAMPLE_RATE);
+            SherpaOnnxFreeWave(wave);
+            continue;
+        }
+        audio_ms = wave->num_samples * 1000.0 / MODEL_SAMPLE_RATE;
+        for (w = 0; w < sizeof(windows) / sizeof(windows[0]); ++w) {
+            double final_ms;
+            double cpu_ms;
+            sherpa_asr_set_commit_window_ms(windows[w]);
+            cpu_ms = run_one(wave, &final_ms);
+            printf("%-28s %5.1fs %8d %10.1f %8.3f %10.1f  %s\n", argv[i], audio_ms / 1000.0, windows[w],
+                   cpu_ms, cpu_ms / audio_ms, final_ms, g_last_asr_text);
+        }
+        SherpaOnnxFreeWave(wave);
+    }
+    cleanup_sherpa_asr();
+    return 0;
+}
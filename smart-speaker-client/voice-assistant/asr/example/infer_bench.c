@@ -0,0 +1,274 @@
+#define _GNU_SOURCE
+#define LOG_LEVEL 2
+#include "../../../debug_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include "../sherpa_asr.h"
+#include "../../kws/sherpa_kws.h"
+#include "../../common/infer_config.h"
+
+#define TAG "INFER-BENCH"
+
+/* 推理线程数 / 绑核配置基准：对每组 ASR 配置重建识别器、绑定解码线程，
+ * 把 WAV 按 ALSA 周期喂给 process_asr_result，统计实时率（rtf = 解码耗时 / 音频时长）、
+ * 进程 CPU 时间折算的 cpu_rtf，以及主动 / 被动上下文切换次数（被动切换多说明线程超订）。
+ * -k 另起 KWS 线程按实时速度循环检测同一段音频（线程数和核取自 client.toml），并给出其 rtf；
+ * -l N 另起 N 个不绑核的忙等线程模拟音乐解码等负载；-r R 每组重复 R 遍（默认 3）。
+ * 用法：./infer_bench [-k] [-l N] [-r R] a.wav [线程数[@核] ...]
+ * 例：./infer_bench -k a.wav 8 4@4-7 4@0-3 2@4-5（16kHz 单声道；不给配置时测 client.toml 与旧的 8 线程不绑核） */
+
+extern char g_last_asr_text[1024];
+
+#define BENCH_TAIL_SILENCE_MS 1000
+#define BENCH_MAX_CONFIGS     16
+#define BENCH_MAX_LOADS       16
+
+typedef struct {
+    int threads;
+    char cpus[64];
+} BenchConfig;
+
+static const SherpaOnnxWave *g_wave;
+static atomic_int g_kws_running = 0;
+static atomic_int g_load_running = 0;
+// KWS 线程累计解码耗时与音频时长（微秒 / 采样数），每组配置开始前清零
+static atomic_llong g_kws_busy_us = 0;
+static atomic_llong g_kws_samples = 0;
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static double rusage_cpu_ms(const struct rusage *ru)
+{
+    return ru->ru_utime.tv_sec * 1000.0 + ru->ru_utime.tv_usec / 1000.0 +
+           ru->ru_stime.tv_sec * 1000.0 + ru->ru_stime.tv_usec / 1000.0;
+}
+
+static void *kws_thread(void *arg)
+{
+    float chunk[PERIOD_SIZE];
+    char keyword[256];
+    int32_t pos = 0;
+    double t0 = now_ms();
+    long long fed = 0;
+    (void)arg;
+
+    infer_bind_current_thread(INFER_KWS);
+    while (atomic_load_explicit(&g_kws_running, memory_order_relaxed)) {
+        int32_t n = PERIOD_SIZE;
+        int32_t k;
+        double due;
+        double start;
+
+        for (k = 0; k < n; ++k) {
+            chunk[k] = g_wave->samples[(pos + k) % g_wave->num_samples];
+        }
+        pos = (pos + n) % g_wave->num_samples;
+        fed += n;
+        // 与采集一致按实时速度送入，KWS 只该占用一小部分 CPU
+        due = t0 + (double)fed * 1000.0 / MODEL_SAMPLE_RATE;
+        if (due > now_ms()) {
+            usleep((useconds_t)((due - now_ms()) * 1000.0));
+        }
+        start = now_ms();
+        process_kws_result(chunk, n, keyword, sizeof(keyword));
+        atomic_fetch_add(&g_kws_busy_us, (long long)((now_ms() - start) * 1000.0));
+        atomic_fetch_add(&g_kws_samples, n);
+    }
+    return NULL;
+}
+
+static void *load_thread(void *arg)
+{
+    volatile double x = 1.0;
+    (void)arg;
+    while (atomic_load_explicit(&g_load_running, memory_order_relaxed)) {
+        x = x * 1.0000001 + 0.0000001;
+    }
+    return NULL;
+}
+
+// "4@4-7" → 4 线程绑 4-7 核；"8" 或 "8@" 不绑核；"cfg" 取 client.toml
+static int parse_config(const char *text, BenchConfig *cfg)
+{
+    const char *at = strchr(text, '@');
+    char *end;
+    long n;
+
+    if (strcmp(text, "cfg") == 0) {
+        cfg->threads = infer_num_threads(INFER_ASR);
+        snprintf(cfg->cpus, sizeof(cfg->cpus), "%s", infer_cpus(INFER_ASR));
+        return 0;
+    }
+    n = strtol(text, &end, 10);
+    if (end == text || (*end != '\0' && *end != '@') || n < 1) {
+        return -1;
+    }
+    cfg->threads = (int)n;
+    snprintf(cfg->cpus, sizeof(cfg->cpus), "%s", at != NULL ? at + 1 : "");
+    return 0;
+}
+
+/* 跑一组配置并打印一行结果，0 成功，-1 配置无效或模型加载失败 */
+static int run_config(const BenchConfig *cfg, int repeats, const cpu_set_t *all_cpus)
+{
+    float chunk[PERIOD_SIZE];
+    int32_t total = g_wave->num_samples + MODEL_SAMPLE_RATE * BENCH_TAIL_SILENCE_MS / 1000;
+    double audio_ms = (double)total * repeats * 1000.0 / MODEL_SAMPLE_RATE;
+    double decode_ms = 0.0;
+    double wall0;
+    double wall_ms;
+    double kws_rtf = -1.0;
+    struct rusage ru0;
+    struct rusage ru1;
+    int r;
+
+    if (infer_config_set(INFER_ASR, cfg->threads, cfg->cpus) != 0) {
+        LOGW(TAG, "配置无效: %d@%s", cfg->threads, cfg->cpus);
+        return -1;
+    }
+    // 先放开上一组的绑核，否则未配置核时识别器线程池会继承上一组的亲和性
+    pthread_setaffinity_np(pthread_self(), sizeof(*all_cpus), all_cpus);
+    if (init_sherpa_asr() != 0) {
+        LOGE(TAG, "初始化ASR模型失败");
+        return -1;
+    }
+    // 解码在本线程，与主进程一样在创建识别器之后绑核
+    infer_bind_current_thread(INFER_ASR);
+
+    atomic_store(&g_kws_busy_us, 0);
+    atomic_store(&g_kws_samples, 0);
+    getrusage(RUSAGE_SELF, &ru0);
+    wall0 = now_ms();
+    for (r = 0; r < repeats; ++r) {
+        int32_t pos;
+        sherpa_asr_reset();
+        g_last_asr_text[0] = '\0';
+        for (pos = 0; pos < total; pos += PERIOD_SIZE) {
+            int32_t n = (total - pos < PERIOD_SIZE) ? total - pos : PERIOD_SIZE;
+            int32_t k;
+            double t0;
+            for (k = 0; k < n; ++k) {
+                chunk[k] = (pos + k < g_wave->num_samples) ? g_wave->samples[pos + k] : 0.0f;
+            }
+            t0 = now_ms();
+            process_asr_result(chunk, n);
+            decode_ms += now_ms() - t0;
+        }
+    }
+    wall_ms = now_ms() - wall0;
+    getrusage(RUSAGE_SELF, &ru1);
+    if (atomic_load(&g_kws_samples) > 0) {
+        kws_rtf = (double)atomic_load(&g_kws_busy_us) / 1000.0 /
+                  ((double)atomic_load(&g_kws_samples) * 1000.0 / MODEL_SAMPLE_RATE);
+    }
+
+    printf("%7d %-10s %10.1f %8.3f %8.3f %9ld %9ld %8.3f  %s\n",
+           cfg->threads, cfg->cpus[0] != '\0' ? cfg->cpus : "-", wall_ms,
+           decode_ms / audio_ms, (rusage_cpu_ms(&ru1) - rusage_cpu_ms(&ru0)) / audio_ms,
+           ru1.ru_nvcsw - ru0.ru_nvcsw, ru1.ru_nivcsw - ru0.ru_nivcsw, kws_rtf, g_last_asr_text);
+    cleanup_sherpa_asr();
+    return 0;
+}
+
+int main(int argc, char const *argv[])
+{
+    BenchConfig configs[BENCH_MAX_CONFIGS];
+    pthread_t loads[BENCH_MAX_LOADS];
+    pthread_t kws_tid;
+    cpu_set_t all_cpus;
+    const char *wav = NULL;
+    int num_configs = 0;
+    int num_loads = 0;
+    int repeats = 3;
+    int with_kws = 0;
+    int i;
+
+    for (i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "-k") == 0) {
+            with_kws = 1;
+        } else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+            num_loads = atoi(argv[++i]);
+            num_loads = num_loads < 0 ? 0 : (num_loads > BENCH_MAX_LOADS ? BENCH_MAX_LOADS : num_loads);
+        } else if (strcmp(argv[i], "-r") == 0 && i + 1 < argc) {
+            repeats = atoi(argv[++i]);
+            repeats = repeats < 1 ? 1 : repeats;
+        } else if (wav == NULL) {
+            wav = argv[i];
+        } else if (num_configs < BENCH_MAX_CONFIGS) {
+            if (parse_config(argv[i], &configs[num_configs]) != 0) {
+                LOGW(TAG, "忽略无效配置: %s", argv[i]);
+                continue;
+            }
+            num_configs++;
+        }
+    }
+    if (wav == NULL) {
+        printf("usage: %s [-k] [-l N] [-r R] a.wav [threads[@cpus] ...]\n", argv[0]);
+        return 1;
+    }
+    if (num_configs == 0) {
+        parse_config("cfg", &configs[num_configs++]);
+        parse_config("8", &configs[num_configs++]);
+    }
+
+    g_wave = SherpaOnnxReadWave(wav);
+    if (g_wave == NULL || g_wave->num_samples == 0) {
+        LOGE(TAG, "读取失败: %s", wav);
+        return -1;
+    }
+    if (g_wave->sample_rate != MODEL_SAMPLE_RATE) {
+        LOGE(TAG, "%s 采样率 %d，需要 %d", wav, g_wave->sample_rate, MODEL_SAMPLE_RATE);
+        SherpaOnnxFreeWave(g_wave);
+        return -1;
+    }
+    pthread_getaffinity_np(pthread_self(), sizeof(all_cpus), &all_cpus);
+
+    if (with_kws) {
+        if (init_sherpa_kws() != 0) {
+            LOGE(TAG, "初始化KWS模型失败");
+            SherpaOnnxFreeWave(g_wave);
+            return -1;
+        }
+        atomic_store(&g_kws_running, 1);
+        pthread_create(&kws_tid, NULL, kws_thread, NULL);
+    }
+    atomic_store(&g_load_running, 1);
+    for (i = 0; i < num_loads; ++i) {
+        pthread_create(&loads[i], NULL, load_thread, NULL);
+    }
+
+    printf("cpus_online=%ld kws=%s%s%s load_threads=%d repeats=%d audio=%.1fs\n",
+           sysconf(_SC_NPROCESSORS_ONLN), with_kws ? "on" : "off",
+           with_kws ? "@" : "", with_kws ? (infer_cpus(INFER_KWS)[0] ? infer_cpus(INFER_KWS) : "-") : "",
+           num_loads, repeats, (double)g_wave->num_samples / MODEL_SAMPLE_RATE);
+    printf("%7s %-10s %10s %8s %8s %9s %9s %8s  %s\n",
+           "threads", "cpus", "wall_ms", "rtf", "cpu_rtf", "nvcsw", "nivcsw", "kws_rtf", "text");
+    for (i = 0; i < num_configs; ++i) {
+        run_config(&configs[i], repeats, &all_cpus);
+    }
+
+    atomic_store(&g_load_running, 0);
+    for (i = 0; i < num_loads; ++i) {
+        pthread_join(loads[i], NULL);
+    }
+    if (with_kws) {
+        atomic_store(&g_kws_running, 0);
+        pthread_join(kws_tid, NULL);
+        cleanup_sherpa_kws();
+    }
+    SherpaOnnxFreeWave(g_wave);
+    return 0;
+}
@@ -6,6 +6,7 @@
 #include "../../debug_log.h"
 #include "sherpa_asr.h"
 #include "../common/mysamplerate.h"
+#include "../common/infer_config.h"
 
 #include <unistd.h>
 #include <time.h>
@@ -37,11 +38,20 @@ const SherpaOnnxCircularBuffer *g_audio_buffer = NULL;
 #define VAD_WINDOW_SIZE 512
 #define BUFFER_CAPACITY 960000
 
+/* 流式识别：每 200ms 新音频出一次中间结果；未提交的尾巴超过窗口时，
+ * 在窗口末段能量最低处切一刀，前半段解码一次后把文本固定下来，之后只解码尾巴 */
+#define ASR_PARTIAL_INTERVAL_SAMPLES (MODEL_SAMPLE_RATE / 5)
+#define ASR_COMMIT_WINDOW_MS 3000
+#define ASR_COMMIT_SEARCH_SAMPLES (MODEL_SAMPLE_RATE * 6 / 10)
+#define ASR_ENERGY_FRAME 320
+
 static float *g_current_audio = NULL;
 static int32_t g_current_audio_size = 0;
 static int32_t g_current_audio_capacity = 0;
 static int32_t g_speech_started = 0;
-static struct timespec g_last_recognize_time = {0, 0};
+static int32_t g_samples_since_partial = 0;
+static int32_t g_commit_window_samples = MODEL_SAMPLE_RATE * ASR_COMMIT_WINDOW_MS / 1000;
+static char g_committed_text[1024] = {0};
 
 static void ensure_audio_capacity(int32_t required_size) {
     if (required_size > g_current_audio_capacity) {
@@ -56,12 +66,133 @@ static void ensure_audio_capacity(int32_t required_size) {
     }
 }
 
-static double get_elapsed_ms(struct timespec *start) {
-    struct timespec now;
-    clock_gettime(CLOCK_MONOTONIC, &now);
-    double elapsed = (now.tv_sec - start->tv_sec) * 1000.0;
-    elapsed += (now.tv_nsec - start->tv_nsec) / 1000000.0;
-    return elapsed;
+void sherpa_asr_set_commit_window_ms(int ms)
+{
+    g_commit_window_samples = (ms > 0) ? MODEL_SAMPLE_RATE / 1000 * ms : 0;
+}
+
+/* 解码一段音频，得到非空文本返回 0 */
+static int asr_decode_samples(const float *samples, int32_t n, char *out, size_t out_size)
+{
+    const SherpaOnnxOfflineStream *stream;
+    const SherpaOnnxOfflineRecognizerResult *result;
+    int ret = -1;
+
+    out[0] = '\0';
+    if (samples == NULL || n <= 0) {
+        return -1;
+    }
+    stream = SherpaOnnxCreateOfflineStream(g_offline_recognizer);
+    if (stream == NULL) {
+        return -1;
+    }
+    SherpaOnnxAcceptWaveformOffline(stream, MODEL_SAMPLE_RATE, samples, n);
+    SherpaOnnxDecodeOfflineStream(g_offline_recognizer, stream);
+    result = SherpaOnnxGetOfflineStreamResult(stream);
+    if (result && result->text && strlen(result->text) > 0) {
+        strncpy(out, result->text, out_size - 1);
+        out[out_size - 1] = '\0';
+        ret = 0;
+    }
+    SherpaOnnxDestroyOfflineRecognizerResult(result);
+    SherpaOnnxDestroyOfflineStream(stream);
+    return ret;
+}
+
+/* 已提交片段末尾的句读去掉再拼接，避免「我想听。周杰伦」 */
+static void asr_append_text(char *dst, size_t dst_size, const char *piece)
+{
+    static const char *const puncts[] = {"。", "，", "？", "！", ".", ",", "?", "!", NULL};
+    size_t len = strlen(dst);
+    int changed = 1;
+    while (changed && len > 0) {
+        int i;
+        changed = 0;
+        for (i = 0; puncts[i] != NULL; ++i) {
+            size_t plen = strlen(puncts[i]);
+            if (len >= plen && memcmp(dst + len - plen, puncts[i], plen) == 0) {
+                len -= plen;
+                dst[len] = '\0';
+                changed = 1;
+                break;
+            }
+        }
+    }
+    if (len + 1 < dst_size) {
+        strncpy(dst + len, piece, dst_size - len - 1);
+        dst[dst_size - 1] = '\0';
+    }
+}
+
+/* 在 [end - ASR_COMMIT_SEARCH_SAMPLES, end) 里找能量最低的 20ms 帧，尽量切在字间停顿上 */
+static int32_t asr_find_commit_point(int32_t end)
+{
+    int32_t begin = end - ASR_COMMIT_SEARCH_SAMPLES;
+    int32_t best = end;
+    double best_energy = -1.0;
+    int32_t f;
+
+    if (begin < ASR_ENERGY_FRAME) {
+        begin = ASR_ENERGY_FRAME;
+    }
+    for (f = begin; f + ASR_ENERGY_FRAME <= end; f += ASR_ENERGY_FRAME / 2) {
+        double energy = 0.0;
+        int32_t k;
+        for (k = 0; k < ASR_ENERGY_FRAME; ++k) {
+            energy += (double)g_current_audio[f + k] * g_current_audio[f + k];
+        }
+        if (best_energy < 0.0 || energy < best_energy) {
+            best_energy = energy;
+            best = f + ASR_ENERGY_FRAME / 2;
+        }
+    }
+    return best;
+}
+
+/* 尾巴过长时把前一段定稿，并把剩余音频挪到缓冲区开头 */
+static void asr_commit_if_needed(void)
+{
+    char piece[1024];
+    int32_t cut;
+
+    if (g_commit_window_samples <= 0 || g_current_audio == NULL ||
+        g_current_audio_size <= g_commit_window_samples) {
+        return;
+    }
+    cut = asr_find_commit_point(g_commit_window_samples);
+    if (asr_decode_samples(g_current_audio, cut, piece, sizeof(piece)) == 0) {
+        asr_append_text(g_committed_text, sizeof(g_committed_text), piece);
+        LOGD(TAG, "定稿: %s", g_committed_text);
+    }
+    memmove(g_current_audio, g_current_audio + cut, (size_t)(g_current_audio_size - cut) * sizeof(float));
+    g_current_audio_size -= cut;
+}
+
+/* 已定稿文本 + 尾巴解码结果 */
+static int asr_decode_current(char *out, size_t out_size)
+{
+    char tail[1024];
+    int has_tail = (asr_decode_samples(g_current_audio, g_current_audio_size, tail, sizeof(tail)) == 0);
+
+    strncpy(out, g_committed_text, out_size - 1);
+    out[out_size - 1] = '\0';
+    if (has_tail) {
+        asr_append_text(out, out_size, tail);
+    }
+    return out[0] != '\0' ? 0 : -1;
+}
+
+static void asr_reset_utterance(void)
+{
+    if (g_current_audio) {
+        free(g_current_audio);
+        g_current_audio = NULL;
+    }
+    g_current_audio_size = 0;
+    g_current_audio_capacity = 0;
+    g_speech_started = 0;
+    g_samples_since_partial = 0;
+    g_committed_text[0] = '\0';
 }
 
 int init_sherpa_asr(void)
@@ -75,7 +206,7 @@ int init_sherpa_asr(void)
     SherpaOnnxOfflineModelConfig offline_model_config;
     memset(&offline_model_config, 0, sizeof(offline_model_config));
     offline_model_config.debug = 0;
-    offline_model_config.num_threads = 8;
+    offline_model_config.num_threads = infer_num_threads(INFER_ASR);
     offline_model_config.provider = "cpu";
     offline_model_config.tokens = MODEL_PREFIX "/model/asr/sherpa-onnx-sense-voice-zh-en-ja-ko-yue-2024-07-17/tokens.txt";
     offline_model_config.sense_voice = sense_voice_config;
@@ -85,7 +216,10 @@ int init_sherpa_asr(void)
     recognizer_config.decoding_method = "greedy_search";
     recognizer_config.model_config = offline_model_config;
 
+    // 识别器的线程池继承创建线程的亲和性，创建时临时绑到 ASR 的核上
+    infer_affinity_enter(INFER_ASR);
     g_offline_recognizer = SherpaOnnxCreateOfflineRecognizer(&recognizer_config);
+    infer_affinity_leave();
     if (!g_offline_recognizer)
     {
         LOGE(TAG, "创建离线识别器失败!");
@@ -122,13 +256,23 @@ int init_sherpa_asr(void)
     }
 
     g_current_audio = NULL;
-    g_current_audio_size = 0;
-    g_current_audio_capacity = 0;
-    g_speech_started = 0;
+    asr_reset_utterance();
 
     return 0;
 }
 
+void sherpa_asr_reset(void)
+{
+    if (g_vad != NULL) {
+        SherpaOnnxVoiceActivityDetectorReset(g_vad);
+    }
+    if (g_audio_buffer != NULL) {
+        SherpaOnnxCircularBufferReset(g_audio_buffer);
+    }
+    asr_reset_utterance();
+    g_current_asr_text_buffer[0] = '\0';
+}
+
 int process_asr_result(float *model_audio, int model_frames)
 {
     int ret = 1;
@@ -151,32 +295,27 @@ int process_asr_result(float *model_audio, int model_frames)
 
         if (!g_speech_started && SherpaOnnxVoiceActivityDetectorDetected(g_vad)) {
             g_speech_started = 1;
+            g_samples_since_partial = 0;
+            g_committed_text[0] = '\0';
             g_current_asr_text_buffer[0] = '\0';
-            clock_gettime(CLOCK_MONOTONIC, &g_last_recognize_time);
             LOGD(TAG, "检测到语音开始");
         }
 
-        if (g_speech_started && get_elapsed_ms(&g_last_recognize_time) > 200) {
-            const SherpaOnnxOfflineStream *stream = SherpaOnnxCreateOfflineStream(g_offline_recognizer);
-            if (stream && g_current_audio && g_current_audio_size > 0) {
-                SherpaOnnxAcceptWaveformOffline(stream, MODEL_SAMPLE_RATE, g_current_audio, g_current_audio_size);
-                SherpaOnnxDecodeOfflineStream(g_offline_recognizer, stream);
-
-                const SherpaOnnxOfflineRecognizerResult *result = SherpaOnnxGetOfflineStreamResult(stream);
-                if (result && strlen(result->text) > 0) {
-                    LOGI(TAG, "识别中: %s", result->text);
-                    strncpy(g_current_asr_text_buffer, result->text, sizeof(g_current_asr_text_buffer) - 1);
-                    strncpy(g_last_asr_text, result->text, 1023);
-                    g_last_asr_text[1023] = '\0';
-                    clock_gettime(CLOCK_MONOTONIC, &g_last_asr_update_time);
-                    g_asr_result_updated = 1;
-                }
-                SherpaOnnxDestroyOfflineRecognizerResult(result);
-            }
-            if (stream) {
-                SherpaOnnxDestroyOfflineStream(stream);
+        if (g_speech_started) {
+            g_samples_since_partial += chunk_size;
+        }
+        if (g_speech_started && g_samples_since_partial >= ASR_PARTIAL_INTERVAL_SAMPLES && g_current_audio) {
+            char text[1024];
+            g_samples_since_partial = 0;
+            asr_commit_if_needed();
+            if (asr_decode_current(text, sizeof(text)) == 0) {
+                LOGI(TAG, "识别中: %s", text);
+                strncpy(g_current_asr_text_buffer, text, sizeof(g_current_asr_text_buffer) - 1);
+                strncpy(g_last_asr_text, text, 1023);
+                g_last_asr_text[1023] = '\0';
+                clock_gettime(CLOCK_MONOTONIC, &g_last_asr_update_time);
+                g_asr_result_updated = 1;
             }
-            clock_gettime(CLOCK_MONOTONIC, &g_last_recognize_time);
         }
 
         if (!g_speech_started && g_current_audio_size > 10 * VAD_WINDOW_SIZE) {
@@ -190,55 +329,35 @@ int process_asr_result(float *model_audio, int model_frames)
         while (!SherpaOnnxVoiceActivityDetectorEmpty(g_vad))
         {
             const SherpaOnnxSpeechSegment *segment = SherpaOnnxVoiceActivityDetectorFront(g_vad);
-
-            const float *samples = SherpaOnnxCircularBufferGet(g_audio_buffer, segment->start, segment->n);
-            if (samples)
-            {
-                const SherpaOnnxOfflineStream *stream = SherpaOnnxCreateOfflineStream(g_offline_recognizer);
-                SherpaOnnxAcceptWaveformOffline(stream, MODEL_SAMPLE_RATE, samples, segment->n);
-                SherpaOnnxDecodeOfflineStream(g_offline_recognizer, stream);
-
-                const SherpaOnnxOfflineRecognizerResult *result = SherpaOnnxGetOfflineStreamResult(stream);
-                if (result && strlen(result->text) > 0)
-                {
-                    const char *final_txt = result->text;
-                    if (g_current_asr_text_buffer[0] != '\0') {
-                        final_txt = g_current_asr_text_buffer;
-                        if (strcmp(final_txt, result->text) != 0) {
-                            LOGD(TAG, "段解码与流式不一致，采用流式: [%s] vs [%s]",
-                                 final_txt, result->text);
-                        }
-                    }
-                    LOGI(TAG, "识别结果: %s", final_txt);
-                    strncpy(g_last_asr_text, final_txt, 1023);
-                    g_last_asr_text[1023] = '\0';
-                    g_current_asr_text_buffer[0] = '\0';
-                    ret = 0;
+            char final_txt[1024];
+            int has_final = -1;
+
+            /* 句末只需解码未定稿的尾巴；缓冲区不可用时退回整段解码 */
+            if (g_speech_started && g_current_audio) {
+                has_final = asr_decode_current(final_txt, sizeof(final_txt));
+            } else {
+                const float *samples = SherpaOnnxCircularBufferGet(g_audio_buffer, segment->start, segment->n);
+                if (samples) {
+                    has_final = asr_decode_samples(samples, segment->n, final_txt, sizeof(final_txt));
+                    SherpaOnnxCircularBufferFree(samples);
                 }
-                else if (g_current_asr_text_buffer[0] != '\0')
-                {
-                    LOGI(TAG, "识别结果: %s", g_current_asr_text_buffer);
-                    strncpy(g_last_asr_text, g_current_asr_text_buffer, 1023);
-                    g_last_asr_text[1023] = '\0';
-                    g_current_asr_text_buffer[0] = '\0';
-                    ret = 0;
-                }
-
-                SherpaOnnxDestroyOfflineRecognizerResult(result);
-                SherpaOnnxDestroyOfflineStream(stream);
-                SherpaOnnxCircularBufferFree(samples);
             }
+            if (has_final != 0 && g_current_asr_text_buffer[0] != '\0') {
+                strncpy(final_txt, g_current_asr_text_buffer, sizeof(final_txt) - 1);
+                final_txt[sizeof(final_txt) - 1] = '\0';
+                has_final = 0;
+            }
+            if (has_final == 0) {
+                LOGI(TAG, "识别结果: %s", final_txt);
+                strncpy(g_last_asr_text, final_txt, 1023);
+                g_last_asr_text[1023] = '\0';
+                ret = 0;
+            }
+            g_current_asr_text_buffer[0] = '\0';
 
             SherpaOnnxDestroySpeechSegment(segment);
             SherpaOnnxVoiceActivityDetectorPop(g_vad);
-
-            if (g_current_audio) {
-                free(g_current_audio);
-                g_current_audio = NULL;
-            }
-            g_current_audio_size = 0;
-            g_current_audio_capacity = 0;
-            g_speech_started = 0;
+            asr_reset_utterance();
         }
 
         i += chunk_size;
@@ -249,13 +368,7 @@ int process_asr_result(float *model_audio, int model_frames)
 
 void cleanup_sherpa_asr(void)
 {
-    if (g_current_audio != NULL)
-    {
-        free(g_current_audio);
-        g_current_audio = NULL;
-    }
-    g_current_audio_size = 0;
-    g_current_audio_capacity = 0;
+    asr_reset_utterance();
 
     if (g_audio_buffer != NULL)
     {
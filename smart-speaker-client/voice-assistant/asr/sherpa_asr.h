@@ -15,5 +15,11 @@ int init_sherpa_asr(void);
 int process_asr_result(float *model_audio, int model_frame);
 void cleanup_sherpa_asr(void);
 
+/* 丢弃 VAD 状态和未完成的句子，下一轮识别从头开始（再次唤醒打断识别时调用） */
+void sherpa_asr_reset(void);
+
+/* 未定稿音频超过该时长即分段定稿；0 表示不分段（每次都从句首整段解码） */
+void sherpa_asr_set_commit_window_ms(int ms);
+
 
 #endif
@@ -0,0 +1,170 @@
+#define LOG_LEVEL 2
+#include "../../../debug_log.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../polyphase.h"
+
+/* TTS 播放转换基准：按 256 帧一块，把单声道 float 转成 ALSA 的交错双声道 int16，
+ * 对比原来的逐样本线性插值+标量限幅/复制与现在的多相重采样+SIMD 内核，输出每秒音频消耗的 CPU 毫秒数。
+ * 先校验 SIMD 内核与标量结果逐样本一致，不一致返回 1。
+ * 用法：./playback_bench [秒数]（默认 60）；RK3588 上用 taskset -c 0 绑到 A55 小核测量 */
+
+#define BLOCK_FRAMES    256
+#define MAX_BLOCK_OUT   (BLOCK_FRAMES * 4)
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void fill_block(float *block, long offset, unsigned int rate)
+{
+    int k;
+    for (k = 0; k < BLOCK_FRAMES; k++) {
+        double t = (double)(offset + k) / rate;
+        // 超出 [-1, 1] 的峰值覆盖限幅分支
+        block[k] = (float)(1.1 * sin(2.0 * M_PI * 220.0 * t) * sin(2.0 * M_PI * 3.0 * t));
+    }
+}
+
+// 原实现：每次播放 malloc 三块缓冲区，浮点除法定位的线性插值，分步限幅和复制
+static double run_legacy(unsigned int in_rate, unsigned int out_rate, int seconds, const float *block)
+{
+    long total = (long)in_rate * seconds;
+    long done;
+    double t0 = now_ms();
+    volatile int16_t sink = 0;
+    float *resampled = (float *)malloc(MAX_BLOCK_OUT * sizeof(float));
+    int16_t *processed = (int16_t *)malloc(MAX_BLOCK_OUT * sizeof(int16_t));
+    int16_t *stereo = (int16_t *)malloc(MAX_BLOCK_OUT * 2 * sizeof(int16_t));
+
+    for (done = 0; done < total; done += BLOCK_FRAMES) {
+        int out_frames = (int)((long)BLOCK_FRAMES * out_rate / in_rate);
+        int i;
+        for (i = 0; i < out_frames; i++) {
+            float pos = (float)i * (float)in_rate / (float)out_rate;
+            int idx = (int)pos;
+            float frac = pos - idx;
+            if (idx >= BLOCK_FRAMES - 1)
+                resampled[i] = block[BLOCK_FRAMES - 1];
+            else
+                resampled[i] = block[idx] * (1.0f - frac) + block[idx + 1] * frac;
+        }
+        for (i = 0; i < out_frames; i++) {
+            float t = resampled[i];
+            if (t < -1.0f) t = -1.0f; else if (t > 1.0f) t = 1.0f;
+            processed[i] = (int16_t)(t * 32767);
+        }
+        for (i = 0; i < out_frames; i++) {
+            stereo[i * 2] = processed[i];
+            stereo[i * 2 + 1] = processed[i];
+        }
+        sink += stereo[out_frames * 2 - 1];
+    }
+    free(resampled);
+    free(processed);
+    free(stereo);
+    return (now_ms() - t0) / seconds;
+}
+
+static double run_polyphase(unsigned int in_rate, unsigned int out_rate, int seconds, const float *block)
+{
+    PolyphaseResampler rs;
+    static float out[MAX_BLOCK_OUT];
+    static int16_t stereo[MAX_BLOCK_OUT * 2];
+    long total = (long)in_rate * seconds;
+    long done;
+    double t0;
+    volatile int16_t sink = 0;
+
+    if (polyphase_init(&rs, in_rate, out_rate, BLOCK_FRAMES) != 0) {
+        return -1.0;
+    }
+    t0 = now_ms();
+    for (done = 0; done < total; done += BLOCK_FRAMES) {
+        int n = BLOCK_FRAMES;
+        const float *src = block;
+        if (rs.taps > 0) {
+            n = polyphase_process(&rs, block, BLOCK_FRAMES, out);
+            src = out;
+        }
+        pcm_float_to_s16_stereo(src, stereo, n);
+        if (n > 0) {
+            sink += stereo[n * 2 - 1];
+        }
+    }
+    t0 = (now_ms() - t0) / seconds;
+    polyphase_free(&rs);
+    return t0;
+}
+
+static int check_kernels(void)
+{
+    static float in[1000];
+    static int16_t in16[1000];
+    static int16_t out[2000];
+    int errors = 0;
+    int i;
+
+    for (i = 0; i < 1000; i++) {
+        in[i] = (float)(1.5 * sin(i * 0.037));
+        in16[i] = (int16_t)(i * 67 - 32768);
+    }
+    in[3] = -1.0f;
+    in[4] = 1.0f;
+    // 奇数长度覆盖尾部标量循环
+    pcm_float_to_s16_stereo(in, out, 999);
+    for (i = 0; i < 999; i++) {
+        float t = in[i] < -1.0f ? -1.0f : (in[i] > 1.0f ? 1.0f : in[i]);
+        int16_t ref = (int16_t)(t * 32767);
+        errors += (out[i * 2] != ref || out[i * 2 + 1] != ref);
+    }
+    pcm_s16_to_stereo(in16, out, 999);
+    for (i = 0; i < 999; i++) {
+        errors += (out[i * 2] != in16[i] || out[i * 2 + 1] != in16[i]);
+    }
+    pcm_s16_to_float(in16, in, 999);
+    for (i = 0; i < 999; i++) {
+        errors += (in[i] != (float)in16[i] / 32768.0f);
+    }
+    printf("kernel check (%s): %s\n", polyphase_simd_name(), errors ? "FAIL" : "ok");
+    return errors;
+}
+
+int main(int argc, char const *argv[])
+{
+    static const unsigned int rates[][2] = {
+        {22050, 48000}, {22050, 44100}, {16000, 48000}, {24000, 48000}, {22050, 22050},
+    };
+    static float block[BLOCK_FRAMES];
+    int seconds = (argc > 1) ? atoi(argv[1]) : 60;
+    size_t r;
+
+    if (seconds <= 0) {
+        seconds = 60;
+    }
+    if (check_kernels() != 0) {
+        return 1;
+    }
+    fill_block(block, 0, 22050);
+
+    printf("%-16s %16s %16s %8s\n", "in->out", "legacy ms/s", "polyphase ms/s", "taps");
+    for (r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        PolyphaseResampler rs;
+        int taps = 0;
+        double legacy = run_legacy(rates[r][0], rates[r][1], seconds, block);
+        double poly = run_polyphase(rates[r][0], rates[r][1], seconds, block);
+        if (polyphase_init(&rs, rates[r][0], rates[r][1], BLOCK_FRAMES) == 0) {
+            taps = rs.taps;
+            polyphase_free(&rs);
+        }
+        printf("%6u->%-8u %16.3f %16.3f %8d\n", rates[r][0], rates[r][1], legacy, poly, taps);
+    }
+    return 0;
+}
@@ -0,0 +1,146 @@
+#define LOG_LEVEL 2
+#include "../../../debug_log.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../mysamplerate.h"
+
+/* 重采样质量测试：各采样率下输入纯音，按 ALSA 周期分块重采样到 MODEL_SAMPLE_RATE，
+ * 对输出做已知频率的最小二乘正弦拟合，残差即失真+混叠噪声，计算 SNR 与通带增益；
+ * 高于目标奈奎斯特频率的纯音应被滤除（阻带衰减）。全部通过返回 0。 */
+
+unsigned int g_actual_rate = 0;     // 正常由 alsa.c 定义，这里不链接 ALSA
+
+#define TEST_SECONDS        2
+#define TEST_AMPLITUDE      0.5
+#define TEST_SKIP_MS        200     // 跳过滤波器启动段
+#define MIN_SNR_DB          60.0
+#define MAX_GAIN_ERR_DB     0.1
+#define MIN_STOPBAND_DB     60.0
+
+static float *g_out = NULL;
+static int g_out_len = 0;
+
+static int run_tone(unsigned int rate, double freq)
+{
+    int total = (int)rate * TEST_SECONDS;
+    int16_t chunk[PERIOD_SIZE];
+    int pos;
+
+    g_actual_rate = rate;
+    if (init_resampler() != 0) {
+        return -1;
+    }
+    g_out_len = 0;
+    for (pos = 0; pos < total; pos += PERIOD_SIZE) {
+        int n = (total - pos < PERIOD_SIZE) ? total - pos : PERIOD_SIZE;
+        float *out = NULL;
+        int out_n = 0;
+        int k;
+        for (k = 0; k < n; k++) {
+            chunk[k] = (int16_t)lrint(TEST_AMPLITUDE * 32767.0 * sin(2.0 * M_PI * freq * (pos + k) / rate));
+        }
+        if (resample_audio(chunk, n, &out, &out_n) != 0) {
+            cleanup_resampler();
+            return -1;
+        }
+        for (k = 0; k < out_n; k++) {
+            g_out[g_out_len++] = out[k];
+        }
+    }
+    cleanup_resampler();
+    return 0;
+}
+
+/* 拟合 a*sin + b*cos，返回 SNR（dB），*gain_db 为拟合幅度相对输入幅度 */
+static double fit_snr(double freq, double *gain_db)
+{
+    int start = MODEL_SAMPLE_RATE * TEST_SKIP_MS / 1000;
+    double ss = 0, sc = 0, cc = 0, ys = 0, yc = 0, det, a, b;
+    double sig = 0, err = 0;
+    int i;
+
+    for (i = start; i < g_out_len; i++) {
+        double w = 2.0 * M_PI * freq * i / MODEL_SAMPLE_RATE;
+        double s = sin(w), c = cos(w);
+        ss += s * s; sc += s * c; cc += c * c;
+        ys += g_out[i] * s; yc += g_out[i] * c;
+    }
+    det = ss * cc - sc * sc;
+    a = (ys * cc - yc * sc) / det;
+    b = (yc * ss - ys * sc) / det;
+    for (i = start; i < g_out_len; i++) {
+        double w = 2.0 * M_PI * freq * i / MODEL_SAMPLE_RATE;
+        double fit = a * sin(w) + b * cos(w);
+        sig += fit * fit;
+        err += (g_out[i] - fit) * (g_out[i] - fit);
+    }
+    *gain_db = 20.0 * log10(sqrt(a * a + b * b) / (TEST_AMPLITUDE * 32767.0 / 32768.0));
+    return 10.0 * log10(sig / (err + 1e-30));
+}
+
+static double residual_db(void)
+{
+    int start = MODEL_SAMPLE_RATE * TEST_SKIP_MS / 1000;
+    double p = 0;
+    int i;
+    for (i = start; i < g_out_len; i++) {
+        p += (double)g_out[i] * g_out[i];
+    }
+    p /= (g_out_len - start);
+    // 相对输入正弦功率 A^2/2
+    return 10.0 * log10(p / (TEST_AMPLITUDE * TEST_AMPLITUDE / 2.0) + 1e-30);
+}
+
+int main(void)
+{
+    static const unsigned int rates[] = {8000, 16000, 22050, 32000, 44100, 48000};
+    static const double pass_freqs[] = {100.0, 440.0, 1000.0, 3000.0, 6000.0};
+    static const double stop_freqs[] = {9000.0, 12000.0, 20000.0};
+    int failed = 0;
+    size_t r, f;
+
+    g_out = (float *)malloc(sizeof(float) * (MODEL_SAMPLE_RATE * TEST_SECONDS * 2 + PERIOD_SIZE * 4));
+    if (g_out == NULL) {
+        return 1;
+    }
+
+    printf("%-8s %-8s %10s %10s  %s\n", "rate", "freq", "snr_db", "gain_db", "result");
+    for (r = 0; r < sizeof(rates) / sizeof(rates[0]); r++) {
+        for (f = 0; f < sizeof(pass_freqs) / sizeof(pass_freqs[0]); f++) {
+            double gain_db, snr;
+            int ok;
+            if (pass_freqs[f] * 2.0 >= rates[r] * 0.9) {
+                continue;
+            }
+            if (run_tone(rates[r], pass_freqs[f]) != 0) {
+                printf("%-8u %-8.0f init/resample failed\n", rates[r], pass_freqs[f]);
+                failed++;
+                continue;
+            }
+            snr = fit_snr(pass_freqs[f], &gain_db);
+            ok = snr >= MIN_SNR_DB && fabs(gain_db) <= MAX_GAIN_ERR_DB;
+            failed += !ok;
+            printf("%-8u %-8.0f %10.1f %10.3f  %s\n", rates[r], pass_freqs[f], snr, gain_db, ok ? "ok" : "FAIL");
+        }
+        for (f = 0; f < sizeof(stop_freqs) / sizeof(stop_freqs[0]); f++) {
+            double atten;
+            int ok;
+            if (stop_freqs[f] * 2.0 >= rates[r]) {
+                continue;
+            }
+            if (run_tone(rates[r], stop_freqs[f]) != 0) {
+                failed++;
+                continue;
+            }
+            atten = -residual_db();
+            ok = atten >= MIN_STOPBAND_DB;
+            failed += !ok;
+            printf("%-8u %-8.0f %10s %10.1f  %s (stopband)\n", rates[r], stop_freqs[f], "-", -atten, ok ? "ok" : "FAIL");
+        }
+    }
+    free(g_out);
+    printf("%s\n", failed ? "FAILED" : "ALL PASSED");
+    return failed ? 1 : 0;
+}
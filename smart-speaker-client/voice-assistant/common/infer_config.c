@@ -0,0 +1,315 @@
+#define _GNU_SOURCE
+#define LOG_LEVEL 4
+#include "../../debug_log.h"
+#include "infer_config.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#define TAG "INFER_CFG"
+
+// 与 player/core/runtime_config.c 读同一个 client.toml
+#ifdef KWS_TEST_MODE
+#define CLIENT_CONFIG_PATH "../../../data/config/client.toml"
+#elif defined(PROCESS_MODE)
+#define CLIENT_CONFIG_PATH "./data/config/client.toml"
+#else
+#define CLIENT_CONFIG_PATH "../../data/config/client.toml"
+#endif
+
+#define INFER_MAX_THREADS 16
+
+typedef struct {
+    const char *name;
+    int num_threads;
+    char cpus[64];
+} InferModelConfig;
+
+/* 默认按 RK3588 划分：ASR/TTS 放 A76 大核（4-7），KWS 单线程放 A55 小核 0，
+ * 避免 KWS 与 ASR 并发时互相抢核；核数不足的板子上与可用核无交集的配置不生效 */
+static InferModelConfig g_models[INFER_MODEL_COUNT] = {
+    [INFER_ASR] = { "asr", 4, "4-7" },
+    [INFER_KWS] = { "kws", 1, "0" },
+    [INFER_TTS] = { "tts", 4, "4-7" },
+};
+
+static pthread_once_t g_load_once = PTHREAD_ONCE_INIT;
+static __thread cpu_set_t t_saved_set;
+static __thread int t_saved_valid = 0;
+
+static void trim_text(char *text)
+{
+    char *start = text;
+    size_t len;
+    while (*start == ' ' || *start == '\t' || *start == '\r' || *start == '\n') {
+        start++;
+    }
+    if (start != text) {
+        memmove(text, start, strlen(start) + 1);
+    }
+    len = strlen(text);
+    while (len > 0 &&
+           (text[len - 1] == ' ' || text[len - 1] == '\t' || text[len - 1] == '\r' || text[len - 1] == '\n')) {
+        text[--len] = '\0';
+    }
+}
+
+static void unquote_text(char *text)
+{
+    size_t len;
+    trim_text(text);
+    len = strlen(text);
+    if (len >= 2 && text[0] == '"' && text[len - 1] == '"') {
+        memmove(text, text + 1, len - 2);
+        text[len - 2] = '\0';
+    }
+}
+
+// "4-7"、"0,2,5-6" 或 "0xf0"；空串得到空集合，返回 0；格式错误返回 -1
+static int parse_cpus(const char *text, cpu_set_t *set)
+{
+    const char *p = text;
+    char *end;
+
+    CPU_ZERO(set);
+    if (text[0] == '\0') {
+        return 0;
+    }
+    if (text[0] == '0' && (text[1] == 'x' || text[1] == 'X')) {
+        unsigned long long mask;
+        int cpu;
+        errno = 0;
+        mask = strtoull(text + 2, &end, 16);
+        if (errno != 0 || end == text + 2 || *end != '\0') {
+            return -1;
+        }
+        for (cpu = 0; cpu < 64; cpu++) {
+            if (mask & (1ULL << cpu)) {
+                CPU_SET(cpu, set);
+            }
+        }
+        return 0;
+    }
+    for (;;) {
+        long lo;
+        long hi;
+        long cpu;
+        lo = strtol(p, &end, 10);
+        if (end == p || lo < 0 || lo >= CPU_SETSIZE) {
+            return -1;
+        }
+        hi = lo;
+        p = end;
+        if (*p == '-') {
+            p++;
+            hi = strtol(p, &end, 10);
+            if (end == p || hi < lo || hi >= CPU_SETSIZE) {
+                return -1;
+            }
+            p = end;
+        }
+        for (cpu = lo; cpu <= hi; cpu++) {
+            CPU_SET((int)cpu, set);
+        }
+        while (*p == ' ') {
+            p++;
+        }
+        if (*p == '\0') {
+            return 0;
+        }
+        if (*p != ',') {
+            return -1;
+        }
+        p++;
+        while (*p == ' ') {
+            p++;
+        }
+    }
+}
+
+static int find_model(const char *key, const char *suffix)
+{
+    int i;
+    size_t n;
+    for (i = 0; i < INFER_MODEL_COUNT; i++) {
+        n = strlen(g_models[i].name);
+        if (strncmp(key, g_models[i].name, n) == 0 && key[n] == '_' && strcmp(key + n + 1, suffix) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static void load_infer_config(void)
+{
+    FILE *fp;
+    char line[256];
+
+    fp = fopen(CLIENT_CONFIG_PATH, "r");
+    if (fp == NULL) {
+        LOGD(TAG, "未找到 %s，推理线程使用默认配置", CLIENT_CONFIG_PATH);
+        return;
+    }
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        char *eq;
+        char *key = line;
+        char *value;
+        int m;
+
+        trim_text(line);
+        if (line[0] == '\0' || line[0] == '#') {
+            continue;
+        }
+        eq = strchr(line, '=');
+        if (eq == NULL) {
+            continue;
+        }
+        *eq = '\0';
+        value = eq + 1;
+        trim_text(key);
+        unquote_text(value);
+
+        if ((m = find_model(key, "threads")) >= 0) {
+            char *end;
+            long n = strtol(value, &end, 10);
+            if (end == value || *end != '\0' || n < 1 || n > INFER_MAX_THREADS) {
+                LOGW(TAG, "%s = %s 无效（1～%d），保持 %d", key, value, INFER_MAX_THREADS, g_models[m].num_threads);
+                continue;
+            }
+            g_models[m].num_threads = (int)n;
+        } else if ((m = find_model(key, "cpus")) >= 0) {
+            cpu_set_t set;
+            if (strlen(value) >= sizeof(g_models[m].cpus) || parse_cpus(value, &set) != 0) {
+                LOGW(TAG, "%s = \"%s\" 无效，保持 \"%s\"", key, value, g_models[m].cpus);
+                continue;
+            }
+            memcpy(g_models[m].cpus, value, strlen(value) + 1);
+        }
+    }
+    fclose(fp);
+}
+
+static void ensure_loaded(void)
+{
+    pthread_once(&g_load_once, load_infer_config);
+}
+
+const char *infer_model_name(InferModel model)
+{
+    if (model < 0 || model >= INFER_MODEL_COUNT) {
+        return "?";
+    }
+    return g_models[model].name;
+}
+
+int infer_num_threads(InferModel model)
+{
+    if (model < 0 || model >= INFER_MODEL_COUNT) {
+        return 1;
+    }
+    ensure_loaded();
+    return g_models[model].num_threads;
+}
+
+const char *infer_cpus(InferModel model)
+{
+    if (model < 0 || model >= INFER_MODEL_COUNT) {
+        return "";
+    }
+    ensure_loaded();
+    return g_models[model].cpus;
+}
+
+int infer_config_set(InferModel model, int num_threads, const char *cpus)
+{
+    cpu_set_t set;
+
+    if (model < 0 || model >= INFER_MODEL_COUNT || num_threads < 1 || num_threads > INFER_MAX_THREADS) {
+        return -1;
+    }
+    if (cpus != NULL && (strlen(cpus) >= sizeof(g_models[model].cpus) || parse_cpus(cpus, &set) != 0)) {
+        return -1;
+    }
+    ensure_loaded();
+    g_models[model].num_threads = num_threads;
+    if (cpus != NULL) {
+        memcpy(g_models[model].cpus, cpus, strlen(cpus) + 1);
+    }
+    return 0;
+}
+
+// 取配置的核与本机存在的核的交集；为空返回 -1（不绑核）
+static int model_cpu_set(InferModel model, cpu_set_t *set)
+{
+    long ncpu = sysconf(_SC_NPROCESSORS_CONF);
+    int cpu;
+
+    if (parse_cpus(g_models[model].cpus, set) != 0) {
+        return -1;
+    }
+    for (cpu = (ncpu > 0 ? (int)ncpu : 1); cpu < CPU_SETSIZE; cpu++) {
+        CPU_CLR(cpu, set);
+    }
+    if (CPU_COUNT(set) == 0) {
+        if (g_models[model].cpus[0] != '\0') {
+            LOGW(TAG, "%s_cpus = \"%s\" 与本机 %ld 个核无交集，不绑核",
+                 g_models[model].name, g_models[model].cpus, ncpu);
+        }
+        return -1;
+    }
+    return 0;
+}
+
+int infer_bind_current_thread(InferModel model)
+{
+    cpu_set_t set;
+    int ret;
+
+    if (model < 0 || model >= INFER_MODEL_COUNT) {
+        return -1;
+    }
+    ensure_loaded();
+    if (model_cpu_set(model, &set) != 0) {
+        return 0;
+    }
+    ret = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    if (ret != 0) {
+        LOGW(TAG, "绑定 %s 线程到核 %s 失败: %s", g_models[model].name, g_models[model].cpus, strerror(ret));
+        return -1;
+    }
+    LOGD(TAG, "%s 线程已绑定到核 %s", g_models[model].name, g_models[model].cpus);
+    return 0;
+}
+
+int infer_affinity_enter(InferModel model)
+{
+    int ret;
+
+    t_saved_valid = 0;
+    ret = pthread_getaffinity_np(pthread_self(), sizeof(t_saved_set), &t_saved_set);
+    if (ret != 0) {
+        LOGW(TAG, "读取线程亲和性失败: %s", strerror(ret));
+        return -1;
+    }
+    t_saved_valid = 1;
+    return infer_bind_current_thread(model);
+}
+
+void infer_affinity_leave(void)
+{
+    int ret;
+
+    if (!t_saved_valid) {
+        return;
+    }
+    t_saved_valid = 0;
+    ret = pthread_setaffinity_np(pthread_self(), sizeof(t_saved_set), &t_saved_set);
+    if (ret != 0) {
+        LOGW(TAG, "恢复线程亲和性失败: %s", strerror(ret));
+    }
+}
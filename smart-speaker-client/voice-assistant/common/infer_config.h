@@ -0,0 +1,35 @@
+#ifndef __INFER_CONFIG_H__
+#define __INFER_CONFIG_H__
+
+/* 各 sherpa 模型的推理线程数与 CPU 亲和性，从 data/config/client.toml 读取：
+ *   asr_threads / kws_threads / tts_threads  onnxruntime 线程数（1～16）
+ *   asr_cpus / kws_cpus / tts_cpus           核列表 "4-7"、"0,2" 或掩码 "0xf0"，留空不绑核
+ * onnxruntime 的线程池在创建会话时生成并继承创建线程的亲和性，
+ * 因此模型创建放在 infer_affinity_enter/leave 之间，解码线程再用 infer_bind_current_thread 绑定。 */
+
+typedef enum {
+    INFER_ASR = 0,
+    INFER_KWS,
+    INFER_TTS,
+    INFER_MODEL_COUNT
+} InferModel;
+
+const char *infer_model_name(InferModel model);
+
+// 配置的推理线程数
+int infer_num_threads(InferModel model);
+
+// 配置的核列表文本（未配置为空串）
+const char *infer_cpus(InferModel model);
+
+// 覆盖配置（基准程序按命令行逐组测试用），cpus 为 NULL 保持不变；0 成功，-1 参数无效
+int infer_config_set(InferModel model, int num_threads, const char *cpus);
+
+// 把调用线程绑定到模型配置的核；未配置或与可用核无交集时不改动，返回 0；系统调用失败返回 -1
+int infer_bind_current_thread(InferModel model);
+
+// 临时把调用线程绑到模型的核上再创建会话，之后用 infer_affinity_leave 恢复（同一线程内不可嵌套）
+int infer_affinity_enter(InferModel model);
+void infer_affinity_leave(void);
+
+#endif
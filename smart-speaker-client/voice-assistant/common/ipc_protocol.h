@@ -3,13 +3,10 @@
 
 #include <stdint.h>
 
-#define FIFO_DIR_PATH "./fifo"
-#define TTS_FIFO_PATH "/tmp/tts_fifo"
-#define KWS_FIFO_PATH "./fifo/kws_fifo"
-#define ASR_FIFO_PATH "./fifo/asr_fifo"
-#define ASR_CTRL_FIFO_PATH "./fifo/asr_ctrl_fifo"
-#define TTS_WAKE_DONE_FIFO_PATH "/tmp/tts_wake_done_fifo"
-#define PLAYER_CTRL_FIFO_PATH "./fifo/player_ctrl_fifo"
+// 各进程在 ipc/ipc_bus.h 消息总线上的监听名
+#define IPC_BUS_PLAYER "player"
+#define IPC_BUS_TTS "tts"
+#define IPC_BUS_ASR_KWS "asr_kws"
 
 #define MAX_TEXT_LEN 1024
 #define MAX_FILENAME_LEN 256
@@ -18,15 +15,26 @@
 
 #define TTS_TEMP_FILE "./tts_temp.wav"
 
-#define ASR_TIMEOUT_SENTINEL "__asr_timeout__"
-
+/* IPCHeader.type：0x00 起为命令（模式切换发给 asr_kws，其余发给 TTS），0x100 起为发给 player 的事件，
+ * 0x200 起为应答（seq 与请求相同） */
 typedef enum {
     IPC_CMD_PLAY_TEXT,
     IPC_CMD_PLAY_AUDIO_FILE,
     IPC_CMD_STOP_PLAYING,
-    IPC_CMD_PLAY_WAKE_RESPONSE,
-    IPC_CMD_SWITCH_OFFLINE,
-    IPC_CMD_SWITCH_ONLINE
+    IPC_CMD_PLAY_WAKE_RESPONSE,     // TTS 开始播唤醒应答时以 IPC_REPLY_WAKE_RESPONSE 应答
+    IPC_CMD_SWITCH_OFFLINE,         // player → asr_kws：切到离线模式
+    IPC_CMD_SWITCH_ONLINE,          // player → asr_kws：切到在线模式
+    IPC_CMD_STREAM_TEXT_BEGIN,      // 打断当前播报，开始流式文本会话，body 为第一段文本（可为空）
+    IPC_CMD_STREAM_TEXT_APPEND,     // 向当前会话追加一段以标点结尾的文本；会话已被打断时丢弃
+    IPC_CMD_STREAM_TEXT_END,        // 文本已发完，播完剩余内容后上报 IPC_EVT_TTS_DONE
+
+    IPC_EVT_ASR_TEXT = 0x100,       // asr_kws → player：最终识别文本
+    IPC_EVT_ASR_TIMEOUT,            // asr_kws → player：唤醒后超时无识别结果
+    IPC_EVT_KWS_WAKE,               // asr_kws → player：唤醒，body 为唤醒词
+    IPC_EVT_TTS_START,              // tts → player：开始播报
+    IPC_EVT_TTS_DONE,               // tts → player：播报结束
+
+    IPC_REPLY_WAKE_RESPONSE = 0x200
 } IPCCommandType;
 
 #endif
@@ -1,14 +1,35 @@
 #define LOG_LEVEL 4
 #include "../../debug_log.h"
 #include "mysamplerate.h"
+#include "polyphase.h"
+#include <errno.h>
+#include <stdlib.h>
+
+#define TAG "RESAMPLER"
 
 static float *src_output_buf = NULL;
-static const int MAX_OUTPUT_FRAMES = PERIOD_SIZE * 3;
+static int src_output_capacity = 0;
 
-#define TAG "RESAMPLER"
+static PolyphaseResampler g_resampler;
+static int g_resampler_ready = 0;
+
+static int ensure_output_capacity(int input_frames)
+{
+    int out_cap = polyphase_max_output(&g_resampler, input_frames);
+    if (out_cap > src_output_capacity) {
+        float *out = (float *)realloc(src_output_buf, (size_t)out_cap * sizeof(float));
+        if (out == NULL) {
+            LOGE(TAG, "分配输出缓冲区失败（内存不足）");
+            return -1;
+        }
+        src_output_buf = out;
+        src_output_capacity = out_cap;
+    }
+    return 0;
+}
 
 int init_resampler(void)
-{   
+{
     if (g_actual_rate <= 0) {
         LOGE(TAG, "重采样初始化失败：g_actual_rate无效（%u），请检查ALSA初始化", g_actual_rate);
         return -1;
@@ -24,22 +45,29 @@ int init_resampler(void)
         return -1;
     }
 
-    src_output_buf = (float *)malloc(MAX_OUTPUT_FRAMES * sizeof(float));
-    if (src_output_buf == NULL) {
-        LOGE(TAG, "分配输出缓冲区失败（内存不足）");
+    if (polyphase_init(&g_resampler, g_actual_rate, MODEL_SAMPLE_RATE, PERIOD_SIZE) != 0) {
+        return -1;
+    }
+    g_resampler_ready = 1;
+    if (ensure_output_capacity(PERIOD_SIZE * 3) != 0) {
+        cleanup_resampler();
         return -1;
     }
 
     if (g_actual_rate == MODEL_SAMPLE_RATE) {
-        LOGI(TAG, "采样率匹配：%u Hz == %d Hz，无需重采样，仅做格式转换", g_actual_rate, MODEL_SAMPLE_RATE);
-    } else {
-        LOGI(TAG, "采样率不匹配：%u Hz → %d Hz，需要重采样", g_actual_rate, MODEL_SAMPLE_RATE);
+        LOGI(TAG, "采样率匹配：%u Hz == %d Hz，无需重采样，仅做格式转换（%s）",
+             g_actual_rate, MODEL_SAMPLE_RATE, polyphase_simd_name());
+        return 0;
     }
+    LOGI(TAG, "采样率不匹配：%u Hz → %d Hz，多相重采样 %d/%d，每相位 %d 抽头（%s）",
+         g_actual_rate, MODEL_SAMPLE_RATE, g_resampler.up, g_resampler.down, g_resampler.taps, polyphase_simd_name());
     return 0;
 }
 
 int resample_audio(const int16_t *input, int input_frames, float **output, int *output_frames)
 {
+    float *dst;
+
     if (input == NULL || output == NULL || output_frames == NULL) {
         LOGE(TAG, "重采样参数无效（空指针）");
         return -EINVAL;
@@ -49,26 +77,38 @@ int resample_audio(const int16_t *input, int input_frames, float **output, int *
         *output_frames = 0;
         return 0;
     }
+    if (!g_resampler_ready) {
+        LOGE(TAG, "重采样器未初始化");
+        return -1;
+    }
 
     if (g_actual_rate == MODEL_SAMPLE_RATE) {
-        for (int i = 0; i < input_frames * CHANNELS; i++) {
-            src_output_buf[i] = (float)input[i] / 32768.0f;
+        // 直通时直接转换到输出缓冲区，不经过重采样器
+        if (ensure_output_capacity(input_frames) != 0) {
+            return -1;
         }
+        pcm_s16_to_float(input, src_output_buf, input_frames * CHANNELS);
         *output = src_output_buf;
         *output_frames = input_frames;
-    } else {
-        LOGE(TAG, "采样率不匹配，暂不支持重采样");
-        return -1;
+        return 0;
     }
 
+    if (polyphase_reserve(&g_resampler, input_frames) != 0 || ensure_output_capacity(input_frames) != 0) {
+        return -1;
+    }
+    dst = polyphase_input(&g_resampler, input_frames);
+    pcm_s16_to_float(input, dst, input_frames);
+    *output = src_output_buf;
+    *output_frames = polyphase_run(&g_resampler, input_frames, src_output_buf);
     return 0;
 }
 
 void cleanup_resampler(void)
 {
-    if (src_output_buf != NULL) {
-        free(src_output_buf);
-        src_output_buf = NULL;
-    }
+    free(src_output_buf);
+    src_output_buf = NULL;
+    src_output_capacity = 0;
+    polyphase_free(&g_resampler);
+    g_resampler_ready = 0;
     LOGI(TAG, "重采样器资源清理完成");
 }
@@ -1,7 +1,6 @@
 #ifndef __MYSAMPLERATE_H__
 #define __MYSAMPLERATE_H__
 
-#include <samplerate.h>
 #include <stdint.h>
 #include "alsa.h"
 
@@ -9,6 +8,7 @@
 int init_resampler(void);
 
 // 2. 核心重采样函数：将ALSA的int16_t数据转换为模型所需的float数据
+// 采样率不同时做多相 sinc 重采样（如 44.1k/48k → 16k），跨调用保持滤波器历史，须按时间顺序连续送入
 // input：ALSA读取的int16_t原始数据
 // input_frames：输入数据帧数
 // output：输出float格式数据的指针（模块内分配，外部无需释放）
@@ -0,0 +1,390 @@
+#define LOG_LEVEL 4
+#include "../../debug_log.h"
+#include "polyphase.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define POLYPHASE_SIMD_NAME "NEON"
+#elif defined(__AVX__)
+#include <immintrin.h>
+#define POLYPHASE_SIMD_NAME "AVX"
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define POLYPHASE_SIMD_NAME "SSE2"
+#else
+#define POLYPHASE_SIMD_NAME "scalar"
+#endif
+
+#define TAG "POLYPHASE"
+
+/* in_rate→out_rate 约分为 L/M（如 48000→16000 为 1/3，22050→48000 为 320/147），
+ * 原型低通按 L 倍上采样设计，拆成 L 个相位，每个相位 taps 个系数，初始化时预先算好；
+ * 第 n 个输出对应输入位置 n*M/L，取整部分定位输入窗口，余数选相位，一次点积得到一个样本。 */
+#define POLYPHASE_ZERO_CROSSINGS    16      // 每侧 sinc 零点数，决定过渡带宽度
+#define POLYPHASE_ROLLOFF           0.90    // 截止频率相对较低一侧奈奎斯特频率的比例
+#define POLYPHASE_KAISER_BETA       8.6     // 阻带约 85dB
+#define POLYPHASE_TAP_ALIGN         8       // 每相位系数数对齐到 SIMD 宽度
+#define POLYPHASE_MAX_PHASES        1024
+#define POLYPHASE_MAX_TAPS          256
+
+const char *polyphase_simd_name(void)
+{
+    return POLYPHASE_SIMD_NAME;
+}
+
+void pcm_s16_to_float(const int16_t *in, float *out, int count)
+{
+    const float scale = 1.0f / 32768.0f;
+    int i = 0;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; i + 8 <= count; i += 8) {
+        int16x8_t v = vld1q_s16(in + i);
+        vst1q_f32(out + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(v))), scale));
+        vst1q_f32(out + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(v))), scale));
+    }
+#elif defined(__AVX2__)
+    const __m256 vscale = _mm256_set1_ps(scale);
+    for (; i + 8 <= count; i += 8) {
+        __m256i v = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i *)(in + i)));
+        _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), vscale));
+    }
+#elif defined(__SSE2__)
+    const __m128 vscale = _mm_set1_ps(scale);
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+        // 与自身交错后算术右移 16 位，即符号扩展到 32 位
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16);
+        _mm_storeu_ps(out + i, _mm_mul_ps(_mm_cvtepi32_ps(lo), vscale));
+        _mm_storeu_ps(out + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(hi), vscale));
+    }
+#endif
+    for (; i < count; i++) {
+        out[i] = (float)in[i] * scale;
+    }
+}
+
+void pcm_float_to_s16_stereo(const float *in, int16_t *out, int count)
+{
+    int i = 0;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    const float32x4_t vmin = vdupq_n_f32(-1.0f);
+    const float32x4_t vmax = vdupq_n_f32(1.0f);
+    for (; i + 8 <= count; i += 8) {
+        float32x4_t a = vminq_f32(vmaxq_f32(vld1q_f32(in + i), vmin), vmax);
+        float32x4_t b = vminq_f32(vmaxq_f32(vld1q_f32(in + i + 4), vmin), vmax);
+        int16x8_t v = vcombine_s16(vmovn_s32(vcvtq_s32_f32(vmulq_n_f32(a, 32767.0f))),
+                                   vmovn_s32(vcvtq_s32_f32(vmulq_n_f32(b, 32767.0f))));
+        int16x8x2_t lr;
+        lr.val[0] = v;
+        lr.val[1] = v;
+        vst2q_s16(out + i * 2, lr);
+    }
+#elif defined(__SSE2__)
+    const __m128 vmin = _mm_set1_ps(-1.0f);
+    const __m128 vmax = _mm_set1_ps(1.0f);
+    const __m128 vscale = _mm_set1_ps(32767.0f);
+    for (; i + 8 <= count; i += 8) {
+        __m128 a = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i), vmin), vmax);
+        __m128 b = _mm_min_ps(_mm_max_ps(_mm_loadu_ps(in + i + 4), vmin), vmax);
+        // 截断取整，与标量 (int16_t)(t * 32767) 一致
+        __m128i v = _mm_packs_epi32(_mm_cvttps_epi32(_mm_mul_ps(a, vscale)),
+                                    _mm_cvttps_epi32(_mm_mul_ps(b, vscale)));
+        _mm_storeu_si128((__m128i *)(out + i * 2), _mm_unpacklo_epi16(v, v));
+        _mm_storeu_si128((__m128i *)(out + i * 2 + 8), _mm_unpackhi_epi16(v, v));
+    }
+#endif
+    for (; i < count; i++) {
+        float t = in[i];
+        int16_t v;
+        if (t < -1.0f) t = -1.0f; else if (t > 1.0f) t = 1.0f;
+        v = (int16_t)(t * 32767);
+        out[i * 2] = v;
+        out[i * 2 + 1] = v;
+    }
+}
+
+void pcm_s16_to_stereo(const int16_t *in, int16_t *out, int count)
+{
+    int i = 0;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    for (; i + 8 <= count; i += 8) {
+        int16x8x2_t lr;
+        lr.val[0] = vld1q_s16(in + i);
+        lr.val[1] = lr.val[0];
+        vst2q_s16(out + i * 2, lr);
+    }
+#elif defined(__SSE2__)
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(in + i));
+        _mm_storeu_si128((__m128i *)(out + i * 2), _mm_unpacklo_epi16(v, v));
+        _mm_storeu_si128((__m128i *)(out + i * 2 + 8), _mm_unpackhi_epi16(v, v));
+    }
+#endif
+    for (; i < count; i++) {
+        out[i * 2] = in[i];
+        out[i * 2 + 1] = in[i];
+    }
+}
+
+// n 为 POLYPHASE_TAP_ALIGN 的整数倍
+static float dot_product(const float *a, const float *b, int n)
+{
+    int i;
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+    float32x4_t acc0 = vdupq_n_f32(0.0f);
+    float32x4_t acc1 = vdupq_n_f32(0.0f);
+    for (i = 0; i < n; i += 8) {
+#if defined(__aarch64__)
+        acc0 = vfmaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vfmaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+#else
+        acc0 = vmlaq_f32(acc0, vld1q_f32(a + i), vld1q_f32(b + i));
+        acc1 = vmlaq_f32(acc1, vld1q_f32(a + i + 4), vld1q_f32(b + i + 4));
+#endif
+    }
+    acc0 = vaddq_f32(acc0, acc1);
+#if defined(__aarch64__)
+    return vaddvq_f32(acc0);
+#else
+    {
+        float32x2_t s = vadd_f32(vget_low_f32(acc0), vget_high_f32(acc0));
+        return vget_lane_f32(vpadd_f32(s, s), 0);
+    }
+#endif
+#elif defined(__AVX__)
+    __m256 acc = _mm256_setzero_ps();
+    __m128 s;
+    for (i = 0; i < n; i += 8) {
+        acc = _mm256_add_ps(acc, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    s = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+#elif defined(__SSE2__)
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    for (i = 0; i < n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    acc0 = _mm_add_ps(acc0, acc1);
+    acc0 = _mm_add_ps(acc0, _mm_movehl_ps(acc0, acc0));
+    acc0 = _mm_add_ss(acc0, _mm_shuffle_ps(acc0, acc0, 1));
+    return _mm_cvtss_f32(acc0);
+#else
+    float sum = 0.0f;
+    for (i = 0; i < n; i++) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+#endif
+}
+
+static unsigned int gcd_u(unsigned int a, unsigned int b)
+{
+    while (b != 0) {
+        unsigned int t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// 零阶修正贝塞尔函数（Kaiser 窗）
+static double bessel_i0(double x)
+{
+    double sum = 1.0;
+    double term = 1.0;
+    double half = x / 2.0;
+    int k;
+    for (k = 1; k < 50; k++) {
+        term *= (half / k) * (half / k);
+        sum += term;
+        if (term < sum * 1e-12) {
+            break;
+        }
+    }
+    return sum;
+}
+
+static int build_filter_bank(PolyphaseResampler *rs)
+{
+    // 截止频率（以 L 倍上采样后的采样率归一化，1.0 为奈奎斯特），取输入、输出中较低的奈奎斯特频率
+    double cutoff = POLYPHASE_ROLLOFF / (double)(rs->up > rs->down ? rs->up : rs->down);
+    double span = (double)POLYPHASE_ZERO_CROSSINGS * 2.0 / cutoff;  // 原型长度（上采样率下的样本数）
+    int taps = (int)ceil(span / rs->up);
+    double center;
+    double i0_beta = bessel_i0(POLYPHASE_KAISER_BETA);
+    int length;
+    int p;
+    int k;
+
+    taps = (taps + POLYPHASE_TAP_ALIGN - 1) / POLYPHASE_TAP_ALIGN * POLYPHASE_TAP_ALIGN;
+    if (taps > POLYPHASE_MAX_TAPS) {
+        LOGE(TAG, "重采样滤波器过长（%d 抽头/相位）", taps);
+        return -1;
+    }
+    length = taps * rs->up;
+    center = (length - 1) / 2.0;
+
+    rs->bank = (float *)malloc((size_t)length * sizeof(float));
+    if (rs->bank == NULL) {
+        LOGE(TAG, "分配重采样滤波器组失败（内存不足）");
+        return -1;
+    }
+    for (p = 0; p < rs->up; p++) {
+        for (k = 0; k < taps; k++) {
+            // 原型第 j 个系数作用于窗口内倒数第 k 个输入；行内反序存放，点积时与输入同向
+            int j = p + k * rs->up;
+            double t = j - center;
+            double r = t / center;
+            double x = M_PI * cutoff * t;
+            double sinc = (fabs(t) < 1e-9) ? 1.0 : sin(x) / x;
+            double w = (fabs(r) <= 1.0) ? bessel_i0(POLYPHASE_KAISER_BETA * sqrt(1.0 - r * r)) / i0_beta : 0.0;
+            rs->bank[(size_t)p * taps + (taps - 1 - k)] = (float)(cutoff * rs->up * sinc * w);
+        }
+    }
+    rs->taps = taps;
+    return 0;
+}
+
+int polyphase_init(PolyphaseResampler *rs, unsigned int in_rate, unsigned int out_rate, int max_input_frames)
+{
+    unsigned int g;
+
+    memset(rs, 0, sizeof(*rs));
+    rs->up = 1;
+    rs->down = 1;
+    if (in_rate == 0 || out_rate == 0) {
+        LOGE(TAG, "重采样初始化失败：采样率无效（%u → %u）", in_rate, out_rate);
+        return -1;
+    }
+    rs->in_rate = in_rate;
+    rs->out_rate = out_rate;
+    if (in_rate != out_rate) {
+        g = gcd_u(in_rate, out_rate);
+        rs->up = (int)(out_rate / g);
+        rs->down = (int)(in_rate / g);
+        if (rs->up > POLYPHASE_MAX_PHASES) {
+            LOGE(TAG, "采样率 %u Hz → %u Hz 的比例 %d/%d 过于复杂，暂不支持", in_rate, out_rate, rs->up, rs->down);
+            polyphase_free(rs);
+            return -1;
+        }
+        if (build_filter_bank(rs) != 0) {
+            polyphase_free(rs);
+            return -1;
+        }
+    }
+    if (polyphase_reserve(rs, max_input_frames) != 0) {
+        polyphase_free(rs);
+        return -1;
+    }
+    polyphase_reset(rs);
+    return 0;
+}
+
+int polyphase_reserve(PolyphaseResampler *rs, int max_input_frames)
+{
+    int history = rs->taps > 0 ? rs->taps - 1 : 0;
+    float *work;
+
+    if (max_input_frames <= rs->work_capacity) {
+        return 0;
+    }
+    work = (float *)realloc(rs->work, (size_t)(history + max_input_frames) * sizeof(float));
+    if (work == NULL) {
+        LOGE(TAG, "分配重采样输入缓冲区失败（内存不足）");
+        return -1;
+    }
+    if (rs->work == NULL) {
+        memset(work, 0, (size_t)history * sizeof(float));
+    }
+    rs->work = work;
+    rs->work_capacity = max_input_frames;
+    return 0;
+}
+
+void polyphase_reset(PolyphaseResampler *rs)
+{
+    int history = rs->taps > 0 ? rs->taps - 1 : 0;
+    if (rs->work != NULL) {
+        memset(rs->work, 0, (size_t)history * sizeof(float));
+    }
+    rs->next_index = history;
+    rs->next_phase = 0;
+}
+
+void polyphase_free(PolyphaseResampler *rs)
+{
+    free(rs->bank);
+    free(rs->work);
+    memset(rs, 0, sizeof(*rs));
+    rs->up = 1;
+    rs->down = 1;
+}
+
+int polyphase_max_output(const PolyphaseResampler *rs, int input_frames)
+{
+    if (rs->taps == 0) {
+        return input_frames;
+    }
+    return (int)((int64_t)input_frames * rs->up / rs->down) + 2;
+}
+
+float *polyphase_input(PolyphaseResampler *rs, int frames)
+{
+    if (rs->work == NULL || frames > rs->work_capacity) {
+        return NULL;
+    }
+    return rs->work + (rs->taps > 0 ? rs->taps - 1 : 0);
+}
+
+int polyphase_run(PolyphaseResampler *rs, int frames, float *output)
+{
+    int history;
+    int end;
+    int n = 0;
+    int idx;
+    int phase;
+
+    if (frames <= 0) {
+        return 0;
+    }
+    if (rs->taps == 0) {
+        memcpy(output, rs->work, (size_t)frames * sizeof(float));
+        return frames;
+    }
+
+    history = rs->taps - 1;
+    end = history + frames;
+    idx = rs->next_index;
+    phase = rs->next_phase;
+    while (idx < end) {
+        output[n++] = dot_product(rs->bank + (size_t)phase * rs->taps, rs->work + idx - history, rs->taps);
+        phase += rs->down;
+        idx += phase / rs->up;
+        phase %= rs->up;
+    }
+
+    // 末尾 taps-1 个样本留作下一次的历史
+    memmove(rs->work, rs->work + frames, (size_t)history * sizeof(float));
+    rs->next_index = idx - frames;
+    rs->next_phase = phase;
+    return n;
+}
+
+int polyphase_process(PolyphaseResampler *rs, const float *input, int frames, float *output)
+{
+    float *dst = polyphase_input(rs, frames);
+    if (dst == NULL) {
+        LOGE(TAG, "输入帧数 %d 超出缓冲区容量 %d", frames, rs->work_capacity);
+        return -1;
+    }
+    memcpy(dst, input, (size_t)frames * sizeof(float));
+    return polyphase_run(rs, frames, output);
+}
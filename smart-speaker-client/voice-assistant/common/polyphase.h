@@ -0,0 +1,50 @@
+#ifndef __POLYPHASE_H__
+#define __POLYPHASE_H__
+
+#include <stdint.h>
+
+/* 多相加窗 sinc 重采样器与 PCM 格式转换内核（NEON/AVX/SSE2/标量），录音（mysamplerate）与 TTS 播放共用。
+ * 重采样器按实例保存滤波器组和跨调用的历史样本，缓冲区在 init/reserve 时一次分配，process 不再分配内存。 */
+
+typedef struct {
+    unsigned int in_rate;
+    unsigned int out_rate;
+    int up;                 // L：约分后的上采样倍数
+    int down;               // M：约分后的下采样倍数
+    int taps;               // 每个相位的系数数，采样率相同时为 0（直通）
+    float *bank;            // [L][taps]，每行系数已反序，与输入窗口顺序点积
+    float *work;            // 前 taps-1 个为历史样本，之后是本次输入
+    int work_capacity;      // 单次可送入的最大输入帧数
+    int next_index;         // 下一个输出对应窗口最后一个输入样本在 work 中的下标
+    int next_phase;
+} PolyphaseResampler;
+
+// 构建 in_rate→out_rate 的滤波器组，预留单次 max_input_frames 帧的输入空间；成功返回 0
+int polyphase_init(PolyphaseResampler *rs, unsigned int in_rate, unsigned int out_rate, int max_input_frames);
+// 扩大单次输入容量（只增不减），成功返回 0
+int polyphase_reserve(PolyphaseResampler *rs, int max_input_frames);
+// 清空历史样本，用于开始一段新的、与之前不连续的音频
+void polyphase_reset(PolyphaseResampler *rs);
+void polyphase_free(PolyphaseResampler *rs);
+
+// input_frames 帧输入最多产生的输出帧数
+int polyphase_max_output(const PolyphaseResampler *rs, int input_frames);
+
+// 返回可直接写入 frames 帧输入的位置（省去一次拷贝），写完后调用 polyphase_run；超出容量返回 NULL
+float *polyphase_input(PolyphaseResampler *rs, int frames);
+// 处理 polyphase_input 写入的 frames 帧，返回输出帧数；output 至少 polyphase_max_output(frames) 个
+int polyphase_run(PolyphaseResampler *rs, int frames, float *output);
+// 等价于 polyphase_input + 拷贝 + polyphase_run；失败返回 -1
+int polyphase_process(PolyphaseResampler *rs, const float *input, int frames, float *output);
+
+// int16 → float（除以 32768）
+void pcm_s16_to_float(const int16_t *in, float *out, int count);
+// float 限幅到 [-1, 1] 后乘 32767 转 int16，单声道复制成左右交错的双声道；out 为 2*count 个
+void pcm_float_to_s16_stereo(const float *in, int16_t *out, int count);
+// int16 单声道复制成左右交错的双声道
+void pcm_s16_to_stereo(const int16_t *in, int16_t *out, int count);
+
+// 当前编译选用的 SIMD 路径名称
+const char *polyphase_simd_name(void);
+
+#endif
@@ -0,0 +1,196 @@
+#define LOG_LEVEL 2
+#include "../../../debug_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../../common/alsa.h"
+#include "../sherpa_kws.h"
+#include "../../main_asr_kws/audio_capture.h"
+#include "../../main_asr_kws/kws_worker.h"
+
+#define TAG "WAKE-BENCH"
+
+/* 唤醒延迟基准：把 WAV 按 ALSA 周期、以实时速度写入采集环形缓冲区，由 KWS 线程检测，
+ * 统计每次唤醒回调相对「触发检测的那段音频进入缓冲区」的延迟，即主流程中唤醒到通知 player 压低音乐的耗时。
+ * 文件之间插入静音，-l N 另起 N 个忙等线程模拟主线程 ASR 解码占用 CPU。
+ * 用法：./wake_bench [-l N] a.wav [b.wav ...]（各文件采样率一致，单声道） */
+
+#define BENCH_GAP_MS        1000
+#define BENCH_MAX_WAKES     256
+
+typedef struct {
+    char keyword[64];
+    uint64_t frame;
+    double at_ms;
+} WakeRecord;
+
+static double g_t0_ms;
+static WakeRecord g_wakes[BENCH_MAX_WAKES];
+static atomic_int g_wake_count = 0;
+static atomic_int g_load_running = 0;
+
+static double now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+static void on_wake(const char *keyword, uint64_t capture_frame)
+{
+    int n = atomic_load(&g_wake_count);
+    if (n >= BENCH_MAX_WAKES) {
+        return;
+    }
+    g_wakes[n].at_ms = now_ms();
+    g_wakes[n].frame = capture_frame;
+    snprintf(g_wakes[n].keyword, sizeof(g_wakes[n].keyword), "%s", keyword);
+    atomic_store(&g_wake_count, n + 1);
+}
+
+static void *load_thread(void *arg)
+{
+    volatile double x = 1.0;
+    (void)arg;
+    while (atomic_load_explicit(&g_load_running, memory_order_relaxed)) {
+        x = x * 1.0000001 + 0.0000001;
+    }
+    return NULL;
+}
+
+// 以实时速度写入 n 帧：第 k 帧在 g_t0_ms + k/rate 之后才可见，与 ALSA 周期读取一致
+static void feed_realtime(const int16_t *pcm, uint64_t *fed, uint64_t n)
+{
+    uint64_t pos = 0;
+    while (pos < n) {
+        uint32_t count = (n - pos < PERIOD_SIZE) ? (uint32_t)(n - pos) : PERIOD_SIZE;
+        double due = g_t0_ms + (double)(*fed + count) * 1000.0 / g_actual_rate;
+        double wait = due - now_ms();
+        if (wait > 0) {
+            usleep((useconds_t)(wait * 1000.0));
+        }
+        audio_capture_feed(pcm + pos, count);
+        // 与主循环不在识别时一样让 ASR 读端跟上，否则缓冲区满后 KWS 也会丢数据
+        audio_capture_keep_preroll(CAPTURE_READER_ASR, 0);
+        pos += count;
+        *fed += count;
+    }
+}
+
+int main(int argc, char const *argv[])
+{
+    const SherpaOnnxWave *waves[64];
+    const char *names[64];
+    uint64_t starts[64];
+    pthread_t loads[16];
+    int16_t *pcm;
+    int16_t *silence;
+    uint64_t fed = 0;
+    uint64_t gap;
+    int num_loads = 0;
+    int num_waves = 0;
+    int first = 1;
+    int i;
+    int n;
+    double sum = 0.0;
+    double lo = 1e9;
+    double hi = 0.0;
+
+    if (argc > 2 && strcmp(argv[1], "-l") == 0) {
+        num_loads = atoi(argv[2]);
+        num_loads = num_loads < 0 ? 0 : (num_loads > 16 ? 16 : num_loads);
+        first = 3;
+    }
+    if (first >= argc) {
+        printf("usage: %s [-l N] a.wav [b.wav ...]\n", argv[0]);
+        return 1;
+    }
+    for (i = first; i < argc && num_waves < 64; ++i) {
+        const SherpaOnnxWave *w = SherpaOnnxReadWave(argv[i]);
+        if (w == NULL) {
+            LOGW(TAG, "读取失败: %s", argv[i]);
+            continue;
+        }
+        if (num_waves > 0 && w->sample_rate != waves[0]->sample_rate) {
+            LOGW(TAG, "%s 采样率 %d 与第一个文件不一致，跳过", argv[i], w->sample_rate);
+            SherpaOnnxFreeWave(w);
+            continue;
+        }
+        names[num_waves] = argv[i];
+        waves[num_waves++] = w;
+    }
+    if (num_waves == 0) {
+        return 1;
+    }
+
+    g_actual_rate = (unsigned int)waves[0]->sample_rate;
+    gap = (uint64_t)g_actual_rate * BENCH_GAP_MS / 1000;
+    if (init_sherpa_kws() != 0) {
+        LOGE(TAG, "初始化KWS模型失败");
+        return -1;
+    }
+    if (audio_capture_start_feed() != 0 || kws_worker_start(on_wake) != 0) {
+        return -1;
+    }
+    atomic_store(&g_load_running, 1);
+    for (i = 0; i < num_loads; ++i) {
+        pthread_create(&loads[i], NULL, load_thread, NULL);
+    }
+
+    silence = (int16_t *)calloc(gap, sizeof(int16_t));
+    g_t0_ms = now_ms();
+    for (i = 0; i < num_waves; ++i) {
+        int32_t k;
+        pcm = (int16_t *)malloc((size_t)waves[i]->num_samples * sizeof(int16_t));
+        for (k = 0; k < waves[i]->num_samples; ++k) {
+            float v = waves[i]->samples[k];
+            v = v < -1.0f ? -1.0f : (v > 1.0f ? 1.0f : v);
+            pcm[k] = (int16_t)(v * 32767);
+        }
+        starts[i] = fed;
+        feed_realtime(pcm, &fed, (uint64_t)waves[i]->num_samples);
+        feed_realtime(silence, &fed, gap);
+        free(pcm);
+    }
+    // 留出最后一个周期的解码时间
+    usleep(500 * 1000);
+
+    atomic_store(&g_load_running, 0);
+    for (i = 0; i < num_loads; ++i) {
+        pthread_join(loads[i], NULL);
+    }
+    kws_worker_stop();
+    audio_capture_stop();
+    cleanup_sherpa_kws();
+
+    n = atomic_load(&g_wake_count);
+    printf("%-28s %10s %12s  %s\n", "file", "at_sec", "latency_ms", "keyword");
+    for (i = 0; i < n; ++i) {
+        int f = 0;
+        double lat = g_wakes[i].at_ms - (g_t0_ms + (double)g_wakes[i].frame * 1000.0 / g_actual_rate);
+        while (f + 1 < num_waves && g_wakes[i].frame > starts[f + 1]) {
+            f++;
+        }
+        printf("%-28s %10.2f %12.1f  %s\n", names[f],
+               (double)(g_wakes[i].frame - starts[f]) / g_actual_rate, lat, g_wakes[i].keyword);
+        sum += lat;
+        lo = lat < lo ? lat : lo;
+        hi = lat > hi ? lat : hi;
+    }
+    printf("wakes=%d files=%d load_threads=%d", n, num_waves, num_loads);
+    if (n > 0) {
+        printf(" latency_ms min=%.1f avg=%.1f max=%.1f", lo, sum / n, hi);
+    }
+    printf("\n");
+
+    free(silence);
+    for (i = 0; i < num_waves; ++i) {
+        SherpaOnnxFreeWave(waves[i]);
+    }
+    return 0;
+}
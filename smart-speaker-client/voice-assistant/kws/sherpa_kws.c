@@ -2,6 +2,7 @@
 #define LOG_LEVEL 4
 #include "../../debug_log.h"
 #include "sherpa_kws.h"
+#include "../common/infer_config.h"
 #include <unistd.h>
 #include <string.h>
 
@@ -39,12 +40,15 @@ int init_sherpa_kws(void)
         MODEL_PREFIX "/model/kws/sherpa-onnx-kws-zipformer-zh-en-3M-2025-12-20/tokens.txt";
 
     config.model_config.provider = "cpu";
-    config.model_config.num_threads = 4;
+    // KWS 线程与 ASR 解码并发运行，线程数和核见 client.toml 的 kws_threads / kws_cpus
+    config.model_config.num_threads = infer_num_threads(INFER_KWS);
     config.model_config.debug = 0;
 
     config.keywords_file = KEYWORDS_FILE;
 
+    infer_affinity_enter(INFER_KWS);
     g_kws_spotter = SherpaOnnxCreateKeywordSpotter(&config);
+    infer_affinity_leave();
     if (!g_kws_spotter) {
       LOGE(TAG, "SherpaOnnxCreateKeywordSpotter 创建kws识别器失败");
       return -1;
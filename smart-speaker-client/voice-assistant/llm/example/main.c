@@ -17,6 +17,13 @@ void sigint_handler(int sig) {
     running = 0;
 }
 
+// 流式增量直接打到终端，观察首字延迟
+static int print_delta(const char *delta, void *arg) {
+    fputs(delta, stdout);
+    fflush(stdout);
+    return running ? 0 : 1;
+}
+
 int main(int argc, char const *argv[]) {
     if (signal(SIGINT, sigint_handler) == SIG_ERR) {
         LOGE(TAG, "注册信号处理失败");
@@ -25,8 +32,9 @@ int main(int argc, char const *argv[]) {
 
     LOGI(TAG, "=== LLM 独立测试启动 ===");
 
-    if (argc != 2) {
-        LOGE(TAG, "用法: %s <你的问题>", argv[0]);
+    // 多个问题依次在同一条长连接上请求
+    if (argc < 2) {
+        LOGE(TAG, "用法: %s <你的问题> [更多问题...]", argv[0]);
         return -1;
     }
 
@@ -37,14 +45,16 @@ int main(int argc, char const *argv[]) {
     LOGI(TAG, "LLM 初始化完成");
 
     char response[MAX_RESPONSE_LEN] = {0};
-    if (generate_llm_response(argv[1], response, sizeof(response)) != 0) {
-        LOGE(TAG, "生成响应失败");
-        cleanup_llm();
-        return -1;
+    for (int i = 1; i < argc && running; i++) {
+        if (query_llm_stream(argv[i], print_delta, NULL, response, sizeof(response)) != 0) {
+            LOGE(TAG, "生成响应失败");
+            cleanup_llm();
+            return -1;
+        }
+        putchar('\n');
+        LOGI(TAG, "LLM 回复: %s", response);
     }
 
-    LOGI(TAG, "LLM 回复: %s", response);
-
     cleanup_llm();
 
     LOGI(TAG, "LLM 测试程序退出");
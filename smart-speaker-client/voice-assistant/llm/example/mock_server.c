@@ -0,0 +1,153 @@
+#define _GNU_SOURCE
+#define LOG_LEVEL 4
+#include "../../../debug_log.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <signal.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+#define TAG "LLM-MOCK"
+
+/* 本地 OpenAI 兼容接口桩，用于不连外网测试 llm.c：
+ * 以 chunked SSE 逐字返回固定回复，长连接上可连续处理多个请求。
+ * 用法：./mock_server [端口] [-j 返回普通 JSON] [-c 每次响应后关闭连接] [-d 每段间隔 ms]
+ * 配合：LLM_ENDPOINT=http://127.0.0.1:端口/v1/chat/completions ./llm_test "问题" */
+
+#define DEFAULT_PORT 18080
+static const char *s_pieces[] = { "今天", "天气", "晴，", "最高", "二十", "五度。", "出门", "记得", "防晒。" };
+
+static int write_all(int fd, const char *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, buf, len, MSG_NOSIGNAL);
+        if (n <= 0) return -1;
+        buf += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static int send_chunk(int fd, const char *data) {
+    char head[32];
+    snprintf(head, sizeof(head), "%zx\r\n", strlen(data));
+    if (write_all(fd, head, strlen(head)) != 0) return -1;
+    if (write_all(fd, data, strlen(data)) != 0) return -1;
+    return write_all(fd, "\r\n", 2);
+}
+
+// 读完一个请求（请求头 + Content-Length 指定的请求体），返回 0；对端关闭返回 -1
+static int read_request(int fd) {
+    static char buf[65536];
+    size_t len = 0;
+    long body_len = 0;
+    char *end;
+
+    for (;;) {
+        ssize_t n = recv(fd, buf + len, sizeof(buf) - 1 - len, 0);
+        if (n <= 0) return -1;
+        len += (size_t)n;
+        buf[len] = '\0';
+        if ((end = strstr(buf, "\r\n\r\n")) != NULL) break;
+        if (len >= sizeof(buf) - 1) return -1;
+    }
+    {
+        char *cl = strcasestr(buf, "Content-Length:");
+        if (cl != NULL && cl < end) body_len = atol(cl + 15);
+    }
+    end += 4;
+    while ((long)(len - (size_t)(end - buf)) < body_len) {
+        ssize_t n = recv(fd, buf + len, sizeof(buf) - 1 - len, 0);
+        if (n <= 0) return -1;
+        len += (size_t)n;
+        buf[len] = '\0';
+    }
+    LOGI(TAG, "请求体: %.*s", (int)body_len, end);
+    return 0;
+}
+
+static int respond_sse(int fd, int close_after, int delay_ms) {
+    char head[256];
+    char event[512];
+    size_t i;
+
+    snprintf(head, sizeof(head),
+             "HTTP/1.1 200 OK\r\nContent-Type: text/event-stream\r\nTransfer-Encoding: chunked\r\n"
+             "Connection: %s\r\n\r\n", close_after ? "close" : "keep-alive");
+    if (write_all(fd, head, strlen(head)) != 0) return -1;
+    for (i = 0; i < sizeof(s_pieces) / sizeof(s_pieces[0]); i++) {
+        snprintf(event, sizeof(event),
+                 "data: {\"choices\":[{\"index\":0,\"delta\":{\"content\":\"%s\"}}]}\n\n", s_pieces[i]);
+        if (send_chunk(fd, event) != 0) return -1;
+        usleep((useconds_t)delay_ms * 1000);
+    }
+    if (send_chunk(fd, "data: [DONE]\n\n") != 0) return -1;
+    return send_chunk(fd, "");
+}
+
+static int respond_json(int fd, int close_after) {
+    char body[1024];
+    char head[256];
+    size_t i;
+    size_t n;
+
+    n = (size_t)snprintf(body, sizeof(body), "{\"choices\":[{\"index\":0,\"message\":{\"role\":\"assistant\",\"content\":\"");
+    for (i = 0; i < sizeof(s_pieces) / sizeof(s_pieces[0]); i++) {
+        n += (size_t)snprintf(body + n, sizeof(body) - n, "%s", s_pieces[i]);
+    }
+    n += (size_t)snprintf(body + n, sizeof(body) - n, "\"}}]}");
+    snprintf(head, sizeof(head),
+             "HTTP/1.1 200 OK\r\nContent-Type: application/json\r\nContent-Length: %zu\r\nConnection: %s\r\n\r\n",
+             n, close_after ? "close" : "keep-alive");
+    if (write_all(fd, head, strlen(head)) != 0) return -1;
+    return write_all(fd, body, n);
+}
+
+int main(int argc, char const *argv[]) {
+    struct sockaddr_in addr;
+    int port = DEFAULT_PORT;
+    int json_mode = 0;
+    int close_after = 0;
+    int delay_ms = 50;
+    int listen_fd;
+    int one = 1;
+    int i;
+
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-j") == 0) json_mode = 1;
+        else if (strcmp(argv[i], "-c") == 0) close_after = 1;
+        else if (strcmp(argv[i], "-d") == 0 && i + 1 < argc) delay_ms = atoi(argv[++i]);
+        else port = atoi(argv[i]);
+    }
+    signal(SIGPIPE, SIG_IGN);
+
+    listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons((uint16_t)port);
+    if (bind(listen_fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(listen_fd, 4) != 0) {
+        LOGE(TAG, "监听 127.0.0.1:%d 失败", port);
+        return -1;
+    }
+    LOGI(TAG, "监听 127.0.0.1:%d（%s%s）", port, json_mode ? "JSON" : "SSE", close_after ? "，短连接" : "");
+
+    for (;;) {
+        int fd = accept(listen_fd, NULL, NULL);
+        int served = 0;
+        if (fd < 0) continue;
+        LOGI(TAG, "新连接");
+        while (read_request(fd) == 0) {
+            int ret = json_mode ? respond_json(fd, close_after) : respond_sse(fd, close_after, delay_ms);
+            served++;
+            if (ret != 0 || close_after) break;
+        }
+        LOGI(TAG, "连接关闭，共处理 %d 个请求", served);
+        close(fd);
+    }
+    return 0;
+}
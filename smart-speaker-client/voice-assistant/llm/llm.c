@@ -4,53 +4,571 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
 #include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
 #include <json-c/json.h>
+#include <openssl/err.h>
+#include <openssl/ssl.h>
 
 #define TAG "LLM"
 
+/* 进程内 OpenAI 兼容客户端：HTTP/1.1 长连接（https 走 OpenSSL，重连时复用 TLS 会话），
+ * 请求带 "stream": true，按 SSE 逐行解析 choices[0].delta.content 并回调；
+ * 服务端不支持流式时按普通 JSON 响应解析。配置读自 llm_config.sh 的 export 行，同名环境变量优先。 */
 #ifdef KWS_TEST_MODE
-#define MODEL_PREFIX "../../3rdparty"
-#define LLM_SCRIPT_PATH "../../llm.sh"
-#elif defined(PROCESS_MODE)
-#define MODEL_PREFIX "./3rdparty"
-#define LLM_SCRIPT_PATH "./voice-assistant/llm.sh"
+#define LLM_CONFIG_PATH "../llm_config.sh"
 #else
-#define MODEL_PREFIX "../3rdparty"
-#define LLM_SCRIPT_PATH "./llm.sh"
+#define LLM_CONFIG_PATH "./voice-assistant/llm/llm_config.sh"
 #endif
-#define MAX_COMMAND_LEN 1024
+
+#define LLM_DEFAULT_ENDPOINT            "https://dashscope.aliyuncs.com/compatible-mode/v1/chat/completions"
+#define LLM_DEFAULT_MODEL               "qwen-plus"
+#define LLM_DEFAULT_CONNECT_TIMEOUT_MS  3000    // 建连 + TLS 握手
+#define LLM_DEFAULT_IDLE_TIMEOUT_MS     8000    // 两次收到数据之间的最长间隔（含首字节）
+#define LLM_DEFAULT_TIMEOUT_MS          30000   // 整个请求的上限
+#define LLM_IO_BUF_SIZE                 8192
+#define LLM_MAX_LINE_LEN                16384   // 响应头、chunk 长度行、SSE 单行
+#define LLM_MAX_JSON_BODY               (64 * 1024)
 #define MAX_RESPONSE_LEN 4096
 
 typedef enum {
     ERR_OK = 0,
     ERR_INVALID_ARGS,
-    ERR_POPEN_FAILED,
+    ERR_CONNECT_FAILED,
+    ERR_REQUEST_FAILED,
+    ERR_HTTP_STATUS,
     ERR_JSON_PARSE_FAILED,
     ERR_NO_CHOICES,
     ERR_NO_MESSAGE,
-    ERR_NO_CONTENT
+    ERR_NO_CONTENT,
+    ERR_ABORTED
 } ErrorCode;
 
-static const char *json_payload_start(const char *s)
-{
-    const char *p = strchr(s, '{');
-    return (p != NULL) ? p : s;
-}
+typedef struct {
+    char endpoint[512];
+    char api_key[256];
+    char model[64];
+    char *system_prompt;
+    int connect_timeout_ms;
+    int idle_timeout_ms;
+    int timeout_ms;
+    int tls_verify;
+    // 由 endpoint 解析
+    int tls;
+    char host[256];
+    char port[8];
+    char path[256];
+} LlmConfig;
+
+typedef struct {
+    int fd;
+    SSL *ssl;
+    SSL_SESSION *session;       // 最近收到的会话票据（on_new_session 保存），重连时恢复，省去完整握手
+    char rbuf[LLM_IO_BUF_SIZE];
+    size_t rpos;
+    size_t rlen;
+    struct timespec deadline;   // 当前请求的截止时间
+    int requests;               // 本连接已完成的请求数
+} LlmConn;
+
+typedef struct {
+    int status;
+    int chunked;
+    long content_length;        // -1 表示读到连接关闭
+    int keep_alive;
+    int event_stream;
+    long chunk_left;
+    int done;
+} HttpBody;
+
+static pthread_mutex_t g_llm_mutex = PTHREAD_MUTEX_INITIALIZER;
+static LlmConfig g_cfg;
+static int g_cfg_loaded = 0;
+static SSL_CTX *g_ssl_ctx = NULL;
+static LlmConn g_conn = { .fd = -1 };
 
 static const char* get_error_message(ErrorCode code) {
     switch (code) {
         case ERR_OK: return "成功";
         case ERR_INVALID_ARGS: return "参数无效";
-        case ERR_POPEN_FAILED: return "执行命令失败";
+        case ERR_CONNECT_FAILED: return "连接服务器失败";
+        case ERR_REQUEST_FAILED: return "请求失败或超时";
+        case ERR_HTTP_STATUS: return "服务器返回错误状态";
         case ERR_JSON_PARSE_FAILED: return "JSON解析失败";
         case ERR_NO_CHOICES: return "未找到choices字段";
         case ERR_NO_MESSAGE: return "未找到message字段";
         case ERR_NO_CONTENT: return "未找到content字段";
+        case ERR_ABORTED: return "调用方中止";
         default: return "未知错误";
     }
 }
 
+/* ---------- 配置 ---------- */
+
+// 解析 `export KEY="value"` / `KEY=value`，value 写入 out
+static int config_line_value(const char *line, const char *key, char *out, size_t out_size) {
+    const char *p = line;
+    size_t klen = strlen(key);
+    size_t n = 0;
+    char quote = 0;
+
+    while (*p == ' ' || *p == '\t') p++;
+    if (strncmp(p, "export ", 7) == 0) p += 7;
+    while (*p == ' ' || *p == '\t') p++;
+    if (strncmp(p, key, klen) != 0 || p[klen] != '=') return -1;
+    p += klen + 1;
+    if (*p == '"' || *p == '\'') quote = *p++;
+    while (*p != '\0' && *p != '\n' && *p != '\r' && n + 1 < out_size) {
+        if (quote ? *p == quote : (*p == ' ' || *p == '#')) break;
+        out[n++] = *p++;
+    }
+    out[n] = '\0';
+    return 0;
+}
+
+static void config_get(FILE *fp, const char *key, char *out, size_t out_size, const char *def) {
+    const char *env = getenv(key);
+    char line[4096];
+
+    if (env != NULL && env[0] != '\0') {
+        snprintf(out, out_size, "%s", env);
+        return;
+    }
+    snprintf(out, out_size, "%s", def);
+    if (fp == NULL) return;
+    rewind(fp);
+    while (fgets(line, sizeof(line), fp) != NULL) {
+        config_line_value(line, key, out, out_size);
+    }
+}
+
+static int config_get_int(FILE *fp, const char *key, int def) {
+    char buf[32];
+    char defbuf[32];
+    snprintf(defbuf, sizeof(defbuf), "%d", def);
+    config_get(fp, key, buf, sizeof(buf), defbuf);
+    return atoi(buf) > 0 ? atoi(buf) : def;
+}
+
+static int parse_endpoint(LlmConfig *cfg) {
+    const char *p = cfg->endpoint;
+    const char *host_end;
+    const char *path;
+    size_t host_len;
+
+    if (strncmp(p, "https://", 8) == 0) {
+        cfg->tls = 1;
+        p += 8;
+    } else if (strncmp(p, "http://", 7) == 0) {
+        cfg->tls = 0;
+        p += 7;
+    } else {
+        return -1;
+    }
+    path = strchr(p, '/');
+    if (path == NULL) path = p + strlen(p);
+    host_end = memchr(p, ':', (size_t)(path - p));
+    if (host_end != NULL) {
+        size_t port_len = (size_t)(path - host_end - 1);
+        if (port_len == 0 || port_len >= sizeof(cfg->port)) return -1;
+        memcpy(cfg->port, host_end + 1, port_len);
+        cfg->port[port_len] = '\0';
+    } else {
+        host_end = path;
+        snprintf(cfg->port, sizeof(cfg->port), "%s", cfg->tls ? "443" : "80");
+    }
+    host_len = (size_t)(host_end - p);
+    if (host_len == 0 || host_len >= sizeof(cfg->host)) return -1;
+    memcpy(cfg->host, p, host_len);
+    cfg->host[host_len] = '\0';
+    snprintf(cfg->path, sizeof(cfg->path), "%s", *path != '\0' ? path : "/");
+    return 0;
+}
+
+static int load_config(void) {
+    FILE *fp = fopen(LLM_CONFIG_PATH, "r");
+    char verify[8];
+
+    if (fp == NULL) {
+        LOGW(TAG, "未找到配置文件 %s，仅使用环境变量", LLM_CONFIG_PATH);
+    }
+    free(g_cfg.system_prompt);
+    memset(&g_cfg, 0, sizeof(g_cfg));
+    g_cfg.system_prompt = (char *)malloc(4096);
+    if (g_cfg.system_prompt == NULL) {
+        if (fp) fclose(fp);
+        return -1;
+    }
+    config_get(fp, "LLM_ENDPOINT", g_cfg.endpoint, sizeof(g_cfg.endpoint), LLM_DEFAULT_ENDPOINT);
+    config_get(fp, "LLM_API_KEY", g_cfg.api_key, sizeof(g_cfg.api_key), "");
+    config_get(fp, "LLM_MODEL", g_cfg.model, sizeof(g_cfg.model), LLM_DEFAULT_MODEL);
+    config_get(fp, "LLM_SYSTEM_PROMPT", g_cfg.system_prompt, 4096, "");
+    config_get(fp, "LLM_TLS_VERIFY", verify, sizeof(verify), "1");
+    g_cfg.tls_verify = atoi(verify) != 0;
+    g_cfg.connect_timeout_ms = config_get_int(fp, "LLM_CONNECT_TIMEOUT_MS", LLM_DEFAULT_CONNECT_TIMEOUT_MS);
+    g_cfg.idle_timeout_ms = config_get_int(fp, "LLM_IDLE_TIMEOUT_MS", LLM_DEFAULT_IDLE_TIMEOUT_MS);
+    g_cfg.timeout_ms = config_get_int(fp, "LLM_TIMEOUT_MS", LLM_DEFAULT_TIMEOUT_MS);
+    if (fp) fclose(fp);
+
+    if (parse_endpoint(&g_cfg) != 0) {
+        LOGE(TAG, "LLM_ENDPOINT 无效: %s", g_cfg.endpoint);
+        return -1;
+    }
+    LOGI(TAG, "LLM 接口 %s://%s:%s%s，模型 %s，超时 连接%d/空闲%d/总%d ms",
+         g_cfg.tls ? "https" : "http", g_cfg.host, g_cfg.port, g_cfg.path, g_cfg.model,
+         g_cfg.connect_timeout_ms, g_cfg.idle_timeout_ms, g_cfg.timeout_ms);
+    g_cfg_loaded = 1;
+    return 0;
+}
+
+/* ---------- 连接 ---------- */
+
+static long ms_until(const struct timespec *deadline) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (deadline->tv_sec - now.tv_sec) * 1000L + (deadline->tv_nsec - now.tv_nsec) / 1000000L;
+}
+
+static void set_io_timeout(int fd, long ms) {
+    struct timeval tv;
+    if (ms < 1) ms = 1;
+    tv.tv_sec = ms / 1000;
+    tv.tv_usec = (ms % 1000) * 1000;
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+}
+
+static void conn_close(void) {
+    if (g_conn.ssl != NULL) {
+        SSL_shutdown(g_conn.ssl);
+        SSL_free(g_conn.ssl);
+        g_conn.ssl = NULL;
+    }
+    if (g_conn.fd >= 0) {
+        close(g_conn.fd);
+        g_conn.fd = -1;
+    }
+    g_conn.rpos = 0;
+    g_conn.rlen = 0;
+    g_conn.requests = 0;
+}
+
+static int tcp_connect(const char *host, const char *port, int timeout_ms) {
+    struct addrinfo hints;
+    struct addrinfo *res = NULL;
+    struct addrinfo *ai;
+    int fd = -1;
+    int rc;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    rc = getaddrinfo(host, port, &hints, &res);
+    if (rc != 0) {
+        LOGE(TAG, "解析 %s 失败: %s", host, gai_strerror(rc));
+        return -1;
+    }
+    for (ai = res; ai != NULL; ai = ai->ai_next) {
+        struct pollfd pfd;
+        int err = 0;
+        socklen_t len = sizeof(err);
+        int flags;
+
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0) continue;
+        flags = fcntl(fd, F_GETFL, 0);
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) != 0) {
+            if (errno != EINPROGRESS) {
+                close(fd);
+                fd = -1;
+                continue;
+            }
+            pfd.fd = fd;
+            pfd.events = POLLOUT;
+            if (poll(&pfd, 1, timeout_ms) != 1 ||
+                getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) != 0 || err != 0) {
+                LOGW(TAG, "连接 %s:%s 失败: %s", host, port, err ? strerror(err) : "超时");
+                close(fd);
+                fd = -1;
+                continue;
+            }
+        }
+        fcntl(fd, F_SETFL, flags);
+        break;
+    }
+    freeaddrinfo(res);
+    if (fd >= 0) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &one, sizeof(one));
+    }
+    return fd;
+}
+
+/* TLS 1.3 的会话票据在握手完成之后才到，握手后立刻 SSL_get1_session 拿到的通常不可恢复；
+ * 由 OpenSSL 收到票据（或 TLS 1.2 握手完成）时回调保存。返回 1 表示接管这份引用 */
+static int on_new_session(SSL *ssl, SSL_SESSION *sess) {
+    (void)ssl;
+    if (g_conn.session != NULL) {
+        SSL_SESSION_free(g_conn.session);
+    }
+    g_conn.session = sess;
+    return 1;
+}
+
+static int conn_open(void) {
+    struct timespec t0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+
+    g_conn.fd = tcp_connect(g_cfg.host, g_cfg.port, g_cfg.connect_timeout_ms);
+    if (g_conn.fd < 0) return -1;
+    if (g_cfg.tls) {
+        if (g_ssl_ctx == NULL) {
+            g_ssl_ctx = SSL_CTX_new(TLS_client_method());
+            if (g_ssl_ctx == NULL) {
+                LOGE(TAG, "创建 SSL_CTX 失败");
+                conn_close();
+                return -1;
+            }
+            SSL_CTX_set_default_verify_paths(g_ssl_ctx);
+            SSL_CTX_set_verify(g_ssl_ctx, g_cfg.tls_verify ? SSL_VERIFY_PEER : SSL_VERIFY_NONE, NULL);
+            SSL_CTX_set_session_cache_mode(g_ssl_ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+            SSL_CTX_sess_set_new_cb(g_ssl_ctx, on_new_session);
+        }
+        g_conn.ssl = SSL_new(g_ssl_ctx);
+        if (g_conn.ssl == NULL) {
+            conn_close();
+            return -1;
+        }
+        SSL_set_tlsext_host_name(g_conn.ssl, g_cfg.host);
+        if (g_cfg.tls_verify) {
+            SSL_set1_host(g_conn.ssl, g_cfg.host);
+        }
+        if (g_conn.session != NULL) {
+            SSL_set_session(g_conn.ssl, g_conn.session);
+        }
+        SSL_set_fd(g_conn.ssl, g_conn.fd);
+        set_io_timeout(g_conn.fd, g_cfg.connect_timeout_ms);
+        if (SSL_connect(g_conn.ssl) != 1) {
+            unsigned long e = ERR_get_error();
+            LOGE(TAG, "TLS 握手失败: %s", e ? ERR_error_string(e, NULL) : "连接被关闭或超时");
+            ERR_clear_error();
+            conn_close();
+            return -1;
+        }
+        LOGI(TAG, "已连接 %s:%s（%s，%s，%.0f ms）", g_cfg.host, g_cfg.port, SSL_get_version(g_conn.ssl),
+             SSL_session_reused(g_conn.ssl) ? "恢复会话" : "完整握手",
+             (double)-ms_until(&t0));
+    } else {
+        LOGI(TAG, "已连接 %s:%s（%.0f ms）", g_cfg.host, g_cfg.port, (double)-ms_until(&t0));
+    }
+    return 0;
+}
+
+// 空闲连接可能已被服务端关闭：可读（EOF 或 close_notify）即视为失效
+static int conn_usable(void) {
+    struct pollfd pfd;
+    if (g_conn.fd < 0 || g_conn.rpos != g_conn.rlen) return 0;
+    pfd.fd = g_conn.fd;
+    pfd.events = POLLIN;
+    return poll(&pfd, 1, 0) == 0;
+}
+
+static int conn_write_all(const char *buf, size_t len) {
+    while (len > 0) {
+        int n;
+        set_io_timeout(g_conn.fd, ms_until(&g_conn.deadline));
+        if (g_conn.ssl != NULL) {
+            n = SSL_write(g_conn.ssl, buf, (int)len);
+        } else {
+            n = (int)send(g_conn.fd, buf, len, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+        }
+        if (n <= 0) return -1;
+        buf += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+// 读缓冲为空时从连接读一次；返回读到的字节数，0 为对端关闭，-1 为错误或超时
+static int conn_fill(void) {
+    long left = ms_until(&g_conn.deadline);
+    int n;
+
+    if (g_conn.rpos < g_conn.rlen) return (int)(g_conn.rlen - g_conn.rpos);
+    if (left <= 0) {
+        LOGW(TAG, "请求超过总超时 %d ms", g_cfg.timeout_ms);
+        return -1;
+    }
+    set_io_timeout(g_conn.fd, left < g_cfg.idle_timeout_ms ? left : g_cfg.idle_timeout_ms);
+    do {
+        if (g_conn.ssl != NULL) {
+            n = SSL_read(g_conn.ssl, g_conn.rbuf, sizeof(g_conn.rbuf));
+            if (n <= 0 && SSL_get_error(g_conn.ssl, n) == SSL_ERROR_ZERO_RETURN) n = 0;
+            else if (n < 0) ERR_clear_error();
+        } else {
+            n = (int)recv(g_conn.fd, g_conn.rbuf, sizeof(g_conn.rbuf), 0);
+        }
+    } while (n < 0 && errno == EINTR);
+    if (n < 0) {
+        LOGW(TAG, "读取响应失败: %s", (errno == EAGAIN || errno == EWOULDBLOCK) ? "等待数据超时" : strerror(errno));
+        return -1;
+    }
+    g_conn.rpos = 0;
+    g_conn.rlen = (size_t)n;
+    return n;
+}
+
+// 读一行（去掉 \r\n），返回长度；超长行截断，-1 为连接错误或提前关闭
+static int conn_read_line(char *line, size_t size) {
+    size_t n = 0;
+    for (;;) {
+        char *nl;
+        size_t avail;
+        size_t take;
+        if (conn_fill() <= 0) return -1;
+        avail = g_conn.rlen - g_conn.rpos;
+        nl = memchr(g_conn.rbuf + g_conn.rpos, '\n', avail);
+        take = nl ? (size_t)(nl - (g_conn.rbuf + g_conn.rpos)) : avail;
+        if (n + take >= size) take = size - 1 - n;
+        memcpy(line + n, g_conn.rbuf + g_conn.rpos, take);
+        n += take;
+        if (nl != NULL) {
+            g_conn.rpos = (size_t)(nl - g_conn.rbuf) + 1;
+            break;
+        }
+        g_conn.rpos += (n + 1 >= size) ? avail : take;
+    }
+    if (n > 0 && line[n - 1] == '\r') n--;
+    line[n] = '\0';
+    return (int)n;
+}
+
+/* ---------- HTTP ---------- */
+
+static int http_send_request(const char *body, size_t body_len) {
+    char header[1024];
+    int hlen = snprintf(header, sizeof(header),
+                        "POST %s HTTP/1.1\r\n"
+                        "Host: %s\r\n"
+                        "Authorization: Bearer %s\r\n"
+                        "Content-Type: application/json\r\n"
+                        "Accept: text/event-stream\r\n"
+                        "Content-Length: %zu\r\n"
+                        "Connection: keep-alive\r\n"
+                        "\r\n",
+                        g_cfg.path, g_cfg.host, g_cfg.api_key, body_len);
+    if (hlen <= 0 || (size_t)hlen >= sizeof(header)) return -1;
+    if (conn_write_all(header, (size_t)hlen) != 0) return -1;
+    return conn_write_all(body, body_len);
+}
+
+static int http_read_headers(HttpBody *hb) {
+    char line[LLM_MAX_LINE_LEN];
+    int n;
+
+    memset(hb, 0, sizeof(*hb));
+    hb->content_length = -1;
+    hb->keep_alive = 1;
+    if (conn_read_line(line, sizeof(line)) < 0) return -1;
+    if (sscanf(line, "HTTP/%*d.%*d %d", &hb->status) != 1) {
+        LOGE(TAG, "无效的响应行: %s", line);
+        return -1;
+    }
+    if (strncmp(line, "HTTP/1.0", 8) == 0) hb->keep_alive = 0;
+    while ((n = conn_read_line(line, sizeof(line))) > 0) {
+        char *v = strchr(line, ':');
+        if (v == NULL) continue;
+        *v++ = '\0';
+        while (*v == ' ') v++;
+        if (strcasecmp(line, "Content-Length") == 0) {
+            hb->content_length = atol(v);
+        } else if (strcasecmp(line, "Transfer-Encoding") == 0 && strstr(v, "chunked") != NULL) {
+            hb->chunked = 1;
+        } else if (strcasecmp(line, "Connection") == 0) {
+            hb->keep_alive = strcasecmp(v, "close") != 0;
+        } else if (strcasecmp(line, "Content-Type") == 0) {
+            hb->event_stream = strstr(v, "text/event-stream") != NULL;
+        }
+    }
+    if (n < 0) return -1;
+    if (!hb->chunked && hb->content_length < 0) hb->keep_alive = 0;
+    if (hb->chunked) hb->content_length = -1;
+    hb->done = (!hb->chunked && hb->content_length == 0);
+    return 0;
+}
+
+// 读响应体，处理 chunked / Content-Length / 读到关闭；返回字节数，0 为响应体结束，-1 为错误
+static int http_read_body(HttpBody *hb, char *buf, size_t size) {
+    size_t take;
+    int avail;
+
+    if (hb->done) return 0;
+    if (hb->chunked && hb->chunk_left == 0) {
+        char line[64];
+        if (conn_read_line(line, sizeof(line)) < 0) return -1;
+        if (line[0] == '\0' && conn_read_line(line, sizeof(line)) < 0) return -1;   // 上一个 chunk 的结尾 CRLF
+        hb->chunk_left = strtol(line, NULL, 16);
+        if (hb->chunk_left <= 0) {
+            // 最后一个 chunk：跳过 trailer 直到空行
+            while (conn_read_line(line, sizeof(line)) > 0) {
+            }
+            hb->done = 1;
+            return 0;
+        }
+    }
+    avail = conn_fill();
+    if (avail < 0) return -1;
+    if (avail == 0) {
+        hb->done = 1;
+        hb->keep_alive = 0;
+        return (hb->chunked || hb->content_length > 0) ? -1 : 0;
+    }
+    take = (size_t)avail < size ? (size_t)avail : size;
+    if (hb->chunked && (long)take > hb->chunk_left) take = (size_t)hb->chunk_left;
+    if (!hb->chunked && hb->content_length >= 0 && (long)take > hb->content_length) take = (size_t)hb->content_length;
+    memcpy(buf, g_conn.rbuf + g_conn.rpos, take);
+    g_conn.rpos += take;
+    if (hb->chunked) {
+        hb->chunk_left -= (long)take;
+    } else if (hb->content_length >= 0) {
+        hb->content_length -= (long)take;
+        if (hb->content_length == 0) hb->done = 1;
+    }
+    return (int)take;
+}
+
+/* ---------- 响应解析 ---------- */
+
+static void append_text(char *out, size_t out_len, size_t *used, const char *text) {
+    size_t n = strlen(text);
+    if (out == NULL || out_len == 0) return;
+    if (*used + n >= out_len) n = out_len - 1 - *used;
+    memcpy(out + *used, text, n);
+    *used += n;
+    out[*used] = '\0';
+}
+
+static void log_api_error(json_object *json) {
+    json_object *error = NULL;
+    json_object *message = NULL;
+    if (json_object_object_get_ex(json, "error", &error) &&
+        json_object_object_get_ex(error, "message", &message)) {
+        LOGE(TAG, "接口返回错误: %s", json_object_get_string(message));
+    }
+}
+
 static ErrorCode parse_json_response(const char* json_str, char* out_content, size_t out_len) {
     LOGD(TAG, "开始解析 JSON 响应");
     json_object* json = json_tokener_parse(json_str);
@@ -67,6 +585,7 @@ static ErrorCode parse_json_response(const char* json_str, char* out_content, si
 
     if (!(choices = json_object_object_get(json, "choices"))) {
         LOGE(TAG, "未找到 choices 字段");
+        log_api_error(json);
         ret = ERR_NO_CHOICES;
         goto cleanup;
     }
@@ -99,72 +618,261 @@ static ErrorCode parse_json_response(const char* json_str, char* out_content, si
     strncpy(out_content, content_str, out_len - 1);
     out_content[out_len - 1] = '\0';
 
-    for (size_t i = 0; i < strlen(out_content); i++) {
-        if (out_content[i] == '\n' || out_content[i] == '\r' || out_content[i] == '\t') {
-            out_content[i] = ' ';
+cleanup:
+    json_object_put(json);
+    return ret;
+}
+
+/* 处理一行 SSE：data: {...} 取 choices[0].delta.content 回调；data: [DONE] 置 *finished */
+static ErrorCode handle_sse_line(const char *line, llm_delta_cb on_delta, void *arg,
+                                 char *response, size_t response_len, size_t *used, int *finished) {
+    json_object *json;
+    json_object *choices = NULL;
+    json_object *delta = NULL;
+    json_object *content = NULL;
+    const char *text;
+    ErrorCode ret = ERR_OK;
+
+    if (strncmp(line, "data:", 5) != 0) return ERR_OK;     // 注释、event:、id: 等
+    line += 5;
+    while (*line == ' ') line++;
+    if (strcmp(line, "[DONE]") == 0) {
+        *finished = 1;
+        return ERR_OK;
+    }
+    json = json_tokener_parse(line);
+    if (json == NULL) {
+        LOGW(TAG, "SSE 数据不是有效 JSON: %.80s", line);
+        return ERR_OK;
+    }
+    if (!json_object_object_get_ex(json, "choices", &choices)) {
+        log_api_error(json);
+        json_object_put(json);
+        return ERR_NO_CHOICES;
+    }
+    if (json_object_array_length(choices) > 0 &&
+        json_object_object_get_ex(json_object_array_get_idx(choices, 0), "delta", &delta) &&
+        json_object_object_get_ex(delta, "content", &content) &&
+        (text = json_object_get_string(content)) != NULL && text[0] != '\0') {
+        append_text(response, response_len, used, text);
+        if (on_delta != NULL && on_delta(text, arg) != 0) {
+            ret = ERR_ABORTED;
         }
     }
+    json_object_put(json);
+    return ret;
+}
 
-    LOGI(TAG, "解析响应成功，内容: %s", out_content);
+static ErrorCode read_sse_body(HttpBody *hb, llm_delta_cb on_delta, void *arg, char *response, size_t response_len) {
+    char *line = (char *)malloc(LLM_MAX_LINE_LEN);
+    char buf[LLM_IO_BUF_SIZE];
+    size_t line_len = 0;
+    size_t used = 0;
+    int finished = 0;
+    ErrorCode ret = ERR_OK;
+    int n;
 
-cleanup:
-    json_object_put(json);
+    if (line == NULL) return ERR_REQUEST_FAILED;
+    // [DONE] 之后继续读完响应体，连接才能复用
+    while (ret == ERR_OK && (n = http_read_body(hb, buf, sizeof(buf))) > 0) {
+        int i;
+        for (i = 0; i < n && ret == ERR_OK; i++) {
+            if (buf[i] != '\n') {
+                if (line_len + 1 < LLM_MAX_LINE_LEN) line[line_len++] = buf[i];
+                continue;
+            }
+            if (line_len > 0 && line[line_len - 1] == '\r') line_len--;
+            line[line_len] = '\0';
+            line_len = 0;
+            if (!finished) {
+                ret = handle_sse_line(line, on_delta, arg, response, response_len, &used, &finished);
+            }
+        }
+    }
+    free(line);
+    if (ret != ERR_OK) return ret;
+    if (n < 0 && !finished) return ERR_REQUEST_FAILED;
+    if (n < 0) hb->keep_alive = 0;
+    if (used == 0) return ERR_NO_CONTENT;
+    return ERR_OK;
+}
+
+static ErrorCode read_json_body(HttpBody *hb, char *response, size_t response_len) {
+    char *body = (char *)malloc(LLM_MAX_JSON_BODY + 1);
+    size_t len = 0;
+    ErrorCode ret;
+    int n;
+
+    if (body == NULL) return ERR_REQUEST_FAILED;
+    while (len < LLM_MAX_JSON_BODY && (n = http_read_body(hb, body + len, LLM_MAX_JSON_BODY - len)) > 0) {
+        len += (size_t)n;
+    }
+    body[len] = '\0';
+    if (!hb->done) hb->keep_alive = 0;
+    if (hb->status != 200) {
+        json_object *json = json_tokener_parse(body);
+        LOGE(TAG, "HTTP %d: %.200s", hb->status, body);
+        if (json != NULL) {
+            log_api_error(json);
+            json_object_put(json);
+        }
+        free(body);
+        return ERR_HTTP_STATUS;
+    }
+    ret = parse_json_response(body, response, response_len);
+    free(body);
     return ret;
 }
 
-int init_llm(void) {
-    LOGI(TAG, "LLM 初始化完成");
-    return 0;
+static char *build_request_body(const char *question, size_t *len) {
+    json_object *root = json_object_new_object();
+    json_object *messages = json_object_new_array();
+    json_object *sys = json_object_new_object();
+    json_object *user = json_object_new_object();
+    char *body;
+
+    json_object_object_add(sys, "role", json_object_new_string("system"));
+    json_object_object_add(sys, "content", json_object_new_string(g_cfg.system_prompt));
+    json_object_object_add(user, "role", json_object_new_string("user"));
+    json_object_object_add(user, "content", json_object_new_string(question));
+    if (g_cfg.system_prompt[0] != '\0') {
+        json_object_array_add(messages, sys);
+    } else {
+        json_object_put(sys);
+    }
+    json_object_array_add(messages, user);
+    json_object_object_add(root, "model", json_object_new_string(g_cfg.model));
+    json_object_object_add(root, "messages", messages);
+    json_object_object_add(root, "stream", json_object_new_boolean(1));
+    body = strdup(json_object_to_json_string_ext(root, JSON_C_TO_STRING_PLAIN));
+    json_object_put(root);
+    if (body != NULL) *len = strlen(body);
+    return body;
 }
 
-int generate_llm_response(const char *question, char *response, size_t response_len) {
-    if (question == NULL || strlen(question) == 0) {
-        LOGE(TAG, "%s", get_error_message(ERR_INVALID_ARGS));
-        return -1;
+static ErrorCode do_request(const char *body, size_t body_len, llm_delta_cb on_delta, void *arg,
+                            char *response, size_t response_len) {
+    HttpBody hb;
+    ErrorCode ret;
+    int attempt;
+    int sent = -1;
+
+    clock_gettime(CLOCK_MONOTONIC, &g_conn.deadline);
+    g_conn.deadline.tv_sec += g_cfg.timeout_ms / 1000;
+    g_conn.deadline.tv_nsec += (long)(g_cfg.timeout_ms % 1000) * 1000000L;
+    if (g_conn.deadline.tv_nsec >= 1000000000L) {
+        g_conn.deadline.tv_sec++;
+        g_conn.deadline.tv_nsec -= 1000000000L;
     }
 
-    LOGI(TAG, "用户问题: %s", question);
+    // 复用的连接可能在发送后才发现已被关闭，此时重连重发一次
+    for (attempt = 0; attempt < 2; attempt++) {
+        int reused = conn_usable();
+        if (!reused) {
+            conn_close();
+            if (conn_open() != 0) return ERR_CONNECT_FAILED;
+        }
+        sent = http_send_request(body, body_len);
+        if (sent == 0 && http_read_headers(&hb) == 0) break;
+        sent = -1;
+        conn_close();
+        if (!reused) break;
+        LOGI(TAG, "长连接已失效，重新连接");
+    }
+    if (sent != 0) return ERR_REQUEST_FAILED;
+
+    if (hb.status == 200 && hb.event_stream) {
+        ret = read_sse_body(&hb, on_delta, arg, response, response_len);
+    } else {
+        ret = read_json_body(&hb, response, response_len);
+        // 非流式响应一次性交给回调
+        if (ret == ERR_OK && on_delta != NULL && on_delta(response, arg) != 0) ret = ERR_ABORTED;
+    }
+    if (ret != ERR_OK || !hb.done || !hb.keep_alive) {
+        conn_close();
+    } else {
+        g_conn.requests++;
+    }
+    return ret;
+}
 
-    char command[MAX_COMMAND_LEN] = {0};
-    snprintf(command, sizeof(command), "cd ./voice-assistant/llm && ./llm.sh \"%s\" 2>>/dev/null", question);
-    LOGD(TAG, "执行命令: %s", command);
+/* ---------- 接口 ---------- */
 
-    FILE* fp = popen(command, "r");
-    if (fp == NULL) {
-        LOGE(TAG, "%s", get_error_message(ERR_POPEN_FAILED));
-        return -1;
+int init_llm(void) {
+    int ret;
+    pthread_mutex_lock(&g_llm_mutex);
+    ret = g_cfg_loaded ? 0 : load_config();
+    pthread_mutex_unlock(&g_llm_mutex);
+    if (ret == 0) {
+        LOGI(TAG, "LLM 初始化完成");
     }
+    return ret;
+}
 
-    char json_response[MAX_RESPONSE_LEN] = {0};
-    size_t total_read = 0;
-    size_t buf_remaining = sizeof(json_response) - 1;
-    char* ptr = json_response;
+int query_llm_stream(const char *question, llm_delta_cb on_delta, void *arg, char *response, size_t response_len) {
+    struct timespec t0;
+    char *body;
+    size_t body_len = 0;
+    ErrorCode err;
+    size_t i;
 
-    while (buf_remaining > 0 && !feof(fp)) {
-        size_t read = fread(ptr, 1, buf_remaining, fp);
-        if (read <= 0) break;
-        total_read += read;
-        ptr += read;
-        buf_remaining -= read;
+    if (question == NULL || strlen(question) == 0 || response == NULL || response_len == 0) {
+        LOGE(TAG, "%s", get_error_message(ERR_INVALID_ARGS));
+        return -1;
     }
-    json_response[total_read] = '\0';
-    pclose(fp);
-    LOGD(TAG, "收到响应，长度: %zu", total_read);
+    response[0] = '\0';
 
-    ErrorCode err = parse_json_response(json_payload_start(json_response), response, response_len);
+    pthread_mutex_lock(&g_llm_mutex);
+    if (!g_cfg_loaded && load_config() != 0) {
+        pthread_mutex_unlock(&g_llm_mutex);
+        return -1;
+    }
+    LOGI(TAG, "用户问题: %s", question);
+    body = build_request_body(question, &body_len);
+    if (body == NULL) {
+        pthread_mutex_unlock(&g_llm_mutex);
+        return -1;
+    }
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    err = do_request(body, body_len, on_delta, arg, response, response_len);
+    free(body);
+    pthread_mutex_unlock(&g_llm_mutex);
 
     if (err != ERR_OK) {
         LOGE(TAG, "%s", get_error_message(err));
         return -1;
     }
-
+    for (i = 0; response[i] != '\0'; i++) {
+        if (response[i] == '\n' || response[i] == '\r' || response[i] == '\t') {
+            response[i] = ' ';
+        }
+    }
+    LOGI(TAG, "解析响应成功（%.0f ms），内容: %s", (double)-ms_until(&t0), response);
     return 0;
 }
 
+int generate_llm_response(const char *question, char *response, size_t response_len) {
+    return query_llm_stream(question, NULL, NULL, response, response_len);
+}
+
 int query_llm(const char *question, char *response, size_t response_len) {
     return generate_llm_response(question, response, response_len);
 }
 
 void cleanup_llm(void) {
+    pthread_mutex_lock(&g_llm_mutex);
+    conn_close();
+    if (g_conn.session != NULL) {
+        SSL_SESSION_free(g_conn.session);
+        g_conn.session = NULL;
+    }
+    if (g_ssl_ctx != NULL) {
+        SSL_CTX_free(g_ssl_ctx);
+        g_ssl_ctx = NULL;
+    }
+    free(g_cfg.system_prompt);
+    g_cfg.system_prompt = NULL;
+    g_cfg_loaded = 0;
+    pthread_mutex_unlock(&g_llm_mutex);
     LOGI(TAG, "LLM 资源清理完成");
 }
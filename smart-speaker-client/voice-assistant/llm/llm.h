@@ -3,9 +3,14 @@
 
 #include <stdio.h>
 
+/* 流式增量回调：delta 为本次新增的回复文本（UTF-8，可能不在句子边界），返回非 0 中止本次请求 */
+typedef int (*llm_delta_cb)(const char *delta, void *arg);
+
 int init_llm(void);
 int generate_llm_response(const char *question, char *response, size_t response_len);
 int query_llm(const char *question, char *response, size_t response_len);
+/* 流式查询：每收到一段增量调用一次 on_delta（可为 NULL），完整回复同时写入 response */
+int query_llm_stream(const char *question, llm_delta_cb on_delta, void *arg, char *response, size_t response_len);
 void cleanup_llm(void);
 
 #endif
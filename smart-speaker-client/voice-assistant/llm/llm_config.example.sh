@@ -14,3 +14,13 @@ export LLM_MODEL="qwen-plus"
 
 # 系统提示词
 export LLM_SYSTEM_PROMPT="你是一个智能音箱助手，回复非常简洁、口语化，适合直接念出来。请遵守以下规则:1.每次回复尽量控制在1-2句话内。2.将语句中只要逗号和句号，不要用其他标点符号。3.不要列举项目符号(如1、2、3)。4.直接回答问题，不要复述用户问题或说根据您的问题。5.语气亲切自然，像朋友聊天一样。"
+
+# 以下为可选项，不写则用默认值；同名环境变量优先于本文件
+# OpenAI 兼容的 chat/completions 接口地址（http:// 或 https://）
+# export LLM_ENDPOINT="https://dashscope.aliyuncs.com/compatible-mode/v1/chat/completions"
+# 建连 + TLS 握手超时、两次收到数据的最长间隔、整个请求的上限（毫秒）
+# export LLM_CONNECT_TIMEOUT_MS="3000"
+# export LLM_IDLE_TIMEOUT_MS="8000"
+# export LLM_TIMEOUT_MS="30000"
+# 校验服务器证书，自签名的内网网关可设为 0
+# export LLM_TLS_VERIFY="1"
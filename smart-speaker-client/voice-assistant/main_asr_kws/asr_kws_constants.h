@@ -2,5 +2,8 @@
 #define __ASR_KWS_CONSTANTS_H__
 
 #define ASR_TIMEOUT_SECONDS 5
+#define ASR_PREROLL_MS      300     // 唤醒→ASR 切换时保留的预录时长
+#define CAPTURE_WAIT_MS     100     // 等待采集数据的超时，期间照常处理控制管道和 ASR 超时
+#define WAKE_RESPONSE_TIMEOUT_MS 15000  // 等待唤醒应答播完的上限，超时直接进入 ASR
 
 #endif
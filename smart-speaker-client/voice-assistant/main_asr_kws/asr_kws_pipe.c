@@ -4,119 +4,105 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
-#include <unistd.h>
 
 #define LOG_LEVEL 4
 #include "../../debug_log.h"
 #include "../common/ipc_protocol.h"
+#include "../../ipc/ipc_bus.h"
 
 #define TAG "ASR_KWS_MAIN"
 
-int asr_kws_pipe_open(int *asr_fd, int *kws_fd, int *tts_fd, int *asr_ctrl_fd) {
-    if (asr_fd == NULL || kws_fd == NULL || tts_fd == NULL || asr_ctrl_fd == NULL) {
-        return -1;
-    }
-    if (*asr_fd != -1) { close(*asr_fd); *asr_fd = -1; }
-    if (*kws_fd != -1) { close(*kws_fd); *kws_fd = -1; }
-    if (*tts_fd != -1) { close(*tts_fd); *tts_fd = -1; }
+static IPCBusServer g_bus = { .listen_fd = -1 };
+static IPCBusLink g_player_link = { .name = IPC_BUS_PLAYER, .fd = -1 };
+static IPCBusLink g_tts_link = { .name = IPC_BUS_TTS, .fd = -1 };
 
-    mkdir(FIFO_DIR_PATH, 0777);
-    if (access(ASR_FIFO_PATH, F_OK) == -1) {
-        if (mkfifo(ASR_FIFO_PATH, 0666) == -1 && errno != EEXIST) {
-            LOGW(TAG, "创建ASR管道失败: %s", strerror(errno));
-        }
-    }
-    if (access(KWS_FIFO_PATH, F_OK) == -1) {
-        if (mkfifo(KWS_FIFO_PATH, 0666) == -1 && errno != EEXIST) {
-            LOGW(TAG, "创建KWS管道失败: %s", strerror(errno));
-        }
-    }
-    if (access(TTS_FIFO_PATH, F_OK) == -1) {
-        if (mkfifo(TTS_FIFO_PATH, 0666) == -1 && errno != EEXIST) {
-            LOGW(TAG, "创建TTS管道失败: %s", strerror(errno));
-        }
-    }
-    if (access(ASR_CTRL_FIFO_PATH, F_OK) == -1) {
-        if (mkfifo(ASR_CTRL_FIFO_PATH, 0666) == -1 && errno != EEXIST) {
-            LOGW(TAG, "创建ASR控制管道失败: %s", strerror(errno));
-        }
-    }
-    if (access(TTS_WAKE_DONE_FIFO_PATH, F_OK) == -1) {
-        if (mkfifo(TTS_WAKE_DONE_FIFO_PATH, 0666) == -1 && errno != EEXIST) {
-            LOGW(TAG, "创建唤醒完成管道失败: %s", strerror(errno));
-        }
-    }
-
-    LOGD(TAG, "尝试打开ASR管道");
-    *asr_fd = open(ASR_FIFO_PATH, O_WRONLY | O_NONBLOCK);
-    LOGD(TAG, "尝试打开KWS管道");
-    *kws_fd = open(KWS_FIFO_PATH, O_WRONLY | O_NONBLOCK);
-    LOGD(TAG, "尝试打开TTS管道");
-    *tts_fd = open(TTS_FIFO_PATH, O_WRONLY | O_NONBLOCK);
-
-    if (*asr_fd != -1 || *kws_fd != -1 || *tts_fd != -1) {
-        LOGI(TAG, "管道打开成功！asr_fd=%d, kws_fd=%d, tts_fd=%d", *asr_fd, *kws_fd, *tts_fd);
+int asr_kws_pipe_open(void) {
+    if (ipc_bus_server_open(&g_bus, IPC_BUS_ASR_KWS) != 0) {
+        LOGE(TAG, "打开消息总线失败（asr_kws 进程是否已在运行？）: %s", strerror(errno));
+        return -1;
     }
+    ipc_bus_link_init(&g_player_link, IPC_BUS_PLAYER);
+    ipc_bus_link_init(&g_tts_link, IPC_BUS_TTS);
+    LOGI(TAG, "消息总线已就绪");
     return 0;
 }
 
-int asr_kws_pipe_write_text(int *fd, const char *path, const char *text) {
-    if (text == NULL || text[0] == '\0') {
-        return -1;
-    }
-    if (fd == NULL || path == NULL) {
-        return -1;
-    }
-    if (*fd == -1) {
-        *fd = open(path, O_WRONLY | O_NONBLOCK);
-    }
-    if (*fd == -1) {
-        if (!(strstr(path, "kws") != NULL && errno == ENXIO)) {
-            LOGW(TAG, "打开管道失败 %s: %s", path, strerror(errno));
-        }
-        return -1;
-    }
-    char buf[MAX_TEXT_LEN + 4] = {0};
-    snprintf(buf, sizeof(buf), "%s\n", text);
-    ssize_t ret = write(*fd, buf, strlen(buf));
-    if (ret < 0) {
-        LOGW(TAG, "写入管道失败 %s: %s", path, strerror(errno));
-        if (errno == EPIPE || errno == ENXIO) {
-            close(*fd);
-            *fd = -1;
+void asr_kws_pipe_close(void) {
+    ipc_bus_link_close(&g_player_link);
+    ipc_bus_link_close(&g_tts_link);
+    ipc_bus_server_close(&g_bus);
+}
+
+static int send_on_link(IPCBusLink *link, uint16_t type, const char *text, uint32_t *seq_out) {
+    uint32_t len = (text != NULL) ? (uint32_t)(strlen(text) + 1) : 0;
+    if (ipc_bus_link_send(link, type, text, len, seq_out) != 0) {
+        // 对端未启动时 ECONNREFUSED，属于正常时序，降级为调试日志
+        if (errno == ECONNREFUSED) {
+            LOGD(TAG, "%s 未就绪，丢弃消息 type=%u", link->name, type);
+        } else {
+            LOGW(TAG, "发送到 %s 失败 type=%u: %s", link->name, type, strerror(errno));
         }
         return -1;
     }
     return 0;
 }
 
-void asr_kws_pipe_process_ctrl(int *asr_ctrl_fd, int *online_mode) {
-    if (asr_ctrl_fd == NULL || online_mode == NULL) {
-        return;
+int asr_kws_pipe_send_player(uint16_t type, const char *text) {
+    return send_on_link(&g_player_link, type, text, NULL);
+}
+
+int asr_kws_pipe_send_tts(uint16_t type, const char *payload, uint32_t *seq_out) {
+    return send_on_link(&g_tts_link, type, payload, seq_out);
+}
+
+int asr_kws_pipe_tts_replied(uint32_t seq) {
+    IPCHeader header;
+    uint8_t body[64];
+    int replied = 0;
+
+    if (seq == 0 || g_tts_link.fd < 0) {
+        return 1;
     }
-    if (*asr_ctrl_fd == -1) {
-        *asr_ctrl_fd = open(ASR_CTRL_FIFO_PATH, O_RDONLY | O_NONBLOCK);
-        if (*asr_ctrl_fd == -1) {
-            return;
+    for (;;) {
+        int ret = ipc_bus_recv(g_tts_link.fd, &header, body, sizeof(body));
+        if (ret == 2) {
+            return replied;
         }
-    }
-    char buf[128] = {0};
-    ssize_t n = read(*asr_ctrl_fd, buf, sizeof(buf) - 1);
-    if (n <= 0) {
-        if (n == 0) {
-            close(*asr_ctrl_fd);
-            *asr_ctrl_fd = -1;
+        if (ret == 0) {
+            // 更早请求的应答（已被新的唤醒取代）直接丢弃
+            if (header.type == IPC_REPLY_WAKE_RESPONSE && header.seq == seq) {
+                replied = 1;
+            }
+            continue;
         }
-        return;
+        if (ret == -1 && errno == EBADMSG) {
+            continue;
+        }
+        LOGW(TAG, "TTS连接已断开，继续进入ASR模式");
+        ipc_bus_link_close(&g_tts_link);
+        return 1;
     }
-    if (strstr(buf, "mode:offline")) {
+}
+
+static void on_ctrl_message(int fd, const IPCHeader *header, const uint8_t *body, void *arg) {
+    int *online_mode = (int *)arg;
+    (void)fd;
+    (void)body;
+
+    if (header->type == IPC_CMD_SWITCH_OFFLINE) {
         *online_mode = ONLINE_MODE_NO;
-        LOGI(TAG, "通过控制管道切换到离线模式");
-    } else if (strstr(buf, "mode:online")) {
+        LOGI(TAG, "player 通知切换到离线模式");
+    } else if (header->type == IPC_CMD_SWITCH_ONLINE) {
         *online_mode = ONLINE_MODE_YES;
-        LOGI(TAG, "通过控制管道切换到在线模式");
+        LOGI(TAG, "player 通知切换到在线模式");
+    } else {
+        LOGW(TAG, "收到未知命令: %u", header->type);
+    }
+}
+
+void asr_kws_pipe_process_ctrl(int *online_mode) {
+    if (online_mode == NULL || g_bus.listen_fd < 0) {
+        return;
     }
+    ipc_bus_server_poll(&g_bus, 0, on_ctrl_message, online_mode);
 }
@@ -1,8 +1,22 @@
 #ifndef __ASR_KWS_PIPE_H__
 #define __ASR_KWS_PIPE_H__
 
-int asr_kws_pipe_open(int *asr_fd, int *kws_fd, int *tts_fd, int *asr_ctrl_fd);
-int asr_kws_pipe_write_text(int *fd, const char *path, const char *text);
-void asr_kws_pipe_process_ctrl(int *asr_ctrl_fd, int *online_mode);
+#include <stdint.h>
+
+/* asr_kws 进程的消息总线收发：向 player 发识别 / 唤醒事件，向 TTS 发播报命令，
+ * 并监听 player 的模式切换命令。除 open/close 外均不阻塞，调用方负责多线程互斥。 */
+
+int asr_kws_pipe_open(void);
+void asr_kws_pipe_close(void);
+
+// text 可为 NULL（无 body 的事件）；0 成功，-1 对端不在或积压
+int asr_kws_pipe_send_player(uint16_t type, const char *text);
+int asr_kws_pipe_send_tts(uint16_t type, const char *payload, uint32_t *seq_out);
+
+// 非阻塞检查 TTS 是否已应答 seq 对应的请求：已应答、连接断开或 seq 为 0 返回 1，仍在等待返回 0
+int asr_kws_pipe_tts_replied(uint32_t seq);
+
+// 处理 player 发来的模式切换命令（非阻塞）
+void asr_kws_pipe_process_ctrl(int *online_mode);
 
 #endif
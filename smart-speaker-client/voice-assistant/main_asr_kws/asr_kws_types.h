@@ -2,7 +2,8 @@
 #define __ASR_KWS_TYPES_H__
 
 enum SherpaOnnxState {
-    STATE_KWS,
+    STATE_KWS,      // 等待唤醒（KWS 线程始终在检测，与状态无关）
+    STATE_WAKE,     // 已唤醒，唤醒应答播放中，等 TTS 完成信号后进入 ASR
     STATE_ASR
 };
 
@@ -0,0 +1,404 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <poll.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#define LOG_LEVEL 4
+#include "../../debug_log.h"
+#include "../common/alsa.h"
+#include "audio_capture.h"
+
+#define TAG "CAPTURE"
+
+/* 读写位置单调递增，取模得到下标；容量为 2 的幂，head - tail 即该读端积压帧数。
+ * head 只由生产者写，每个读端的 tail 只由该读端线程写，release/acquire 保证样本先于位置可见。 */
+typedef struct {
+    _Atomic uint64_t tail;
+    int wake_fd;                            // eventfd：有新数据或线程退出时唤醒该读端
+    uint64_t skipped_frames;                // 仅该读端线程读写
+} CaptureReaderState;
+
+static int16_t *g_ring = NULL;
+static uint32_t g_ring_frames = 0;
+static uint32_t g_ring_mask = 0;
+static _Atomic uint64_t g_head = 0;
+static CaptureReaderState g_readers[CAPTURE_READER_COUNT];
+
+static pthread_t g_thread;
+static int g_thread_started = 0;
+static int g_started = 0;                   // 环形缓冲区已建立（采集线程或外部喂数据）
+static atomic_int g_capture_running = 0;
+static atomic_int g_capture_failed = 0;
+
+static _Atomic uint64_t g_dropped_frames = 0;
+static _Atomic uint32_t g_xruns = 0;
+static _Atomic uint32_t g_max_fill = 0;
+
+static void capture_wake_consumers(void)
+{
+    uint64_t one = 1;
+    int r;
+
+    for (r = 0; r < CAPTURE_READER_COUNT; r++) {
+        if (write(g_readers[r].wake_fd, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+            LOGW(TAG, "唤醒读端%d失败: %s", r, strerror(errno));
+        }
+    }
+}
+
+// 最慢读端的位置，决定还能写多少
+static uint64_t capture_min_tail(void)
+{
+    uint64_t min_tail = atomic_load_explicit(&g_readers[0].tail, memory_order_acquire);
+    int r;
+
+    for (r = 1; r < CAPTURE_READER_COUNT; r++) {
+        uint64_t t = atomic_load_explicit(&g_readers[r].tail, memory_order_acquire);
+        if (t < min_tail) {
+            min_tail = t;
+        }
+    }
+    return min_tail;
+}
+
+static void capture_push(const int16_t *frames, uint32_t count)
+{
+    uint64_t head = atomic_load_explicit(&g_head, memory_order_relaxed);
+    uint64_t tail = capture_min_tail();
+    uint32_t space = g_ring_frames - (uint32_t)(head - tail);
+    uint32_t fill;
+    uint32_t pos;
+    uint32_t first;
+
+    if (count > space) {
+        // 推理落后太多：丢弃放不下的新数据，已在缓冲区里的旧数据保持连续
+        atomic_fetch_add_explicit(&g_dropped_frames, count - space, memory_order_relaxed);
+        count = space;
+    }
+    if (count > 0) {
+        pos = (uint32_t)head & g_ring_mask;
+        first = g_ring_frames - pos;
+        if (first > count) {
+            first = count;
+        }
+        memcpy(g_ring + (size_t)pos * CHANNELS, frames, (size_t)first * CHANNELS * sizeof(int16_t));
+        memcpy(g_ring, frames + (size_t)first * CHANNELS, (size_t)(count - first) * CHANNELS * sizeof(int16_t));
+        atomic_store_explicit(&g_head, head + count, memory_order_release);
+    }
+    fill = (uint32_t)(head + count - tail);
+    if (fill > atomic_load_explicit(&g_max_fill, memory_order_relaxed)) {
+        atomic_store_explicit(&g_max_fill, fill, memory_order_relaxed);
+    }
+    capture_wake_consumers();
+}
+
+static void *capture_thread(void *arg)
+{
+    int16_t period[PERIOD_SIZE * CHANNELS];
+    (void)arg;
+
+    while (atomic_load_explicit(&g_capture_running, memory_order_relaxed)) {
+        snd_pcm_sframes_t n = snd_pcm_readi(g_pcm_handle, period, PERIOD_SIZE);
+        if (n == -EPIPE) {
+            uint32_t xruns = atomic_fetch_add_explicit(&g_xruns, 1, memory_order_relaxed) + 1;
+            LOGW(TAG, "ALSA录音溢出(第%u次)，重新准备设备", xruns);
+            snd_pcm_prepare(g_pcm_handle);
+            continue;
+        }
+        if (n < 0) {
+            if (n == -EAGAIN || n == -EINTR) {
+                continue;
+            }
+            if (snd_pcm_recover(g_pcm_handle, (int)n, 1) == 0) {
+                LOGW(TAG, "ALSA读取失败已恢复: %s", snd_strerror((int)n));
+                continue;
+            }
+            LOGE(TAG, "ALSA读取失败，采集线程退出: %s", snd_strerror((int)n));
+            atomic_store(&g_capture_failed, 1);
+            break;
+        }
+        if (n > 0) {
+            capture_push(period, (uint32_t)n);
+        }
+    }
+    capture_wake_consumers();
+    return NULL;
+}
+
+// 采集线程不处理进程信号，保证 SIGINT 等总在主线程执行（处理函数里要 join 采集线程）
+static int capture_create_thread(void)
+{
+    pthread_attr_t attr;
+    struct sched_param sp;
+    sigset_t block;
+    sigset_t old;
+    int ret;
+
+    sigfillset(&block);
+    pthread_sigmask(SIG_BLOCK, &block, &old);
+
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    memset(&sp, 0, sizeof(sp));
+    sp.sched_priority = AUDIO_CAPTURE_RT_PRIORITY;
+    pthread_attr_setschedparam(&attr, &sp);
+    ret = pthread_create(&g_thread, &attr, capture_thread, NULL);
+    pthread_attr_destroy(&attr);
+    if (ret == 0) {
+        LOGI(TAG, "采集线程已启动（SCHED_FIFO 优先级 %d）", AUDIO_CAPTURE_RT_PRIORITY);
+    } else {
+        LOGW(TAG, "实时调度不可用(%s)，采集线程使用普通调度", strerror(ret));
+        ret = pthread_create(&g_thread, NULL, capture_thread, NULL);
+        if (ret != 0) {
+            LOGE(TAG, "创建采集线程失败: %s", strerror(ret));
+        }
+    }
+
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    return ret == 0 ? 0 : -1;
+}
+
+// 建立环形缓冲区和各读端的 eventfd
+static int capture_ring_init(void)
+{
+    uint32_t want;
+    uint32_t frames = 1;
+    int r;
+
+    want = g_actual_rate * AUDIO_CAPTURE_RING_SECONDS;
+    while (frames < want) {
+        frames <<= 1;
+    }
+    g_ring = (int16_t *)malloc((size_t)frames * CHANNELS * sizeof(int16_t));
+    if (g_ring == NULL) {
+        LOGE(TAG, "分配采集环形缓冲区失败（内存不足）");
+        return -1;
+    }
+    g_ring_frames = frames;
+    g_ring_mask = frames - 1;
+    atomic_store(&g_head, 0);
+    atomic_store(&g_dropped_frames, 0);
+    atomic_store(&g_xruns, 0);
+    atomic_store(&g_max_fill, 0);
+    atomic_store(&g_capture_failed, 0);
+
+    for (r = 0; r < CAPTURE_READER_COUNT; r++) {
+        atomic_store(&g_readers[r].tail, 0);
+        g_readers[r].skipped_frames = 0;
+        g_readers[r].wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (g_readers[r].wake_fd < 0) {
+            LOGE(TAG, "创建eventfd失败: %s", strerror(errno));
+            while (r-- > 0) {
+                close(g_readers[r].wake_fd);
+                g_readers[r].wake_fd = -1;
+            }
+            free(g_ring);
+            g_ring = NULL;
+            return -1;
+        }
+    }
+    g_started = 1;
+    LOGI(TAG, "采集环形缓冲区: %u 帧 (%.1f 秒)，%d 个读端", frames, (double)frames / g_actual_rate,
+         CAPTURE_READER_COUNT);
+    return 0;
+}
+
+static void capture_ring_free(void)
+{
+    int r;
+
+    for (r = 0; r < CAPTURE_READER_COUNT; r++) {
+        close(g_readers[r].wake_fd);
+        g_readers[r].wake_fd = -1;
+    }
+    free(g_ring);
+    g_ring = NULL;
+    g_started = 0;
+}
+
+int audio_capture_start(void)
+{
+    if (g_started) {
+        return 0;
+    }
+    if (g_pcm_handle == NULL || g_actual_rate == 0) {
+        LOGE(TAG, "ALSA未初始化，无法启动采集线程");
+        return -1;
+    }
+    if (capture_ring_init() != 0) {
+        return -1;
+    }
+
+    atomic_store(&g_capture_running, 1);
+    if (capture_create_thread() != 0) {
+        atomic_store(&g_capture_running, 0);
+        capture_ring_free();
+        return -1;
+    }
+    g_thread_started = 1;
+    return 0;
+}
+
+int audio_capture_start_feed(void)
+{
+    if (g_started) {
+        return 0;
+    }
+    if (g_actual_rate == 0) {
+        LOGE(TAG, "未设置采样率，无法建立采集缓冲区");
+        return -1;
+    }
+    return capture_ring_init();
+}
+
+void audio_capture_feed(const int16_t *frames, uint32_t count)
+{
+    if (g_started && !g_thread_started && frames != NULL && count > 0) {
+        capture_push(frames, count);
+    }
+}
+
+void audio_capture_stop(void)
+{
+    if (!g_started) {
+        return;
+    }
+    if (g_thread_started) {
+        // snd_pcm_readi 最多阻塞一个周期，置位后 join 即可
+        atomic_store(&g_capture_running, 0);
+        pthread_join(g_thread, NULL);
+        g_thread_started = 0;
+    }
+    audio_capture_log_stats();
+    capture_ring_free();
+}
+
+// 等待 eventfd 并清零；返回 poll 结果
+static int capture_wait_wake(CaptureReaderState *rd, int timeout_ms)
+{
+    struct pollfd pfd;
+    uint64_t cnt;
+    int pr;
+
+    pfd.fd = rd->wake_fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    pr = poll(&pfd, 1, timeout_ms);
+    if (pr > 0) {
+        if (read(rd->wake_fd, &cnt, sizeof(cnt)) < 0 && errno != EAGAIN) {
+            LOGW(TAG, "读取eventfd失败: %s", strerror(errno));
+        }
+    }
+    return pr;
+}
+
+int audio_capture_read(AudioCaptureReader reader, int16_t *buf, int max_frames, int timeout_ms)
+{
+    CaptureReaderState *rd;
+    uint64_t head;
+    uint64_t tail;
+    uint32_t avail;
+    uint32_t count;
+    uint32_t pos;
+    uint32_t first;
+
+    if (g_ring == NULL || buf == NULL || max_frames <= 0 || reader < 0 || reader >= CAPTURE_READER_COUNT) {
+        return -1;
+    }
+    rd = &g_readers[reader];
+
+    tail = atomic_load_explicit(&rd->tail, memory_order_relaxed);
+    head = atomic_load_explicit(&g_head, memory_order_acquire);
+    if (head == tail) {
+        if (atomic_load(&g_capture_failed)) {
+            return -1;
+        }
+        capture_wait_wake(rd, timeout_ms);
+        head = atomic_load_explicit(&g_head, memory_order_acquire);
+        if (head == tail) {
+            return atomic_load(&g_capture_failed) ? -1 : 0;
+        }
+    }
+
+    avail = (uint32_t)(head - tail);
+    count = avail < (uint32_t)max_frames ? avail : (uint32_t)max_frames;
+    pos = (uint32_t)tail & g_ring_mask;
+    first = g_ring_frames - pos;
+    if (first > count) {
+        first = count;
+    }
+    memcpy(buf, g_ring + (size_t)pos * CHANNELS, (size_t)first * CHANNELS * sizeof(int16_t));
+    memcpy(buf + (size_t)first * CHANNELS, g_ring, (size_t)(count - first) * CHANNELS * sizeof(int16_t));
+    atomic_store_explicit(&rd->tail, tail + count, memory_order_release);
+    return (int)count;
+}
+
+int audio_capture_wait(AudioCaptureReader reader, int timeout_ms)
+{
+    CaptureReaderState *rd;
+
+    if (g_ring == NULL || reader < 0 || reader >= CAPTURE_READER_COUNT) {
+        return -1;
+    }
+    rd = &g_readers[reader];
+    if (atomic_load(&g_capture_failed)) {
+        return -1;
+    }
+    capture_wait_wake(rd, timeout_ms);
+    if (atomic_load(&g_capture_failed)) {
+        return -1;
+    }
+    return (int)(atomic_load_explicit(&g_head, memory_order_acquire) -
+                 atomic_load_explicit(&rd->tail, memory_order_relaxed));
+}
+
+void audio_capture_keep_preroll(AudioCaptureReader reader, int preroll_ms)
+{
+    CaptureReaderState *rd;
+    uint64_t head;
+    uint64_t tail;
+    uint64_t keep;
+
+    if (g_ring == NULL || reader < 0 || reader >= CAPTURE_READER_COUNT) {
+        return;
+    }
+    rd = &g_readers[reader];
+    keep = (preroll_ms > 0) ? (uint64_t)g_actual_rate * (uint64_t)preroll_ms / 1000 : 0;
+    tail = atomic_load_explicit(&rd->tail, memory_order_relaxed);
+    head = atomic_load_explicit(&g_head, memory_order_acquire);
+    if (head - tail <= keep) {
+        return;
+    }
+    rd->skipped_frames += head - keep - tail;
+    atomic_store_explicit(&rd->tail, head - keep, memory_order_release);
+}
+
+void audio_capture_get_stats(AudioCaptureStats *stats)
+{
+    if (stats == NULL) {
+        return;
+    }
+    stats->captured_frames = atomic_load_explicit(&g_head, memory_order_relaxed);
+    stats->dropped_frames = atomic_load_explicit(&g_dropped_frames, memory_order_relaxed);
+    stats->skipped_frames = g_readers[CAPTURE_READER_ASR].skipped_frames;
+    stats->xruns = atomic_load_explicit(&g_xruns, memory_order_relaxed);
+    stats->max_fill_frames = atomic_load_explicit(&g_max_fill, memory_order_relaxed);
+}
+
+void audio_capture_log_stats(void)
+{
+    AudioCaptureStats st;
+
+    audio_capture_get_stats(&st);
+    LOGI(TAG, "采集统计: 采集=%llu帧 ALSA溢出=%u次 缓冲区满丢弃=%llu帧 ASR跳过=%llu帧 最高水位=%u/%u帧",
+         (unsigned long long)st.captured_frames, st.xruns, (unsigned long long)st.dropped_frames,
+         (unsigned long long)st.skipped_frames, st.max_fill_frames, g_ring_frames);
+}
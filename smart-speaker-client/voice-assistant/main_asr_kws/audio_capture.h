@@ -0,0 +1,50 @@
+#ifndef __AUDIO_CAPTURE_H__
+#define __AUDIO_CAPTURE_H__
+
+#include <stdint.h>
+
+/* 独立采集线程：snd_pcm_readi 写入单生产者环形缓冲区，每个读端有自己的读位置：
+ * KWS 线程持续读取做唤醒检测，主线程只在识别期间读取做 ASR，解码慢时只是积压而不会让 ALSA 溢出。
+ * 缓冲区按最慢的读端判断是否已满，因此不读数据的读端须用 audio_capture_keep_preroll 跟上写位置。 */
+
+#define AUDIO_CAPTURE_RING_SECONDS  8       // 环形缓冲区容量（秒），推理落后超过该时长才会丢音频
+#define AUDIO_CAPTURE_RT_PRIORITY   50      // 采集线程 SCHED_FIFO 优先级，无权限时退回普通调度
+
+typedef enum {
+    CAPTURE_READER_ASR = 0,     // 主线程：识别期间读取，其余时间只保留预录
+    CAPTURE_READER_KWS,         // KWS 线程：始终读取
+    CAPTURE_READER_COUNT
+} AudioCaptureReader;
+
+typedef struct {
+    uint64_t captured_frames;   // 采集到的总帧数
+    uint64_t dropped_frames;    // 环形缓冲区满而丢弃的帧数（推理跟不上）
+    uint64_t skipped_frames;    // ASR 读端主动跳过的帧数（未在识别、唤醒应答期间的录音）
+    uint32_t xruns;             // ALSA 溢出次数（-EPIPE）
+    uint32_t max_fill_frames;   // 环形缓冲区历史最高水位
+} AudioCaptureStats;
+
+// 启动采集线程（需在 init_alsa 之后调用），0 成功，-1 失败
+int audio_capture_start(void);
+
+// 不启动 ALSA 采集线程，改由调用方用 audio_capture_feed 写入（测试时回放 WAV）；需先设置 g_actual_rate
+int audio_capture_start_feed(void);
+void audio_capture_feed(const int16_t *frames, uint32_t count);
+
+// 停止采集线程并释放缓冲区，可重复调用
+void audio_capture_stop(void);
+
+// 从 reader 读端读取最多 max_frames 帧；无数据时最多等待 timeout_ms
+// 返回读取帧数，超时返回 0，采集线程异常退出返回 -1；每个读端只能由一个线程调用
+int audio_capture_read(AudioCaptureReader reader, int16_t *buf, int max_frames, int timeout_ms);
+
+// 等待新数据写入（不消费），最多 timeout_ms；返回该读端积压帧数，采集线程异常退出返回 -1
+int audio_capture_wait(AudioCaptureReader reader, int timeout_ms);
+
+// 丢弃该读端积压音频，只保留最近 preroll_ms 毫秒作为下一阶段的起始
+void audio_capture_keep_preroll(AudioCaptureReader reader, int preroll_ms);
+
+void audio_capture_get_stats(AudioCaptureStats *stats);
+void audio_capture_log_stats(void);
+
+#endif
@@ -0,0 +1,127 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#define LOG_LEVEL 4
+#include "../../debug_log.h"
+#include "../common/alsa.h"
+#include "../common/infer_config.h"
+#include "../common/polyphase.h"
+#include "../kws/sherpa_kws.h"
+#include "asr_kws_constants.h"
+#include "audio_capture.h"
+#include "kws_worker.h"
+
+#define TAG "KWS_WORKER"
+
+static pthread_t g_thread;
+static int g_thread_started = 0;
+static atomic_int g_worker_running = 0;
+static kws_wake_cb g_on_wake = NULL;
+
+// 重采样器只在 KWS 线程使用，与主线程 ASR 的 mysamplerate 互不干扰
+static PolyphaseResampler g_resampler;
+static int16_t *g_pcm = NULL;
+static float *g_model_audio = NULL;
+
+static void *kws_thread(void *arg)
+{
+    uint64_t consumed = 0;
+    (void)arg;
+
+    infer_bind_current_thread(INFER_KWS);
+
+    while (atomic_load_explicit(&g_worker_running, memory_order_relaxed)) {
+        char keyword[256] = {0};
+        float *audio = g_model_audio;
+        int frames = audio_capture_read(CAPTURE_READER_KWS, g_pcm, PERIOD_SIZE, CAPTURE_WAIT_MS);
+
+        if (frames < 0) {
+            LOGE(TAG, "录音采集已停止，KWS线程退出");
+            break;
+        }
+        if (frames == 0) {
+            continue;
+        }
+        consumed += (uint64_t)frames;
+
+        if (g_resampler.taps > 0) {
+            pcm_s16_to_float(g_pcm, polyphase_input(&g_resampler, frames), frames);
+            frames = polyphase_run(&g_resampler, frames, g_model_audio);
+        } else {
+            pcm_s16_to_float(g_pcm, audio, frames);
+        }
+        if (frames == 0) {
+            continue;
+        }
+        if (process_kws_result(audio, frames, keyword, sizeof(keyword)) && g_on_wake != NULL) {
+            g_on_wake(keyword, consumed);
+        }
+    }
+    return NULL;
+}
+
+int kws_worker_start(kws_wake_cb on_wake)
+{
+    sigset_t block;
+    sigset_t old;
+    int ret;
+
+    if (g_thread_started) {
+        return 0;
+    }
+    if (polyphase_init(&g_resampler, g_actual_rate, MODEL_SAMPLE_RATE, PERIOD_SIZE) != 0) {
+        return -1;
+    }
+    g_pcm = (int16_t *)malloc(PERIOD_SIZE * CHANNELS * sizeof(int16_t));
+    g_model_audio = (float *)malloc((size_t)polyphase_max_output(&g_resampler, PERIOD_SIZE) * sizeof(float));
+    if (g_pcm == NULL || g_model_audio == NULL) {
+        LOGE(TAG, "分配KWS缓冲区失败（内存不足）");
+        goto fail;
+    }
+    g_on_wake = on_wake;
+
+    // 与采集线程一样不处理进程信号，SIGINT 等总在主线程执行
+    sigfillset(&block);
+    pthread_sigmask(SIG_BLOCK, &block, &old);
+    atomic_store(&g_worker_running, 1);
+    ret = pthread_create(&g_thread, NULL, kws_thread, NULL);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    if (ret != 0) {
+        LOGE(TAG, "创建KWS线程失败: %s", strerror(ret));
+        atomic_store(&g_worker_running, 0);
+        goto fail;
+    }
+    g_thread_started = 1;
+    LOGI(TAG, "KWS线程已启动（%u Hz → %d Hz）", g_actual_rate, MODEL_SAMPLE_RATE);
+    return 0;
+
+fail:
+    free(g_pcm);
+    free(g_model_audio);
+    g_pcm = NULL;
+    g_model_audio = NULL;
+    polyphase_free(&g_resampler);
+    return -1;
+}
+
+void kws_worker_stop(void)
+{
+    if (!g_thread_started) {
+        return;
+    }
+    // 读取最多等待 CAPTURE_WAIT_MS，置位后 join 即可
+    atomic_store(&g_worker_running, 0);
+    pthread_join(g_thread, NULL);
+    g_thread_started = 0;
+
+    free(g_pcm);
+    free(g_model_audio);
+    g_pcm = NULL;
+    g_model_audio = NULL;
+    polyphase_free(&g_resampler);
+    LOGI(TAG, "KWS线程已停止");
+}
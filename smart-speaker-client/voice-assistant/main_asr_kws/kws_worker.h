@@ -0,0 +1,18 @@
+#ifndef __KWS_WORKER_H__
+#define __KWS_WORKER_H__
+
+#include <stdint.h>
+
+/* KWS 线程：从采集环形缓冲区的 KWS 读端持续取音频做关键词检测，
+ * 不受主线程 ASR 解码和唤醒应答握手阻塞，识别或播报期间也能再次唤醒。 */
+
+// 检测到关键词时在 KWS 线程上回调；capture_frame 为检测时 KWS 读端已消费的采集帧数
+typedef void (*kws_wake_cb)(const char *keyword, uint64_t capture_frame);
+
+// 启动 KWS 线程（需在 init_sherpa_kws 和 audio_capture_start 之后调用），0 成功，-1 失败
+int kws_worker_start(kws_wake_cb on_wake);
+
+// 停止并回收 KWS 线程，可重复调用；须在 audio_capture_stop 之前调用
+void kws_worker_stop(void);
+
+#endif
@@ -4,11 +4,9 @@
 #include <errno.h>
 #include <signal.h>
 #include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
 #include <unistd.h>
 #include <time.h>
-#include <poll.h>
+#include <pthread.h>
 
 #define LOG_LEVEL 4
 #include "../../debug_log.h"
@@ -16,11 +14,14 @@
 #include "../../ipc/ipc_message.h"
 #include "../common/alsa.h"
 #include "../common/mysamplerate.h"
+#include "../common/infer_config.h"
 #include "../asr/sherpa_asr.h"
 #include "../kws/sherpa_kws.h"
 #include "asr_kws_constants.h"
 #include "asr_kws_types.h"
 #include "asr_kws_pipe.h"
+#include "audio_capture.h"
+#include "kws_worker.h"
 
 #define TAG "ASR_KWS_MAIN"
 
@@ -28,96 +29,117 @@ char g_last_asr_text[1024] = {0};
 struct timespec g_last_asr_update_time = {0, 0};
 int g_asr_result_updated = 0;
 
-int running = 1;
-int asr_fd = -1;
-int kws_fd = -1;
-int tts_fd = -1;
-int asr_ctrl_fd = -1;
+static volatile sig_atomic_t running = 1;
 int16_t *alsa_buf = NULL;
-uint32_t g_tts_seq = 0;
 
 int current_state = STATE_KWS;
 enum OnlineMode g_current_online_mode = ONLINE_MODE_YES;
 
-/* 须在发 PLAY_WAKE_RESPONSE 之前打开读端，否则 TTS 侧 O_WRONLY|O_NONBLOCK 会因无读端而 ENXIO，无法写入完成信号 */
-static int tts_wake_done_open_and_drain(void)
-{
-    int rfd = open(TTS_WAKE_DONE_FIFO_PATH, O_RDONLY | O_NONBLOCK);
-    char drain[64];
-    ssize_t n;
+/* KWS 线程与主线程都会经总线发消息，连接的收发和重连都在该锁内。
+ * KWS 线程每次唤醒递增 g_wake_seq 并记下 PLAY_WAKE_RESPONSE 的请求 seq，主线程据此进入 STATE_WAKE，
+ * 在循环中非阻塞地等 TTS 带同一 seq 的应答，期间仍可被再次唤醒打断 */
+static pthread_mutex_t g_pipe_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint32_t g_wake_seq = 0;
+static uint32_t g_wake_reply_seq = 0;
+static uint32_t g_wake_seen_seq = 0;            // 仅主线程
+static struct timespec g_wake_start_time;       // 仅主线程
 
-    if (rfd < 0) {
-        LOGW(TAG, "打开tts唤醒完成管道失败: %s", strerror(errno));
-        return -1;
+static int send_tts_command_locked(IPCCommandType type, const char *text, const char *filename, uint32_t *seq_out) {
+    const char *payload = NULL;
+    if (type == IPC_CMD_PLAY_TEXT) {
+        payload = text;
+    } else if (type == IPC_CMD_PLAY_AUDIO_FILE) {
+        payload = filename;
     }
-    while ((n = read(rfd, drain, sizeof(drain))) > 0) {
+    // 非阻塞发送，TTS 未就绪或积压时直接放弃，不在采集 / 唤醒路径上重试等待
+    if (asr_kws_pipe_send_tts((uint16_t)type, payload, seq_out) != 0) {
+        return -1;
     }
-    return rfd;
+    LOGD(TAG, "发送TTS命令成功: type=%d", type);
+    return 0;
 }
 
-static void tts_wake_done_wait_close(int rfd)
-{
-    struct pollfd pfd;
-    char b = 0;
-    int pr;
+int send_tts_command(IPCCommandType type, const char *text, const char *filename) {
+    int ret;
+    pthread_mutex_lock(&g_pipe_mutex);
+    ret = send_tts_command_locked(type, text, filename, NULL);
+    pthread_mutex_unlock(&g_pipe_mutex);
+    return ret;
+}
+
+static void send_player_event(IPCCommandType type, const char *text) {
+    pthread_mutex_lock(&g_pipe_mutex);
+    asr_kws_pipe_send_player((uint16_t)type, text);
+    pthread_mutex_unlock(&g_pipe_mutex);
+}
 
-    if (rfd < 0) {
+/* KWS 线程回调：立即通知 player（唤醒即压低音乐）并打断 TTS、播唤醒应答，不等应答播完；
+ * 识别中、应答中或播报中再次唤醒同样走这里，由主线程丢弃进行中的识别 */
+static void on_kws_wake(const char *keyword, uint64_t capture_frame) {
+    uint32_t seq = 0;
+
+    if (strcmp(keyword, "小米小米") != 0 && strcmp(keyword, "小刘同学") != 0) {
         return;
     }
-    pfd.fd = rfd;
-    pfd.events = POLLIN;
-    pfd.revents = 0;
-    pr = poll(&pfd, 1, 15000);
-    if (pr > 0 && (pfd.revents & POLLIN)) {
-        if (read(rfd, &b, 1) != 1) {
-            LOGW(TAG, "读取tts唤醒完成信号失败: %s", strerror(errno));
-        }
-    } else if (pr == 0) {
-        LOGW(TAG, "等待tts唤醒完成超时，继续进入ASR模式");
-    } else if (pr < 0) {
-        LOGW(TAG, "等待tts唤醒完成失败: %s", strerror(errno));
-    } else {
-        LOGW(TAG, "tts唤醒完成管道异常关闭，继续进入ASR模式");
-    }
-    close(rfd);
+    LOGI(TAG, "检测到唤醒词: %s（采集第 %.2f 秒）", keyword, (double)capture_frame / g_actual_rate);
+
+    pthread_mutex_lock(&g_pipe_mutex);
+    asr_kws_pipe_send_player(IPC_EVT_KWS_WAKE, keyword);
+    send_tts_command_locked(IPC_CMD_STOP_PLAYING, NULL, NULL, NULL);
+    // 发送失败时 seq 为 0，主线程不再等应答；旧请求的应答 seq 不同，不会被误认
+    send_tts_command_locked(IPC_CMD_PLAY_WAKE_RESPONSE, NULL, NULL, &seq);
+    g_wake_reply_seq = seq;
+    g_wake_seq++;
+    pthread_mutex_unlock(&g_pipe_mutex);
 }
 
-int send_tts_command(IPCCommandType type, const char *text, const char *filename) {
-    if (tts_fd == -1) {
-        asr_kws_pipe_open(&asr_fd, &kws_fd, &tts_fd, &asr_ctrl_fd);
-        if (tts_fd == -1) {
-            LOGW(TAG, "TTS管道未打开");
-            return -1;
-        }
-    }
+static void enter_kws_state(void) {
+    memset(g_last_asr_text, 0, sizeof(g_last_asr_text));
+    g_asr_result_updated = 0;
+    current_state = STATE_KWS;
+    LOGI(TAG, "=========关键词识别模式=========");
+}
 
-    const char *payload = NULL;
-    if (type == IPC_CMD_PLAY_TEXT) {
-        payload = text;
-    } else if (type == IPC_CMD_PLAY_AUDIO_FILE) {
-        payload = filename;
-    }
+// 主线程：处理新的唤醒，以及唤醒应答开始播放（或超时）后进入 ASR
+static void handle_wake_events(void) {
+    int done = 0;
 
-    int retry_count = 3;
-    while (retry_count > 0) {
-        uint32_t body_len = payload ? (uint32_t)(strlen(payload) + 1) : 0;
-        if (ipc_send_message(tts_fd, (uint16_t)type, payload, body_len, &g_tts_seq) == 0) {
-            LOGD(TAG, "发送TTS命令成功: type=%d", type);
-            return 0;
+    pthread_mutex_lock(&g_pipe_mutex);
+    if (g_wake_seq != g_wake_seen_seq) {
+        g_wake_seen_seq = g_wake_seq;
+        if (current_state == STATE_ASR) {
+            LOGI(TAG, "识别中再次唤醒，丢弃本轮识别: %s", g_last_asr_text);
         }
-        LOGE(TAG, "发送TTS命令失败: %s (errno=%d)", strerror(errno), errno);
-        if (errno == EPIPE || errno == ENXIO) {
-            LOGW(TAG, "管道破裂，尝试重新打开");
-            close(tts_fd);
-            tts_fd = -1;
-            asr_kws_pipe_open(&asr_fd, &kws_fd, &tts_fd, &asr_ctrl_fd);
+        sherpa_asr_reset();
+        memset(g_last_asr_text, 0, sizeof(g_last_asr_text));
+        g_asr_result_updated = 0;
+        clock_gettime(CLOCK_MONOTONIC, &g_wake_start_time);
+        current_state = STATE_WAKE;
+        LOGI(TAG, "=========唤醒应答=========");
+    }
+    if (current_state == STATE_WAKE) {
+        struct timespec now;
+        long elapsed_ms;
+
+        done = asr_kws_pipe_tts_replied(g_wake_reply_seq);
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        elapsed_ms = (now.tv_sec - g_wake_start_time.tv_sec) * 1000L +
+                     (now.tv_nsec - g_wake_start_time.tv_nsec) / 1000000L;
+        if (!done && elapsed_ms > WAKE_RESPONSE_TIMEOUT_MS) {
+            LOGW(TAG, "等待tts唤醒应答超时，继续进入ASR模式");
+            done = 1;
         }
-        retry_count--;
-        struct pollfd pfd = { .fd = 0, .events = 0 };
-        poll(&pfd, 1, 50);
     }
-    LOGE(TAG, "发送TTS命令失败，重试次数耗尽");
-    return -1;
+    pthread_mutex_unlock(&g_pipe_mutex);
+
+    if (done) {
+        clock_gettime(CLOCK_MONOTONIC, &g_last_asr_update_time);
+        current_state = STATE_ASR;
+        LOGI(TAG, "=========语音识别模式=========");
+        // 唤醒应答播放期间的录音含有设备自身的声音，跳过但保留末尾预录，避免截掉紧接着开口的指令
+        audio_capture_keep_preroll(CAPTURE_READER_ASR, ASR_PREROLL_MS);
+        audio_capture_log_stats();
+    }
 }
 
 void check_asr_timeout(void) {
@@ -136,38 +158,20 @@ void check_asr_timeout(void) {
         if (strlen(g_last_asr_text) > 0) {
             LOGI(TAG, "最终识别结果: %s", g_last_asr_text);
             send_tts_command(IPC_CMD_STOP_PLAYING, NULL, NULL);
-            asr_kws_pipe_write_text(&asr_fd, ASR_FIFO_PATH, g_last_asr_text);
+            send_player_event(IPC_EVT_ASR_TEXT, g_last_asr_text);
         } else {
-            char line[64];
-            snprintf(line, sizeof(line), "%s\n", ASR_TIMEOUT_SENTINEL);
-            if (asr_fd >= 0) {
-                write(asr_fd, line, strlen(line));
-            }
+            send_player_event(IPC_EVT_ASR_TIMEOUT, NULL);
         }
 
-        memset(g_last_asr_text, 0, sizeof(g_last_asr_text));
-        g_asr_result_updated = 0;
-        current_state = STATE_KWS;
-        LOGI(TAG, "=========关键词识别模式=========");
+        enter_kws_state();
     }
 }
 
+/* 只清标志：线程 join、模型释放等都不是异步信号安全的，而且主线程可能正持有 g_pipe_mutex，
+ * 在这里 join KWS 线程会死锁。主循环最多 CAPTURE_WAIT_MS 后看到标志，走 CLEAR 清理 */
 void sigint_handler(int sig) {
-    LOGI(TAG, "收到退出信号，正在清理资源...");
-    if (alsa_buf != NULL) {
-        free(alsa_buf);
-    }
-    if (asr_fd != -1) close(asr_fd);
-    if (kws_fd != -1) close(kws_fd);
-    if (tts_fd != -1) close(tts_fd);
-    if (asr_ctrl_fd != -1) close(asr_ctrl_fd);
-    cleanup_sherpa_asr();
-    cleanup_resampler();
-    cleanup_alsa();
-    cleanup_sherpa_kws();
-    LOGI(TAG, "ASR+KWS进程退出");
+    (void)sig;
     running = 0;
-    exit(0);
 }
 
 static void offline_handler(int s) {
@@ -236,27 +240,51 @@ int main(int argc, char const *argv[]) {
     }
     LOGI(TAG, "关键词识别模型加载完成");
 
-    asr_kws_pipe_open(&asr_fd, &kws_fd, &tts_fd, &asr_ctrl_fd);
+    if (!running) goto CLEAR;
+
+    if (asr_kws_pipe_open() != 0) {
+        goto CLEAR;
+    }
+
+    if (audio_capture_start() != 0) {
+        LOGE(TAG, "启动录音采集线程失败!");
+        goto CLEAR;
+    }
+    if (kws_worker_start(on_kws_wake) != 0) {
+        LOGE(TAG, "启动KWS线程失败!");
+        goto CLEAR;
+    }
+    // 主线程跑 ASR 解码，采集线程和 KWS 线程创建之后再绑核，二者不继承 ASR 的亲和性
+    infer_bind_current_thread(INFER_ASR);
     LOGI(TAG, "=========关键词识别模式=========");
 
     while (running) {
-        asr_kws_pipe_process_ctrl(&asr_ctrl_fd, (int *)&g_current_online_mode);
-        snd_pcm_sframes_t read_frames = snd_pcm_readi(g_pcm_handle, alsa_buf, PERIOD_SIZE);
-        if (read_frames < 0) {
-            LOGW(TAG, "ALSA读取失败: %s", snd_strerror(read_frames));
-            if (read_frames == -EPIPE) {
-                snd_pcm_prepare(g_pcm_handle);
-                continue;
+        asr_kws_pipe_process_ctrl((int *)&g_current_online_mode);
+        handle_wake_events();
+
+        if (current_state != STATE_ASR) {
+            // 不在识别时只等新数据、保留预录，音频由 KWS 线程处理
+            if (audio_capture_wait(CAPTURE_READER_ASR, CAPTURE_WAIT_MS) < 0) {
+                LOGE(TAG, "录音采集线程已退出");
+                break;
             }
+            audio_capture_keep_preroll(CAPTURE_READER_ASR, ASR_PREROLL_MS);
+            continue;
+        }
+
+        int read_frames = audio_capture_read(CAPTURE_READER_ASR, alsa_buf, PERIOD_SIZE, CAPTURE_WAIT_MS);
+        if (read_frames < 0) {
+            LOGE(TAG, "录音采集线程已退出");
             break;
         }
         if (read_frames == 0) {
+            check_asr_timeout();
             continue;
         }
 
         float *model_audio = NULL;
         int model_frames = 0;
-        if (resample_audio(alsa_buf, (int)read_frames, &model_audio, &model_frames) != 0) {
+        if (resample_audio(alsa_buf, read_frames, &model_audio, &model_frames) != 0) {
             LOGW(TAG, "重采样失败，跳过当前帧");
             continue;
         }
@@ -264,48 +292,26 @@ int main(int argc, char const *argv[]) {
             continue;
         }
 
-        if (current_state == STATE_ASR && g_current_online_mode == ONLINE_MODE_YES) {
-            if (process_asr_result(model_audio, model_frames) == 0) {
-                LOGI(TAG, "识别完成，结果: %s", g_last_asr_text);
-
-                if (strlen(g_last_asr_text) > 0) {
-                    send_tts_command(IPC_CMD_STOP_PLAYING, NULL, NULL);
-                    asr_kws_pipe_write_text(&asr_fd, ASR_FIFO_PATH, g_last_asr_text);
-                }
-
-                memset(g_last_asr_text, 0, sizeof(g_last_asr_text));
-                g_asr_result_updated = 0;
-                current_state = STATE_KWS;
-                LOGI(TAG, "=========关键词识别模式=========");
-            } else {
-                check_asr_timeout();
-            }
-        } else if (current_state == STATE_KWS) {
-            char keyword[256] = {0};
-            if (process_kws_result(model_audio, model_frames, keyword, sizeof(keyword))) {
-                int is_wake = (!strcmp(keyword, "小米小米") || !strcmp(keyword, "小刘同学"));
-                if (!is_wake)
-                    continue;
-                LOGI(TAG, "检测到唤醒词: %s", keyword);
-                {
-                    int wake_done_rfd = tts_wake_done_open_and_drain();
-                    asr_kws_pipe_write_text(&kws_fd, KWS_FIFO_PATH, keyword);
-                    send_tts_command(IPC_CMD_STOP_PLAYING, NULL, NULL);
-                    send_tts_command(IPC_CMD_PLAY_WAKE_RESPONSE, NULL, NULL);
-                    tts_wake_done_wait_close(wake_done_rfd);
-                }
-                clock_gettime(CLOCK_MONOTONIC, &g_last_asr_update_time);
-                memset(g_last_asr_text, 0, sizeof(g_last_asr_text));
-                g_asr_result_updated = 0;
-                current_state = STATE_ASR;
-                LOGI(TAG, "=========语音识别模式=========");
-                snd_pcm_drop(g_pcm_handle);
-                snd_pcm_prepare(g_pcm_handle);
+        if (g_current_online_mode != ONLINE_MODE_YES) {
+            check_asr_timeout();
+            continue;
+        }
+        if (process_asr_result(model_audio, model_frames) == 0) {
+            LOGI(TAG, "识别完成，结果: %s", g_last_asr_text);
+
+            if (strlen(g_last_asr_text) > 0) {
+                send_tts_command(IPC_CMD_STOP_PLAYING, NULL, NULL);
+                send_player_event(IPC_EVT_ASR_TEXT, g_last_asr_text);
             }
+            enter_kws_state();
+        } else {
+            check_asr_timeout();
         }
     }
 
 CLEAR:
+    kws_worker_stop();
+    audio_capture_stop();
     if (alsa_buf != NULL) {
         free(alsa_buf);
     }
@@ -313,6 +319,7 @@ CLEAR:
     cleanup_resampler();
     cleanup_alsa();
     cleanup_sherpa_kws();
-    LOGI(TAG, "语音识别系统退出...");
+    asr_kws_pipe_close();
+    LOGI(TAG, "ASR+KWS进程退出");
     return 0;
 }
@@ -3,32 +3,31 @@
 #include <string.h>
 #include <errno.h>
 #include <signal.h>
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
 #include <unistd.h>
-#include <poll.h>
 
 #define LOG_LEVEL 4
 #include "../../debug_log.h"
 #include "../common/ipc_protocol.h"
 #include "../../ipc/ipc_message.h"
+#include "../../ipc/ipc_bus.h"
 #include "../tts/alsa_output.h"
 #include "../tts/sherpa_tts.h"
 #include "tts_playback.h"
 #include "tts_ipc_handler.h"
+#include "tts_cache.h"
+
+#define TTS_PREWARM_LIST "./voice-assistant/tts_prewarm.txt"
 
 #define TAG "TTS_MAIN"
 
 int running = 1;
-int tts_fd = -1;
+static IPCBusServer g_bus = { .listen_fd = -1 };
 
 void sigint_handler(int signum) {
     LOGI(TAG, "收到退出信号，正在清理资源...");
     tts_playback_cleanup();
-    if (tts_fd != -1) {
-        close(tts_fd);
-    }
+    tts_cache_cleanup();
+    ipc_bus_server_close(&g_bus);
     cleanup_alsa_output();
     cleanup_sherpa_tts();
     LOGI(TAG, "TTS进程退出");
@@ -42,27 +41,10 @@ void sigusr1_handler(int signum) {
     tts_playback_join();
 }
 
-int open_pipes(void) {
-    mkdir(FIFO_DIR_PATH, 0777);
-    if (access(TTS_FIFO_PATH, F_OK) == -1) {
-        if (mkfifo(TTS_FIFO_PATH, 0666) == -1 && errno != EEXIST) {
-            LOGE(TAG, "创建TTS管道失败: %s", strerror(errno));
-            return -1;
-        }
-    }
-    if (access(TTS_WAKE_DONE_FIFO_PATH, F_OK) == -1) {
-        if (mkfifo(TTS_WAKE_DONE_FIFO_PATH, 0666) == -1 && errno != EEXIST) {
-            LOGE(TAG, "创建唤醒完成管道失败: %s", strerror(errno));
-            return -1;
-        }
-    }
-    tts_fd = open(TTS_FIFO_PATH, O_RDONLY);
-    if (tts_fd == -1) {
-        LOGE(TAG, "打开TTS管道失败: %s", strerror(errno));
-        return -1;
-    }
-    LOGI(TAG, "TTS管道打开成功");
-    return 0;
+static void on_bus_message(int fd, const IPCHeader *header, const uint8_t *body, void *arg) {
+    (void)arg;
+    LOGD(TAG, "收到完整消息，type=%u, body_len=%u, seq=%u", header->type, header->body_len, header->seq);
+    handle_ipc_message(fd, header, body);
 }
 
 int main(int argc, char const *argv[]) {
@@ -85,6 +67,10 @@ int main(int argc, char const *argv[]) {
         return -1;
     }
 
+    if (tts_cache_init(TTS_CACHE_DIR, g_tts_model_hash, g_tts_sample_rate, TTS_SPEAKER_ID, TTS_SPEED) != 0) {
+        LOGW(TAG, "TTS缓存不可用，所有文本都将实时合成");
+    }
+
     char playback_device[256] = "dmix:CARD=rockchipes8388,DEV=0";
     LOGI(TAG, "使用播放设备: %s", playback_device);
 
@@ -94,39 +80,21 @@ int main(int argc, char const *argv[]) {
         return -1;
     }
 
-    if (open_pipes() != 0) {
-        LOGE(TAG, "打开管道失败");
+    if (ipc_bus_server_open(&g_bus, IPC_BUS_TTS) != 0) {
+        LOGE(TAG, "打开消息总线失败（TTS进程是否已在运行？）: %s", strerror(errno));
         cleanup_alsa_output();
         cleanup_sherpa_tts();
         return -1;
     }
 
+    tts_playback_prewarm_start(TTS_PREWARM_LIST);
     LOGI(TAG, "TTS进程就绪，等待命令...");
     LOGD(TAG, "IPC协议头大小: %zu bytes", sizeof(IPCHeader));
 
     while (running) {
-        struct pollfd pfd = { .fd = tts_fd, .events = POLLIN };
-        int pr = poll(&pfd, 1, 100);
-        if (pr <= 0) {
-            continue;
-        }
-        while (running) {
-            IPCHeader header;
-            uint8_t *body = NULL;
-            int ret = ipc_recv_message(tts_fd, &header, &body);
-            if (ret == 1) {
-                break;
-            }
-            if (ret == 2) {
-                continue;
-            }
-            if (ret != 0) {
-                LOGE(TAG, "读取IPC消息失败: %s", strerror(errno));
-                break;
-            }
-            LOGD(TAG, "收到完整消息，type=%u, body_len=%u, seq=%u", header.type, header.body_len, header.seq);
-            handle_ipc_message(header.type, body, header.body_len);
-            free(body);
+        if (ipc_bus_server_poll(&g_bus, 100, on_bus_message, NULL) < 0) {
+            LOGE(TAG, "等待IPC消息失败: %s", strerror(errno));
+            usleep(100 * 1000);
         }
     }
 
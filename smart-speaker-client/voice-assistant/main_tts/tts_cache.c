@@ -0,0 +1,432 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define LOG_LEVEL 4
+#include "../../debug_log.h"
+#include "tts_cache.h"
+
+#define TAG "TTS_CACHE"
+
+#define TTS_CACHE_MAGIC     "TTSC"
+#define TTS_CACHE_VERSION   1
+#define TTS_CACHE_BUCKETS   256
+
+typedef struct {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t sample_rate;
+    uint32_t num_samples;
+    uint32_t text_len;          // 不含结尾 0，文本后补齐到 4 字节再放样本
+    uint32_t reserved;
+} TtsCacheFileHeader;
+
+typedef struct TtsCacheEntry {
+    uint64_t key;
+    const char *text;           // 指向映射区内的文本
+    const float *samples;
+    int32_t n;
+    void *map;
+    size_t map_len;
+    int refs;
+    struct TtsCacheEntry *hash_next;
+    struct TtsCacheEntry *lru_prev;
+    struct TtsCacheEntry *lru_next;
+} TtsCacheEntry;
+
+static pthread_mutex_t g_cache_mutex = PTHREAD_MUTEX_INITIALIZER;
+static char g_cache_dir[256] = {0};
+static uint64_t g_key_seed = 0;
+static uint32_t g_sample_rate = 0;
+static TtsCacheEntry *g_buckets[TTS_CACHE_BUCKETS];
+static TtsCacheEntry *g_lru_head = NULL;       // 最近使用
+static TtsCacheEntry *g_lru_tail = NULL;
+static size_t g_mem_bytes = 0;
+static size_t g_disk_bytes = 0;
+static unsigned long g_hits = 0;
+static unsigned long g_misses = 0;
+
+static uint64_t fnv1a(uint64_t h, const void *data, size_t len)
+{
+    const unsigned char *p = (const unsigned char *)data;
+    size_t i;
+    for (i = 0; i < len; i++) {
+        h ^= p[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+static uint64_t cache_key(const char *text)
+{
+    return fnv1a(g_key_seed, text, strlen(text));
+}
+
+static void cache_path(uint64_t key, char *out, size_t out_size)
+{
+    snprintf(out, out_size, "%s/%016llx.pcm", g_cache_dir, (unsigned long long)key);
+}
+
+static size_t cache_text_span(uint32_t text_len)
+{
+    return ((size_t)text_len + 1 + 3) & ~(size_t)3;
+}
+
+static void lru_unlink(TtsCacheEntry *e)
+{
+    if (e->lru_prev) e->lru_prev->lru_next = e->lru_next; else g_lru_head = e->lru_next;
+    if (e->lru_next) e->lru_next->lru_prev = e->lru_prev; else g_lru_tail = e->lru_prev;
+    e->lru_prev = e->lru_next = NULL;
+}
+
+static void lru_push_front(TtsCacheEntry *e)
+{
+    e->lru_prev = NULL;
+    e->lru_next = g_lru_head;
+    if (g_lru_head) g_lru_head->lru_prev = e; else g_lru_tail = e;
+    g_lru_head = e;
+}
+
+static void entry_remove(TtsCacheEntry *e)
+{
+    TtsCacheEntry **pp = &g_buckets[e->key % TTS_CACHE_BUCKETS];
+    while (*pp != NULL && *pp != e) {
+        pp = &(*pp)->hash_next;
+    }
+    if (*pp == e) {
+        *pp = e->hash_next;
+    }
+    lru_unlink(e);
+    g_mem_bytes -= e->map_len;
+    munmap(e->map, e->map_len);
+    free(e);
+}
+
+// 从 LRU 尾部淘汰未被引用的条目
+static void mem_evict_locked(void)
+{
+    TtsCacheEntry *e = g_lru_tail;
+    while (g_mem_bytes > TTS_CACHE_MEM_BYTES && e != NULL) {
+        TtsCacheEntry *prev = e->lru_prev;
+        if (e->refs == 0) {
+            entry_remove(e);
+        }
+        e = prev;
+    }
+}
+
+static TtsCacheEntry *mem_find_locked(uint64_t key, const char *text)
+{
+    TtsCacheEntry *e;
+    for (e = g_buckets[key % TTS_CACHE_BUCKETS]; e != NULL; e = e->hash_next) {
+        if (e->key == key && strcmp(e->text, text) == 0) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+// 映射磁盘文件并校验；键或文本不符（哈希碰撞、旧模型）返回 NULL
+static TtsCacheEntry *disk_load_locked(uint64_t key, const char *text)
+{
+    char path[320];
+    const TtsCacheFileHeader *hdr;
+    TtsCacheEntry *e;
+    struct stat st;
+    size_t text_len = strlen(text);
+    size_t need;
+    void *map;
+    int fd;
+
+    cache_path(key, path, sizeof(path));
+    fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(TtsCacheFileHeader)) {
+        close(fd);
+        return NULL;
+    }
+    map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        LOGW(TAG, "映射缓存文件失败: %s (%s)", path, strerror(errno));
+        return NULL;
+    }
+    hdr = (const TtsCacheFileHeader *)map;
+    need = sizeof(*hdr) + cache_text_span(hdr->text_len) + (size_t)hdr->num_samples * sizeof(float);
+    if (memcmp(hdr->magic, TTS_CACHE_MAGIC, 4) != 0 || hdr->version != TTS_CACHE_VERSION ||
+        hdr->key != key || hdr->sample_rate != g_sample_rate || hdr->text_len != text_len ||
+        need != (size_t)st.st_size ||
+        memcmp((const char *)map + sizeof(*hdr), text, text_len) != 0) {
+        munmap(map, (size_t)st.st_size);
+        return NULL;
+    }
+
+    e = (TtsCacheEntry *)calloc(1, sizeof(TtsCacheEntry));
+    if (e == NULL) {
+        munmap(map, (size_t)st.st_size);
+        return NULL;
+    }
+    e->key = key;
+    e->text = (const char *)map + sizeof(*hdr);
+    e->samples = (const float *)((const char *)map + sizeof(*hdr) + cache_text_span(hdr->text_len));
+    e->n = (int32_t)hdr->num_samples;
+    e->map = map;
+    e->map_len = (size_t)st.st_size;
+    e->hash_next = g_buckets[key % TTS_CACHE_BUCKETS];
+    g_buckets[key % TTS_CACHE_BUCKETS] = e;
+    lru_push_front(e);
+    g_mem_bytes += e->map_len;
+    // 更新修改时间，磁盘淘汰按最近使用
+    utimensat(AT_FDCWD, path, NULL, 0);
+    return e;
+}
+
+typedef struct {
+    char name[32];
+    time_t mtime;
+    off_t size;
+} DiskFile;
+
+static int disk_file_cmp(const void *a, const void *b)
+{
+    const DiskFile *x = (const DiskFile *)a;
+    const DiskFile *y = (const DiskFile *)b;
+    return (x->mtime > y->mtime) - (x->mtime < y->mtime);
+}
+
+/* 扫描目录统计占用；evict 时删最旧的文件直到降到上限的 3/4（已映射的文件删除后映射仍有效） */
+static void disk_scan(int evict)
+{
+    DIR *dir = opendir(g_cache_dir);
+    DiskFile *files = NULL;
+    size_t count = 0;
+    size_t cap = 0;
+    size_t total = 0;
+    struct dirent *de;
+    size_t i;
+
+    if (dir == NULL) {
+        return;
+    }
+    while ((de = readdir(dir)) != NULL) {
+        char path[320];
+        struct stat st;
+        size_t len = strlen(de->d_name);
+        if (len < 5 || len >= sizeof(files[0].name) || strcmp(de->d_name + len - 4, ".pcm") != 0) {
+            continue;
+        }
+        snprintf(path, sizeof(path), "%s/%s", g_cache_dir, de->d_name);
+        if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) {
+            continue;
+        }
+        total += (size_t)st.st_size;
+        if (!evict) {
+            continue;
+        }
+        if (count == cap) {
+            size_t ncap = cap ? cap * 2 : 64;
+            DiskFile *nf = (DiskFile *)realloc(files, ncap * sizeof(DiskFile));
+            if (nf == NULL) {
+                break;
+            }
+            files = nf;
+            cap = ncap;
+        }
+        memcpy(files[count].name, de->d_name, len + 1);
+        files[count].mtime = st.st_mtime;
+        files[count].size = st.st_size;
+        count++;
+    }
+    closedir(dir);
+
+    if (evict && total > TTS_CACHE_DISK_BYTES) {
+        qsort(files, count, sizeof(DiskFile), disk_file_cmp);
+        for (i = 0; i < count && total > TTS_CACHE_DISK_BYTES / 4 * 3; i++) {
+            char path[320];
+            snprintf(path, sizeof(path), "%s/%s", g_cache_dir, files[i].name);
+            if (unlink(path) == 0) {
+                total -= (size_t)files[i].size;
+            }
+        }
+        LOGI(TAG, "磁盘缓存超限，淘汰 %zu 个文件，剩余 %zu KB", i, total / 1024);
+    }
+    free(files);
+    g_disk_bytes = total;
+}
+
+int tts_cache_is_cacheable(const char *text)
+{
+    size_t len;
+    if (g_cache_dir[0] == '\0' || text == NULL) {
+        return 0;
+    }
+    len = strlen(text);
+    return len > 0 && len <= TTS_CACHE_MAX_TEXT_BYTES;
+}
+
+int tts_cache_init(const char *dir, uint64_t model_hash, uint32_t sample_rate, int32_t speaker_id, float speed)
+{
+    char parent[256];
+    char *slash;
+
+    if (dir == NULL || strlen(dir) >= sizeof(g_cache_dir)) {
+        return -1;
+    }
+    snprintf(parent, sizeof(parent), "%s", dir);
+    slash = strrchr(parent, '/');
+    if (slash != NULL && slash != parent) {
+        *slash = '\0';
+        if (mkdir(parent, 0755) != 0 && errno != EEXIST) {
+            LOGW(TAG, "创建目录失败: %s (%s)", parent, strerror(errno));
+            return -1;
+        }
+    }
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        LOGW(TAG, "创建缓存目录失败: %s (%s)", dir, strerror(errno));
+        return -1;
+    }
+
+    pthread_mutex_lock(&g_cache_mutex);
+    snprintf(g_cache_dir, sizeof(g_cache_dir), "%s", dir);
+    g_sample_rate = sample_rate;
+    g_key_seed = fnv1a(14695981039346656037ULL, &model_hash, sizeof(model_hash));
+    g_key_seed = fnv1a(g_key_seed, &sample_rate, sizeof(sample_rate));
+    g_key_seed = fnv1a(g_key_seed, &speaker_id, sizeof(speaker_id));
+    g_key_seed = fnv1a(g_key_seed, &speed, sizeof(speed));
+    disk_scan(1);
+    pthread_mutex_unlock(&g_cache_mutex);
+    LOGI(TAG, "TTS缓存目录: %s，磁盘占用 %zu KB", dir, g_disk_bytes / 1024);
+    return 0;
+}
+
+int tts_cache_lookup(const char *text, TtsCacheHit *hit)
+{
+    TtsCacheEntry *e;
+    uint64_t key;
+
+    if (!tts_cache_is_cacheable(text) || hit == NULL) {
+        return -1;
+    }
+    key = cache_key(text);
+    pthread_mutex_lock(&g_cache_mutex);
+    e = mem_find_locked(key, text);
+    if (e != NULL) {
+        lru_unlink(e);
+        lru_push_front(e);
+    } else {
+        e = disk_load_locked(key, text);
+    }
+    if (e == NULL) {
+        g_misses++;
+        pthread_mutex_unlock(&g_cache_mutex);
+        return -1;
+    }
+    e->refs++;
+    g_hits++;
+    mem_evict_locked();
+    pthread_mutex_unlock(&g_cache_mutex);
+    hit->samples = e->samples;
+    hit->n = e->n;
+    hit->entry = e;
+    return 0;
+}
+
+void tts_cache_release(TtsCacheHit *hit)
+{
+    if (hit == NULL || hit->entry == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&g_cache_mutex);
+    ((TtsCacheEntry *)hit->entry)->refs--;
+    mem_evict_locked();
+    pthread_mutex_unlock(&g_cache_mutex);
+    hit->entry = NULL;
+    hit->samples = NULL;
+    hit->n = 0;
+}
+
+int tts_cache_store(const char *text, const float *samples, int32_t n)
+{
+    TtsCacheFileHeader hdr;
+    static const char pad[4] = {0};
+    char path[320];
+    char tmp[340];
+    size_t text_len;
+    size_t file_len;
+    uint64_t key;
+    FILE *fp;
+    int ok;
+
+    if (!tts_cache_is_cacheable(text) || samples == NULL || n <= 0) {
+        return -1;
+    }
+    text_len = strlen(text);
+    key = cache_key(text);
+    memset(&hdr, 0, sizeof(hdr));
+    memcpy(hdr.magic, TTS_CACHE_MAGIC, 4);
+    hdr.version = TTS_CACHE_VERSION;
+    hdr.key = key;
+    hdr.sample_rate = g_sample_rate;
+    hdr.num_samples = (uint32_t)n;
+    hdr.text_len = (uint32_t)text_len;
+
+    cache_path(key, path, sizeof(path));
+    snprintf(tmp, sizeof(tmp), "%s.%ld.tmp", path, (long)getpid());
+    fp = fopen(tmp, "wb");
+    if (fp == NULL) {
+        LOGW(TAG, "写缓存失败: %s (%s)", tmp, strerror(errno));
+        return -1;
+    }
+    ok = fwrite(&hdr, sizeof(hdr), 1, fp) == 1 &&
+         fwrite(text, 1, text_len, fp) == text_len &&
+         fwrite(pad, 1, cache_text_span((uint32_t)text_len) - text_len, fp) == cache_text_span((uint32_t)text_len) - text_len &&
+         fwrite(samples, sizeof(float), (size_t)n, fp) == (size_t)n;
+    if (fclose(fp) != 0) {
+        ok = 0;
+    }
+    if (!ok || rename(tmp, path) != 0) {
+        LOGW(TAG, "写缓存失败: %s", path);
+        unlink(tmp);
+        return -1;
+    }
+    file_len = sizeof(hdr) + cache_text_span((uint32_t)text_len) + (size_t)n * sizeof(float);
+
+    pthread_mutex_lock(&g_cache_mutex);
+    g_disk_bytes += file_len;
+    if (g_disk_bytes > TTS_CACHE_DISK_BYTES) {
+        disk_scan(1);
+    }
+    if (mem_find_locked(key, text) == NULL) {
+        disk_load_locked(key, text);
+        mem_evict_locked();
+    }
+    pthread_mutex_unlock(&g_cache_mutex);
+    LOGD(TAG, "已缓存 %d 个样本: %s", n, text);
+    return 0;
+}
+
+void tts_cache_cleanup(void)
+{
+    int i;
+    pthread_mutex_lock(&g_cache_mutex);
+    LOGI(TAG, "TTS缓存统计: 命中 %lu 次，未命中 %lu 次，内存 %zu KB", g_hits, g_misses, g_mem_bytes / 1024);
+    for (i = 0; i < TTS_CACHE_BUCKETS; i++) {
+        while (g_buckets[i] != NULL) {
+            entry_remove(g_buckets[i]);
+        }
+    }
+    g_cache_dir[0] = '\0';
+    g_hits = 0;
+    g_misses = 0;
+    pthread_mutex_unlock(&g_cache_mutex);
+}
@@ -0,0 +1,33 @@
+#ifndef __TTS_CACHE_H__
+#define __TTS_CACHE_H__
+
+#include <stdint.h>
+
+/* TTS 合成结果缓存：键为 (文本, 说话人, 语速, 模型标识) 的哈希。
+ * 磁盘上每条一个文件（头 + 文本 + float PCM），命中时 mmap 进内存 LRU，样本直接指向映射区。 */
+
+#define TTS_CACHE_DIR               "./data/tts_cache"
+#define TTS_CACHE_MEM_BYTES         (8 * 1024 * 1024)   // 内存 LRU 上限（按映射大小计）
+#define TTS_CACHE_DISK_BYTES        (64 * 1024 * 1024)  // 磁盘上限，超出按修改时间淘汰最旧的
+#define TTS_CACHE_MAX_TEXT_BYTES    128                 // 只缓存短句，长回答几乎不会重复
+
+typedef struct {
+    const float *samples;
+    int32_t n;
+    void *entry;        // 内部句柄，用完须 tts_cache_release
+} TtsCacheHit;
+
+// 初始化缓存目录；model_hash/sample_rate/speaker_id/speed 参与键计算，模型变化后旧条目自然失效
+int tts_cache_init(const char *dir, uint64_t model_hash, uint32_t sample_rate, int32_t speaker_id, float speed);
+void tts_cache_cleanup(void);
+
+// 命中返回 0 并填充 hit，未命中返回 -1
+int tts_cache_lookup(const char *text, TtsCacheHit *hit);
+void tts_cache_release(TtsCacheHit *hit);
+
+// 写入磁盘并放入内存 LRU；文本过长或不可缓存时返回 -1
+int tts_cache_store(const char *text, const float *samples, int32_t n);
+
+int tts_cache_is_cacheable(const char *text);
+
+#endif
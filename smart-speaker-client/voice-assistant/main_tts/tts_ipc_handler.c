@@ -2,18 +2,21 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
-#include <fcntl.h>
 #include <unistd.h>
 
 #define LOG_LEVEL 4
 #include "../../debug_log.h"
 #include "../common/ipc_protocol.h"
+#include "../../ipc/ipc_bus.h"
 #include "../tts/alsa_output.h"
 #include "tts_playback.h"
 
 #define TAG "TTS_MAIN"
 
-void handle_ipc_message(uint16_t type, const uint8_t *body, uint32_t body_len) {
+void handle_ipc_message(int fd, const IPCHeader *header, const uint8_t *body) {
+    uint16_t type = header->type;
+    uint32_t body_len = header->body_len;
+
     switch (type) {
         case IPC_CMD_PLAY_TEXT: {
             if (body == NULL || body_len == 0) {
@@ -27,16 +30,40 @@ void handle_ipc_message(uint16_t type, const uint8_t *body, uint32_t body_len) {
             LOGI(TAG, "收到播放文本命令, 长度: %u", body_len);
             tts_playback_stop();
             if (tts_playback_request_text(text) != 0) {
-                tts_playback_notify_player("tts:done");
+                tts_playback_notify_player(IPC_EVT_TTS_DONE);
             }
             free(text);
             break;
         }
 
+        case IPC_CMD_STREAM_TEXT_BEGIN:
+        case IPC_CMD_STREAM_TEXT_APPEND: {
+            char *text = (char *)malloc(body_len + 1);
+            if (!text) return;
+            if (body_len > 0) memcpy(text, body, body_len);
+            text[body_len] = '\0';
+            if (type == IPC_CMD_STREAM_TEXT_BEGIN) {
+                LOGI(TAG, "收到流式文本开始命令, 长度: %u", body_len);
+                tts_playback_stop();
+                if (tts_playback_request_text_stream(text) != 0) {
+                    tts_playback_notify_player(IPC_EVT_TTS_DONE);
+                }
+            } else if (tts_playback_append_text(text) != 0) {
+                LOGD(TAG, "流式文本会话已结束，丢弃: %s", text);
+            }
+            free(text);
+            break;
+        }
+
+        case IPC_CMD_STREAM_TEXT_END:
+            LOGI(TAG, "收到流式文本结束命令");
+            tts_playback_end_text_stream();
+            break;
+
         case IPC_CMD_PLAY_AUDIO_FILE: {
             if (body == NULL || body_len == 0) {
                 LOGW(TAG, "音频文件路径为空，跳过播放");
-                tts_playback_notify_player("tts:done");
+                tts_playback_notify_player(IPC_EVT_TTS_DONE);
                 break;
             }
             if (tts_playback_get_content_session()) {
@@ -45,24 +72,24 @@ void handle_ipc_message(uint16_t type, const uint8_t *body, uint32_t body_len) {
             char *path = (char *)malloc(body_len + 1);
             if (path == NULL) {
                 LOGE(TAG, "分配音频路径内存失败");
-                tts_playback_notify_player("tts:done");
+                tts_playback_notify_player(IPC_EVT_TTS_DONE);
                 break;
             }
             memcpy(path, body, body_len);
             path[body_len] = '\0';
             if (path[0] == '\0') {
                 free(path);
-                tts_playback_notify_player("tts:done");
+                tts_playback_notify_player(IPC_EVT_TTS_DONE);
                 break;
             }
             LOGI(TAG, "收到播放音频文件命令: %s", path);
             if (access(path, F_OK) != 0) {
                 LOGW(TAG, "音频文件不存在: %s", path);
                 free(path);
-                tts_playback_notify_player("tts:done");
+                tts_playback_notify_player(IPC_EVT_TTS_DONE);
                 break;
             }
-            tts_playback_notify_player("tts:start");
+            tts_playback_notify_player(IPC_EVT_TTS_START);
             tts_playback_play_wav_file(path);
             free(path);
             break;
@@ -76,20 +103,14 @@ void handle_ipc_message(uint16_t type, const uint8_t *body, uint32_t body_len) {
         case IPC_CMD_PLAY_WAKE_RESPONSE: {
             LOGI(TAG, "收到播放唤醒响应命令");
             tts_playback_stop();
-            tts_playback_notify_player("tts:start");
-            /* 在 wake_response 内 join 旧播放线程之前写 fifo，避免 ASR 在 poll 上与 dmix 争用同卡死 */
-            int wfd = open(TTS_WAKE_DONE_FIFO_PATH, O_WRONLY | O_NONBLOCK);
-            if (wfd >= 0) {
-                if (write(wfd, "1", 1) != 1) {
-                    LOGW(TAG, "写入tts唤醒完成信号失败: %s", strerror(errno));
-                }
-                close(wfd);
-            } else {
-                LOGW(TAG, "打开tts唤醒完成管道写端失败: %s", strerror(errno));
+            tts_playback_notify_player(IPC_EVT_TTS_START);
+            /* 在 wake_response 内 join 旧播放线程之前应答，asr_kws 收到同 seq 的应答即进入识别，不等应答音播完 */
+            if (ipc_bus_reply(fd, header, IPC_REPLY_WAKE_RESPONSE, NULL, 0) != 0) {
+                LOGW(TAG, "回复唤醒应答失败: %s", strerror(errno));
             }
             tts_playback_wake_response();
             if (!tts_playback_is_playing()) {
-                tts_playback_notify_player("tts:done");
+                tts_playback_notify_player(IPC_EVT_TTS_DONE);
             }
             break;
         }
@@ -3,6 +3,9 @@
 
 #include <stdint.h>
 
-void handle_ipc_message(uint16_t type, const uint8_t *body, uint32_t body_len);
+#include "../../ipc/ipc_message.h"
+
+// 处理一条总线消息；需要应答的命令（PLAY_WAKE_RESPONSE）沿 fd 回复同 seq 的应答
+void handle_ipc_message(int fd, const IPCHeader *header, const uint8_t *body);
 
 #endif
@@ -6,15 +6,22 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <time.h>
+#include <ctype.h>
+#include <errno.h>
 
 #include "../../debug_log.h"
 #include "../common/ipc_protocol.h"
+#include "../../ipc/ipc_bus.h"
+#include "../../ipc/pcm_ring.h"
+#include "../common/polyphase.h"
+#include "../common/infer_config.h"
 #include "../tts/alsa_output.h"
 #include "../tts/sherpa_tts.h"
 #include "tts_playback.h"
+#include "tts_cache.h"
 
 #define TAG "TTS_MAIN"
-#define PLAYBACK_BUFFER_SIZE (16 * 1024)
+#define PLAYBACK_BUFFER_SIZE 4096      // WAV 每次读取的样本数，也是转换级单次最大输入
 
 typedef struct {
     char riff[4];
@@ -33,138 +40,589 @@ typedef struct {
 static pthread_t playback_thread = 0;
 static pthread_mutex_t playback_mutex = PTHREAD_MUTEX_INITIALIZER;
 static int playback_should_stop = 0;
-static float *playback_samples = NULL;
-static int32_t playback_n = 0;
 static char *playback_wav_filename = NULL;
 static int s_wav_play_is_wake = 0;
 static volatile int s_tts_content_session = 0;
 
-static void notify_player_tts_event(const char *event) {
-    int fd = open(PLAYER_CTRL_FIFO_PATH, O_WRONLY | O_NONBLOCK);
-    if (fd < 0) {
-        LOGW(TAG, "上报TTS事件失败: %s", event);
+/* 流式文本播放：合成线程按句切分、逐句合成，写入环形缓冲区；播放线程边取边写 ALSA，
+ * 首句合成完即可出声。环形缓冲区与停止标志共用 playback_mutex，s_stream_cond 通知数据/空间/停止。 */
+#define TTS_STREAM_RING_SECONDS     4
+#define TTS_CHUNK_FIRST_MIN_BYTES   12      // 首句遇到逗号类标点即可切分，尽快出声
+#define TTS_CHUNK_MIN_BYTES         45      // 之后约 15 个汉字以上才在逗号处切分，保证韵律
+#define TTS_CHUNK_MAX_BYTES         240     // 没有标点的长段强制切分
+#define TTS_STREAM_TEXT_IDLE_MS     15000   // 流式文本会话超过该时间没有新文本视为结束，防止发送端异常退出后一直占用
+
+/* 流式文本会话（LLM 边生成边播报）：text 随追加增长，合成线程取走 [text_pos, text_len) 后等待下一段，
+ * open 清零后处理完剩余文本即结束。text/text_len/open 受 playback_mutex 保护。 */
+typedef struct {
+    char *text;
+    size_t text_len;
+    size_t text_cap;
+    size_t text_pos;        // 合成线程已取走的位置
+    int open;
+    unsigned int stop_gen;
+    int interrupted;
+    int collect;            // 当前段可缓存：回调同时把样本收集到 pcm
+    float *pcm;
+    int32_t pcm_len;
+    int32_t pcm_cap;
+} SynthJob;
+
+/* 播放转换级：单声道 float/int16 → （多相重采样）→ 限幅、转 int16、复制成双声道。
+ * 缓冲区首次使用时按 PLAYBACK_BUFFER_SIZE 分配，之后各次播放复用；采样率不变时保留滤波器组，只清历史。
+ * 文本与 WAV 播放线程不会同时运行，共用一个实例。 */
+typedef struct {
+    PolyphaseResampler rs;
+    int resample;
+    int ready;
+    float *out_float;       // 重采样输出
+    int16_t *out_stereo;    // 交错双声道，送 ALSA
+    int out_cap;            // out_float 容量（帧）
+    int16_t *wav_buf;       // WAV 读入缓冲
+} PlaybackConverter;
+
+static PlaybackConverter s_conv;
+
+/* 输出路由：混音进程（audio_mixer）在线时按 PCM_RING_RATE 写进共享内存，由它与音乐合成一路输出，
+ * 不再各自 drop/prepare/预填静音；不在线时照旧直接写 g_pcm_handle。每次播放开始时判断一次。
+ * 共享内存只映射一次，混音进程重启后沿用同一块；s_mix_attached 受 playback_mutex 保护。 */
+static PcmRing s_mix_ring;
+static int s_mix_attached = 0;
+static int s_use_mixer = 0;             // 本次播放是否走混音进程，仅播放线程读写
+
+static pthread_t synth_thread = 0;
+static pthread_cond_t s_stream_cond = PTHREAD_COND_INITIALIZER;
+static float *s_stream_buf = NULL;
+static int32_t s_stream_cap = 0;
+static int64_t s_stream_head = 0;               // 合成线程写入位置（单调递增）
+static int64_t s_stream_tail = 0;               // 播放线程读取位置
+static int s_stream_synth_done = 0;
+static unsigned int s_stop_gen = 0;             // 每次停止加一，旧的合成线程据此退出
+static SynthJob *s_stream_job = NULL;           // 正在接收追加文本的会话，结束或停止后置空
+static struct timespec s_stream_request_time;
+
+static pthread_t prewarm_thread = 0;
+static volatile int s_prewarm_stop = 0;
+
+static double elapsed_ms_since(const struct timespec *t0) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - t0->tv_sec) * 1000.0 + (now.tv_nsec - t0->tv_nsec) / 1000000.0;
+}
+
+/* 播放线程和主线程都会上报，共用一条到 player 的长连接；非阻塞发送，player 未启动时直接丢弃 */
+static pthread_mutex_t s_player_link_mutex = PTHREAD_MUTEX_INITIALIZER;
+static IPCBusLink s_player_link = { .name = IPC_BUS_PLAYER, .fd = -1 };
+
+static void notify_player_tts_event(uint16_t event) {
+    const char *name = (event == IPC_EVT_TTS_START) ? "tts:start" : "tts:done";
+    int ret;
+
+    pthread_mutex_lock(&s_player_link_mutex);
+    ret = ipc_bus_link_send(&s_player_link, event, NULL, 0, NULL);
+    pthread_mutex_unlock(&s_player_link_mutex);
+    if (ret != 0) {
+        LOGW(TAG, "上报TTS事件失败: %s (%s)", name, strerror(errno));
         return;
     }
-    write(fd, event, strlen(event));
-    write(fd, "\n", 1);
-    close(fd);
-    LOGI(TAG, "上报TTS事件: %s", event);
+    LOGI(TAG, "上报TTS事件: %s", name);
 }
 
-static void* playback_text_thread(void *arg) {
-    LOGI(TAG, "播放线程启动");
-    float *samples = NULL;
-    int32_t n = 0;
+/* 0 非标点，1 逗号类（可切分），2 句末（必切）；*len 为该字符的字节数 */
+static int tts_punct_kind(const char *p, int *len) {
+    static const char *const strong[] = {"。", "！", "？", "；", "…"};
+    static const char *const weak[] = {"，", "、", "：", "—"};
+    unsigned char c = (unsigned char)*p;
+    size_t i;
+
+    if (c < 0x80) {
+        *len = 1;
+        if (c == '!' || c == '?' || c == ';' || c == '\n') return 2;
+        if (c == '.' && (p[1] == '\0' || p[1] == ' ' || p[1] == '\n')) return 2;
+        if (c == ',' || c == ':') return 1;
+        return 0;
+    }
+    *len = (c >= 0xF0) ? 4 : (c >= 0xE0) ? 3 : (c >= 0xC0) ? 2 : 1;
+    for (i = 0; i < sizeof(strong) / sizeof(strong[0]); i++) {
+        if (strncmp(p, strong[i], strlen(strong[i])) == 0) return 2;
+    }
+    for (i = 0; i < sizeof(weak) / sizeof(weak[0]); i++) {
+        if (strncmp(p, weak[i], strlen(weak[i])) == 0) return 1;
+    }
+    return 0;
+}
+
+/* 从 *pp 取下一段待合成文本（含结尾标点），纯标点/空白段跳过；没有更多文本返回 0 */
+static int tts_next_chunk(const char **pp, char *out, size_t out_size, int first) {
+    size_t min_bytes = first ? TTS_CHUNK_FIRST_MIN_BYTES : TTS_CHUNK_MIN_BYTES;
+    const char *p = *pp;
+
+    while (*p != '\0') {
+        size_t len = 0;
+        int speakable = 0;
+        while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
+        while (*p != '\0') {
+            int clen;
+            int kind = tts_punct_kind(p, &clen);
+            if (len + (size_t)clen >= out_size || len + (size_t)clen > TTS_CHUNK_MAX_BYTES) break;
+            memcpy(out + len, p, (size_t)clen);
+            len += (size_t)clen;
+            p += clen;
+            if (kind == 0 && ((unsigned char)p[-clen] >= 0x80 || isalnum((unsigned char)p[-clen]))) {
+                speakable = 1;
+            }
+            if (kind == 2 || (kind == 1 && len >= min_bytes)) {
+                // 连续标点（如"！？"、"……"）归入同一段
+                while (*p != '\0' && tts_punct_kind(p, &clen) != 0 && len + (size_t)clen < out_size) {
+                    memcpy(out + len, p, (size_t)clen);
+                    len += (size_t)clen;
+                    p += clen;
+                }
+                break;
+            }
+        }
+        out[len] = '\0';
+        *pp = p;
+        if (speakable) return 1;
+        if (len == 0 && *p != '\0') {
+            p++;    // 单个字符超出缓冲区，理论上不会发生
+        }
+    }
+    *pp = p;
+    return 0;
+}
+
+/* sherpa 合成回调：写入环形缓冲区，满了等播放线程腾出空间；返回 0 让 sherpa 停止合成 */
+static void synth_collect_samples(SynthJob *job, const float *samples, int32_t n) {
+    if (job->pcm_len + n > job->pcm_cap) {
+        int32_t cap = job->pcm_cap ? job->pcm_cap : (int32_t)g_tts_sample_rate * 2;
+        float *pcm;
+        while (cap < job->pcm_len + n) cap *= 2;
+        pcm = (float *)realloc(job->pcm, (size_t)cap * sizeof(float));
+        if (pcm == NULL) {
+            job->collect = 0;
+            return;
+        }
+        job->pcm = pcm;
+        job->pcm_cap = cap;
+    }
+    memcpy(job->pcm + job->pcm_len, samples, (size_t)n * sizeof(float));
+    job->pcm_len += n;
+}
+
+static int32_t synth_push_samples(const float *samples, int32_t n, void *arg) {
+    SynthJob *job = (SynthJob *)arg;
+    if (job->collect) {
+        synth_collect_samples(job, samples, n);
+    }
     pthread_mutex_lock(&playback_mutex);
-    samples = playback_samples;
-    n = playback_n;
-    playback_samples = NULL;
-    playback_n = 0;
+    while (n > 0) {
+        int32_t space;
+        int32_t pos;
+        int32_t count;
+        int32_t first;
+        while (s_stop_gen == job->stop_gen && s_stream_head - s_stream_tail >= s_stream_cap) {
+            pthread_cond_wait(&s_stream_cond, &playback_mutex);
+        }
+        if (s_stop_gen != job->stop_gen) {
+            job->interrupted = 1;
+            pthread_mutex_unlock(&playback_mutex);
+            return 0;
+        }
+        space = s_stream_cap - (int32_t)(s_stream_head - s_stream_tail);
+        count = n < space ? n : space;
+        pos = (int32_t)(s_stream_head % s_stream_cap);
+        first = s_stream_cap - pos < count ? s_stream_cap - pos : count;
+        memcpy(s_stream_buf + pos, samples, (size_t)first * sizeof(float));
+        memcpy(s_stream_buf, samples + first, (size_t)(count - first) * sizeof(float));
+        s_stream_head += count;
+        samples += count;
+        n -= count;
+        pthread_cond_broadcast(&s_stream_cond);
+    }
     pthread_mutex_unlock(&playback_mutex);
-    if (samples == NULL || n == 0) {
-        LOGE(TAG, "没有可播放的音频数据");
-        return NULL;
+    return 1;
+}
+
+// 调用方持有 playback_mutex
+static int synth_job_append_locked(SynthJob *job, const char *text, size_t n) {
+    if (job->text_len + n + 1 > job->text_cap) {
+        size_t cap = job->text_cap ? job->text_cap : 256;
+        char *buf;
+        while (cap < job->text_len + n + 1) cap *= 2;
+        buf = (char *)realloc(job->text, cap);
+        if (buf == NULL) return -1;
+        job->text = buf;
+        job->text_cap = cap;
     }
-    if (g_pcm_handle != NULL) {
-        snd_pcm_drop(g_pcm_handle);
-        if (snd_pcm_prepare(g_pcm_handle) < 0) {
-            LOGE(TAG, "准备PCM设备失败");
-            destroy_generated_audio(samples);
-            return NULL;
+    memcpy(job->text + job->text_len, text, n);
+    job->text_len += n;
+    job->text[job->text_len] = '\0';
+    return 0;
+}
+
+/* 取走已追加但未合成的文本；会话仍打开时等待新文本，停止、结束或空闲超时返回 NULL */
+static char *synth_job_take_text(SynthJob *job) {
+    char *piece = NULL;
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += TTS_STREAM_TEXT_IDLE_MS / 1000;
+    pthread_mutex_lock(&playback_mutex);
+    while (s_stop_gen == job->stop_gen && job->open && job->text_pos == job->text_len) {
+        if (pthread_cond_timedwait(&s_stream_cond, &playback_mutex, &deadline) == ETIMEDOUT) {
+            LOGW(TAG, "流式文本 %d ms 未收到新内容，结束会话", TTS_STREAM_TEXT_IDLE_MS);
+            job->open = 0;
+            if (s_stream_job == job) s_stream_job = NULL;
         }
-        pcm_write_silence(g_pcm_handle);
     }
-    unsigned int sample_rate = g_tts_sample_rate;
-    unsigned int playback_rate = g_alsa_playback_rate;
-    int need_resample = (playback_rate != 0 && playback_rate != sample_rate);
-    size_t max_out_frames = need_resample ? (size_t)(PERIOD_SIZE * playback_rate / sample_rate) + 1 : (size_t)PERIOD_SIZE;
-    if (max_out_frames > 1024) max_out_frames = 1024;
-    int16_t *processed_samples = malloc(max_out_frames * sizeof(int16_t));
-    int16_t *stereo_buf = malloc(max_out_frames * 2 * sizeof(int16_t));
-    float *resampled_buf = need_resample ? (float *)malloc(max_out_frames * sizeof(float)) : NULL;
-    if (processed_samples == NULL || stereo_buf == NULL || (need_resample && resampled_buf == NULL)) {
-        free(processed_samples);
-        free(stereo_buf);
-        free(resampled_buf);
-        destroy_generated_audio(samples);
-        return NULL;
+    if (s_stop_gen == job->stop_gen && job->text_pos < job->text_len) {
+        piece = strndup(job->text + job->text_pos, job->text_len - job->text_pos);
+        job->text_pos = job->text_len;
     }
-    int32_t offset = 0;
-    int should_stop_local = 0;
-    while (offset < n && !should_stop_local) {
-        pthread_mutex_lock(&playback_mutex);
-        should_stop_local = playback_should_stop;
-        pthread_mutex_unlock(&playback_mutex);
-        if (should_stop_local) break;
-        int32_t samples_to_process = (n - offset) > PERIOD_SIZE ? PERIOD_SIZE : (n - offset);
-        int out_frames;
-        const int16_t *write_buf;
-        snd_pcm_uframes_t write_frames;
-        if (need_resample && resampled_buf != NULL) {
-            out_frames = (int)((long)samples_to_process * (long)playback_rate / (long)sample_rate);
-            if (out_frames > (int)max_out_frames) out_frames = (int)max_out_frames;
-            for (int i = 0; i < out_frames; i++) {
-                float pos = (float)i * (float)sample_rate / (float)playback_rate;
-                int idx = (int)pos;
-                float frac = pos - idx;
-                if (idx >= samples_to_process - 1)
-                    resampled_buf[i] = samples[offset + samples_to_process - 1];
-                else
-                    resampled_buf[i] = samples[offset + idx] * (1.0f - frac) + samples[offset + idx + 1] * frac;
+    pthread_mutex_unlock(&playback_mutex);
+    return piece;
+}
+
+static void* synth_text_thread(void *arg) {
+    SynthJob *job = (SynthJob *)arg;
+    char *piece;
+    char chunk[TTS_CHUNK_MAX_BYTES + 16];
+    int index = 0;
+
+    // 合成线程每次播报新建，绑到 tts_cpus 上与 onnxruntime 线程池同簇
+    infer_bind_current_thread(INFER_TTS);
+    // 追加的每段文本都以标点结尾，逐段切分即可，不必与后续文本拼接
+    while ((piece = synth_job_take_text(job)) != NULL) {
+        const char *p = piece;
+        while (tts_next_chunk(&p, chunk, sizeof(chunk), index == 0)) {
+            struct timespec t0;
+            TtsCacheHit hit;
+            int stopped;
+            pthread_mutex_lock(&playback_mutex);
+            stopped = (s_stop_gen != job->stop_gen);
+            pthread_mutex_unlock(&playback_mutex);
+            if (stopped) break;
+            index++;
+            if (tts_cache_lookup(chunk, &hit) == 0) {
+                LOGD(TAG, "第%d段命中缓存: %s", index, chunk);
+                job->collect = 0;
+                synth_push_samples(hit.samples, hit.n, job);
+                tts_cache_release(&hit);
+                continue;
+            }
+            clock_gettime(CLOCK_MONOTONIC, &t0);
+            job->collect = tts_cache_is_cacheable(chunk);
+            job->pcm_len = 0;
+            if (generate_tts_audio_with_callback(chunk, synth_push_samples, job) != 0) {
+                LOGW(TAG, "第%d段合成失败，跳过: %s", index, chunk);
+                continue;
             }
-            for (int i = 0; i < out_frames; i++) {
-                float t = resampled_buf[i];
-                if (t < -1.0f) t = -1.0f; else if (t > 1.0f) t = 1.0f;
-                processed_samples[i] = (int16_t)(t * 32767);
+            LOGD(TAG, "第%d段合成耗时 %.0f ms: %s", index, elapsed_ms_since(&t0), chunk);
+            if (job->collect && !job->interrupted && job->pcm_len > 0) {
+                tts_cache_store(chunk, job->pcm, job->pcm_len);
+            }
+        }
+        free(piece);
+    }
+    pthread_mutex_lock(&playback_mutex);
+    s_stream_synth_done = 1;
+    if (s_stream_job == job) s_stream_job = NULL;
+    pthread_cond_broadcast(&s_stream_cond);
+    pthread_mutex_unlock(&playback_mutex);
+    free(job->pcm);
+    free(job->text);
+    free(job);
+    return NULL;
+}
+
+static int prewarm_should_yield(void) {
+    return s_prewarm_stop || s_tts_content_session;
+}
+
+/* 逐行读取常用语，按与播放相同的方式切段，缺失的段合成后写入缓存；有文本播放时让出模型 */
+static void* prewarm_cache_thread(void *arg) {
+    char *path = (char *)arg;
+    char line[512];
+    char chunk[TTS_CHUNK_MAX_BYTES + 16];
+    int cached = 0;
+    int generated = 0;
+    FILE *fp = fopen(path, "r");
+
+    infer_bind_current_thread(INFER_TTS);
+    if (fp == NULL) {
+        LOGW(TAG, "打开TTS预热列表失败: %s", path);
+        free(path);
+        return NULL;
+    }
+    while (!s_prewarm_stop && fgets(line, sizeof(line), fp) != NULL) {
+        const char *p = line;
+        int first = 1;
+        line[strcspn(line, "\r\n")] = '\0';
+        if (line[0] == '#') continue;
+        while (!s_prewarm_stop && tts_next_chunk(&p, chunk, sizeof(chunk), first)) {
+            TtsCacheHit hit;
+            float *samples = NULL;
+            int32_t n = 0;
+            uint32_t sample_rate = 0;
+            int ret = -1;
+            first = 0;
+            if (tts_cache_lookup(chunk, &hit) == 0) {
+                tts_cache_release(&hit);
+                cached++;
+                continue;
             }
-            for (int i = 0; i < out_frames; i++) {
-                stereo_buf[i * 2] = processed_samples[i];
-                stereo_buf[i * 2 + 1] = processed_samples[i];
+            // 让出判断在合成锁内做，实时请求最多等正在合成的这一小段
+            while (!s_prewarm_stop &&
+                   (ret = generate_tts_audio_full_yielding(chunk, prewarm_should_yield,
+                                                           &samples, &n, &sample_rate)) == 1) {
+                usleep(200 * 1000);
             }
-            write_buf = stereo_buf;
-            write_frames = (snd_pcm_uframes_t)out_frames;
-        } else {
-            float t;
-            for (int32_t i = 0; i < samples_to_process; i++) {
-                t = samples[offset + i];
-                if (t < -1.0f) t = -1.0f; else if (t > 1.0f) t = 1.0f;
-                processed_samples[i] = (int16_t)(t * 32767);
+            if (s_prewarm_stop) {
+                destroy_generated_audio(samples);
+                break;
             }
-            for (int32_t i = 0; i < samples_to_process; i++) {
-                stereo_buf[i * 2] = processed_samples[i];
-                stereo_buf[i * 2 + 1] = processed_samples[i];
+            if (ret == 0 && n > 0) {
+                if (tts_cache_store(chunk, samples, n) == 0) {
+                    generated++;
+                }
             }
-            write_buf = stereo_buf;
-            write_frames = (snd_pcm_uframes_t)samples_to_process;
+            destroy_generated_audio(samples);
         }
-        pthread_mutex_lock(&playback_mutex);
-        if (playback_should_stop) { pthread_mutex_unlock(&playback_mutex); break; }
+    }
+    fclose(fp);
+    LOGI(TAG, "TTS缓存预热完成: 已有 %d 段，新合成 %d 段", cached, generated);
+    free(path);
+    return NULL;
+}
+
+void tts_playback_prewarm_start(const char *list_path) {
+    char *path;
+    if (list_path == NULL || prewarm_thread != 0) return;
+    path = strdup(list_path);
+    if (path == NULL) return;
+    s_prewarm_stop = 0;
+    if (pthread_create(&prewarm_thread, NULL, prewarm_cache_thread, path) != 0) {
+        LOGW(TAG, "创建TTS缓存预热线程失败");
+        prewarm_thread = 0;
+        free(path);
+    }
+}
+
+/* 取出最多 max 个样本；缓冲区空时等待合成。返回 0 表示合成已结束且数据取完，-1 表示被停止 */
+static int32_t stream_pop_samples(float *out, int32_t max, unsigned int stop_gen) {
+    int32_t avail;
+    int32_t count;
+    int32_t pos;
+    int32_t first;
+
+    pthread_mutex_lock(&playback_mutex);
+    while (s_stop_gen == stop_gen && s_stream_head == s_stream_tail && !s_stream_synth_done) {
+        pthread_cond_wait(&s_stream_cond, &playback_mutex);
+    }
+    if (s_stop_gen != stop_gen) {
         pthread_mutex_unlock(&playback_mutex);
-        if (pcm_write_all(g_pcm_handle, write_buf, write_frames) < 0) {
+        return -1;
+    }
+    avail = (int32_t)(s_stream_head - s_stream_tail);
+    count = avail < max ? avail : max;
+    pos = (int32_t)(s_stream_tail % s_stream_cap);
+    first = s_stream_cap - pos < count ? s_stream_cap - pos : count;
+    memcpy(out, s_stream_buf + pos, (size_t)first * sizeof(float));
+    memcpy(out + first, s_stream_buf, (size_t)(count - first) * sizeof(float));
+    s_stream_tail += count;
+    pthread_cond_broadcast(&s_stream_cond);
+    pthread_mutex_unlock(&playback_mutex);
+    return count;
+}
+
+static int playback_conv_prepare(unsigned int in_rate) {
+    unsigned int out_rate = s_use_mixer ? PCM_RING_RATE :
+                            (g_alsa_playback_rate != 0 ? g_alsa_playback_rate : in_rate);
+    int out_cap;
+    if (s_conv.ready && s_conv.rs.in_rate == in_rate && s_conv.rs.out_rate == out_rate) {
+        polyphase_reset(&s_conv.rs);
+        return 0;
+    }
+    polyphase_free(&s_conv.rs);
+    s_conv.ready = 0;
+    if (polyphase_init(&s_conv.rs, in_rate, out_rate, PLAYBACK_BUFFER_SIZE) != 0) {
+        return -1;
+    }
+    s_conv.resample = (in_rate != out_rate);
+    out_cap = polyphase_max_output(&s_conv.rs, PLAYBACK_BUFFER_SIZE);
+    if (out_cap > s_conv.out_cap) {
+        float *out_float = (float *)realloc(s_conv.out_float, (size_t)out_cap * sizeof(float));
+        int16_t *out_stereo;
+        if (out_float == NULL) return -1;
+        s_conv.out_float = out_float;
+        out_stereo = (int16_t *)realloc(s_conv.out_stereo, (size_t)out_cap * 2 * sizeof(int16_t));
+        if (out_stereo == NULL) return -1;
+        s_conv.out_stereo = out_stereo;
+        s_conv.out_cap = out_cap;
+    }
+    if (s_conv.wav_buf == NULL) {
+        s_conv.wav_buf = (int16_t *)malloc(PLAYBACK_BUFFER_SIZE * sizeof(int16_t));
+        if (s_conv.wav_buf == NULL) return -1;
+    }
+    s_conv.ready = 1;
+    if (s_conv.resample) {
+        LOGI(TAG, "播放重采样 %u Hz → %u Hz，多相 %d/%d，每相位 %d 抽头（%s）",
+             in_rate, out_rate, s_conv.rs.up, s_conv.rs.down, s_conv.rs.taps, polyphase_simd_name());
+    }
+    return 0;
+}
+
+// 返回输出帧数，*out 指向交错双声道 int16；n 不超过 PLAYBACK_BUFFER_SIZE
+static int playback_conv_float(const float *in, int n, const int16_t **out) {
+    if (s_conv.resample) {
+        n = polyphase_process(&s_conv.rs, in, n, s_conv.out_float);
+        if (n < 0) return -1;
+        in = s_conv.out_float;
+    }
+    pcm_float_to_s16_stereo(in, s_conv.out_stereo, n);
+    *out = s_conv.out_stereo;
+    return n;
+}
+
+static int playback_conv_s16(const int16_t *in, int n, const int16_t **out) {
+    if (s_conv.resample) {
+        float *dst = polyphase_input(&s_conv.rs, n);
+        if (dst == NULL) return -1;
+        pcm_s16_to_float(in, dst, n);
+        n = polyphase_run(&s_conv.rs, n, s_conv.out_float);
+        pcm_float_to_s16_stereo(s_conv.out_float, s_conv.out_stereo, n);
+    } else {
+        pcm_s16_to_stereo(in, s_conv.out_stereo, n);
+    }
+    *out = s_conv.out_stereo;
+    return n;
+}
+
+static void playback_conv_free(void) {
+    polyphase_free(&s_conv.rs);
+    free(s_conv.out_float);
+    free(s_conv.out_stereo);
+    free(s_conv.wav_buf);
+    memset(&s_conv, 0, sizeof(s_conv));
+}
+
+static int text_stop_requested(void *arg) {
+    unsigned int stop_gen = *(const unsigned int *)arg;
+    int stopped;
+    pthread_mutex_lock(&playback_mutex);
+    stopped = (s_stop_gen != stop_gen);
+    pthread_mutex_unlock(&playback_mutex);
+    return stopped;
+}
+
+static int wav_stop_requested(void *arg) {
+    int stopped;
+    (void)arg;
+    pthread_mutex_lock(&playback_mutex);
+    stopped = playback_should_stop;
+    pthread_mutex_unlock(&playback_mutex);
+    return stopped;
+}
+
+// 开始一次播放：选定输出路由；直连时先丢掉上次残留并预填静音
+static int tts_output_begin(void) {
+    int use_mixer;
+    pthread_mutex_lock(&playback_mutex);
+    if (!s_mix_attached && pcm_ring_attach(&s_mix_ring, PCM_RING_TTS) == 0) {
+        s_mix_attached = 1;
+    }
+    use_mixer = s_mix_attached && pcm_ring_reader_alive(&s_mix_ring);
+    pthread_mutex_unlock(&playback_mutex);
+    if (use_mixer != s_use_mixer) {
+        LOGI(TAG, "TTS输出改为%s", use_mixer ? "经混音进程" : "直连ALSA");
+        s_use_mixer = use_mixer;
+    }
+    if (!s_use_mixer && g_pcm_handle != NULL) {
+        snd_pcm_drop(g_pcm_handle);
+        if (snd_pcm_prepare(g_pcm_handle) < 0) {
+            LOGE(TAG, "准备PCM设备失败");
+            return -1;
+        }
+        pcm_write_silence(g_pcm_handle);
+    }
+    return 0;
+}
+
+// 被打断时返回 0，由调用方按停止标志收尾；混音进程中途退出返回 -1
+static int tts_output_write(const int16_t *buf, int frames, pcm_ring_stop_fn stop, void *arg) {
+    if (s_use_mixer) {
+        if (pcm_ring_write_all(&s_mix_ring, buf, (uint32_t)frames, stop, arg) < 0) {
+            LOGE(TAG, "混音进程无响应，本次播放结束");
+            return -1;
+        }
+        return 0;
+    }
+    return pcm_write_all(g_pcm_handle, buf, (snd_pcm_uframes_t)frames) < 0 ? -1 : 0;
+}
+
+// 播放结束：被打断立即丢弃未播数据，否则等播完
+static void tts_output_end(int stopped, pcm_ring_stop_fn stop, void *arg) {
+    if (s_use_mixer) {
+        if (stopped || pcm_ring_drain(&s_mix_ring, stop, arg) == 1) {
+            pcm_ring_flush(&s_mix_ring);
+        }
+        return;
+    }
+    if (g_pcm_handle == NULL) return;
+    if (stopped) {
+        snd_pcm_drop(g_pcm_handle);
+    } else {
+        snd_pcm_drain(g_pcm_handle);
+    }
+}
+
+static void* playback_text_thread(void *arg) {
+    LOGI(TAG, "播放线程启动");
+    // 以停止代数判断打断：唤醒应答会先清 playback_should_stop 再 join 本线程
+    unsigned int stop_gen = (unsigned int)(uintptr_t)arg;
+    float samples[PERIOD_SIZE];
+    int32_t n = stream_pop_samples(samples, PERIOD_SIZE, stop_gen);
+    int started = 0;
+    if (n <= 0) {
+        if (n == 0) {
+            LOGE(TAG, "没有可播放的音频数据");
+        }
+        goto out;
+    }
+    LOGI(TAG, "首段音频就绪，距请求 %.0f ms", elapsed_ms_since(&s_stream_request_time));
+    tts_playback_notify_player(IPC_EVT_TTS_START);
+    started = 1;
+    if (tts_output_begin() != 0) {
+        goto out;
+    }
+    if (playback_conv_prepare(g_tts_sample_rate) != 0) {
+        LOGE(TAG, "初始化播放转换失败");
+        goto out;
+    }
+    while (n > 0) {
+        const int16_t *write_buf;
+        int write_frames = playback_conv_float(samples, n, &write_buf);
+        if (write_frames < 0) break;
+        if (tts_output_write(write_buf, write_frames, text_stop_requested, &stop_gen) < 0) {
             LOGE(TAG, "写入PCM失败");
             break;
         }
-        offset += samples_to_process;
+        n = stream_pop_samples(samples, PERIOD_SIZE, stop_gen);
     }
+out:
     pthread_mutex_lock(&playback_mutex);
-    should_stop_local = playback_should_stop;
+    int should_stop_local = (s_stop_gen != stop_gen);
     pthread_mutex_unlock(&playback_mutex);
-    if (should_stop_local && g_pcm_handle != NULL) {
-        snd_pcm_drop(g_pcm_handle);
-    } else if (!should_stop_local && g_pcm_handle != NULL) {
-        snd_pcm_drain(g_pcm_handle);
+    if (started) {
+        tts_output_end(should_stop_local, text_stop_requested, &stop_gen);
     }
-    free(processed_samples);
-    free(stereo_buf);
-    free(resampled_buf);
-    destroy_generated_audio(samples);
     if (should_stop_local) {
         LOGI(TAG, "文本播放已被打断");
     } else {
         LOGI(TAG, "文本播放完成");
     }
     s_tts_content_session = 0;
-    notify_player_tts_event("tts:done");
+    notify_player_tts_event(IPC_EVT_TTS_DONE);
     pthread_mutex_lock(&playback_mutex);
     playback_thread = 0;
     pthread_mutex_unlock(&playback_mutex);
@@ -203,8 +661,9 @@ static void* playback_wav_thread(void *arg) {
         free(filename);
         return NULL;
     }
-    if (header.audio_format != 1) {
-        LOGE(TAG, "不支持的音频格式: %d", header.audio_format);
+    if (header.audio_format != 1 || header.bits_per_sample != 16 || header.num_channels != 1) {
+        LOGE(TAG, "不支持的音频格式: format=%d, %d bit, %d 声道（仅支持 16 bit 单声道 PCM）",
+             header.audio_format, header.bits_per_sample, header.num_channels);
         fclose(wav_file);
         free(filename);
         return NULL;
@@ -225,36 +684,19 @@ static void* playback_wav_thread(void *arg) {
         free(filename);
         return NULL;
     }
-    if (g_pcm_handle != NULL) {
-        snd_pcm_drop(g_pcm_handle);
-        if (snd_pcm_prepare(g_pcm_handle) < 0) {
-            LOGE(TAG, "准备PCM设备失败");
-            fclose(wav_file);
-            free(filename);
-            return NULL;
-        }
-        pcm_write_silence(g_pcm_handle);
-    }
-    uint32_t bytes_per_sample = header.bits_per_sample / 8;
-    uint32_t buffer_size_bytes = PLAYBACK_BUFFER_SIZE * bytes_per_sample;
-    uint8_t *buffer = (uint8_t *)malloc(buffer_size_bytes);
-    uint8_t *stereo_buf = (uint8_t *)malloc(buffer_size_bytes * 2);
-    if (buffer == NULL || stereo_buf == NULL) {
-        free(buffer);
-        free(stereo_buf);
+    if (tts_output_begin() != 0) {
         fclose(wav_file);
         free(filename);
         return NULL;
     }
-    unsigned int wav_rate = header.sample_rate;
-    unsigned int playback_rate = g_alsa_playback_rate;
-    int wav_need_resample = (playback_rate != 0 && playback_rate != wav_rate);
-    size_t max_wav_out = wav_need_resample ? (buffer_size_bytes / bytes_per_sample) * playback_rate / wav_rate + 1 : 0;
-    int16_t *wav_resampled = NULL;
-    if (wav_need_resample && max_wav_out > 0) {
-        wav_resampled = (int16_t *)malloc(max_wav_out * 2 * sizeof(int16_t));
-        if (!wav_resampled) wav_need_resample = 0;
+    if (playback_conv_prepare(header.sample_rate) != 0) {
+        LOGE(TAG, "初始化播放转换失败");
+        fclose(wav_file);
+        free(filename);
+        return NULL;
     }
+    uint32_t bytes_per_sample = sizeof(int16_t);
+    uint32_t buffer_size_bytes = PLAYBACK_BUFFER_SIZE * bytes_per_sample;
     uint32_t total_bytes_read = 0;
     LOGI(TAG, "开始播放 (总数据大小: %u bytes, 块大小: %u bytes)", chunk_size, buffer_size_bytes);
     int should_stop_local = 0;
@@ -265,44 +707,18 @@ static void* playback_wav_thread(void *arg) {
         if (should_stop_local) break;
         uint32_t bytes_to_read = (chunk_size - total_bytes_read) < buffer_size_bytes ?
                                   (chunk_size - total_bytes_read) : buffer_size_bytes;
-        size_t bytes_read = fread(buffer, 1, bytes_to_read, wav_file);
+        size_t bytes_read = fread(s_conv.wav_buf, 1, bytes_to_read, wav_file);
         if (bytes_read != bytes_to_read) {
             LOGE(TAG, "读取音频数据失败 (已读 %zu, 预期 %u)", bytes_read, bytes_to_read);
             break;
         }
-        int32_t num_samples = bytes_read / bytes_per_sample;
-        const int16_t *mono = (const int16_t *)buffer;
-        snd_pcm_uframes_t write_frames;
         const int16_t *write_buf;
-        if (wav_need_resample && wav_resampled != NULL) {
-            int out_samples = (int)((long)num_samples * (long)playback_rate / (long)wav_rate);
-            if (out_samples > (int)max_wav_out) out_samples = (int)max_wav_out;
-            for (int i = 0; i < out_samples; i++) {
-                float pos = (float)i * (float)wav_rate / (float)playback_rate;
-                int idx = (int)pos;
-                float frac = pos - idx;
-                int16_t v;
-                if (idx >= num_samples - 1)
-                    v = mono[num_samples - 1];
-                else
-                    v = (int16_t)(mono[idx] * (1.0f - frac) + mono[idx + 1] * frac);
-                wav_resampled[i * 2] = v;
-                wav_resampled[i * 2 + 1] = v;
-            }
-            write_buf = wav_resampled;
-            write_frames = (snd_pcm_uframes_t)out_samples;
-        } else {
-            for (int32_t i = 0; i < num_samples; i++) {
-                memcpy(stereo_buf + i * bytes_per_sample * 2, buffer + i * bytes_per_sample, bytes_per_sample);
-                memcpy(stereo_buf + i * bytes_per_sample * 2 + bytes_per_sample, buffer + i * bytes_per_sample, bytes_per_sample);
-            }
-            write_buf = (const int16_t *)stereo_buf;
-            write_frames = (snd_pcm_uframes_t)num_samples;
-        }
+        int write_frames = playback_conv_s16(s_conv.wav_buf, (int)(bytes_read / bytes_per_sample), &write_buf);
+        if (write_frames < 0) break;
         pthread_mutex_lock(&playback_mutex);
         if (playback_should_stop) { pthread_mutex_unlock(&playback_mutex); break; }
         pthread_mutex_unlock(&playback_mutex);
-        if (pcm_write_all(g_pcm_handle, write_buf, write_frames) < 0) {
+        if (tts_output_write(write_buf, write_frames, wav_stop_requested, NULL) < 0) {
             LOGE(TAG, "ALSA写入失败");
             break;
         }
@@ -311,14 +727,7 @@ static void* playback_wav_thread(void *arg) {
     pthread_mutex_lock(&playback_mutex);
     should_stop_local = playback_should_stop;
     pthread_mutex_unlock(&playback_mutex);
-    if (should_stop_local && g_pcm_handle != NULL) {
-        snd_pcm_drop(g_pcm_handle);
-    } else if (!should_stop_local && g_pcm_handle != NULL) {
-        snd_pcm_drain(g_pcm_handle);
-    }
-    free(buffer);
-    free(stereo_buf);
-    free(wav_resampled);
+    tts_output_end(should_stop_local, wav_stop_requested, NULL);
     fclose(wav_file);
     free(filename);
     if (should_stop_local) {
@@ -327,7 +736,7 @@ static void* playback_wav_thread(void *arg) {
         LOGI(TAG, "WAV播放完成");
     }
     if (!s_wav_play_is_wake)
-        notify_player_tts_event("tts:done");
+        notify_player_tts_event(IPC_EVT_TTS_DONE);
     s_wav_play_is_wake = 0;
     pthread_mutex_lock(&playback_mutex);
     playback_thread = 0;
@@ -335,40 +744,116 @@ static void* playback_wav_thread(void *arg) {
     return NULL;
 }
 
-void tts_playback_notify_player(const char *event) {
+void tts_playback_notify_player(uint16_t event) {
     notify_player_tts_event(event);
 }
 
 void tts_playback_stop(void) {
     pthread_mutex_lock(&playback_mutex);
     playback_should_stop = 1;
+    s_stop_gen++;
+    pthread_cond_broadcast(&s_stream_cond);
+    if (s_mix_attached) {
+        pcm_ring_flush(&s_mix_ring);
+    }
     pthread_mutex_unlock(&playback_mutex);
     if (g_pcm_handle != NULL) {
         snd_pcm_drop(g_pcm_handle);
     }
 }
 
-int tts_playback_request_text(const char *text) {
-    tts_playback_join();
-    s_tts_content_session = 1;
-    float *samples = NULL;
-    int32_t n = 0;
-    uint32_t sample_rate = 0;
-    if (generate_tts_audio_full(text, &samples, &n, &sample_rate) != 0 || n <= 0) {
-        s_tts_content_session = 0;
+static int start_text_session(const char *text, int open) {
+    SynthJob *job;
+    unsigned int stop_gen;
+
+    if (s_stream_buf == NULL) {
+        s_stream_cap = (int32_t)(g_tts_sample_rate * TTS_STREAM_RING_SECONDS);
+        s_stream_buf = (float *)malloc((size_t)s_stream_cap * sizeof(float));
+        if (s_stream_buf == NULL) {
+            LOGE(TAG, "分配TTS流式缓冲区失败");
+            return -1;
+        }
+    }
+    job = (SynthJob *)calloc(1, sizeof(SynthJob));
+    if (job == NULL || synth_job_append_locked(job, text, strlen(text)) != 0) {
+        if (job != NULL) free(job->text);
+        free(job);
         return -1;
     }
-    tts_playback_notify_player("tts:start");
+    job->open = open;
+    s_tts_content_session = 1;
+    clock_gettime(CLOCK_MONOTONIC, &s_stream_request_time);
     pthread_mutex_lock(&playback_mutex);
     playback_should_stop = 0;
-    if (playback_samples != NULL) destroy_generated_audio(playback_samples);
-    playback_samples = samples;
-    playback_n = n;
+    s_stream_head = 0;
+    s_stream_tail = 0;
+    s_stream_synth_done = 0;
+    job->stop_gen = s_stop_gen;
+    stop_gen = s_stop_gen;
+    s_stream_job = open ? job : NULL;
     pthread_mutex_unlock(&playback_mutex);
-    pthread_create(&playback_thread, NULL, playback_text_thread, NULL);
+    if (pthread_create(&synth_thread, NULL, synth_text_thread, job) != 0) {
+        LOGE(TAG, "创建TTS合成线程失败");
+        synth_thread = 0;
+        pthread_mutex_lock(&playback_mutex);
+        s_stream_job = NULL;
+        pthread_mutex_unlock(&playback_mutex);
+        free(job->text);
+        free(job);
+        s_tts_content_session = 0;
+        return -1;
+    }
+    if (pthread_create(&playback_thread, NULL, playback_text_thread, (void *)(uintptr_t)stop_gen) != 0) {
+        LOGE(TAG, "创建TTS播放线程失败");
+        playback_thread = 0;
+        tts_playback_stop();
+        tts_playback_join();
+        s_tts_content_session = 0;
+        return -1;
+    }
     return 0;
 }
 
+int tts_playback_request_text(const char *text) {
+    const char *probe = text;
+    char chunk[TTS_CHUNK_MAX_BYTES + 16];
+
+    tts_playback_join();
+    if (text == NULL || !tts_next_chunk(&probe, chunk, sizeof(chunk), 1)) {
+        LOGW(TAG, "文本没有可合成的内容");
+        return -1;
+    }
+    return start_text_session(text, 0);
+}
+
+int tts_playback_request_text_stream(const char *text) {
+    tts_playback_join();
+    LOGI(TAG, "开始流式文本会话");
+    return start_text_session(text != NULL ? text : "", 1);
+}
+
+int tts_playback_append_text(const char *text) {
+    int ret = -1;
+    if (text == NULL) return -1;
+    pthread_mutex_lock(&playback_mutex);
+    if (s_stream_job != NULL && s_stream_job->open && s_stream_job->stop_gen == s_stop_gen) {
+        ret = synth_job_append_locked(s_stream_job, text, strlen(text));
+        pthread_cond_broadcast(&s_stream_cond);
+    }
+    pthread_mutex_unlock(&playback_mutex);
+    return ret;
+}
+
+void tts_playback_end_text_stream(void) {
+    pthread_mutex_lock(&playback_mutex);
+    if (s_stream_job != NULL) {
+        s_stream_job->open = 0;
+        s_stream_job = NULL;
+        pthread_cond_broadcast(&s_stream_cond);
+    }
+    pthread_mutex_unlock(&playback_mutex);
+}
+
 void tts_playback_wake_response(void) {
     const char *wake_files[] = {
         "./voice-assistant/wake_audio/nihao.wav",
@@ -420,18 +905,29 @@ void tts_playback_play_wav_file(const char *path) {
 }
 
 void tts_playback_cleanup(void) {
+    s_prewarm_stop = 1;
+    if (prewarm_thread != 0) {
+        pthread_join(prewarm_thread, NULL);
+        prewarm_thread = 0;
+    }
     pthread_mutex_lock(&playback_mutex);
     playback_should_stop = 1;
+    s_stop_gen++;
+    pthread_cond_broadcast(&s_stream_cond);
     pthread_mutex_unlock(&playback_mutex);
-    if (playback_thread != 0) {
-        pthread_join(playback_thread, NULL);
-        playback_thread = 0;
+    tts_playback_join();
+    if (s_mix_attached) {
+        pcm_ring_flush(&s_mix_ring);
+        pcm_ring_close(&s_mix_ring);
+        s_mix_attached = 0;
     }
+    pthread_mutex_lock(&s_player_link_mutex);
+    ipc_bus_link_close(&s_player_link);
+    pthread_mutex_unlock(&s_player_link_mutex);
     pthread_mutex_destroy(&playback_mutex);
-    if (playback_samples != NULL) {
-        destroy_generated_audio(playback_samples);
-        playback_samples = NULL;
-    }
+    free(s_stream_buf);
+    s_stream_buf = NULL;
+    playback_conv_free();
     if (playback_wav_filename != NULL) {
         free(playback_wav_filename);
         playback_wav_filename = NULL;
@@ -451,4 +947,9 @@ void tts_playback_join(void) {
         pthread_join(playback_thread, NULL);
         playback_thread = 0;
     }
+    // 被打断时合成线程在当前一段合成完后才退出，新的文本请求前须等它结束
+    if (synth_thread != 0) {
+        pthread_join(synth_thread, NULL);
+        synth_thread = 0;
+    }
 }
@@ -1,14 +1,23 @@
 #ifndef __TTS_PLAYBACK_H__
 #define __TTS_PLAYBACK_H__
 
-void tts_playback_notify_player(const char *event);
+#include <stdint.h>
+
+// event 为 IPC_EVT_TTS_START / IPC_EVT_TTS_DONE
+void tts_playback_notify_player(uint16_t event);
 void tts_playback_stop(void);
 int tts_playback_request_text(const char *text);
+// 流式文本：开始会话后逐段追加（每段以标点结尾），结束后播完剩余内容；会话被停止后追加返回 -1
+int tts_playback_request_text_stream(const char *text);
+int tts_playback_append_text(const char *text);
+void tts_playback_end_text_stream(void);
 void tts_playback_wake_response(void);
 void tts_playback_play_wav_file(const char *path);
 void tts_playback_cleanup(void);
 int tts_playback_get_content_session(void);
 int tts_playback_is_playing(void);
 void tts_playback_join(void);
+// 后台按常用语列表预热合成缓存
+void tts_playback_prewarm_start(const char *list_path);
 
 #endif
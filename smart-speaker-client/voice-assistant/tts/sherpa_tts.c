@@ -1,12 +1,19 @@
 #define LOG_LEVEL 4
 #include "../../debug_log.h"
 #include "sherpa_tts.h"
+#include "../common/infer_config.h"
 
 #include <stdlib.h>
 #include <string.h>
+#include <pthread.h>
+#include <sys/stat.h>
 
 const SherpaOnnxOfflineTts *g_tts = NULL;
 unsigned int g_tts_sample_rate = 0;
+uint64_t g_tts_model_hash = 0;
+
+// 回调上下文是全局的，合成调用需串行（播放合成线程与缓存预热线程会同时用）
+static pthread_mutex_t g_generate_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 #define TAG "TTS"
 
@@ -42,6 +49,36 @@ static int32_t internal_tts_progress_callback(const float *samples, int32_t n, f
     return 1;
 }
 
+static uint64_t compute_model_hash(const SherpaOnnxOfflineTtsConfig *config)
+{
+    const char *files[4];
+    uint64_t h = 14695981039346656037ULL;
+    size_t i;
+    size_t k;
+
+    files[0] = config->model.matcha.acoustic_model;
+    files[1] = config->model.matcha.vocoder;
+    files[2] = config->model.matcha.lexicon;
+    files[3] = config->rule_fsts;
+    for (i = 0; i < sizeof(files) / sizeof(files[0]); i++) {
+        struct stat st;
+        uint64_t parts[2] = {0, 0};
+        const unsigned char *p = (const unsigned char *)files[i];
+        for (; p != NULL && *p != '\0'; p++) {
+            h = (h ^ *p) * 1099511628211ULL;
+        }
+        if (files[i] != NULL && stat(files[i], &st) == 0) {
+            parts[0] = (uint64_t)st.st_size;
+            parts[1] = (uint64_t)st.st_mtime;
+        }
+        p = (const unsigned char *)parts;
+        for (k = 0; k < sizeof(parts); k++) {
+            h = (h ^ p[k]) * 1099511628211ULL;
+        }
+    }
+    return h;
+}
+
 static int init_sherpa_tts_internal(int max_num_sentences)
 {
     SherpaOnnxOfflineTtsConfig config;
@@ -58,18 +95,21 @@ static int init_sherpa_tts_internal(int max_num_sentences)
     config.model.matcha.dict_dir = MODEL_PREFIX "/model/tts/matcha-icefall-zh-en/espeak-ng-data";
     config.model.matcha.data_dir = MODEL_PREFIX "/model/tts/matcha-icefall-zh-en/espeak-ng-data";
 
-    config.model.num_threads = 8;
+    config.model.num_threads = infer_num_threads(INFER_TTS);
     config.model.provider = "cpu";
     config.model.debug = 0;
     config.max_num_sentences = max_num_sentences;
 
+    infer_affinity_enter(INFER_TTS);
     g_tts = SherpaOnnxCreateOfflineTts(&config);
+    infer_affinity_leave();
     if (g_tts == NULL) {
         LOGE(TAG, "创建TTS实例失败!");
         return -1;
     }
 
     g_tts_sample_rate = SherpaOnnxOfflineTtsSampleRate(g_tts);
+    g_tts_model_hash = compute_model_hash(&config);
     LOGI(TAG, "TTS模型加载完成，采样率: %d Hz, max_num_sentences: %d", g_tts_sample_rate, max_num_sentences);
 
     return 0;
@@ -92,8 +132,9 @@ int generate_tts_audio(const char *text, const char *output_filename)
         return -1;
     }
 
-    const float speed = 1.0f;
-    const SherpaOnnxGeneratedAudio *audio = SherpaOnnxOfflineTtsGenerate(g_tts, text, 0, speed);
+    pthread_mutex_lock(&g_generate_mutex);
+    const SherpaOnnxGeneratedAudio *audio = SherpaOnnxOfflineTtsGenerate(g_tts, text, TTS_SPEAKER_ID, TTS_SPEED);
+    pthread_mutex_unlock(&g_generate_mutex);
     if (audio == NULL) {
         LOGE(TAG, "生成音频失败!");
         return -1;
@@ -110,15 +151,26 @@ int generate_tts_audio(const char *text, const char *output_filename)
     return 0;
 }
 
-int generate_tts_audio_full(const char *text, float **samples, int32_t *n, uint32_t *sample_rate)
+/* 低优先级合成（缓存预热用）：拿到合成锁之后再问 should_yield，有实时请求就立即放锁让出，
+ * 避免"检查空闲"与"抢锁"之间插进来的实时请求排在整段预热合成后面。返回 0 成功，1 让出，-1 失败；
+ * should_yield 为 NULL 即普通的整段合成 */
+int generate_tts_audio_full_yielding(const char *text, int (*should_yield)(void),
+                                     float **samples, int32_t *n, uint32_t *sample_rate)
 {
+    const SherpaOnnxGeneratedAudio *audio;
+
     if (g_tts == NULL) {
         LOGE(TAG, "TTS实例未初始化!");
         return -1;
     }
 
-    const float speed = 1.0f;
-    const SherpaOnnxGeneratedAudio *audio = SherpaOnnxOfflineTtsGenerate(g_tts, text, 0, speed);
+    pthread_mutex_lock(&g_generate_mutex);
+    if (should_yield != NULL && should_yield()) {
+        pthread_mutex_unlock(&g_generate_mutex);
+        return 1;
+    }
+    audio = SherpaOnnxOfflineTtsGenerate(g_tts, text, TTS_SPEAKER_ID, TTS_SPEED);
+    pthread_mutex_unlock(&g_generate_mutex);
     if (audio == NULL) {
         LOGE(TAG, "生成音频失败!");
         return -1;
@@ -140,6 +192,11 @@ int generate_tts_audio_full(const char *text, float **samples, int32_t *n, uint3
     return 0;
 }
 
+int generate_tts_audio_full(const char *text, float **samples, int32_t *n, uint32_t *sample_rate)
+{
+    return generate_tts_audio_full_yielding(text, NULL, samples, n, sample_rate);
+}
+
 void destroy_generated_audio(float *samples)
 {
     if (samples != NULL) {
@@ -154,12 +211,16 @@ int generate_tts_audio_with_callback(const char *text, TTSCallback callback, voi
         return -1;
     }
 
-    const float speed = 1.0f;
+    pthread_mutex_lock(&g_generate_mutex);
     g_callback_context.user_callback = callback;
     g_callback_context.user_arg = arg;
 
     const SherpaOnnxGeneratedAudio *audio = SherpaOnnxOfflineTtsGenerateWithCallbackWithArg(
-        g_tts, text, 0, speed, internal_tts_callback, NULL);
+        g_tts, text, TTS_SPEAKER_ID, TTS_SPEED, internal_tts_callback, NULL);
+
+    g_callback_context.user_callback = NULL;
+    g_callback_context.user_arg = NULL;
+    pthread_mutex_unlock(&g_generate_mutex);
 
     if (audio == NULL) {
         LOGE(TAG, "生成音频失败!");
@@ -167,8 +228,6 @@ int generate_tts_audio_with_callback(const char *text, TTSCallback callback, voi
     }
 
     SherpaOnnxDestroyOfflineTtsGeneratedAudio(audio);
-    g_callback_context.user_callback = NULL;
-    g_callback_context.user_arg = NULL;
 
     return 0;
 }
@@ -180,12 +239,16 @@ int generate_tts_audio_with_progress_callback(const char *text, TTSProgressCallb
         return -1;
     }
 
-    const float speed = 1.0f;
+    pthread_mutex_lock(&g_generate_mutex);
     g_callback_context.user_progress_callback = callback;
     g_callback_context.user_arg = arg;
 
     const SherpaOnnxGeneratedAudio *audio = SherpaOnnxOfflineTtsGenerateWithProgressCallbackWithArg(
-        g_tts, text, 0, speed, internal_tts_progress_callback, NULL);
+        g_tts, text, TTS_SPEAKER_ID, TTS_SPEED, internal_tts_progress_callback, NULL);
+
+    g_callback_context.user_progress_callback = NULL;
+    g_callback_context.user_arg = NULL;
+    pthread_mutex_unlock(&g_generate_mutex);
 
     if (audio == NULL) {
         LOGE(TAG, "生成音频失败!");
@@ -193,8 +256,6 @@ int generate_tts_audio_with_progress_callback(const char *text, TTSProgressCallb
     }
 
     SherpaOnnxDestroyOfflineTtsGeneratedAudio(audio);
-    g_callback_context.user_progress_callback = NULL;
-    g_callback_context.user_arg = NULL;
 
     return 0;
 }
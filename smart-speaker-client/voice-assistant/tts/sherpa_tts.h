@@ -4,8 +4,13 @@
 #include  <stdio.h>
 #include "sherpa-onnx/c-api/c-api.h"
 
+#define TTS_SPEAKER_ID  0
+#define TTS_SPEED       1.0f
+
 extern const SherpaOnnxOfflineTts *g_tts;
 extern unsigned int g_tts_sample_rate;
+// 模型标识（由模型文件路径、大小、修改时间算出），供合成结果缓存做键
+extern uint64_t g_tts_model_hash;
 
 typedef int32_t (*TTSCallback)(const float *samples, int32_t n, void *arg);
 typedef int32_t (*TTSProgressCallback)(const float *samples, int32_t n, float progress, void *arg);
@@ -14,6 +19,8 @@ int init_sherpa_tts(void);
 int init_sherpa_tts_with_chunk_size(int max_num_sentences);
 int generate_tts_audio(const char *text, const char *output_filename);
 int generate_tts_audio_full(const char *text, float **samples, int32_t *n, uint32_t *sample_rate);
+int generate_tts_audio_full_yielding(const char *text, int (*should_yield)(void),
+                                     float **samples, int32_t *n, uint32_t *sample_rate);
 int generate_tts_audio_with_callback(const char *text, TTSCallback callback, void *arg);
 int generate_tts_audio_with_progress_callback(const char *text, TTSProgressCallback callback, void *arg);
 void destroy_generated_audio(float *samples);
@@ -0,0 +1,309 @@
+#include "musiclistmodel.h"
+#include <QFont>
+#include <QHash>
+#include <QJsonObject>
+#include <QSet>
+
+namespace {
+
+// 一次展开给视图的行数：足够铺满列表，又不会在收到大歌单时一次性排版上千行
+const int kFetchBatch = 100;
+
+QString buildMusicDisplay(const QString &title, const QString &subtitle)
+{
+    return subtitle.isEmpty() ? title : (subtitle + QStringLiteral("/") + title);
+}
+
+// 没有 source/id 的旧格式条目（纯字符串）退回按显示文本区分
+QString baseKey(const MusicEntry &e)
+{
+    if (e.source.isEmpty() && e.id.isEmpty())
+        return QStringLiteral("name:") + e.kind + QLatin1Char(':') + e.display;
+    return e.kind + QLatin1Char(':') + e.source + QLatin1Char(':') + e.id;
+}
+
+void assignKeys(QVector<MusicEntry> &entries, QHash<QString, int> &seen)
+{
+    for (MusicEntry &e : entries) {
+        const QString base = baseKey(e);
+        const int n = seen.value(base, 0);
+        seen.insert(base, n + 1);
+        e.key = (n == 0) ? base : base + QLatin1Char('#') + QString::number(n);
+    }
+}
+
+}
+
+MusicListModel::MusicListModel(QObject *parent)
+    : QAbstractListModel(parent),
+      m_visible(0),
+      m_remotePage(0),
+      m_remoteTotalPages(0),
+      m_remotePending(false)
+{
+}
+
+QVector<MusicEntry> MusicListModel::entriesFromJson(const QJsonArray &arr)
+{
+    QVector<MusicEntry> out;
+    out.reserve(arr.size());
+    for (const QJsonValue &val : arr) {
+        MusicEntry e;
+        e.kind = QStringLiteral("song");
+        if (val.isString()) {
+            e.display = val.toString();
+        } else if (val.isObject()) {
+            QJsonObject o = val.toObject();
+            e.subtitle = o[QStringLiteral("subtitle")].toString();
+            e.title = o[QStringLiteral("title")].toString();
+            e.source = o[QStringLiteral("source")].toString();
+            e.id = o[QStringLiteral("id")].toString();
+            e.kind = o[QStringLiteral("kind")].toString();
+            if (e.kind.isEmpty()) e.kind = QStringLiteral("song");
+            if (e.title.isEmpty()) e.title = o[QStringLiteral("song_name")].toString();
+            if (e.subtitle.isEmpty()) e.subtitle = o[QStringLiteral("singer")].toString();
+            e.display = buildMusicDisplay(e.title, e.subtitle);
+        }
+        if (e.display.isEmpty()) continue;
+        out.append(e);
+    }
+    return out;
+}
+
+int MusicListModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_visible;
+}
+
+QVariant MusicListModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= m_visible)
+        return QVariant();
+    const MusicEntry &e = m_entries.at(index.row());
+    switch (role) {
+    case Qt::DisplayRole:
+        return e.display;
+    case Qt::FontRole:
+        if (!m_currentKey.isEmpty() && e.key == m_currentKey) {
+            QFont font;
+            font.setBold(true);
+            return font;
+        }
+        return QVariant();
+    case TitleRole:
+        return e.title;
+    case SubtitleRole:
+        return e.subtitle;
+    case SourceRole:
+        return e.source;
+    case IdRole:
+        return e.id;
+    case KindRole:
+        return e.kind;
+    default:
+        return QVariant();
+    }
+}
+
+bool MusicListModel::canFetchMore(const QModelIndex &parent) const
+{
+    if (parent.isValid())
+        return false;
+    if (m_visible < m_entries.size())
+        return true;
+    return !m_remotePending && m_remotePage > 0 && m_remotePage < m_remoteTotalPages;
+}
+
+void MusicListModel::fetchMore(const QModelIndex &parent)
+{
+    if (parent.isValid())
+        return;
+    if (m_visible < m_entries.size()) {
+        const int last = qMin(m_visible + kFetchBatch, m_entries.size()) - 1;
+        beginInsertRows(QModelIndex(), m_visible, last);
+        m_visible = last + 1;
+        endInsertRows();
+        return;
+    }
+    if (canFetchMore(parent)) {
+        m_remotePending = true;
+        emit moreRequested(m_remotePage + 1);
+    }
+}
+
+void MusicListModel::applyEntries(QVector<MusicEntry> entries)
+{
+    QHash<QString, int> seen;
+    assignKeys(entries, seen);
+
+    // 已展开的行数保持不变（不少于一批），用户正在看的位置不会因刷新被收起
+    const int visible = qMin(entries.size(), qMax(m_visible, kFetchBatch));
+    m_entries.resize(m_visible);
+    diffVisible(entries.mid(0, visible));
+    m_entries = entries;
+    m_visible = visible;
+}
+
+void MusicListModel::appendEntries(QVector<MusicEntry> entries)
+{
+    m_remotePending = false;
+    if (entries.isEmpty())
+        return;
+    QHash<QString, int> seen;
+    for (const MusicEntry &e : m_entries)
+        seen[baseKey(e)] += 1;
+    assignKeys(entries, seen);
+
+    if (m_visible < m_entries.size()) {
+        m_entries += entries;
+        return;
+    }
+    beginInsertRows(QModelIndex(), m_visible, m_visible + entries.size() - 1);
+    m_entries += entries;
+    m_visible = m_entries.size();
+    endInsertRows();
+}
+
+void MusicListModel::setRemotePaging(int page, int totalPages)
+{
+    m_remotePage = page;
+    m_remoteTotalPages = totalPages;
+    m_remotePending = false;
+}
+
+void MusicListModel::clear()
+{
+    beginResetModel();
+    m_entries.clear();
+    m_visible = 0;
+    m_currentKey.clear();
+    m_remotePage = 0;
+    m_remoteTotalPages = 0;
+    m_remotePending = false;
+    endResetModel();
+}
+
+const MusicEntry *MusicListModel::entryAt(int row) const
+{
+    if (row < 0 || row >= m_entries.size())
+        return nullptr;
+    return &m_entries.at(row);
+}
+
+void MusicListModel::revealUpTo(int row)
+{
+    if (row < m_visible || row >= m_entries.size())
+        return;
+    beginInsertRows(QModelIndex(), m_visible, row);
+    m_visible = row + 1;
+    endInsertRows();
+}
+
+int MusicListModel::currentRow() const
+{
+    if (m_currentKey.isEmpty())
+        return -1;
+    for (int i = 0; i < m_entries.size(); ++i) {
+        if (m_entries.at(i).key == m_currentKey)
+            return i;
+    }
+    return -1;
+}
+
+void MusicListModel::setCurrentRow(int row)
+{
+    const int old = currentRow();
+    const MusicEntry *e = entryAt(row);
+    m_currentKey = e ? e->key : QString();
+    if (old >= 0 && old < m_visible)
+        emit dataChanged(index(old), index(old), {Qt::FontRole});
+    if (row >= 0 && row < m_visible && row != old)
+        emit dataChanged(index(row), index(row), {Qt::FontRole});
+}
+
+int MusicListModel::findTrack(const QString &source, const QString &id, const QString &singer) const
+{
+    int fallback = -1;
+    if (id.isEmpty())
+        return -1;
+    for (int i = 0; i < m_entries.size(); ++i) {
+        const MusicEntry &e = m_entries.at(i);
+        if (e.id != id)
+            continue;
+        if (!source.isEmpty() && e.source != source)
+            continue;
+        if (!singer.isEmpty() && e.subtitle == singer)
+            return i;
+        if (fallback < 0)
+            fallback = i;
+    }
+    return fallback;
+}
+
+bool MusicListModel::sameContent(const MusicEntry &a, const MusicEntry &b)
+{
+    return a.title == b.title && a.subtitle == b.subtitle && a.display == b.display;
+}
+
+// 把可见的 m_entries 就地改成 target：先删掉不再出现的行，再按 target 顺序逐行移动或插入。
+// 键在两边都唯一，已对齐的前缀不再变动，所以要找的行只可能在当前行之后
+void MusicListModel::diffVisible(const QVector<MusicEntry> &target)
+{
+    QSet<QString> wanted;
+    for (const MusicEntry &t : target)
+        wanted.insert(t.key);
+
+    int i = m_entries.size() - 1;
+    while (i >= 0) {
+        if (wanted.contains(m_entries.at(i).key)) {
+            --i;
+            continue;
+        }
+        const int last = i;
+        while (i >= 0 && !wanted.contains(m_entries.at(i).key))
+            --i;
+        beginRemoveRows(QModelIndex(), i + 1, last);
+        m_entries.remove(i + 1, last - i);
+        m_visible = m_entries.size();
+        endRemoveRows();
+    }
+
+    QSet<QString> present;
+    for (const MusicEntry &e : m_entries)
+        present.insert(e.key);
+
+    for (int row = 0; row < target.size(); ++row) {
+        const MusicEntry &t = target.at(row);
+        if (row < m_entries.size() && m_entries.at(row).key == t.key) {
+            if (!sameContent(m_entries.at(row), t)) {
+                m_entries[row] = t;
+                emit dataChanged(index(row), index(row));
+            }
+            continue;
+        }
+        if (present.contains(t.key)) {
+            int from = row + 1;
+            while (from < m_entries.size() && m_entries.at(from).key != t.key)
+                ++from;
+            if (from >= m_entries.size())
+                continue;   // 键唯一时不会发生
+            const bool changed = !sameContent(m_entries.at(from), t);
+            beginMoveRows(QModelIndex(), from, from, QModelIndex(), row);
+            m_entries.remove(from);
+            m_entries.insert(row, t);
+            endMoveRows();
+            if (changed)
+                emit dataChanged(index(row), index(row));
+            continue;
+        }
+        int end = row;
+        while (end < target.size() && !present.contains(target.at(end).key))
+            ++end;
+        beginInsertRows(QModelIndex(), row, end - 1);
+        for (int k = row; k < end; ++k)
+            m_entries.insert(k, target.at(k));
+        m_visible = m_entries.size();
+        endInsertRows();
+        row = end - 1;
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef MUSICLISTMODEL_H
+#define MUSICLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <QJsonArray>
+#include <QString>
+#include <QVector>
+
+// 列表中的一项（歌曲或歌单）
+struct MusicEntry
+{
+    QString title;
+    QString subtitle;
+    QString source;
+    QString id;
+    QString kind;       // "song" / "playlist"
+    QString display;    // 列表显示文本：歌手/歌名
+    QString key;        // 差量更新用的键：(source, id)，同一首重复出现时追加序号
+};
+
+// 播放队列 / 搜索结果共用的列表模型：
+// 1. applyEntries 按 (source, id) 与当前内容做差量，只对增删、移动、变化的行发通知，选中与滚动位置不被重置；
+// 2. 视图只看到已展开的行，滚动到底时 fetchMore 再展开一批；本地已全部展开且服务端还有下一页时发 moreRequested
+class MusicListModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    enum MusicRole {
+        TitleRole = Qt::UserRole + 1,
+        SubtitleRole,
+        SourceRole,
+        IdRole,
+        KindRole
+    };
+
+    explicit MusicListModel(QObject *parent = nullptr);
+
+    static QVector<MusicEntry> entriesFromJson(const QJsonArray &arr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    void applyEntries(QVector<MusicEntry> entries);     // 整表替换（差量通知）
+    void appendEntries(QVector<MusicEntry> entries);    // 追加服务端下一页
+    void setRemotePaging(int page, int totalPages);     // 服务端分页进度，totalPages <= page 表示没有更多
+    void clear();
+
+    const MusicEntry *entryAt(int row) const;
+    int totalCount() const { return m_entries.size(); }
+    void revealUpTo(int row);                           // 确保 row 已展开给视图
+
+    int currentRow() const;
+    void setCurrentRow(int row);                        // 当前曲目加粗显示，按键记录，行移动后仍跟随
+    int findTrack(const QString &source, const QString &id, const QString &singer) const;
+
+signals:
+    void moreRequested(int page);
+
+private:
+    QVector<MusicEntry> m_entries;  // 已知的全部条目，前 m_visible 条对视图可见
+    int m_visible;
+    QString m_currentKey;
+    int m_remotePage;
+    int m_remoteTotalPages;
+    bool m_remotePending;
+
+    static bool sameContent(const MusicEntry &a, const MusicEntry &b);
+    void diffVisible(const QVector<MusicEntry> &target);
+};
+
+#endif // MUSICLISTMODEL_H
@@ -1,5 +1,6 @@
 #include "player.h"
 #include "ui_player.h"
+#include "musiclistmodel.h"
 #include <QJsonArray>
 #include <QApplication>
 #include <QDateTime>
@@ -9,67 +10,24 @@
 
 namespace {
 
-enum MusicItemRole {
-    MusicTitleRole = Qt::UserRole + 1,
-    MusicSubtitleRole,
-    MusicSourceRole,
-    MusicIdRole,
-    MusicKindRole
-};
-
-QString buildMusicDisplay(const QString &title, const QString &subtitle)
-{
-    return subtitle.isEmpty() ? title : (subtitle + QStringLiteral("/") + title);
-}
-
-void populateListFromJson(QListWidget *list, const QJsonArray &arr)
-{
-    for (const QJsonValue &val : arr) {
-        QString title, subtitle, source, songId;
-        QString kind = QStringLiteral("song");
-        QString displayName;
-        if (val.isString()) {
-            displayName = val.toString();
-        } else if (val.isObject()) {
-            QJsonObject o = val.toObject();
-            subtitle = o[QStringLiteral("subtitle")].toString();
-            title = o[QStringLiteral("title")].toString();
-            source = o[QStringLiteral("source")].toString();
-            songId = o[QStringLiteral("id")].toString();
-            kind = o[QStringLiteral("kind")].toString();
-            if (kind.isEmpty()) kind = QStringLiteral("song");
-            if (title.isEmpty()) title = o[QStringLiteral("song_name")].toString();
-            if (subtitle.isEmpty()) subtitle = o[QStringLiteral("singer")].toString();
-            displayName = buildMusicDisplay(title, subtitle);
-        }
-        if (displayName.isEmpty()) continue;
-
-        QListWidgetItem *item = new QListWidgetItem(displayName);
-        item->setData(MusicTitleRole, title);
-        item->setData(MusicSubtitleRole, subtitle);
-        item->setData(MusicSourceRole, source);
-        item->setData(MusicIdRole, songId);
-        item->setData(MusicKindRole, kind);
-        list->addItem(item);
-    }
-}
+const int kSearchPageSize = 30;
+const int kDefaultPingIntervalMs = 30 * 1000;
 
 void sendPlayFromItem(Socket *socket, const QString &appid, const QString &deviceid,
-                      QListWidgetItem *item)
+                      const MusicEntry *item)
 {
     if (!item) return;
-    QString itemKind = item->data(MusicKindRole).toString();
     QJsonObject root;
-    root["cmd"] = (itemKind == QStringLiteral("playlist"))
+    root["cmd"] = (item->kind == QStringLiteral("playlist"))
                       ? QStringLiteral("app_play_playlist")
                       : QStringLiteral("app_play_assign_song");
     root["appid"] = appid;
     root["deviceid"] = deviceid;
-    root["music"] = item->text();
-    root["title"] = item->data(MusicTitleRole).toString();
-    root["subtitle"] = item->data(MusicSubtitleRole).toString();
-    root["source"] = item->data(MusicSourceRole).toString();
-    root["id"] = item->data(MusicIdRole).toString();
+    root["music"] = item->display;
+    root["title"] = item->title;
+    root["subtitle"] = item->subtitle;
+    root["source"] = item->source;
+    root["id"] = item->id;
     socket->WriteData(root);
 }
 
@@ -91,6 +49,13 @@ Player::Player(Socket *socket, QString appid, QString deviceid, QWidget *parent)
 
     applyStyleSheet();
 
+    m_playlistModel = new MusicListModel(this);
+    m_searchModel = new MusicListModel(this);
+    ui->music_listView->setModel(m_playlistModel);
+    ui->search_result_listView->setModel(m_searchModel);
+    connect(m_searchModel, &MusicListModel::moreRequested,
+            this, &Player::requestSearchPage);
+
     m_tabGroup = new QButtonGroup(this);
     m_tabGroup->addButton(ui->tab_playlist_button, 0);
     m_tabGroup->addButton(ui->tab_search_button, 1);
@@ -101,10 +66,15 @@ Player::Player(Socket *socket, QString appid, QString deviceid, QWidget *parent)
 
     connect(m_socket, &Socket::readyRead, this, &Player::server_reply_slot);
 
-    reportTimer = new QTimer(this);
-    reportTimer->setInterval(1000);
-    connect(reportTimer, &QTimer::timeout, this, &Player::tryreport);
-    reportTimer->start();
+    /* 订阅一次，之后服务端只推送变化；本端满一个间隔没发过消息才发 ping 保活。
+     * 服务端只按应用端发来的帧刷新存活时间，所以计时跟着发送走，收到推送不算 */
+    m_subscribed = false;
+    m_pingTimer = new QTimer(this);
+    m_pingTimer->setSingleShot(true);
+    m_pingTimer->setInterval(kDefaultPingIntervalMs);
+    connect(m_pingTimer, &QTimer::timeout, this, &Player::sendPing);
+    connect(m_socket, &Socket::dataWritten, m_pingTimer, static_cast<void (QTimer::*)()>(&QTimer::start));
+    player_subscribe();
 }
 
 Player::~Player()
@@ -162,16 +132,16 @@ void Player::applyStyleSheet()
         "  color: #c9d1d9;"
         "}"
 
-        "QListWidget {"
+        "QListView {"
         "  background-color: #161b22; color: #e6edf3;"
         "  border: 1px solid #21262d; border-radius: 10px;"
         "  padding: 4px; font-size: 14px; outline: none;"
         "}"
-        "QListWidget::item {"
+        "QListView::item {"
         "  padding: 10px 14px; border-radius: 6px; margin: 2px 4px;"
         "}"
-        "QListWidget::item:selected { background-color: #1f3a5f; color: #ffffff; }"
-        "QListWidget::item:hover:!selected { background-color: #1c2633; }"
+        "QListView::item:selected { background-color: #1f3a5f; color: #ffffff; }"
+        "QListView::item:hover:!selected { background-color: #1c2633; }"
 
         "QPushButton#play_button {"
         "  background-color: #58a6ff; color: #0d1117;"
@@ -219,15 +189,47 @@ void Player::switchToTab(int index)
         ui->tab_search_button->setChecked(true);
 }
 
-void Player::tryreport()
+void Player::player_subscribe(void)
 {
     if (m_socket->ConnectState) {
         QJsonObject json;
-        json["cmd"] = "app_report";
+        json["cmd"] = "app_subscribe";
         json["appid"] = m_appid;
         json["deviceid"] = m_deviceid;
         m_socket->WriteData(json);
     }
+    m_pingTimer->start();
+}
+
+// 订阅未成功（设备暂不在线）时借 ping 的时机重试订阅
+void Player::sendPing()
+{
+    if (!m_subscribed) {
+        player_subscribe();
+        return;
+    }
+    if (m_socket->ConnectState) {
+        QJsonObject json;
+        json["cmd"] = "ping";
+        m_socket->WriteData(json);
+    }
+    m_pingTimer->start();
+}
+
+void Player::player_subscribe_reply_handler(QJsonObject& root)
+{
+    const QString cmd = root["cmd"].toString();
+    const QString result = root["result"].toString();
+    if (cmd == "reply_app_subscribe") {
+        m_subscribed = (result == "success");
+        const int interval = root[QStringLiteral("ping_interval")].toInt(0);
+        if (interval > 0)
+            m_pingTimer->setInterval(interval * 1000);
+    } else if (result == "offline") {
+        // 服务端已不认这条订阅（设备重连、超时），立即重新订阅
+        m_subscribed = false;
+        player_subscribe();
+    }
 }
 
 void Player::server_reply_slot(void)
@@ -235,7 +237,9 @@ void Player::server_reply_slot(void)
     QJsonObject root;
     while (m_socket->readOneJson(root)) {
         QString cmd = root["cmd"].toString();
-        if (cmd == "device_report")
+        if (cmd == "reply_app_subscribe" || cmd == "pong")
+            player_subscribe_reply_handler(root);
+        else if (cmd == "device_report")
             player_device_report_handler(root);
         else if (cmd == "upload_music_list")
             player_upload_music_list_handler(root);
@@ -359,30 +363,36 @@ void Player::player_upload_music_list_handler(QJsonObject& root)
     m_playlistVersion = root[QStringLiteral("playlist_version")].toInt(m_playlistVersion);
     m_get_music_flag = false;
 
-    ui->music_listWidget->clear();
-
     QJsonArray musicArray = root["music"].toArray();
     if (musicArray.isEmpty())
         musicArray = root["items"].toArray();
 
-    populateListFromJson(ui->music_listWidget, musicArray);
+    m_playlistModel->applyEntries(MusicListModel::entriesFromJson(musicArray));
     syncCurrentTrackSelection(currentIndex);
     updatePlaylistPageLabelFromJson(root);
 }
 
 void Player::player_search_result_handler(QJsonObject& root)
 {
-    ui->search_result_listWidget->clear();
-
     QJsonArray items = root["items"].toArray();
     if (items.isEmpty())
         items = root["music"].toArray();
 
-    populateListFromJson(ui->search_result_listWidget, items);
+    // 第 2 页起是滚动到底时自动请求的，追加到已有结果后面，不切换标签页
+    const int page = root[QStringLiteral("page")].toInt(1);
+    const int totalPages = root[QStringLiteral("total_pages")].toInt(0);
+    QVector<MusicEntry> entries = MusicListModel::entriesFromJson(items);
+    if (page > 1)
+        m_searchModel->appendEntries(entries);
+    else
+        m_searchModel->applyEntries(entries);
+    m_searchModel->setRemotePaging(page, totalPages);
 
-    int count = ui->search_result_listWidget->count();
+    const int total = root[QStringLiteral("total")].toInt(0);
+    const int count = total > 0 ? total : m_searchModel->totalCount();
     ui->tab_search_button->setText(QStringLiteral("搜索结果 (%1)").arg(count));
-    switchToTab(1);
+    if (page <= 1)
+        switchToTab(1);
 }
 
 void Player::updatePlaylistPageLabelFromJson(const QJsonObject &root)
@@ -496,30 +506,29 @@ void Player::on_order_radioButton_clicked()
     m_socket->WriteData(root);
 }
 
-void Player::on_music_listWidget_doubleClicked(const QModelIndex &index)
+void Player::on_music_listView_doubleClicked(const QModelIndex &index)
 {
-    QListWidgetItem *item = ui->music_listWidget->item(index.row());
+    const MusicEntry *item = m_playlistModel->entryAt(index.row());
     if (!item) return;
     setMusicItemSelectedAndBold(index.row());
     sendPlayFromItem(m_socket, m_appid, m_deviceid, item);
 }
 
-void Player::on_search_result_listWidget_doubleClicked(const QModelIndex &index)
+void Player::on_search_result_listView_doubleClicked(const QModelIndex &index)
 {
-    QListWidgetItem *item = ui->search_result_listWidget->item(index.row());
+    const MusicEntry *item = m_searchModel->entryAt(index.row());
     if (!item) return;
-    QString itemKind = item->data(MusicKindRole).toString();
-    if (itemKind == QStringLiteral("playlist")) {
+    if (item->kind == QStringLiteral("playlist")) {
         sendPlayFromItem(m_socket, m_appid, m_deviceid, item);
     } else {
         QJsonObject root;
         root["cmd"] = QStringLiteral("app_insert_play_song");
         root["appid"] = m_appid;
         root["deviceid"] = m_deviceid;
-        root["title"] = item->data(MusicTitleRole).toString();
-        root["subtitle"] = item->data(MusicSubtitleRole).toString();
-        root["source"] = item->data(MusicSourceRole).toString();
-        root["id"] = item->data(MusicIdRole).toString();
+        root["title"] = item->title;
+        root["subtitle"] = item->subtitle;
+        root["source"] = item->source;
+        root["id"] = item->id;
         m_socket->WriteData(root);
     }
 }
@@ -528,25 +537,29 @@ void Player::on_song_search_button_clicked()
 {
     const QString keyword = ui->search_keyword_edit->text().trimmed();
     if (keyword.isEmpty()) return;
-    QJsonObject root;
-    root["cmd"] = "music.search.song";
-    root["keyword"] = keyword;
-    root["source"] = "all";
-    root["page"] = 1;
-    root["page_size"] = 30;
-    m_socket->WriteData(root);
+    m_searchCmd = QStringLiteral("music.search.song");
+    m_searchKeyword = keyword;
+    requestSearchPage(1);
 }
 
 void Player::on_playlist_search_button_clicked()
 {
     const QString keyword = ui->search_keyword_edit->text().trimmed();
     if (keyword.isEmpty()) return;
+    m_searchCmd = QStringLiteral("music.search.playlist");
+    m_searchKeyword = keyword;
+    requestSearchPage(1);
+}
+
+void Player::requestSearchPage(int page)
+{
+    if (m_searchCmd.isEmpty()) return;
     QJsonObject root;
-    root["cmd"] = "music.search.playlist";
-    root["keyword"] = keyword;
+    root["cmd"] = m_searchCmd;
+    root["keyword"] = m_searchKeyword;
     root["source"] = "all";
-    root["page"] = 1;
-    root["page_size"] = 30;
+    root["page"] = page;
+    root["page_size"] = kSearchPageSize;
     m_socket->WriteData(root);
 }
 
@@ -562,70 +575,37 @@ void Player::on_tab_search_button_clicked()
 
 void Player::clearMusicItemBold()
 {
-    const int count = ui->music_listWidget->count();
-    for (int i = 0; i < count; ++i) {
-        QListWidgetItem *item = ui->music_listWidget->item(i);
-        if (item) {
-            QFont font = item->font();
-            font.setBold(false);
-            item->setFont(font);
-        }
-    }
+    m_playlistModel->setCurrentRow(-1);
 }
 
 void Player::setMusicItemSelectedAndBold(int index)
 {
-    const int count = ui->music_listWidget->count();
-    if (index < 0 || index >= count) return;
-    clearMusicItemBold();
-    QListWidgetItem *targetItem = ui->music_listWidget->item(index);
-    if (targetItem) {
-        ui->music_listWidget->setCurrentItem(targetItem);
-        QFont font = targetItem->font();
-        font.setBold(true);
-        targetItem->setFont(font);
-    }
+    if (index < 0 || index >= m_playlistModel->totalCount()) return;
+    // 当前曲目可能还在未展开的部分，先展开到该行再选中
+    m_playlistModel->revealUpTo(index);
+    m_playlistModel->setCurrentRow(index);
+    ui->music_listView->setCurrentIndex(m_playlistModel->index(index));
 }
 
 int Player::getCurrentSelectedMusicIndex()
 {
-    QListWidgetItem *currentItem = ui->music_listWidget->currentItem();
-    if (!currentItem) return -1;
-    return ui->music_listWidget->row(currentItem);
+    const QModelIndex current = ui->music_listView->currentIndex();
+    return current.isValid() ? current.row() : -1;
 }
 
 int Player::getMusicListCount()
 {
-    return ui->music_listWidget->count();
+    return m_playlistModel->totalCount();
 }
 
 void Player::syncCurrentTrackSelection(int currentIndex)
 {
-    const int count = ui->music_listWidget->count();
-    if (currentIndex >= 0 && currentIndex < count) {
-        setMusicItemSelectedAndBold(currentIndex);
+    if (currentIndex >= 0 && currentIndex < m_playlistModel->totalCount()) {
+        if (currentIndex != m_playlistModel->currentRow())
+            setMusicItemSelectedAndBold(currentIndex);
         return;
     }
-    if (m_currentSongId.isEmpty())
-        return;
-    int fallback = -1;
-    for (int i = 0; i < count; ++i) {
-        QListWidgetItem *item = ui->music_listWidget->item(i);
-        if (!item) continue;
-        if (item->data(MusicIdRole).toString() != m_currentSongId)
-            continue;
-        const bool srcOk = m_currentSource.isEmpty() ||
-            item->data(MusicSourceRole).toString() == m_currentSource;
-        if (!srcOk)
-            continue;
-        if (!m_currentSinger.isEmpty() &&
-            item->data(MusicSubtitleRole).toString() == m_currentSinger) {
-            setMusicItemSelectedAndBold(i);
-            return;
-        }
-        if (fallback < 0)
-            fallback = i;
-    }
-    if (fallback >= 0)
-        setMusicItemSelectedAndBold(fallback);
+    const int row = m_playlistModel->findTrack(m_currentSource, m_currentSongId, m_currentSinger);
+    if (row >= 0 && row != m_playlistModel->currentRow())
+        setMusicItemSelectedAndBold(row);
 }
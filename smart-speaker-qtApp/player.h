@@ -5,6 +5,7 @@
 #include "socket.h"
 
 class QButtonGroup;
+class MusicListModel;
 
 namespace Ui {
 class Player;
@@ -23,7 +24,8 @@ private:
     Socket* m_socket;
     QString m_appid;
     QString m_deviceid;
-    QTimer *reportTimer;
+    QTimer *m_pingTimer;
+    bool m_subscribed;
     bool m_get_music_flag;
     qint64 m_lastPlaylistRequestMs;
     int m_playlistVersion;
@@ -32,7 +34,13 @@ private:
     QString m_currentSongId;
     QString m_currentSinger;
     QButtonGroup *m_tabGroup;
+    MusicListModel *m_playlistModel;
+    MusicListModel *m_searchModel;
+    QString m_searchCmd;        // 最近一次搜索，滚动加载下一页时沿用
+    QString m_searchKeyword;
 
+    void player_subscribe(void);
+    void player_subscribe_reply_handler(QJsonObject& root);
     void player_device_report_handler(QJsonObject& root);
     void player_get_music_list(void);
     void player_upload_music_list_handler(QJsonObject& root);
@@ -55,7 +63,7 @@ private:
 
 private slots:
     void server_reply_slot(void);
-    void tryreport();
+    void sendPing();
     void on_play_button_clicked();
     void on_prev_button_clicked();
     void on_next_button_clicked();
@@ -63,14 +71,15 @@ private slots:
     void on_voladd_button_clicked();
     void on_single_radioButton_clicked();
     void on_order_radioButton_clicked();
-    void on_music_listWidget_doubleClicked(const QModelIndex &index);
-    void on_search_result_listWidget_doubleClicked(const QModelIndex &index);
+    void on_music_listView_doubleClicked(const QModelIndex &index);
+    void on_search_result_listView_doubleClicked(const QModelIndex &index);
     void on_playlist_page_prev_button_clicked();
     void on_playlist_page_next_button_clicked();
     void on_song_search_button_clicked();
     void on_playlist_search_button_clicked();
     void on_tab_playlist_button_clicked();
     void on_tab_search_button_clicked();
+    void requestSearchPage(int page);
 };
 
 #endif // PLAYER_H
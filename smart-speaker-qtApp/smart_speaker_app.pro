@@ -18,12 +18,14 @@ DEFINES += QT_DEPRECATED_WARNINGS
 SOURCES += \
     bind.cpp \
     main.cpp \
+    musiclistmodel.cpp \
     player.cpp \
     socket.cpp \
     widget.cpp
 
 HEADERS += \
     bind.h \
+    musiclistmodel.h \
     player.h \
     socket.h \
     widget.h
@@ -136,12 +136,13 @@ void Socket::ReadData(QJsonObject& root)
 void Socket::WriteData(const QJsonObject &json)
 {
     QJsonDocument d(json);
-    QByteArray SendData = d.toJson();
+    QByteArray SendData = d.toJson(QJsonDocument::Compact);
     int len = SendData.size();
     //第一次发送数据长度
     m_socket->write((char *)&len,sizeof(int));
     //发送数据本身
     m_socket->write(SendData);
     // qDebug()<<"发送消息:"<< SendData;
+    emit dataWritten();
 }
 
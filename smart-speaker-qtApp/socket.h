@@ -43,6 +43,7 @@ private slots:
 signals:
     void readyRead();   // 自定义信号，转发QTcpSocket的readyRead
     void disconnectedFromServer(); // 自定义信号：掉线通知
+    void dataWritten();     // 每发出一条消息触发一次
 };
 
 #endif // SOCKET_H
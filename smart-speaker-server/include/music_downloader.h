@@ -41,6 +41,35 @@ void music_configure_online(const char *api_url, const char *api_key, const char
 
 int music_api_configured(void);
 
+/* 共享 HTTP 客户端：连接池参数（0 为默认值），应在首次搜索/取链前调用 */
+void music_http_configure(uint32_t pool_max_idle_per_host, uint32_t pool_idle_timeout_secs,
+                          uint32_t connect_timeout_secs, uint32_t tcp_keepalive_secs);
+
+/* 搜索调度：all 凑够 quorum 个源有结果后再等 quorum_grace_ms 即返回，超过 hedge_after_ms 未返回的源对冲补发一次；
+ * priority_race 非 0 时 auto 各源同时发出取最先的非空结果。前三项 0 为默认值（3 / 2500 / 500） */
+void music_search_configure(uint32_t quorum, uint32_t hedge_after_ms, uint32_t quorum_grace_ms, int priority_race);
+
+/* 连接复用计数：reused = requests - new_connections */
+typedef struct {
+    uint64_t requests;
+    uint64_t new_connections;
+    uint64_t reused;
+    uint64_t client_builds;
+} music_http_stats_t;
+
+music_result_t music_http_stats(music_http_stats_t *out);
+void music_http_stats_reset(void);
+
+/* 下载：服务端支持 Range 时按 segments 段并行（0 为默认 1，最大 8），单段连续失败重试 max_retries 次（0 为默认 3） */
+void music_download_configure(uint32_t segments, uint32_t max_retries);
+
+/* 在线歌曲本地缓存：按 <dir>/<歌手>/<歌名>.<扩展名> 存放，超过 max_bytes 淘汰最久未播放的；max_bytes 为 0 关闭。
+ * lookup / store 返回的路径需 music_free_string 释放 */
+music_result_t music_cache_configure(const char *dir, uint64_t max_bytes);
+char *music_cache_lookup(const char *singer, const char *song, const char *quality);
+char *music_cache_store(const char *url, const char *singer, const char *song, const char *quality,
+                        progress_callback_t callback, void *user_data);
+
 typedef struct {
     char *play_url;
     char *source;
@@ -61,12 +90,67 @@ music_result_t music_search_page(const char *keyword, const char *platform, uint
 
 void music_free_search_result(music_search_result_t *result);
 
+/* 异步接口：搜索 / 取链在库内工作线程执行，完成后 music_async_init 返回的 eventfd 可读，
+ * 调用方在自己的线程里调用 music_async_dispatch 执行回调。提交失败返回 0 且不会回调。 */
+typedef uint64_t music_job_t;
+
+typedef enum {
+    MUSIC_JOB_SEARCH = 1,
+    MUSIC_JOB_URL = 2,
+    MUSIC_JOB_RESOLVE = 3,
+    MUSIC_JOB_URL_BATCH = 4,
+    MUSIC_JOB_CACHE = 5
+} music_job_kind_t;
+
+/* 按 kind 只有对应字段有效；全部内容仅在回调内有效，回调返回后由库释放 */
+typedef struct {
+    music_job_t job;
+    music_job_kind_t kind;
+    music_result_t status; /* 批量任务恒为 Ok，逐条成败见 urls */
+    music_search_result_t search;
+    music_resolve_result_t resolve;
+    char *url;
+    char **urls; /* 与提交顺序一致，失败项为 NULL */
+    size_t url_count;
+    char *path; /* MUSIC_JOB_CACHE：缓存文件路径 */
+} music_completion_t;
+
+typedef struct {
+    const char *source;
+    const char *song_id;
+} music_url_request_t;
+
+typedef void (*music_completion_cb)(const music_completion_t *completion, void *user_data);
+
+/* workers 为 0 时默认 4，只有首次调用生效；返回的 fd 由库持有，失败 -1 */
+int music_async_init(uint32_t workers);
+size_t music_async_dispatch(void);
+/* 1：取消成功，之后不会回调；0：已回调或不存在 */
+int music_job_cancel(music_job_t job);
+
+music_job_t music_search_page_async(const char *keyword, const char *platform, uint32_t page, uint32_t page_size,
+                                    music_completion_cb callback, void *user_data);
+music_job_t music_get_url_async(const char *source, const char *song_id, const char *quality,
+                                music_completion_cb callback, void *user_data);
+music_job_t music_resolve_keyword_async(const char *keyword, const char *platform, const char *quality,
+                                        music_completion_cb callback, void *user_data);
+/* items 提交时即拷贝；各项并行取链，全部完成后回调一次 */
+music_job_t music_get_url_batch_async(const music_url_request_t *items, size_t count, const char *quality,
+                                      music_completion_cb callback, void *user_data);
+/* 整首下载进缓存，单独线程执行；完成后 path 为缓存文件路径 */
+music_job_t music_cache_store_async(const char *url, const char *singer, const char *song, const char *quality,
+                                    music_completion_cb callback, void *user_data);
+
 music_result_t music_download(const char *source, const char *song_id, const char *quality, const char *output_dir,
                               progress_callback_t callback, void *user_data);
 
 music_result_t music_download_with_path(const char *source, const char *song_id, const char *quality,
                                         const char *output_path, progress_callback_t callback, void *user_data);
 
+/* 按链接下载，写 <output_path>.part 并在完成后改名；失败保留断点，再次调用继续 */
+music_result_t music_download_url(const char *url, const char *output_path, progress_callback_t callback,
+                                  void *user_data);
+
 char *music_get_extension(const char *quality);
 void music_free_string(char *s);
 
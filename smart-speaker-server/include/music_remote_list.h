@@ -1,6 +1,8 @@
 #ifndef MUSIC_REMOTE_LIST_H
 #define MUSIC_REMOTE_LIST_H
 
+#include "music_downloader.h"
+
 #include <json/json.h>
 #include <string>
 
@@ -9,7 +11,10 @@ bool music_remote_keyword_is_vague(const std::string &keyword);
 void music_remote_apply_source_hints(std::string &keyword, std::string &platform,
                                      const std::string &fallback_platform);
 
-bool music_remote_list_music_page(const std::string &keyword, int page, int page_size, Json::Value &music,
-                                  int &out_total, int &out_total_pages);
+/** list_music 远程分页的查询词与平台（已去掉「网易云的」等来源提示）；未配置 Key 或关键词为空返回 false */
+bool music_remote_list_prepare(const std::string &keyword, std::string &kw, std::string &plat);
+
+/** 搜索结果 → list_music 条目（singer/song/path/source/song_id），play_url 由调用方另行取链 */
+void music_remote_list_fill_items(const music_search_result_t &res, Json::Value &music);
 
 #endif
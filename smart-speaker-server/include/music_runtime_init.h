@@ -3,4 +3,7 @@
 
 int music_runtime_init(void);
 
+/* music.toml 中 cache_max_mb > 0 且缓存目录可用时为 1 */
+int music_runtime_cache_enabled(void);
+
 #endif
@@ -8,6 +8,8 @@
 #include <list>
 
 #define TIMEOUT 3
+/* app_subscribe 订阅的应用端靠 ping 或任意命令保活，空闲时只需偶尔一帧 */
+#define APP_PING_TIMEOUT 90
 
 class Server;
 
@@ -24,6 +26,7 @@ typedef struct PlayerInfo_t
     int m_cur_mode;
     time_t m_device_last_time;
     time_t m_app_last_time;
+    bool m_app_subscribed;
     Json::Value m_last_device_report;
     Json::Value m_last_music_list;
     struct bufferevent *m_device_bev;
@@ -46,6 +49,9 @@ public:
 
     void player_device_update_infolist(struct bufferevent *bev, const Json::Value &report, Server *s);
     void player_app_update_infolist(struct bufferevent *bev, const Json::Value &report, Server *s);
+    void player_app_subscribe(struct bufferevent *bev, const Json::Value &json, Server *s);
+    void player_app_ping(struct bufferevent *bev, const Json::Value &json, Server *s);
+    void player_app_touch(struct bufferevent *bev);
     void player_device_update_music_list(struct bufferevent *bev, const Json::Value &report, Server *s);
 
     void player_app_register(struct bufferevent *bev, const Json::Value &json, Server *s);
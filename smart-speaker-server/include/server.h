@@ -19,6 +19,7 @@ private:
     struct event_base *m_eventbase;
     Database *m_database;
     PlayerInfo *m_player_info;
+    struct event *m_music_event;
     bool m_ok;
 
 public:
@@ -46,7 +47,11 @@ public:
     bool server_app_option(struct bufferevent *bev, Json::Value &root);
     bool server_device_reply_handle(struct bufferevent *bev, const Json::Value &root);
 
+    /** 释放连接前先取消（或解除）其未完成的 music-lib 任务，之后完成的回调不会再写这个 bufferevent */
+    static void server_release_bev(struct bufferevent *bev);
     static void event_cb(struct bufferevent *bev, short what, void *ctx);
+    /** music-lib 异步任务完成（eventfd 可读）：在事件循环线程里执行各任务的回调 */
+    static void music_async_cb(evutil_socket_t fd, short what, void *ctx);
 };
 
 #endif
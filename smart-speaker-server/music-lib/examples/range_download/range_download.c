@@ -0,0 +1,76 @@
+#include "../music.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void progress(uint64_t down, uint64_t total, void* data) {
+    (void)data;
+    if (total > 0) {
+        printf("\r%.1f%% (%llu / %llu)", (double)down / total * 100, (unsigned long long)down,
+               (unsigned long long)total);
+    } else {
+        printf("\r%llu bytes", (unsigned long long)down);
+    }
+    fflush(stdout);
+}
+
+static void usage(const char* prog) {
+    fprintf(stderr, "用法:\n");
+    fprintf(stderr, "  %s <链接> <输出路径> [分段数]\n", prog);
+    fprintf(stderr, "  %s --cache <缓存目录> <容量MB> <链接> <歌手> <歌名> [音质]\n", prog);
+}
+
+static int run_download(const char* url, const char* output, uint32_t segments) {
+    music_result_t r;
+
+    music_download_configure(segments, 0);
+    printf("下载 %s -> %s（%u 段）\n", url, output, segments);
+    r = music_download_url(url, output, progress, NULL);
+    if (r != Ok) {
+        printf("\n✗ 下载失败，错误码 %d；再次运行同一命令会从断点继续\n", r);
+        return 1;
+    }
+    printf("\n✓ 完成\n");
+    return 0;
+}
+
+static int run_cache(int argc, char* argv[]) {
+    const char* dir = argv[2];
+    uint64_t max_bytes = strtoull(argv[3], NULL, 10) * 1024 * 1024;
+    const char* url = argv[4];
+    const char* singer = argv[5];
+    const char* song = argv[6];
+    const char* quality = argc > 7 ? argv[7] : "320k";
+    char* path;
+
+    if (music_cache_configure(dir, max_bytes) != Ok) {
+        return 1;
+    }
+    path = music_cache_lookup(singer, song, quality);
+    if (path != NULL) {
+        printf("✓ 缓存命中: %s\n", path);
+        music_free_string(path);
+        return 0;
+    }
+    printf("未命中，下载进缓存...\n");
+    path = music_cache_store(url, singer, song, quality, progress, NULL);
+    if (path == NULL) {
+        printf("\n✗ 缓存失败\n");
+        return 1;
+    }
+    printf("\n✓ 已缓存: %s\n", path);
+    music_free_string(path);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc >= 7 && strcmp(argv[1], "--cache") == 0) {
+        return run_cache(argc, argv);
+    }
+    if (argc < 3) {
+        usage(argv[0]);
+        return 2;
+    }
+    return run_download(argv[1], argv[2], argc > 3 ? (uint32_t)strtoul(argv[3], NULL, 10) : 1);
+}
@@ -0,0 +1,75 @@
+#include "../music.h"
+
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int g_done = 0;
+
+static void on_batch_done(const music_completion_t* c, void* user_data) {
+    const music_url_request_t* items = (const music_url_request_t*)user_data;
+    size_t i;
+    size_t ok = 0;
+
+    for (i = 0; i < c->url_count; i++) {
+        if (c->urls[i] != NULL) {
+            ok++;
+            printf("%s:%s -> %s\n", items[i].source, items[i].song_id, c->urls[i]);
+        } else {
+            printf("%s:%s -> 获取失败\n", items[i].source, items[i].song_id);
+        }
+    }
+    printf("========================================\n");
+    printf("成功 %zu / %zu\n", ok, c->url_count);
+    g_done = 1;
+}
+
+int main(int argc, char* argv[]) {
+    music_url_request_t* items;
+    int count;
+    int fd;
+    int i;
+
+    if (argc < 4) {
+        fprintf(stderr, "用法: %s <music_api_key> <音质> <平台:歌曲ID> [平台:歌曲ID ...]\n", argv[0]);
+        return 2;
+    }
+    music_configure_online("https://source.shiqianjiang.cn/api/music", argv[1], "lx-music-request/2.12.0");
+
+    count = argc - 3;
+    items = (music_url_request_t*)calloc((size_t)count, sizeof(*items));
+    if (items == NULL) {
+        return 1;
+    }
+    for (i = 0; i < count; i++) {
+        char* sep = strchr(argv[i + 3], ':');
+        if (sep == NULL) {
+            fprintf(stderr, "参数格式应为 平台:歌曲ID: %s\n", argv[i + 3]);
+            free(items);
+            return 2;
+        }
+        *sep = '\0';
+        items[i].source = argv[i + 3];
+        items[i].song_id = sep + 1;
+    }
+
+    // 事件循环里的用法：fd 注册到 poll/epoll/libevent，可读时 dispatch，回调在本线程执行
+    fd = music_async_init(0);
+    if (fd < 0 || music_get_url_batch_async(items, (size_t)count, argv[2], on_batch_done, items) == 0) {
+        fprintf(stderr, "提交批量取链失败\n");
+        free(items);
+        return 1;
+    }
+    while (!g_done) {
+        struct pollfd pfd;
+        pfd.fd = fd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        if (poll(&pfd, 1, -1) > 0) {
+            music_async_dispatch();
+        }
+    }
+    free(items);
+    return 0;
+}
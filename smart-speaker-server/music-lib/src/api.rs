@@ -1,6 +1,7 @@
 //! API 模块 - 负责与音乐 API 交互，获取音乐下载链接
 use serde::Deserialize;
-use reqwest::blocking::Client;
+use crate::http;
+use reqwest::header::USER_AGENT;
 use std::sync::Mutex;
 
 const DEFAULT_API_URL: &str = "https://source.shiqianjiang.cn/api/music";
@@ -119,16 +120,6 @@ fn get_platform_qualities(source: &str) -> &'static [&'static str] {
     }
 }
 
-fn url_request_client() -> Result<Client, String> {
-    let ua = music_user_agent_for_client();
-
-    Client::builder()
-        .user_agent(ua)
-        .redirect(reqwest::redirect::Policy::limited(5))
-        .build()
-        .map_err(|e| e.to_string())
-}
-
 /// 验证某个平台是否支持指定音质
 fn is_quality_supported_for_platform(source: &str, quality: &str) -> bool {
     get_platform_qualities(source).contains(&quality)
@@ -155,8 +146,8 @@ fn fetch_music_url(source: &str, song_id: &str, quality: &str, api_key: &str) ->
         base, source, song_id, quality
     );
 
-    let resp = url_request_client()?
-        .get(&url)
+    let resp = http::get(&url)?
+        .header(USER_AGENT, music_user_agent_for_client())
         .header("Content-Type", "application/json")
         .header("X-API-Key", api_key)
         .send()
@@ -0,0 +1,260 @@
+//! 缓存模块 - 在线播放过的歌曲落到本地，总大小超限时按最近使用时间淘汰
+//!
+//! 缓存文件按 `<歌手>/<歌名>.<扩展名>` 存放，与服务端本地曲库的目录结构一致；
+//! 缓存目录即曲库目录时，离线模式的本地搜索可以直接命中最近播放过的歌。
+//! 只有经本模块写入的文件才参与淘汰：索引 `.music-cache.idx` 记录每条的大小与最近使用时间，
+//! 用户自己放进曲库的同名文件视为命中，但不计入容量、也不会被删除。
+//! 命中只改内存里的最近使用时间，不每次重写索引（SD 卡上每播一首就整写一遍）：
+//! 增删条目时立即落盘，仅有使用时间变化时最多每 `INDEX_FLUSH_INTERVAL_MS` 落盘一次，换目录或关闭缓存时补写。
+use crate::downloader::{self, Downloader, ProgressCallback};
+use std::collections::{HashMap, HashSet};
+use std::fs;
+use std::path::PathBuf;
+use std::sync::Mutex;
+use std::time::{SystemTime, UNIX_EPOCH};
+
+const INDEX_FILE: &str = ".music-cache.idx";
+
+/// 只有最近使用时间变化时，索引落盘的最短间隔
+const INDEX_FLUSH_INTERVAL_MS: u64 = 10 * 60 * 1000;
+
+/// 单个路径分量的最大字符数，避免超出文件系统的文件名长度限制
+const MAX_NAME_CHARS: usize = 80;
+
+struct Entry {
+    size: u64,
+    /// 毫秒时间戳
+    last_used: u64,
+}
+
+struct Cache {
+    dir: PathBuf,
+    max_bytes: u64,
+    /// 相对 dir 的路径 → 条目
+    entries: HashMap<String, Entry>,
+    total: u64,
+    /// 正在下载的条目，同一首歌不并发下载
+    in_flight: HashSet<String>,
+    /// 内存里的最近使用时间比索引文件新
+    dirty: bool,
+    /// 上次写索引的毫秒时间戳
+    flushed_at: u64,
+}
+
+static CACHE: Mutex<Option<Cache>> = Mutex::new(None);
+
+fn now_ms() -> u64 {
+    SystemTime::now()
+        .duration_since(UNIX_EPOCH)
+        .map(|d| d.as_millis() as u64)
+        .unwrap_or(0)
+}
+
+/// 歌手 / 歌名转成安全的路径分量：去掉分隔符与控制字符，不以 `.` 开头（曲库扫描会跳过隐藏文件）
+fn sanitize(name: &str) -> String {
+    let cleaned: String = name
+        .trim()
+        .chars()
+        .map(|c| if c == '/' || c == '\\' || c.is_control() { '_' } else { c })
+        .take(MAX_NAME_CHARS)
+        .collect();
+    let cleaned = cleaned.trim_start_matches('.').trim();
+    if cleaned.is_empty() {
+        "未知".to_string()
+    } else {
+        cleaned.to_string()
+    }
+}
+
+/// 缓存条目的相对路径
+pub fn entry_name(singer: &str, song: &str, quality: &str) -> String {
+    format!(
+        "{}/{}.{}",
+        sanitize(singer),
+        sanitize(song),
+        downloader::get_extension(quality)
+    )
+}
+
+impl Cache {
+    /// 读索引；文件已被删除或大小对不上的条目直接丢弃
+    fn load_index(&mut self) {
+        let text = match fs::read_to_string(self.dir.join(INDEX_FILE)) {
+            Ok(t) => t,
+            Err(_) => return,
+        };
+        for line in text.lines() {
+            let mut it = line.splitn(3, '\t');
+            let (Some(used), Some(size), Some(name)) = (it.next(), it.next(), it.next()) else {
+                continue;
+            };
+            let (Ok(last_used), Ok(size)) = (used.parse::<u64>(), size.parse::<u64>()) else {
+                continue;
+            };
+            match fs::metadata(self.dir.join(name)) {
+                Ok(md) if md.is_file() && md.len() == size => {
+                    self.total += size;
+                    self.entries.insert(name.to_string(), Entry { size, last_used });
+                }
+                _ => {}
+            }
+        }
+    }
+
+    fn save_index(&mut self) {
+        let mut text = String::new();
+        for (name, e) in &self.entries {
+            text.push_str(&format!("{}\t{}\t{}\n", e.last_used, e.size, name));
+        }
+        let path = self.dir.join(INDEX_FILE);
+        let tmp = self.dir.join(format!("{}.tmp", INDEX_FILE));
+        if let Err(e) = fs::write(&tmp, text).and_then(|_| fs::rename(&tmp, &path)) {
+            eprintln!("写缓存索引 {} 失败: {}", path.display(), e);
+            return;
+        }
+        self.dirty = false;
+        self.flushed_at = now_ms();
+    }
+
+    /// 淘汰最久未用的条目直到不超过上限；`keep` 为刚写入的条目，不参与淘汰
+    fn evict(&mut self, keep: &str) {
+        while self.total > self.max_bytes {
+            let victim = self
+                .entries
+                .iter()
+                .filter(|(name, _)| name.as_str() != keep)
+                .min_by_key(|(_, e)| e.last_used)
+                .map(|(name, _)| name.clone());
+            let Some(name) = victim else {
+                break;
+            };
+            let e = self.entries.remove(&name).unwrap();
+            self.total -= e.size;
+            let path = self.dir.join(&name);
+            if let Err(err) = fs::remove_file(&path) {
+                eprintln!("淘汰缓存 {} 失败: {}", path.display(), err);
+            }
+            // 歌手目录空了一并删掉；非空时 remove_dir 失败，忽略即可
+            if let Some(parent) = path.parent() {
+                if parent != self.dir {
+                    let _ = fs::remove_dir(parent);
+                }
+            }
+        }
+    }
+
+    /// 命中时返回完整路径；受管条目顺带刷新最近使用时间（只在内存里，按间隔落盘）
+    fn hit(&mut self, name: &str) -> Option<PathBuf> {
+        let path = self.dir.join(name);
+        if !path.is_file() {
+            if let Some(e) = self.entries.remove(name) {
+                self.total -= e.size;
+                self.save_index();
+            }
+            return None;
+        }
+        if let Some(e) = self.entries.get_mut(name) {
+            let now = now_ms();
+            e.last_used = now;
+            self.dirty = true;
+            if now.saturating_sub(self.flushed_at) >= INDEX_FLUSH_INTERVAL_MS {
+                self.save_index();
+            }
+        }
+        Some(path)
+    }
+}
+
+/// 重新配置或关闭缓存时旧实例被替换，补写尚未落盘的使用时间
+impl Drop for Cache {
+    fn drop(&mut self) {
+        if self.dirty {
+            self.save_index();
+        }
+    }
+}
+
+/// 启用缓存；`max_bytes` 为 0 或目录为空时关闭。重复调用以最后一次为准，超出新上限的条目立即淘汰
+pub fn configure(dir: &str, max_bytes: u64) -> Result<(), String> {
+    let mut slot = CACHE.lock().unwrap();
+    if dir.is_empty() || max_bytes == 0 {
+        *slot = None;
+        return Ok(());
+    }
+    fs::create_dir_all(dir).map_err(|e| format!("创建缓存目录 {} 失败: {}", dir, e))?;
+    let mut c = Cache {
+        dir: PathBuf::from(dir),
+        max_bytes,
+        entries: HashMap::new(),
+        total: 0,
+        in_flight: HashSet::new(),
+        dirty: false,
+        flushed_at: 0,
+    };
+    c.load_index();
+    c.evict("");
+    c.save_index();
+    *slot = Some(c);
+    Ok(())
+}
+
+/// 查缓存，命中返回文件路径
+pub fn lookup(singer: &str, song: &str, quality: &str) -> Option<PathBuf> {
+    let name = entry_name(singer, song, quality);
+    CACHE.lock().unwrap().as_mut()?.hit(&name)
+}
+
+/// 下载到缓存并返回路径；已缓存时直接返回。下载在锁外进行，期间其他查询不受影响
+pub fn store_url(
+    url: &str,
+    singer: &str,
+    song: &str,
+    quality: &str,
+    callback: Option<ProgressCallback>,
+    user_data: *mut std::ffi::c_void,
+) -> Result<PathBuf, String> {
+    let name = entry_name(singer, song, quality);
+    let (dir, path) = {
+        let mut slot = CACHE.lock().unwrap();
+        let c = slot.as_mut().ok_or_else(|| "缓存未启用".to_string())?;
+        if let Some(p) = c.hit(&name) {
+            return Ok(p);
+        }
+        if !c.in_flight.insert(name.clone()) {
+            return Err(format!("{} 正在缓存", name));
+        }
+        (c.dir.clone(), c.dir.join(&name))
+    };
+
+    let result = Downloader::new().download(url, &path.to_string_lossy(), callback, user_data);
+
+    let mut slot = CACHE.lock().unwrap();
+    if let Some(c) = slot.as_mut() {
+        c.in_flight.remove(&name);
+    }
+    result?;
+    let size = fs::metadata(&path).map_err(|e| e.to_string())?.len();
+    let c = match slot.as_mut() {
+        // 下载期间缓存被关闭或换了目录：文件留作普通曲库文件，不纳入管理
+        Some(c) if c.dir == dir => c,
+        _ => return Ok(path),
+    };
+    if size > c.max_bytes {
+        let _ = fs::remove_file(&path);
+        return Err(format!("{} 超过缓存上限 ({} > {} 字节)", name, size, c.max_bytes));
+    }
+    if let Some(old) = c.entries.insert(
+        name.clone(),
+        Entry {
+            size,
+            last_used: now_ms(),
+        },
+    ) {
+        c.total -= old.size;
+    }
+    c.total += size;
+    c.evict(&name);
+    c.save_index();
+    Ok(path)
+}
+
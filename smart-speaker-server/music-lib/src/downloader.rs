@@ -1,51 +1,374 @@
-//! 下载器模块 - 负责下载音乐文件并管理进度
-use reqwest::blocking::Client;
-use std::fs::{self, File};
-use std::io::{Write, Read};
-use std::path::Path;
+//! 下载器模块 - 断点续传、分段并行下载与原子落盘
+//!
+//! 下载先写入 `<目标>.part`，旁边的 `<目标>.part.state` 记录总长度、校验标识（ETag / Last-Modified）和各段进度。
+//! 中断后再次下载同一路径时用 `Range` + `If-Range` 从断点继续；资源已变化时服务端回 200，丢弃旧数据整体重下。
+//! 服务端支持 Range 且文件够大时按配置的段数并行拉取，各段用 `write_at` 写同一文件的不同偏移。
+//! 全部完成并核对长度后 fsync，再 rename 成目标文件，其他进程不会读到写了一半的文件。
+use crate::http;
+use reqwest::blocking::Response;
+use reqwest::header::{CONTENT_RANGE, ETAG, IF_RANGE, LAST_MODIFIED, RANGE};
+use reqwest::StatusCode;
+use std::fs::{self, File, OpenOptions};
+use std::io::Read;
+use std::os::unix::fs::FileExt;
+use std::path::{Path, PathBuf};
+use std::sync::mpsc;
+use std::sync::Mutex;
+use std::time::Duration;
 
 /// 进度回调函数类型定义
 pub type ProgressCallback = extern "C" fn(u64, u64, *mut std::ffi::c_void);
 
-/// 下载器结构体
-pub struct Downloader {
-    client: Client,
+/// 分段与重试配置，0 表示沿用默认值
+#[derive(Clone, Copy)]
+pub struct DownloadConfig {
+    pub segments: usize,
+    pub max_retries: u32,
 }
 
+/// 默认单连接下载，与原先行为一致；分段需显式开启
+const DEFAULT_CONFIG: DownloadConfig = DownloadConfig {
+    segments: 1,
+    max_retries: 3,
+};
+
+const MAX_SEGMENTS: usize = 8;
+
+/// 每段至少 1 MiB，更小的文件分段只会多几次握手
+const MIN_SEGMENT_BYTES: u64 = 1024 * 1024;
+
+/// 进度文件的落盘间隔
+const STATE_SAVE_BYTES: u64 = 256 * 1024;
+
+/// 一次连接至少写入这么多才算有进展、清零失败计数；防止每次只给几个字节就断开的服务端无限重试
+const PROGRESS_RESET_BYTES: u64 = 64 * 1024;
+
+/// 重试间隔按连续失败次数线性增长
+const RETRY_BACKOFF: Duration = Duration::from_millis(500);
+
+/// 共享客户端的 30s 整体超时不够下载一首无损；超时后也只是从断点重连
+const DOWNLOAD_TIMEOUT: Duration = Duration::from_secs(300);
+
+/// 总长度未知时分段的结束位置（读到 EOF 为止）
+const UNKNOWN_END: u64 = u64::MAX;
+
+static CONFIG: Mutex<DownloadConfig> = Mutex::new(DEFAULT_CONFIG);
+
+/// 修改分段数与单段连续失败的重试次数，对之后开始的下载生效
+pub fn configure(cfg: DownloadConfig) {
+    let merged = DownloadConfig {
+        segments: if cfg.segments > 0 {
+            cfg.segments.min(MAX_SEGMENTS)
+        } else {
+            DEFAULT_CONFIG.segments
+        },
+        max_retries: if cfg.max_retries > 0 {
+            cfg.max_retries
+        } else {
+            DEFAULT_CONFIG.max_retries
+        },
+    };
+    *CONFIG.lock().unwrap() = merged;
+}
+
+/// 一段字节区间 [start, end)，done 为已写入的字节数
+#[derive(Clone)]
+struct Segment {
+    start: u64,
+    end: u64,
+    done: u64,
+}
+
+impl Segment {
+    fn offset(&self) -> u64 {
+        self.start + self.done
+    }
+
+    fn remaining(&self) -> u64 {
+        if self.end == UNKNOWN_END {
+            u64::MAX
+        } else {
+            self.end - self.offset()
+        }
+    }
+
+    fn finished(&self) -> bool {
+        self.end != UNKNOWN_END && self.offset() >= self.end
+    }
+}
+
+/// `.part.state` 的内容；只有服务端支持 Range 且总长度已知时才会落盘
+struct PartState {
+    total: u64,
+    validator: String,
+    segments: Vec<Segment>,
+}
+
+impl PartState {
+    fn downloaded(&self) -> u64 {
+        self.segments.iter().map(|s| s.done).sum()
+    }
+
+    /// 文本格式：`total N` / `seg START END DONE`（每段一行）/ `validator ...`（可含空格，放最后）
+    fn save(&self, path: &Path) -> Result<(), String> {
+        let mut text = format!("total {}\n", self.total);
+        for s in &self.segments {
+            text.push_str(&format!("seg {} {} {}\n", s.start, s.end, s.done));
+        }
+        text.push_str(&format!("validator {}\n", self.validator));
+        let tmp = with_suffix(path, ".tmp");
+        fs::write(&tmp, text).map_err(|e| e.to_string())?;
+        fs::rename(&tmp, path).map_err(|e| e.to_string())
+    }
+
+    /// 读取进度；与 .part 文件对不上（长度不符、分段不连续）时视为无效
+    fn load(path: &Path, part: &Path) -> Option<Self> {
+        let text = fs::read_to_string(path).ok()?;
+        let mut st = PartState {
+            total: 0,
+            validator: String::new(),
+            segments: Vec::new(),
+        };
+        for line in text.lines() {
+            let (key, rest) = line.split_once(' ').unwrap_or((line, ""));
+            match key {
+                "total" => st.total = rest.trim().parse().ok()?,
+                "validator" => st.validator = rest.to_string(),
+                "seg" => {
+                    let v: Vec<u64> = rest
+                        .split_whitespace()
+                        .map(|x| x.parse().ok())
+                        .collect::<Option<Vec<u64>>>()?;
+                    if v.len() != 3 || v[1] < v[0] || v[2] > v[1] - v[0] {
+                        return None;
+                    }
+                    st.segments.push(Segment {
+                        start: v[0],
+                        end: v[1],
+                        done: v[2],
+                    });
+                }
+                _ => {}
+            }
+        }
+        let mut next = 0u64;
+        for s in &st.segments {
+            if s.start != next {
+                return None;
+            }
+            next = s.end;
+        }
+        if st.total == 0 || next != st.total {
+            return None;
+        }
+        let len = fs::metadata(part).ok()?.len();
+        if len != st.total {
+            return None;
+        }
+        Some(st)
+    }
+}
+
+enum FetchError {
+    /// 服务端不再按原资源回应 Range（返回 200 或范围不符），断点作废
+    Changed,
+    /// 网络错误、读到一半断开等，可从当前偏移重试
+    Retry(String),
+    /// HTTP 错误状态等，重试无意义
+    Fatal(String),
+}
+
+impl FetchError {
+    fn message(self) -> String {
+        match self {
+            FetchError::Changed => "资源已变化或服务端不支持断点续传".to_string(),
+            FetchError::Retry(e) | FetchError::Fatal(e) => e,
+        }
+    }
+}
+
+/// 工作线程上报的进度：(分段下标, 该段已写入字节数)
+type Progress = (usize, u64);
+
+fn with_suffix(path: &Path, suffix: &str) -> PathBuf {
+    let mut s = path.as_os_str().to_owned();
+    s.push(suffix);
+    PathBuf::from(s)
+}
+
+/// 解析 `Content-Range: bytes START-END/TOTAL`，TOTAL 为 `*` 时返回 None
+fn parse_content_range(v: &str) -> Option<(u64, Option<u64>)> {
+    let rest = v.trim().strip_prefix("bytes ")?;
+    let (range, total) = rest.split_once('/')?;
+    let (start, _) = range.split_once('-')?;
+    let start = start.trim().parse().ok()?;
+    Some((start, total.trim().parse().ok()))
+}
+
+/// If-Range 只接受强 ETag，弱 ETag 退回 Last-Modified
+fn validator_of(resp: &Response) -> String {
+    let header = |name| {
+        resp.headers()
+            .get(name)
+            .and_then(|v| v.to_str().ok())
+            .map(|s| s.to_string())
+    };
+    match header(ETAG) {
+        Some(etag) if !etag.starts_with("W/") => etag,
+        _ => header(LAST_MODIFIED).unwrap_or_default(),
+    }
+}
+
+fn split_segments(total: u64, wanted: usize) -> Vec<Segment> {
+    let n = (wanted as u64).min(total / MIN_SEGMENT_BYTES).max(1);
+    let step = total / n;
+    (0..n)
+        .map(|i| Segment {
+            start: i * step,
+            end: if i == n - 1 { total } else { (i + 1) * step },
+            done: 0,
+        })
+        .collect()
+}
+
+/// 请求 [start, end) 区间；必须回 206 且起点、总长度与预期一致
+fn open_range(url: &str, seg: &Segment, total: u64, validator: &str) -> Result<Response, FetchError> {
+    let range = if seg.end == UNKNOWN_END {
+        format!("bytes={}-", seg.offset())
+    } else {
+        format!("bytes={}-{}", seg.offset(), seg.end - 1)
+    };
+    let mut req = http::get(url)
+        .map_err(FetchError::Fatal)?
+        .timeout(DOWNLOAD_TIMEOUT)
+        .header(RANGE, range);
+    if !validator.is_empty() {
+        req = req.header(IF_RANGE, validator);
+    }
+    let resp = req.send().map_err(|e| FetchError::Retry(e.to_string()))?;
+    let status = resp.status();
+    if status == StatusCode::PARTIAL_CONTENT {
+        let cr = resp
+            .headers()
+            .get(CONTENT_RANGE)
+            .and_then(|v| v.to_str().ok())
+            .and_then(parse_content_range);
+        return match cr {
+            Some((start, t)) if start == seg.offset() && t.is_none_or(|t| t == total) => Ok(resp),
+            _ => Err(FetchError::Changed),
+        };
+    }
+    if status.is_success() {
+        return Err(FetchError::Changed);
+    }
+    if status.is_server_error() {
+        return Err(FetchError::Retry(format!("HTTP {}", status)));
+    }
+    Err(FetchError::Fatal(format!("HTTP {}", status)))
+}
+
+/// 下载一段；`resp` 为已打开的响应（首段复用探测请求）。
+/// `resumable` 为 false 时服务端不支持 Range，中途失败无法续传
+#[allow(clippy::too_many_arguments)]
+fn fetch_segment(
+    url: &str,
+    file: &File,
+    index: usize,
+    mut seg: Segment,
+    mut resp: Option<Response>,
+    total: u64,
+    validator: &str,
+    resumable: bool,
+    max_retries: u32,
+    tx: mpsc::Sender<Progress>,
+) -> Result<(), FetchError> {
+    let mut buf = vec![0u8; 64 * 1024];
+    let mut failures = 0u32;
+    loop {
+        let opened = match resp.take() {
+            Some(r) => Ok(r),
+            None => open_range(url, &seg, total, validator),
+        };
+        match opened.and_then(|r| read_into(r, file, index, &mut seg, &mut buf, &tx, &mut failures)) {
+            Ok(()) => return Ok(()),
+            Err(FetchError::Retry(e)) if resumable && failures < max_retries => {
+                failures += 1;
+                eprintln!("下载分段 {} 于 {} 字节处中断，第 {} 次重试: {}", index, seg.offset(), failures, e);
+                std::thread::sleep(RETRY_BACKOFF * failures);
+            }
+            Err(e) => return Err(e),
+        }
+    }
+}
+
+/// 把响应体写入本段，直到本段写满（长度未知时读到 EOF）
+fn read_into(
+    mut resp: Response,
+    file: &File,
+    index: usize,
+    seg: &mut Segment,
+    buf: &mut [u8],
+    tx: &mpsc::Sender<Progress>,
+    failures: &mut u32,
+) -> Result<(), FetchError> {
+    let begin = seg.done;
+    while !seg.finished() {
+        let want = (buf.len() as u64).min(seg.remaining()) as usize;
+        match resp.read(&mut buf[..want]) {
+            Ok(0) if seg.end == UNKNOWN_END => return Ok(()),
+            Ok(0) => return Err(FetchError::Retry("连接提前结束".to_string())),
+            Ok(n) => {
+                file.write_all_at(&buf[..n], seg.offset())
+                    .map_err(|e| FetchError::Fatal(e.to_string()))?;
+                seg.done += n as u64;
+                if seg.done - begin >= PROGRESS_RESET_BYTES {
+                    *failures = 0;
+                }
+                let _ = tx.send((index, seg.done));
+            }
+            Err(e) => return Err(FetchError::Retry(e.to_string())),
+        }
+    }
+    Ok(())
+}
+
+/// 下载器结构体（连接走进程内共享的客户端，见 http 模块）
+pub struct Downloader;
+
 impl Downloader {
     /// 创建一个新的下载器实例
-    /// 
+    ///
     /// # 返回
     /// 新的 Downloader 实例
     pub fn new() -> Self {
-        Self { client: Client::new() }
+        Self
     }
-    
+
     /// 检查响应是否是 JSON 错误
     fn is_json_error_response(data: &[u8]) -> bool {
         if data.len() < 2 {
             return false;
         }
-        
+
         let trimmed = data.trim_ascii_start();
         if trimmed.is_empty() {
             return false;
         }
-        
+
         // 检查是否以 { 或 [ 开头（JSON 特征）
         trimmed[0] == b'{' || trimmed[0] == b'['
     }
-    
-    /// 下载文件
-    /// 
+
+    /// 下载文件（断点续传；完成前目标路径不会出现）
+    ///
     /// # 参数
     /// - url: 下载链接
     /// - path: 保存路径
-    /// - callback: 进度回调函数（可选）
+    /// - callback: 进度回调函数（可选），只在调用线程里执行
     /// - user_data: 用户自定义数据指针
-    /// 
+    ///
     /// # 返回
-    /// 成功时返回 Ok(())，失败时返回错误信息
+    /// 成功时返回 Ok(())，失败时返回错误信息；失败后 .part 与进度文件保留，下次从断点继续
     pub fn download(
         &self,
         url: &str,
@@ -53,17 +376,59 @@ impl Downloader {
         callback: Option<ProgressCallback>,
         user_data: *mut std::ffi::c_void,
     ) -> Result<(), String> {
-        let path_obj = Path::new(path);
-        if let Some(parent) = path_obj.parent() {
+        let target = Path::new(path);
+        if let Some(parent) = target.parent() {
             fs::create_dir_all(parent).map_err(|e| e.to_string())?;
         }
-        
-        let mut resp = self.client.get(url).send().map_err(|e| e.to_string())?;
-        
+        let part = with_suffix(target, ".part");
+        let state_path = with_suffix(target, ".part.state");
+        let cfg = *CONFIG.lock().unwrap();
+
+        if let Some(st) = PartState::load(&state_path, &part) {
+            let file = OpenOptions::new()
+                .write(true)
+                .open(&part)
+                .map_err(|e| e.to_string())?;
+            eprintln!("断点续传 {}: 已有 {}/{} 字节", path, st.downloaded(), st.total);
+            match self.run(url, &file, st, None, Some(&state_path), true, cfg, callback, user_data) {
+                Ok(total) => return Self::finish(file, &part, &state_path, target, total),
+                Err(FetchError::Changed) => eprintln!("断点作废，重新下载 {}", path),
+                Err(e) => return Err(e.message()),
+            }
+        }
+        let _ = fs::remove_file(&state_path);
+        self.download_fresh(url, target, &part, &state_path, cfg, callback, user_data)
+    }
+
+    #[allow(clippy::too_many_arguments)]
+    fn download_fresh(
+        &self,
+        url: &str,
+        target: &Path,
+        part: &Path,
+        state_path: &Path,
+        cfg: DownloadConfig,
+        callback: Option<ProgressCallback>,
+        user_data: *mut std::ffi::c_void,
+    ) -> Result<(), String> {
+        // 带 Range 的首个请求同时用来探测是否支持分段与总长度
+        let mut resp = http::get(url)?
+            .timeout(DOWNLOAD_TIMEOUT)
+            .header(RANGE, "bytes=0-")
+            .send()
+            .map_err(|e| e.to_string())?;
+        let status = resp.status();
+        if !status.is_success() {
+            return Err(format!("下载失败: HTTP {}", status));
+        }
+
+        // 响应体读出一部分后 content_length 会随之变小，先记下
+        let content_length = resp.content_length().unwrap_or(0);
+
         // 先读取一部分数据检查是否是 JSON 错误
         let mut first_buf = [0u8; 1024];
         let first_read = resp.read(&mut first_buf).map_err(|e| e.to_string())?;
-        
+
         if first_read > 0 && Self::is_json_error_response(&first_buf[..first_read]) {
             // 尝试读取完整响应作为错误信息
             let mut error_content = Vec::from(&first_buf[..first_read]);
@@ -75,53 +440,174 @@ impl Downloader {
                     Err(_) => break,
                 }
             }
-            
+
             let error_msg = String::from_utf8_lossy(&error_content).to_string();
             return Err(format!("下载失败: {}", error_msg));
         }
-        
-        let total = resp.content_length().unwrap_or(0);
-        let mut file = File::create(path).map_err(|e| e.to_string())?;
-        
-        // 写入已经读取的第一部分
-        if first_read > 0 {
-            file.write_all(&first_buf[..first_read]).map_err(|e| e.to_string())?;
-        }
-        
-        let mut downloaded = first_read as u64;
-        let mut buf = [0u8; 8192];
-        
+
+        let ranged_total = if status == StatusCode::PARTIAL_CONTENT {
+            resp.headers()
+                .get(CONTENT_RANGE)
+                .and_then(|v| v.to_str().ok())
+                .and_then(parse_content_range)
+                .and_then(|(start, total)| if start == 0 { total } else { None })
+        } else {
+            None
+        };
+        let st = match ranged_total {
+            Some(total) if total > 0 => PartState {
+                total,
+                validator: validator_of(&resp),
+                segments: split_segments(total, cfg.segments),
+            },
+            // 不支持 Range：单连接读到底，总长度只用于进度与最终校验
+            _ => {
+                let total = content_length;
+                PartState {
+                    total,
+                    validator: String::new(),
+                    segments: vec![Segment {
+                        start: 0,
+                        end: if total > 0 { total } else { UNKNOWN_END },
+                        done: 0,
+                    }],
+                }
+            }
+        };
+
+        let file = OpenOptions::new()
+            .write(true)
+            .create(true)
+            .truncate(true)
+            .open(part)
+            .map_err(|e| e.to_string())?;
+        let resumable = ranged_total.is_some_and(|t| t > 0);
+        if resumable {
+            // 预分配后各段可按偏移乱序写入，进度文件中的长度校验也依赖这一点
+            file.set_len(st.total).map_err(|e| e.to_string())?;
+        }
+        let mut st = st;
+        let head = (first_read as u64).min(st.segments[0].remaining()) as usize;
+        file.write_all_at(&first_buf[..head], 0).map_err(|e| e.to_string())?;
+        st.segments[0].done = head as u64;
+        if resumable {
+            st.save(state_path)?;
+        }
+        let state_file = if resumable { Some(state_path) } else { None };
+        match self.run(url, &file, st, Some(resp), state_file, resumable, cfg, callback, user_data) {
+            Ok(total) => Self::finish(file, part, state_path, target, total),
+            Err(e) => {
+                if !resumable {
+                    drop(file);
+                    let _ = fs::remove_file(part);
+                }
+                Err(e.message())
+            }
+        }
+    }
+
+    /// 各段各开一个线程下载，调用线程汇总进度、回调并定期保存进度文件；返回总长度（未知时为实际写入量）
+    #[allow(clippy::too_many_arguments)]
+    fn run(
+        &self,
+        url: &str,
+        file: &File,
+        mut st: PartState,
+        first: Option<Response>,
+        state_path: Option<&Path>,
+        resumable: bool,
+        cfg: DownloadConfig,
+        callback: Option<ProgressCallback>,
+        user_data: *mut std::ffi::c_void,
+    ) -> Result<u64, FetchError> {
+        let total = st.total;
+        let validator = st.validator.clone();
+        let mut downloaded = st.downloaded();
+        let mut unsaved = 0u64;
+        let (tx, rx) = mpsc::channel::<Progress>();
         if let Some(cb) = callback {
             cb(downloaded, total, user_data);
         }
-        
-        loop {
-            match resp.read(&mut buf) {
-                Ok(0) => break,
-                Ok(n) => {
-                    file.write_all(&buf[..n]).map_err(|e| e.to_string())?;
-                    downloaded += n as u64;
-                    if let Some(cb) = callback {
-                        cb(downloaded, total, user_data);
-                    }
+
+        let results: Vec<Result<(), FetchError>> = std::thread::scope(|s| {
+            let mut first = first;
+            let handles: Vec<_> = st
+                .segments
+                .iter()
+                .enumerate()
+                .filter(|(_, seg)| !seg.finished())
+                .map(|(i, seg)| {
+                    let seg = seg.clone();
+                    // 探测请求从 0 开始，只能接着用于第一段
+                    let resp = if i == 0 { first.take() } else { None };
+                    let tx = tx.clone();
+                    let validator = validator.as_str();
+                    s.spawn(move || {
+                        fetch_segment(url, file, i, seg, resp, total, validator, resumable, cfg.max_retries, tx)
+                    })
+                })
+                .collect();
+            drop(tx);
+
+            for (i, done) in rx {
+                let seg = &mut st.segments[i];
+                downloaded += done - seg.done;
+                unsaved += done - seg.done;
+                seg.done = done;
+                if let Some(cb) = callback {
+                    cb(downloaded, total, user_data);
                 }
-                Err(e) => {
-                    if downloaded > 0 && downloaded == total {
-                        break;
+                if unsaved >= STATE_SAVE_BYTES {
+                    if let Some(p) = state_path {
+                        let _ = st.save(p);
                     }
-                    return Err(e.to_string());
+                    unsaved = 0;
                 }
             }
+            handles
+                .into_iter()
+                .map(|h| h.join().unwrap_or_else(|_| Err(FetchError::Fatal("下载线程异常".to_string()))))
+                .collect()
+        });
+
+        if let Some(p) = state_path {
+            let _ = st.save(p);
+        }
+        // 资源变化优先上报，调用方据此整体重下
+        let mut failure = None;
+        for r in results {
+            match r {
+                Ok(()) => {}
+                Err(FetchError::Changed) => return Err(FetchError::Changed),
+                Err(e) => failure = failure.or(Some(e)),
+            }
+        }
+        match failure {
+            Some(e) => Err(e),
+            None if total > 0 => Ok(total),
+            None => Ok(downloaded),
+        }
+    }
+
+    /// 核对长度、fsync 后改名为目标文件
+    fn finish(file: File, part: &Path, state_path: &Path, target: &Path, total: u64) -> Result<(), String> {
+        let len = file.metadata().map_err(|e| e.to_string())?.len();
+        if len != total {
+            return Err(format!("下载不完整: {}/{} 字节", len, total));
         }
+        file.sync_all().map_err(|e| e.to_string())?;
+        drop(file);
+        fs::rename(part, target).map_err(|e| e.to_string())?;
+        let _ = fs::remove_file(state_path);
         Ok(())
     }
 }
 
 /// 根据音质获取文件扩展名
-/// 
+///
 /// # 参数
 /// - quality: 音质
-/// 
+///
 /// # 返回
 /// 文件扩展名（如 "mp3", "flac"）
 pub fn get_extension(quality: &str) -> &'static str {
@@ -0,0 +1,90 @@
+//! 搜索执行器 - 常驻的有界线程池，聚合搜索的各源请求在此执行
+//!
+//! 原先每次 `all` 搜索新建 5 个线程并全部 join；现在任务投递到固定数量的工作线程，
+//! 调用方凑够结果即可返回，落后的请求继续在池里跑完（受 HTTP 超时约束），结果被丢弃。
+//! 调用方放弃等待后，排队中尚未开始的任务由 `Canceled` 标记跳过，不再发出请求。
+use std::collections::VecDeque;
+use std::sync::atomic::{AtomicBool, Ordering};
+use std::sync::{Arc, Condvar, Mutex, OnceLock};
+
+/// 5 个源各一次请求 + 各一次对冲，足够一次聚合搜索不排队；并发的多次搜索按先后排队
+const SEARCH_WORKERS: usize = 10;
+
+type Task = Box<dyn FnOnce() + Send>;
+
+struct Inner {
+    queue: Mutex<VecDeque<Task>>,
+    ready: Condvar,
+}
+
+static EXECUTOR: OnceLock<Arc<Inner>> = OnceLock::new();
+
+/// 一次搜索的取消标记，调用方返回时置位
+#[derive(Clone)]
+pub struct Canceled(Arc<AtomicBool>);
+
+impl Canceled {
+    pub fn new() -> Self {
+        Canceled(Arc::new(AtomicBool::new(false)))
+    }
+
+    pub fn cancel(&self) {
+        self.0.store(true, Ordering::Relaxed);
+    }
+
+    pub fn is_canceled(&self) -> bool {
+        self.0.load(Ordering::Relaxed)
+    }
+}
+
+fn executor() -> &'static Arc<Inner> {
+    EXECUTOR.get_or_init(|| {
+        let inner = Arc::new(Inner {
+            queue: Mutex::new(VecDeque::new()),
+            ready: Condvar::new(),
+        });
+        for i in 0..SEARCH_WORKERS {
+            let w = Arc::clone(&inner);
+            if let Err(e) = std::thread::Builder::new()
+                .name(format!("music-search-{}", i))
+                .spawn(move || worker_loop(&w))
+            {
+                eprintln!("搜索线程创建失败: {}", e);
+            }
+        }
+        inner
+    })
+}
+
+fn worker_loop(inner: &Inner) {
+    loop {
+        let task = {
+            let mut q = inner.queue.lock().unwrap();
+            loop {
+                if let Some(t) = q.pop_front() {
+                    break t;
+                }
+                q = inner.ready.wait(q).unwrap();
+            }
+        };
+        // 单个源解析异常不能带走工作线程
+        if std::panic::catch_unwind(std::panic::AssertUnwindSafe(task)).is_err() {
+            eprintln!("搜索任务异常");
+        }
+    }
+}
+
+/// 投递任务；`canceled` 置位后尚未开始的任务直接跳过
+pub fn spawn<F>(canceled: &Canceled, f: F)
+where
+    F: FnOnce() + Send + 'static,
+{
+    let c = canceled.clone();
+    let inner = executor();
+    inner.queue.lock().unwrap().push_back(Box::new(move || {
+        if !c.is_canceled() {
+            f();
+        }
+    }));
+    inner.ready.notify_one();
+}
@@ -0,0 +1,193 @@
+//! HTTP 模块 - 进程内共享的 reqwest 客户端与连接复用计数
+//!
+//! 搜索、取链、下载共用一个 `Client`（内部是 Arc，clone 只加引用计数），
+//! 连接池按 host 保留空闲连接，同一音源的后续请求省掉 DNS、TCP 与 TLS 握手。
+//! 新建连接一定会先做一次 DNS 解析，这里用包一层的解析器计数，`请求数 - 新建连接数` 即复用次数。
+use reqwest::blocking::{Client, RequestBuilder};
+use reqwest::dns::{Addrs, Name, Resolve, Resolving};
+use std::future::Future;
+use std::net::ToSocketAddrs;
+use std::pin::Pin;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::{Arc, Mutex, RwLock};
+use std::task::{Context, Poll, Waker};
+use std::time::Duration;
+
+/// 连接池与超时配置，0 表示沿用默认值
+#[derive(Clone, Copy)]
+pub struct HttpConfig {
+    pub pool_max_idle_per_host: usize,
+    pub pool_idle_timeout_secs: u64,
+    pub connect_timeout_secs: u64,
+    pub tcp_keepalive_secs: u64,
+}
+
+const DEFAULT_CONFIG: HttpConfig = HttpConfig {
+    pool_max_idle_per_host: 4,
+    pool_idle_timeout_secs: 90,
+    connect_timeout_secs: 10,
+    tcp_keepalive_secs: 60,
+};
+
+/// 单次请求的整体超时（搜索另行收紧到 15s）；与原先 `Client::new()` 的默认值一致
+const DEFAULT_REQUEST_TIMEOUT: Duration = Duration::from_secs(30);
+
+/// 取链接口可能 302 到 CDN，限制跳转次数
+const MAX_REDIRECTS: usize = 5;
+
+static CONFIG: Mutex<HttpConfig> = Mutex::new(DEFAULT_CONFIG);
+static SHARED: RwLock<Option<Client>> = RwLock::new(None);
+
+static REQUESTS: AtomicU64 = AtomicU64::new(0);
+static NEW_CONNECTIONS: AtomicU64 = AtomicU64::new(0);
+static CLIENT_BUILDS: AtomicU64 = AtomicU64::new(0);
+
+/// 连接复用计数快照
+pub struct HttpStats {
+    pub requests: u64,
+    pub new_connections: u64,
+    pub reused: u64,
+    pub client_builds: u64,
+}
+
+/// 修改连接池配置；已建好的客户端会被替换，进行中的请求继续用旧客户端直到结束
+pub fn configure(cfg: HttpConfig) {
+    let merged = HttpConfig {
+        pool_max_idle_per_host: if cfg.pool_max_idle_per_host > 0 {
+            cfg.pool_max_idle_per_host
+        } else {
+            DEFAULT_CONFIG.pool_max_idle_per_host
+        },
+        pool_idle_timeout_secs: if cfg.pool_idle_timeout_secs > 0 {
+            cfg.pool_idle_timeout_secs
+        } else {
+            DEFAULT_CONFIG.pool_idle_timeout_secs
+        },
+        connect_timeout_secs: if cfg.connect_timeout_secs > 0 {
+            cfg.connect_timeout_secs
+        } else {
+            DEFAULT_CONFIG.connect_timeout_secs
+        },
+        tcp_keepalive_secs: if cfg.tcp_keepalive_secs > 0 {
+            cfg.tcp_keepalive_secs
+        } else {
+            DEFAULT_CONFIG.tcp_keepalive_secs
+        },
+    };
+    *CONFIG.lock().unwrap() = merged;
+    *SHARED.write().unwrap() = None;
+}
+
+fn build_client(cfg: HttpConfig) -> Result<Client, String> {
+    let client = Client::builder()
+        .pool_max_idle_per_host(cfg.pool_max_idle_per_host)
+        .pool_idle_timeout(Duration::from_secs(cfg.pool_idle_timeout_secs))
+        .connect_timeout(Duration::from_secs(cfg.connect_timeout_secs))
+        .tcp_keepalive(Duration::from_secs(cfg.tcp_keepalive_secs))
+        .tcp_nodelay(true)
+        .timeout(DEFAULT_REQUEST_TIMEOUT)
+        .redirect(reqwest::redirect::Policy::limited(MAX_REDIRECTS))
+        .dns_resolver(Arc::new(CountingResolver))
+        .build()
+        .map_err(|e| e.to_string())?;
+    CLIENT_BUILDS.fetch_add(1, Ordering::Relaxed);
+    Ok(client)
+}
+
+/// 取共享客户端，首次调用时按当前配置构建
+pub fn client() -> Result<Client, String> {
+    if let Some(c) = SHARED.read().unwrap().as_ref() {
+        return Ok(c.clone());
+    }
+    let mut slot = SHARED.write().unwrap();
+    if let Some(c) = slot.as_ref() {
+        return Ok(c.clone());
+    }
+    let cfg = *CONFIG.lock().unwrap();
+    let c = build_client(cfg)?;
+    *slot = Some(c.clone());
+    Ok(c)
+}
+
+/// 用共享客户端发起 GET，并计入请求数；User-Agent、超时等由调用方按接口设置
+pub fn get(url: &str) -> Result<RequestBuilder, String> {
+    let c = client()?;
+    REQUESTS.fetch_add(1, Ordering::Relaxed);
+    Ok(c.get(url))
+}
+
+pub fn stats() -> HttpStats {
+    let requests = REQUESTS.load(Ordering::Relaxed);
+    let new_connections = NEW_CONNECTIONS.load(Ordering::Relaxed);
+    HttpStats {
+        requests,
+        new_connections,
+        // 跳转到新 host 时一次请求可能新建多条连接，差值不会为负
+        reused: requests.saturating_sub(new_connections),
+        client_builds: CLIENT_BUILDS.load(Ordering::Relaxed),
+    }
+}
+
+pub fn reset_stats() {
+    REQUESTS.store(0, Ordering::Relaxed);
+    NEW_CONNECTIONS.store(0, Ordering::Relaxed);
+}
+
+/// 系统 getaddrinfo 解析并计数。
+/// 阻塞客户端的所有请求共用一个内部运行时线程，解析放到独立线程里做，避免一个慢 DNS 卡住其他请求
+struct CountingResolver;
+
+struct ResolveSlot {
+    result: Option<Result<Vec<std::net::SocketAddr>, String>>,
+    waker: Option<Waker>,
+}
+
+struct ResolveFuture {
+    slot: Arc<Mutex<ResolveSlot>>,
+}
+
+impl Future for ResolveFuture {
+    type Output = Result<Addrs, Box<dyn std::error::Error + Send + Sync>>;
+
+    fn poll(self: Pin<&mut Self>, cx: &mut Context<'_>) -> Poll<Self::Output> {
+        let mut slot = self.slot.lock().unwrap();
+        match slot.result.take() {
+            Some(Ok(addrs)) => Poll::Ready(Ok(Box::new(addrs.into_iter()) as Addrs)),
+            Some(Err(e)) => Poll::Ready(Err(e.into())),
+            None => {
+                slot.waker = Some(cx.waker().clone());
+                Poll::Pending
+            }
+        }
+    }
+}
+
+impl Resolve for CountingResolver {
+    fn resolve(&self, name: Name) -> Resolving {
+        NEW_CONNECTIONS.fetch_add(1, Ordering::Relaxed);
+        let host = name.as_str().to_string();
+        let slot = Arc::new(Mutex::new(ResolveSlot {
+            result: None,
+            waker: None,
+        }));
+        let worker_slot = Arc::clone(&slot);
+        let spawned = std::thread::Builder::new()
+            .name("music-dns".to_string())
+            .spawn(move || {
+                // 端口填 0，由 reqwest 按 URL 的 scheme / 端口替换
+                let result = (host.as_str(), 0u16)
+                    .to_socket_addrs()
+                    .map(|it| it.collect::<Vec<_>>())
+                    .map_err(|e| format!("DNS 解析 {} 失败: {}", host, e));
+                let mut s = worker_slot.lock().unwrap();
+                s.result = Some(result);
+                if let Some(w) = s.waker.take() {
+                    w.wake();
+                }
+            });
+        if let Err(e) = spawned {
+            slot.lock().unwrap().result = Some(Err(format!("DNS 线程创建失败: {}", e)));
+        }
+        Box::pin(ResolveFuture { slot })
+    }
+}
@@ -0,0 +1,329 @@
+//! 异步任务模块 - 搜索 / 取链放到后台工作线程，完成后经 eventfd 通知调用方
+//!
+//! 调用方把 `notify_fd()` 注册到自己的事件循环，可读时调用 `dispatch()`，
+//! 完成回调在调用 `dispatch()` 的线程里执行，libevent 这类单线程循环无需额外加锁。
+//! 批量取链拆成逐条子任务分给各工作线程并行执行，全部完成后只回调一次。
+//! 缓存下载整首歌耗时长，每个任务单独起线程，不占用搜索 / 取链的工作线程。
+use crate::{api, cache, search};
+use std::collections::{HashMap, VecDeque};
+use std::fs::File;
+use std::io::{Read, Write};
+use std::os::fd::{AsRawFd, FromRawFd, RawFd};
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::{Arc, Condvar, Mutex, OnceLock};
+
+pub type JobId = u64;
+
+/// 未指定时的工作线程数：取链与搜索都是网络等待为主，4 个足够覆盖一页列表的并发
+const DEFAULT_WORKERS: usize = 4;
+const MAX_WORKERS: usize = 32;
+
+/// `<sys/eventfd.h>`：EFD_NONBLOCK = O_NONBLOCK，EFD_CLOEXEC = O_CLOEXEC
+const EFD_NONBLOCK: i32 = 0o4000;
+const EFD_CLOEXEC: i32 = 0o2000000;
+
+unsafe extern "C" {
+    fn eventfd(initval: u32, flags: i32) -> i32;
+}
+
+pub enum Request {
+    Search {
+        keyword: String,
+        platform: String,
+        page: u32,
+        page_size: u32,
+    },
+    Url {
+        source: String,
+        song_id: String,
+        quality: String,
+    },
+    Resolve {
+        keyword: String,
+        platform: String,
+        quality: String,
+    },
+    /// (source, song_id) 列表，音质相同
+    UrlBatch {
+        items: Vec<(String, String)>,
+        quality: String,
+    },
+    /// 下载到本地缓存
+    CacheStore {
+        url: String,
+        singer: String,
+        song: String,
+        quality: String,
+    },
+}
+
+pub enum Outcome {
+    Search(Result<search::SearchPage, String>),
+    Url(Result<String, String>),
+    Resolve(Result<(search::SongInfo, String), String>),
+    /// 与提交顺序一致
+    UrlBatch(Vec<Result<String, String>>),
+    /// 缓存文件路径
+    Cache(Result<String, String>),
+}
+
+/// 完成回调，在 `dispatch()` 的线程里执行
+pub type OnDone = Box<dyn FnOnce(JobId, Outcome) + Send>;
+
+struct BatchState {
+    id: JobId,
+    items: Vec<(String, String)>,
+    quality: String,
+    results: Mutex<Vec<Option<Result<String, String>>>>,
+    remaining: AtomicUsize,
+}
+
+enum Task {
+    Single(JobId, Request),
+    BatchItem(Arc<BatchState>, usize),
+}
+
+struct State {
+    next_id: JobId,
+    queue: VecDeque<Task>,
+    /// 尚未回调（也未取消）的任务
+    waiting: HashMap<JobId, OnDone>,
+    done: VecDeque<(JobId, Outcome)>,
+}
+
+struct Pool {
+    state: Mutex<State>,
+    work: Condvar,
+    efd: File,
+}
+
+static POOL: OnceLock<Pool> = OnceLock::new();
+
+/// 关键词 → 首条搜索结果 + 其播放链接（同步，供 `music_resolve_keyword` 与异步任务共用）
+pub fn resolve_keyword(keyword: &str, platform: &str, quality: &str) -> Result<(search::SongInfo, String), String> {
+    let page = search::search_music_paged(keyword, platform, 1, 1)?;
+    let first = page
+        .songs
+        .into_iter()
+        .next()
+        .ok_or_else(|| "没有搜索结果".to_string())?;
+    let url = api::get_music_url(&first.source, &first.id, quality)?;
+    Ok((first, url))
+}
+
+/// 启动工作线程并返回通知 fd；只有第一次调用的 workers 生效（0 为默认值）
+pub fn init(workers: usize) -> Result<RawFd, String> {
+    if let Some(p) = POOL.get() {
+        return Ok(p.efd.as_raw_fd());
+    }
+    let fd = unsafe { eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC) };
+    if fd < 0 {
+        return Err(format!("eventfd 创建失败: {}", std::io::Error::last_os_error()));
+    }
+    let pool = Pool {
+        state: Mutex::new(State {
+            next_id: 1,
+            queue: VecDeque::new(),
+            waiting: HashMap::new(),
+            done: VecDeque::new(),
+        }),
+        work: Condvar::new(),
+        efd: unsafe { File::from_raw_fd(fd) },
+    };
+    // 并发初始化时落选的一方丢弃自己的 Pool（连同 eventfd），用胜出者的
+    if POOL.set(pool).is_err() {
+        return Ok(POOL.get().unwrap().efd.as_raw_fd());
+    }
+    let pool = POOL.get().unwrap();
+    let n = if workers == 0 { DEFAULT_WORKERS } else { workers.min(MAX_WORKERS) };
+    for i in 0..n {
+        let spawned = std::thread::Builder::new()
+            .name(format!("music-job-{}", i))
+            .spawn(move || worker_loop(pool));
+        if let Err(e) = spawned {
+            if i == 0 {
+                return Err(format!("工作线程创建失败: {}", e));
+            }
+            eprintln!("music 异步任务: 仅启动 {} 个工作线程: {}", i, e);
+            break;
+        }
+    }
+    Ok(pool.efd.as_raw_fd())
+}
+
+fn pool() -> Result<&'static Pool, String> {
+    init(0)?;
+    Ok(POOL.get().unwrap())
+}
+
+/// 提交任务，返回非 0 的任务号
+pub fn submit(req: Request, on_done: OnDone) -> Result<JobId, String> {
+    let p = pool()?;
+    let mut st = p.state.lock().unwrap();
+    let id = st.next_id;
+    st.next_id += 1;
+    st.waiting.insert(id, on_done);
+    match req {
+        Request::UrlBatch { items, quality } if !items.is_empty() => {
+            let n = items.len();
+            let batch = Arc::new(BatchState {
+                id,
+                items,
+                quality,
+                results: Mutex::new((0..n).map(|_| None).collect()),
+                remaining: AtomicUsize::new(n),
+            });
+            for i in 0..n {
+                st.queue.push_back(Task::BatchItem(Arc::clone(&batch), i));
+            }
+            drop(st);
+            p.work.notify_all();
+        }
+        Request::UrlBatch { .. } => {
+            // 空批量不经过工作线程，下一次 dispatch 直接回调
+            st.done.push_back((id, Outcome::UrlBatch(Vec::new())));
+            drop(st);
+            p.notify();
+        }
+        req @ Request::CacheStore { .. } => {
+            drop(st);
+            let spawned = std::thread::Builder::new()
+                .name("music-cache".to_string())
+                .spawn(move || p.complete(id, run(req)));
+            if let Err(e) = spawned {
+                p.complete(id, Outcome::Cache(Err(format!("缓存线程创建失败: {}", e))));
+            }
+        }
+        req => {
+            st.queue.push_back(Task::Single(id, req));
+            drop(st);
+            p.work.notify_one();
+        }
+    }
+    Ok(id)
+}
+
+/// 取消任务：返回 true 表示取消成功，之后不会再回调；已完成回调或不存在返回 false。
+/// 已在执行的 HTTP 请求不会被打断，只是结果被丢弃
+pub fn cancel(id: JobId) -> bool {
+    let p = match POOL.get() {
+        Some(p) => p,
+        None => return false,
+    };
+    let mut st = p.state.lock().unwrap();
+    st.queue.retain(|t| match t {
+        Task::Single(tid, _) => *tid != id,
+        Task::BatchItem(..) => true,
+    });
+    st.waiting.remove(&id).is_some()
+}
+
+/// 清掉通知计数并回调所有已完成的任务，返回回调次数
+pub fn dispatch() -> usize {
+    let p = match POOL.get() {
+        Some(p) => p,
+        None => return 0,
+    };
+    let mut buf = [0u8; 8];
+    // 非阻塞：计数为 0 时返回 WouldBlock，忽略即可
+    let _ = (&p.efd).read(&mut buf);
+
+    let ready: Vec<(JobId, Outcome, OnDone)> = {
+        let mut st = p.state.lock().unwrap();
+        let done: Vec<(JobId, Outcome)> = st.done.drain(..).collect();
+        done.into_iter()
+            .filter_map(|(id, out)| st.waiting.remove(&id).map(|cb| (id, out, cb)))
+            .collect()
+    };
+    // 回调里可能再提交新任务，必须在锁外执行
+    let n = ready.len();
+    for (id, out, cb) in ready {
+        cb(id, out);
+    }
+    n
+}
+
+impl Pool {
+    fn notify(&self) {
+        let _ = (&self.efd).write(&1u64.to_ne_bytes());
+    }
+
+    fn is_waiting(&self, id: JobId) -> bool {
+        self.state.lock().unwrap().waiting.contains_key(&id)
+    }
+
+    fn complete(&self, id: JobId, out: Outcome) {
+        self.state.lock().unwrap().done.push_back((id, out));
+        self.notify();
+    }
+}
+
+fn run(req: Request) -> Outcome {
+    match req {
+        Request::Search {
+            keyword,
+            platform,
+            page,
+            page_size,
+        } => Outcome::Search(search::search_music_paged(&keyword, &platform, page, page_size)),
+        Request::Url {
+            source,
+            song_id,
+            quality,
+        } => Outcome::Url(api::get_music_url(&source, &song_id, &quality)),
+        Request::Resolve {
+            keyword,
+            platform,
+            quality,
+        } => Outcome::Resolve(resolve_keyword(&keyword, &platform, &quality)),
+        Request::UrlBatch { .. } => Outcome::UrlBatch(Vec::new()),
+        Request::CacheStore {
+            url,
+            singer,
+            song,
+            quality,
+        } => Outcome::Cache(
+            cache::store_url(&url, &singer, &song, &quality, None, std::ptr::null_mut())
+                .map(|p| p.to_string_lossy().into_owned()),
+        ),
+    }
+}
+
+fn run_batch_item(pool: &Pool, batch: &BatchState, index: usize) {
+    // 整批已取消时跳过剩余的网络请求
+    let result = if pool.is_waiting(batch.id) {
+        let (source, song_id) = &batch.items[index];
+        api::get_music_url(source, song_id, &batch.quality)
+    } else {
+        Err("已取消".to_string())
+    };
+    batch.results.lock().unwrap()[index] = Some(result);
+    if batch.remaining.fetch_sub(1, Ordering::AcqRel) == 1 {
+        let results = std::mem::take(&mut *batch.results.lock().unwrap())
+            .into_iter()
+            .map(|r| r.unwrap_or_else(|| Err("未执行".to_string())))
+            .collect();
+        pool.complete(batch.id, Outcome::UrlBatch(results));
+    }
+}
+
+fn worker_loop(pool: &'static Pool) {
+    loop {
+        let task = {
+            let mut st = pool.state.lock().unwrap();
+            loop {
+                if let Some(t) = st.queue.pop_front() {
+                    break t;
+                }
+                st = pool.work.wait(st).unwrap();
+            }
+        };
+        match task {
+            Task::Single(id, req) => {
+                let out = run(req);
+                pool.complete(id, out);
+            }
+            Task::BatchItem(batch, index) => run_batch_item(pool, &batch, index),
+        }
+    }
+}
@@ -1,7 +1,12 @@
 //! 音乐下载器库 - 提供 C 语言 API 接口
 mod api;
+mod cache;
 mod downloader;
+mod executor;
+mod http;
+mod jobs;
 mod search;
+mod similar;
 
 use std::ffi::{CStr, CString, c_char, c_void};
 use std::path::Path;
@@ -171,6 +176,35 @@ pub extern "C" fn music_download_with_path(
     }
 }
 
+/// 直接按链接下载（断点续传；分段数见 `music_download_configure`）
+/// 
+/// # 参数
+/// - url: 下载链接
+/// - output_path: 完整输出路径；下载中写 `<output_path>.part`，完成后改名
+/// - callback: 进度回调函数（可选）
+/// - user_data: 用户自定义数据指针
+/// 
+/// # 返回
+/// 操作结果（Result::Ok 表示成功）；失败时保留 .part，再次调用从断点继续
+#[unsafe(no_mangle)]
+pub extern "C" fn music_download_url(
+    url: *const c_char,
+    output_path: *const c_char,
+    callback: Option<CProgressCallback>,
+    user_data: *mut c_void,
+) -> Result {
+    let (Some(url), Some(output_path)) = (c_arg(url), c_arg(output_path)) else {
+        return Result::InvalidParam;
+    };
+    match downloader::Downloader::new().download(&url, &output_path, callback, user_data) {
+        Ok(_) => Result::Ok,
+        Err(e) => {
+            eprintln!("下载错误: {}", e);
+            Result::DownloadError
+        }
+    }
+}
+
 /// 根据音质获取文件扩展名
 /// 
 /// # 参数
@@ -218,6 +252,158 @@ pub extern "C" fn music_configure_online(
     );
 }
 
+/// 设置共享 HTTP 客户端的连接池参数（各项为 0 时用默认值）
+///
+/// # 参数
+/// - pool_max_idle_per_host: 每个 host 保留的空闲连接数（默认 4）
+/// - pool_idle_timeout_secs: 空闲连接保留秒数（默认 90）
+/// - connect_timeout_secs: 建连超时秒数（默认 10）
+/// - tcp_keepalive_secs: TCP keepalive 间隔秒数（默认 60）
+///
+/// 应在首次搜索/取链前调用；之后调用会重建客户端，原有空闲连接随旧客户端释放
+#[unsafe(no_mangle)]
+pub extern "C" fn music_http_configure(
+    pool_max_idle_per_host: u32,
+    pool_idle_timeout_secs: u32,
+    connect_timeout_secs: u32,
+    tcp_keepalive_secs: u32,
+) {
+    http::configure(http::HttpConfig {
+        pool_max_idle_per_host: pool_max_idle_per_host as usize,
+        pool_idle_timeout_secs: pool_idle_timeout_secs as u64,
+        connect_timeout_secs: connect_timeout_secs as u64,
+        tcp_keepalive_secs: tcp_keepalive_secs as u64,
+    });
+}
+
+/// 设置聚合 / 顺序搜索的调度参数（前三项为 0 时用默认值）
+///
+/// # 参数
+/// - quorum: `all` 有结果的源达到此数即收尾（默认 3，最大 5 即等全部源）
+/// - hedge_after_ms: `all` 某源超过此时长未返回则对冲补发一次（默认 2500；≥15000 等于关闭）
+/// - quorum_grace_ms: `all` 凑够 quorum 后再等其余源的毫秒数（默认 500）
+/// - priority_race: `auto` 非 0 时各源同时发出、取最先返回的非空结果；0 为按序逐个尝试
+#[unsafe(no_mangle)]
+pub extern "C" fn music_search_configure(
+    quorum: u32,
+    hedge_after_ms: u32,
+    quorum_grace_ms: u32,
+    priority_race: i32,
+) {
+    search::configure_tuning(search::SearchTuning {
+        quorum: quorum as usize,
+        hedge_after: std::time::Duration::from_millis(hedge_after_ms as u64),
+        quorum_grace: std::time::Duration::from_millis(quorum_grace_ms as u64),
+        priority_race: priority_race != 0,
+    });
+}
+
+/// 设置下载分段与重试（各项为 0 时用默认值）
+///
+/// # 参数
+/// - segments: 服务端支持 Range 时的并行分段数（默认 1，最大 8；每段至少 1 MiB）
+/// - max_retries: 单段连续失败的重试次数，每次从断点继续（默认 3）
+#[unsafe(no_mangle)]
+pub extern "C" fn music_download_configure(segments: u32, max_retries: u32) {
+    downloader::configure(downloader::DownloadConfig {
+        segments: segments as usize,
+        max_retries,
+    });
+}
+
+/// 启用在线歌曲的本地缓存，按 `<dir>/<歌手>/<歌名>.<扩展名>` 存放，总大小超过 max_bytes 时淘汰最久未播放的
+///
+/// # 参数
+/// - dir: 缓存目录；设为本地曲库目录时离线模式可直接搜到缓存的歌
+/// - max_bytes: 容量上限，0 或 dir 为 NULL 时关闭缓存
+///
+/// # 返回
+/// 目录无法创建时返回 Result::InvalidParam
+#[unsafe(no_mangle)]
+pub extern "C" fn music_cache_configure(dir: *const c_char, max_bytes: u64) -> Result {
+    let dir = c_arg(dir).unwrap_or_default();
+    match cache::configure(&dir, max_bytes) {
+        Ok(()) => Result::Ok,
+        Err(e) => {
+            eprintln!("music_cache_configure: {}", e);
+            Result::InvalidParam
+        }
+    }
+}
+
+/// 查缓存；命中返回文件路径（需要调用 music_free_string 释放），未命中或未启用返回 NULL
+#[unsafe(no_mangle)]
+pub extern "C" fn music_cache_lookup(
+    singer: *const c_char,
+    song: *const c_char,
+    quality: *const c_char,
+) -> *mut c_char {
+    let (Some(singer), Some(song), Some(quality)) = (c_arg(singer), c_arg(song), c_arg(quality)) else {
+        return std::ptr::null_mut();
+    };
+    match cache::lookup(&singer, &song, &quality) {
+        Some(p) => str_to_c_raw(&p.to_string_lossy()),
+        None => std::ptr::null_mut(),
+    }
+}
+
+/// 把链接下载进缓存（同步）；已缓存时直接返回
+///
+/// # 返回
+/// 缓存文件路径（需要调用 music_free_string 释放），失败返回 NULL
+#[unsafe(no_mangle)]
+pub extern "C" fn music_cache_store(
+    url: *const c_char,
+    singer: *const c_char,
+    song: *const c_char,
+    quality: *const c_char,
+    callback: Option<CProgressCallback>,
+    user_data: *mut c_void,
+) -> *mut c_char {
+    let (Some(url), Some(singer), Some(song), Some(quality)) =
+        (c_arg(url), c_arg(singer), c_arg(song), c_arg(quality))
+    else {
+        return std::ptr::null_mut();
+    };
+    match cache::store_url(&url, &singer, &song, &quality, callback, user_data) {
+        Ok(p) => str_to_c_raw(&p.to_string_lossy()),
+        Err(e) => {
+            eprintln!("缓存失败: {}", e);
+            std::ptr::null_mut()
+        }
+    }
+}
+
+/// C 语言 HTTP 连接复用计数
+#[repr(C)]
+pub struct CMusicHttpStats {
+    requests: u64,
+    new_connections: u64,
+    reused: u64,
+    client_builds: u64,
+}
+
+/// 读取连接复用计数（自进程启动或上次 `music_http_stats_reset` 起）
+#[unsafe(no_mangle)]
+pub extern "C" fn music_http_stats(out: *mut CMusicHttpStats) -> Result {
+    if out.is_null() {
+        return Result::InvalidParam;
+    }
+    let st = http::stats();
+    unsafe {
+        (*out).requests = st.requests;
+        (*out).new_connections = st.new_connections;
+        (*out).reused = st.reused;
+        (*out).client_builds = st.client_builds;
+    }
+    Result::Ok
+}
+
+#[unsafe(no_mangle)]
+pub extern "C" fn music_http_stats_reset() {
+    http::reset_stats();
+}
+
 /// 是否已在 `data/config/music.toml` 中配置 `music_api_key`
 #[unsafe(no_mangle)]
 pub extern "C" fn music_api_configured() -> i32 {
@@ -278,25 +464,19 @@ pub extern "C" fn music_resolve_keyword(
         Ok(s) => s,
         Err(_) => return Result::InvalidParam,
     };
-    let page = match search::search_music_paged(keyword, platform, 1, 1) {
-        Ok(p) => p,
-        Err(e) => {
-            eprintln!("music_resolve_keyword 搜索: {}", e);
-            return Result::ApiError;
-        }
-    };
-    let first = match page.songs.into_iter().next() {
-        Some(s) => s,
-        None => return Result::ApiError,
-    };
-    let url = match api::get_music_url(&first.source, &first.id, quality) {
-        Ok(u) => u,
+    let (first, url) = match jobs::resolve_keyword(keyword, platform, quality) {
+        Ok(r) => r,
         Err(e) => {
-            eprintln!("music_resolve_keyword 取链: {}", e);
+            eprintln!("music_resolve_keyword: {}", e);
             return Result::ApiError;
         }
     };
-    let pu = str_to_c_raw(&url);
+    unsafe { fill_resolve_result(&first, &url, &mut *out) }
+}
+
+/// 把首条歌曲与播放链接写入 `out`（各字段需 `music_free_resolve_result` 释放）
+fn fill_resolve_result(first: &search::SongInfo, url: &str, out: &mut CMusicResolveResult) -> Result {
+    let pu = str_to_c_raw(url);
     let src = str_to_c_raw(&first.source);
     let sid = str_to_c_raw(&first.id);
     let art = str_to_c_raw(&first.artist);
@@ -319,13 +499,11 @@ pub extern "C" fn music_resolve_keyword(
         }
         return Result::ApiError;
     }
-    unsafe {
-        (*out).play_url = pu;
-        (*out).source = src;
-        (*out).song_id = sid;
-        (*out).singer = art;
-        (*out).song = name;
-    }
+    out.play_url = pu;
+    out.source = src;
+    out.song_id = sid;
+    out.singer = art;
+    out.song = name;
     Result::Ok
 }
 
@@ -422,6 +600,11 @@ pub extern "C" fn music_search_page(
             return Result::ApiError;
         }
     };
+    unsafe { fill_search_result(search_ret, &mut *result) }
+}
+
+/// 把一页搜索结果转成 C 结构（需 `music_free_search_result` 释放）
+fn fill_search_result(search_ret: search::SearchPage, result: &mut CMusicSearchResult) -> Result {
     let songs = search_ret.songs;
     let total = search_ret.total as u32;
     let ret_page = search_ret.page;
@@ -436,14 +619,12 @@ pub extern "C" fn music_search_page(
 
     let count = songs.len();
     if count == 0 {
-        unsafe {
-            (*result).results = std::ptr::null_mut();
-            (*result).count = 0;
-            (*result).page = ret_page;
-            (*result).page_size = ret_page_size;
-            (*result).total = total;
-            (*result).total_pages = total_pages;
-        }
+        result.results = std::ptr::null_mut();
+        result.count = 0;
+        result.page = ret_page;
+        result.page_size = ret_page_size;
+        result.total = total;
+        result.total_pages = total_pages;
         return Result::Ok;
     }
     
@@ -512,15 +693,13 @@ pub extern "C" fn music_search_page(
         }
     }
     
-    unsafe {
-        (*result).results = results_ptr;
-        (*result).count = count;
-        (*result).page = ret_page;
-        (*result).page_size = ret_page_size;
-        (*result).total = total;
-        (*result).total_pages = total_pages;
-    }
-    
+    result.results = results_ptr;
+    result.count = count;
+    result.page = ret_page;
+    result.page_size = ret_page_size;
+    result.total = total;
+    result.total_pages = total_pages;
+
     Result::Ok
 }
 
@@ -562,3 +741,316 @@ pub extern "C" fn music_free_search_result(result: *mut CMusicSearchResult) {
         (*result).total_pages = 0;
     }
 }
+
+/// 异步任务类型
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub enum CMusicJobKind {
+    Search = 1,
+    Url = 2,
+    Resolve = 3,
+    UrlBatch = 4,
+    Cache = 5,
+}
+
+/// 异步任务完成信息；按 kind 只有对应字段有效，全部内容仅在回调内有效，回调返回后由库释放
+#[repr(C)]
+pub struct CMusicCompletion {
+    job: u64,
+    kind: CMusicJobKind,
+    /// 单条任务的结果；批量任务恒为 Ok，逐条成败见 urls
+    status: Result,
+    search: CMusicSearchResult,
+    resolve: CMusicResolveResult,
+    url: *mut c_char,
+    /// 批量取链：与提交顺序一致，失败项为 NULL
+    urls: *mut *mut c_char,
+    url_count: usize,
+    /// 缓存任务：本地文件路径
+    path: *mut c_char,
+}
+
+/// 批量取链的一项
+#[repr(C)]
+pub struct CMusicUrlRequest {
+    source: *const c_char,
+    song_id: *const c_char,
+}
+
+/// 完成回调，在调用 `music_async_dispatch` 的线程里执行
+pub type CCompletionCallback = extern "C" fn(*const CMusicCompletion, *mut c_void);
+
+/// 调用方的 user_data 原样带回回调线程；库内只保存不解引用
+struct UserData(*mut c_void);
+unsafe impl Send for UserData {}
+
+impl UserData {
+    fn ptr(&self) -> *mut c_void {
+        self.0
+    }
+}
+
+fn c_arg(p: *const c_char) -> Option<String> {
+    if p.is_null() {
+        return None;
+    }
+    unsafe { CStr::from_ptr(p).to_str().ok().map(|s| s.to_string()) }
+}
+
+fn deliver(id: jobs::JobId, out: jobs::Outcome, cb: CCompletionCallback, user_data: *mut c_void) {
+    let kind = match &out {
+        jobs::Outcome::Search(_) => CMusicJobKind::Search,
+        jobs::Outcome::Url(_) => CMusicJobKind::Url,
+        jobs::Outcome::Resolve(_) => CMusicJobKind::Resolve,
+        jobs::Outcome::UrlBatch(_) => CMusicJobKind::UrlBatch,
+        jobs::Outcome::Cache(_) => CMusicJobKind::Cache,
+    };
+    let mut c = CMusicCompletion {
+        job: id,
+        kind,
+        status: Result::Ok,
+        search: CMusicSearchResult {
+            results: std::ptr::null_mut(),
+            count: 0,
+            page: 0,
+            page_size: 0,
+            total: 0,
+            total_pages: 0,
+        },
+        resolve: CMusicResolveResult {
+            play_url: std::ptr::null_mut(),
+            source: std::ptr::null_mut(),
+            song_id: std::ptr::null_mut(),
+            singer: std::ptr::null_mut(),
+            song: std::ptr::null_mut(),
+        },
+        url: std::ptr::null_mut(),
+        urls: std::ptr::null_mut(),
+        url_count: 0,
+        path: std::ptr::null_mut(),
+    };
+    let mut urls: Vec<*mut c_char> = Vec::new();
+    match out {
+        jobs::Outcome::Search(Ok(page)) => c.status = fill_search_result(page, &mut c.search),
+        jobs::Outcome::Url(Ok(u)) => {
+            c.url = str_to_c_raw(&u);
+            if c.url.is_null() {
+                c.status = Result::ApiError;
+            }
+        }
+        jobs::Outcome::Resolve(Ok((first, u))) => c.status = fill_resolve_result(&first, &u, &mut c.resolve),
+        jobs::Outcome::UrlBatch(list) => {
+            let failed = list.iter().filter(|r| r.is_err()).count();
+            if failed > 0 {
+                eprintln!("批量取链: {}/{} 条失败", failed, list.len());
+            }
+            urls = list
+                .iter()
+                .map(|r| match r {
+                    Ok(u) => str_to_c_raw(u),
+                    Err(_) => std::ptr::null_mut(),
+                })
+                .collect();
+            if !urls.is_empty() {
+                c.urls = urls.as_mut_ptr();
+                c.url_count = urls.len();
+            }
+        }
+        jobs::Outcome::Cache(Ok(p)) => {
+            c.path = str_to_c_raw(&p);
+            if c.path.is_null() {
+                c.status = Result::DownloadError;
+            }
+        }
+        jobs::Outcome::Search(Err(e)) | jobs::Outcome::Url(Err(e)) | jobs::Outcome::Resolve(Err(e)) => {
+            eprintln!("异步任务 {} 失败: {}", id, e);
+            c.status = Result::ApiError;
+        }
+        jobs::Outcome::Cache(Err(e)) => {
+            eprintln!("异步任务 {} 失败: {}", id, e);
+            c.status = Result::DownloadError;
+        }
+    }
+    cb(&c, user_data);
+    music_free_search_result(&mut c.search);
+    music_free_resolve_result(&mut c.resolve);
+    music_free_string(c.url);
+    music_free_string(c.path);
+    for u in urls {
+        music_free_string(u);
+    }
+}
+
+fn submit_job(req: jobs::Request, cb: CCompletionCallback, user_data: *mut c_void) -> u64 {
+    let ud = UserData(user_data);
+    match jobs::submit(req, Box::new(move |id, out| deliver(id, out, cb, ud.ptr()))) {
+        Ok(id) => id,
+        Err(e) => {
+            eprintln!("提交异步任务失败: {}", e);
+            0
+        }
+    }
+}
+
+/// 启动异步任务的工作线程，返回完成通知用的 eventfd（非阻塞）
+///
+/// # 参数
+/// - workers: 工作线程数，0 为默认 4；只有首次调用生效
+///
+/// # 返回
+/// fd 可读时调用 `music_async_dispatch`；失败返回 -1。重复调用返回同一个 fd，调用方不要关闭它
+#[unsafe(no_mangle)]
+pub extern "C" fn music_async_init(workers: u32) -> i32 {
+    match jobs::init(workers as usize) {
+        Ok(fd) => fd,
+        Err(e) => {
+            eprintln!("music_async_init: {}", e);
+            -1
+        }
+    }
+}
+
+/// 在当前线程回调所有已完成的任务，返回回调次数
+#[unsafe(no_mangle)]
+pub extern "C" fn music_async_dispatch() -> usize {
+    jobs::dispatch()
+}
+
+/// 取消任务；返回 1 表示之后不会再回调（调用方可释放 user_data），0 表示已回调过或任务不存在
+#[unsafe(no_mangle)]
+pub extern "C" fn music_job_cancel(job: u64) -> i32 {
+    if jobs::cancel(job) { 1 } else { 0 }
+}
+
+/// 异步 `music_search_page`；返回任务号，参数非法或提交失败返回 0（不会回调）
+#[unsafe(no_mangle)]
+pub extern "C" fn music_search_page_async(
+    keyword: *const c_char,
+    platform: *const c_char,
+    page: u32,
+    page_size: u32,
+    callback: Option<CCompletionCallback>,
+    user_data: *mut c_void,
+) -> u64 {
+    let (Some(keyword), Some(platform), Some(cb)) = (c_arg(keyword), c_arg(platform), callback) else {
+        return 0;
+    };
+    submit_job(
+        jobs::Request::Search {
+            keyword,
+            platform,
+            page,
+            page_size,
+        },
+        cb,
+        user_data,
+    )
+}
+
+/// 异步 `music_get_url`，结果在 completion 的 url 字段
+#[unsafe(no_mangle)]
+pub extern "C" fn music_get_url_async(
+    source: *const c_char,
+    song_id: *const c_char,
+    quality: *const c_char,
+    callback: Option<CCompletionCallback>,
+    user_data: *mut c_void,
+) -> u64 {
+    let (Some(source), Some(song_id), Some(quality), Some(cb)) =
+        (c_arg(source), c_arg(song_id), c_arg(quality), callback)
+    else {
+        return 0;
+    };
+    submit_job(
+        jobs::Request::Url {
+            source,
+            song_id,
+            quality,
+        },
+        cb,
+        user_data,
+    )
+}
+
+/// 异步 `music_resolve_keyword`，结果在 completion 的 resolve 字段
+#[unsafe(no_mangle)]
+pub extern "C" fn music_resolve_keyword_async(
+    keyword: *const c_char,
+    platform: *const c_char,
+    quality: *const c_char,
+    callback: Option<CCompletionCallback>,
+    user_data: *mut c_void,
+) -> u64 {
+    let (Some(keyword), Some(platform), Some(quality), Some(cb)) =
+        (c_arg(keyword), c_arg(platform), c_arg(quality), callback)
+    else {
+        return 0;
+    };
+    submit_job(
+        jobs::Request::Resolve {
+            keyword,
+            platform,
+            quality,
+        },
+        cb,
+        user_data,
+    )
+}
+
+/// 批量取链：各项分给工作线程并行执行，全部完成后回调一次
+///
+/// # 参数
+/// - items / count: (source, song_id) 数组，提交时即拷贝，返回后调用方可释放
+/// - quality: 各项共用的音质
+#[unsafe(no_mangle)]
+pub extern "C" fn music_get_url_batch_async(
+    items: *const CMusicUrlRequest,
+    count: usize,
+    quality: *const c_char,
+    callback: Option<CCompletionCallback>,
+    user_data: *mut c_void,
+) -> u64 {
+    let (Some(quality), Some(cb)) = (c_arg(quality), callback) else {
+        return 0;
+    };
+    if items.is_null() && count > 0 {
+        return 0;
+    }
+    let mut list = Vec::with_capacity(count);
+    for i in 0..count {
+        let it = unsafe { &*items.add(i) };
+        match (c_arg(it.source), c_arg(it.song_id)) {
+            (Some(source), Some(song_id)) => list.push((source, song_id)),
+            _ => return 0,
+        }
+    }
+    submit_job(jobs::Request::UrlBatch { items: list, quality }, cb, user_data)
+}
+
+/// 异步 `music_cache_store`，完成后 completion 的 path 字段为缓存文件路径。
+/// 整首下载在独立线程进行，不占用搜索 / 取链的工作线程；同一首歌正在缓存时以失败回调
+#[unsafe(no_mangle)]
+pub extern "C" fn music_cache_store_async(
+    url: *const c_char,
+    singer: *const c_char,
+    song: *const c_char,
+    quality: *const c_char,
+    callback: Option<CCompletionCallback>,
+    user_data: *mut c_void,
+) -> u64 {
+    let (Some(url), Some(singer), Some(song), Some(quality), Some(cb)) =
+        (c_arg(url), c_arg(singer), c_arg(song), c_arg(quality), callback)
+    else {
+        return 0;
+    };
+    submit_job(
+        jobs::Request::CacheStore {
+            url,
+            singer,
+            song,
+            quality,
+        },
+        cb,
+        user_data,
+    )
+}
@@ -1,9 +1,17 @@
 //! 搜索模块 - 负责从各音乐平台搜索歌曲
-use reqwest::blocking::Client;
+use crate::executor::{self, Canceled};
+use crate::http;
+use crate::similar::Similar;
+use reqwest::blocking::RequestBuilder;
+use reqwest::header::USER_AGENT;
 use serde::Deserialize;
 use serde_json::Value;
 use std::cmp::Ordering;
 use std::collections::HashSet;
+use std::collections::hash_map::DefaultHasher;
+use std::hash::{Hash, Hasher};
+use std::sync::Mutex;
+use std::sync::mpsc::{self, RecvTimeoutError};
 use std::time::{Duration, Instant};
 use std::vec::Vec;
 
@@ -18,12 +26,63 @@ const PRIORITY_SEARCH_TOTAL: Duration = Duration::from_secs(75);
 /// lx `store/search/music/state.ts`：`listInfos.all.limit`
 const LX_AGG_SOURCE_LIMIT: u32 = 30;
 
-fn http_client() -> Result<Client, String> {
-    Client::builder()
-        .user_agent(HTTP_USER_AGENT)
-        .timeout(HTTP_SEARCH_TIMEOUT)
-        .build()
-        .map_err(|e| e.to_string())
+/// lx `musicSdk/index` 源顺序：`auto` 按此逐个尝试，`all` 按此拼接后再排序
+const SOURCE_ORDER: [&str; 5] = ["kw", "kg", "tx", "wy", "mg"];
+
+/// 聚合 / 顺序搜索的调度参数
+#[derive(Clone, Copy)]
+pub struct SearchTuning {
+    /// `all`：有结果的源达到此数即开始收尾，不再等最慢的源
+    pub quorum: usize,
+    /// `all`：某源超过此时长仍未返回，再发一次同样的请求（对冲），取先到者
+    pub hedge_after: Duration,
+    /// `all`：凑够 quorum 后再给其余源的宽限
+    pub quorum_grace: Duration,
+    /// `auto`：各源同时发出，取最先返回的非空结果，不再逐个顺序尝试
+    pub priority_race: bool,
+}
+
+const DEFAULT_TUNING: SearchTuning = SearchTuning {
+    quorum: 3,
+    hedge_after: Duration::from_millis(2500),
+    quorum_grace: Duration::from_millis(500),
+    priority_race: false,
+};
+
+static TUNING: Mutex<SearchTuning> = Mutex::new(DEFAULT_TUNING);
+
+/// 设置搜索调度参数；quorum / hedge_after / quorum_grace 为 0 时沿用默认值
+pub fn configure_tuning(t: SearchTuning) {
+    let mut g = TUNING.lock().unwrap();
+    *g = SearchTuning {
+        quorum: if t.quorum > 0 {
+            t.quorum.min(SOURCE_ORDER.len())
+        } else {
+            DEFAULT_TUNING.quorum
+        },
+        hedge_after: if t.hedge_after.is_zero() {
+            DEFAULT_TUNING.hedge_after
+        } else {
+            t.hedge_after
+        },
+        quorum_grace: if t.quorum_grace.is_zero() {
+            DEFAULT_TUNING.quorum_grace
+        } else {
+            t.quorum_grace
+        },
+        priority_race: t.priority_race,
+    };
+}
+
+fn tuning() -> SearchTuning {
+    *TUNING.lock().unwrap()
+}
+
+/// 搜索请求：共享客户端 + 桌面浏览器 UA + 15s 超时
+fn search_get(url: &str) -> Result<RequestBuilder, String> {
+    Ok(http::get(url)?
+        .header(USER_AGENT, HTTP_USER_AGENT)
+        .timeout(HTTP_SEARCH_TIMEOUT))
 }
 
 /// 支持的搜索平台
@@ -138,7 +197,7 @@ pub fn search_qq_music_paged(keyword: &str, page: u32, page_size: u32) -> Result
         w, page, page_size
     );
 
-    let resp = http_client()?.get(&url).send().map_err(|e| e.to_string())?;
+    let resp = search_get(&url)?.send().map_err(|e| e.to_string())?;
     if !resp.status().is_success() {
         return Err(format!("QQ 音乐搜索 HTTP {}", resp.status()));
     }
@@ -191,8 +250,7 @@ pub fn search_netease_music_paged(keyword: &str, page: u32, page_size: u32) -> R
         s, page_size, offset
     );
 
-    let resp = http_client()?
-        .get(&url)
+    let resp = search_get(&url)?
         .header("Referer", "https://music.163.com/")
         .send()
         .map_err(|e| e.to_string())?;
@@ -233,16 +291,6 @@ pub fn search_netease_music_paged(keyword: &str, page: u32, page_size: u32) -> R
     })
 }
 
-fn empty_search_page(page: u32, page_size: u32) -> SearchPage {
-    SearchPage {
-        songs: Vec::new(),
-        total: 0,
-        page,
-        page_size,
-        max_page: 0,
-    }
-}
-
 fn value_as_string(v: &Value) -> String {
     match v {
         Value::String(s) => s.clone(),
@@ -386,7 +434,7 @@ pub fn search_kuwo_music_paged(keyword: &str, page: u32, page_size: u32) -> Resu
             "http://search.kuwo.cn/r.s?client=kt&all={}&pn={}&rn={}&uid=794762570&ver=kwplayer_ar_9.2.2.1&vipver=1&show_copyright_off=1&newver=1&ft=music&cluster=0&strategy=2012&encoding=utf8&rformat=json&vermerge=1&mobi=1&issubtitle=1",
             q, pn, page_size
         );
-        let resp = http_client()?.get(&url).send().map_err(|e| e.to_string())?;
+        let resp = search_get(&url)?.send().map_err(|e| e.to_string())?;
         if !resp.status().is_success() {
             return Err(format!("酷我搜索 HTTP {}", resp.status()));
         }
@@ -469,7 +517,7 @@ pub fn search_kugou_music_paged(keyword: &str, page: u32, page_size: u32) -> Res
             "https://songsearch.kugou.com/song_search_v2?keyword={}&page={}&pagesize={}&userid=0&clientver=&platform=WebFilter&filter=2&iscorrection=1&privilege_filter=0&area_code=1",
             k, page, page_size
         );
-        let resp = http_client()?.get(&url).send().map_err(|e| e.to_string())?;
+        let resp = search_get(&url)?.send().map_err(|e| e.to_string())?;
         if !resp.status().is_success() {
             return Err(format!("酷狗搜索 HTTP {}", resp.status()));
         }
@@ -525,8 +573,9 @@ pub fn search_migu_music_paged(keyword: &str, page: u32, page_size: u32) -> Resu
         "https://jadeite.migu.cn/music_search/v3/search/searchAll?isCorrect=0&isCopyright=1&searchSwitch=%7B%22song%22%3A1%2C%22album%22%3A0%2C%22singer%22%3A0%2C%22tagSong%22%3A1%2C%22mvSong%22%3A0%2C%22bestShow%22%3A1%2C%22songlist%22%3A0%2C%22lyricSong%22%3A0%7D&pageSize={}&text={}&pageNo={}&sort=0&sid=USS",
         page_size, q, page
     );
-    let resp = http_client()?
-        .get(&url)
+    // 咪咕要求移动端 UA，不用 search_get 以免带上两个 User-Agent
+    let resp = http::get(&url)?
+        .timeout(HTTP_SEARCH_TIMEOUT)
         .header("uiVersion", "A_music_3.6.1")
         .header("deviceId", device_id)
         .header("timestamp", &ts)
@@ -563,52 +612,12 @@ pub fn search_migu_music_paged(keyword: &str, page: u32, page_size: u32) -> Resu
     })
 }
 
-/// lx `common/utils/common.ts`：`similar`
-fn levenshtein_distance_chars(short_s: &str, long_s: &str) -> usize {
-    let a: Vec<char> = short_s.chars().collect();
-    let b: Vec<char> = long_s.chars().collect();
-    let al = a.len();
-    let bl = b.len();
-    if al == 0 {
-        return bl;
-    }
-    if bl == 0 {
-        return al;
-    }
-    let mut dp = vec![0usize; bl + 1];
-    for j in 0..=bl {
-        dp[j] = j;
-    }
-    for i in 1..=al {
-        let mut prev = dp[0];
-        dp[0] = i;
-        for j in 1..=bl {
-            let tmp = dp[j];
-            let cost = usize::from(a[i - 1] != b[j - 1]);
-            dp[j] = (dp[j] + 1).min(dp[j - 1] + 1).min(prev + cost);
-            prev = tmp;
-        }
-    }
-    dp[bl]
-}
-
-fn lx_similar(a: &str, b: &str) -> f64 {
-    let a = a.trim();
-    let b = b.trim();
-    if a.is_empty() || b.is_empty() {
-        return 0.0;
-    }
-    let (short_s, long_s) = if a.len() > b.len() { (b, a) } else { (a, b) };
-    let bl = long_s.chars().count();
-    if bl == 0 {
-        return 0.0;
-    }
-    let dist = levenshtein_distance_chars(short_s, long_s);
-    1.0 - (dist as f64 / bl as f64)
-}
-
-fn lx_id_key(song: &SongInfo) -> String {
-    format!("{}_{}", song.source, song.id)
+/// lx `deduplicationList` 的 `${source}_${id}` 去重键，取 64 位哈希免去逐条拼字符串
+fn lx_id_key(song: &SongInfo) -> u64 {
+    let mut h = DefaultHasher::new();
+    song.source.hash(&mut h);
+    song.id.hash(&mut h);
+    h.finish()
 }
 
 fn source_all_page(total: usize, fetch_limit: u32) -> u32 {
@@ -624,45 +633,80 @@ fn merge_all_sources_lx(
     keyword: &str,
     page: u32,
     fetch_limit: u32,
-    ordered: &[(Vec<SongInfo>, usize)],
+    ordered: Vec<(Vec<SongInfo>, usize)>,
 ) -> (Vec<SongInfo>, usize, u32) {
-    let mut combined: Vec<SongInfo> = Vec::new();
+    let mut combined: Vec<SongInfo> = Vec::with_capacity(ordered.iter().map(|(songs, _)| songs.len()).sum());
     let mut max_total: usize = 0;
     let mut max_all_page: u32 = 0;
     for (songs, total) in ordered {
-        max_total = max_total.max(*total);
-        let ap = source_all_page(*total, fetch_limit);
+        max_total = max_total.max(total);
+        let ap = source_all_page(total, fetch_limit);
         max_all_page = max_all_page.max(ap);
         if ap < page {
             continue;
         }
-        combined.extend(songs.iter().cloned());
+        combined.extend(songs);
     }
-    let mut seen: HashSet<String> = HashSet::new();
+    let mut seen: HashSet<u64> = HashSet::with_capacity(combined.len());
     combined.retain(|s| seen.insert(lx_id_key(s)));
-    let mut scored: Vec<(f64, usize, SongInfo)> = combined
+
+    let sim = Similar::new(keyword);
+    let mut haystack = String::new();
+    let mut scored: Vec<(f64, SongInfo)> = combined
         .into_iter()
-        .enumerate()
-        .map(|(i, s)| {
-            let haystack = format!("{} {}", s.name, s.artist);
-            (lx_similar(keyword, &haystack), i, s)
+        .map(|s| {
+            haystack.clear();
+            haystack.push_str(&s.name);
+            haystack.push(' ');
+            haystack.push_str(&s.artist);
+            (sim.score(&haystack), s)
         })
         .collect();
-    scored.sort_by(|a, b| {
-        b.0.partial_cmp(&a.0)
-            .unwrap_or(Ordering::Equal)
-            .then_with(|| a.1.cmp(&b.1))
-    });
-    let songs: Vec<SongInfo> = scored.into_iter().map(|(_, _, s)| s).collect();
+    // 稳定排序：同分保持拼接顺序
+    scored.sort_by(|a, b| b.0.partial_cmp(&a.0).unwrap_or(Ordering::Equal));
+    let songs: Vec<SongInfo> = scored.into_iter().map(|(_, s)| s).collect();
     (songs, max_total, max_all_page)
 }
 
+fn search_source_paged(source: &str, keyword: &str, page: u32, page_size: u32) -> Result<SearchPage, String> {
+    match source {
+        "tx" => search_qq_music_paged(keyword, page, page_size),
+        "wy" => search_netease_music_paged(keyword, page, page_size),
+        "kw" => search_kuwo_music_paged(keyword, page, page_size),
+        "kg" => search_kugou_music_paged(keyword, page, page_size),
+        "mg" => search_migu_music_paged(keyword, page, page_size),
+        _ => Err(format!("未知搜索源 {}", source)),
+    }
+}
+
+/// 一次多源搜索的结果通道：(源下标, 结果)
+type SourceReply = (usize, Result<SearchPage, String>);
+
+/// 把 `SOURCE_ORDER[index]` 的搜索投递到执行器，结果经 `tx` 送回；调用方已放弃时结果被丢弃
+fn launch_source(
+    index: usize,
+    keyword: &str,
+    page: u32,
+    page_size: u32,
+    canceled: &Canceled,
+    tx: &mpsc::Sender<SourceReply>,
+) {
+    let kw = keyword.to_string();
+    let tx = tx.clone();
+    executor::spawn(canceled, move || {
+        let r = search_source_paged(SOURCE_ORDER[index], &kw, page, page_size);
+        let _ = tx.send((index, r));
+    });
+}
+
 /// `auto`：lx `musicSdk/index` 源顺序 kw→kg→tx→wy→mg；单次 HTTP 15s；总预算 `PRIORITY_SEARCH_TOTAL`
 fn search_priority_paged(keyword: &str, page: u32, page_size: u32) -> Result<SearchPage, String> {
-    const ORDER: &[&str] = &["kw", "kg", "tx", "wy", "mg"];
+    if tuning().priority_race {
+        return search_priority_race_paged(keyword, page, page_size);
+    }
     let start = Instant::now();
     let mut last_note = String::new();
-    for p in ORDER {
+    for p in SOURCE_ORDER {
         let elapsed = start.elapsed();
         if elapsed >= PRIORITY_SEARCH_TOTAL {
             last_note = format!(
@@ -680,15 +724,7 @@ fn search_priority_paged(keyword: &str, page: u32, page_size: u32) -> Result<Sea
             );
             break;
         }
-        let r = match *p {
-            "tx" => search_qq_music_paged(keyword, page, page_size),
-            "wy" => search_netease_music_paged(keyword, page, page_size),
-            "kw" => search_kuwo_music_paged(keyword, page, page_size),
-            "kg" => search_kugou_music_paged(keyword, page, page_size),
-            "mg" => search_migu_music_paged(keyword, page, page_size),
-            _ => continue,
-        };
-        match r {
+        match search_source_paged(p, keyword, page, page_size) {
             Ok(sp) if !sp.songs.is_empty() => return Ok(sp),
             Ok(_) => last_note = format!("{}:无结果", p),
             Err(e) => last_note = format!("{}: {}", p, e),
@@ -697,77 +733,153 @@ fn search_priority_paged(keyword: &str, page: u32, page_size: u32) -> Result<Sea
     Err(format!("顺序搜索无有效结果; {}", last_note))
 }
 
+/// `auto` 竞速：各源同时发出，最先返回的非空结果胜出，最坏等待一次 HTTP 超时而非 75s
+fn search_priority_race_paged(keyword: &str, page: u32, page_size: u32) -> Result<SearchPage, String> {
+    let deadline = Instant::now() + HTTP_SEARCH_TIMEOUT + Duration::from_secs(1);
+    let canceled = Canceled::new();
+    let (tx, rx) = mpsc::channel::<SourceReply>();
+    for i in 0..SOURCE_ORDER.len() {
+        launch_source(i, keyword, page, page_size, &canceled, &tx);
+    }
+    drop(tx);
+
+    let mut notes: Vec<String> = Vec::new();
+    let mut answered = 0;
+    let result = loop {
+        if answered == SOURCE_ORDER.len() {
+            break None;
+        }
+        let now = Instant::now();
+        if now >= deadline {
+            notes.push(format!("其余源 {}s 内未返回", HTTP_SEARCH_TIMEOUT.as_secs()));
+            break None;
+        }
+        match rx.recv_timeout(deadline - now) {
+            Ok((i, r)) => {
+                answered += 1;
+                match r {
+                    Ok(sp) if !sp.songs.is_empty() => break Some(sp),
+                    Ok(_) => notes.push(format!("{}:无结果", SOURCE_ORDER[i])),
+                    Err(e) => notes.push(format!("{}: {}", SOURCE_ORDER[i], e)),
+                }
+            }
+            Err(RecvTimeoutError::Timeout) => continue,
+            Err(RecvTimeoutError::Disconnected) => break None,
+        }
+    };
+    canceled.cancel();
+    result.ok_or_else(|| format!("竞速搜索无有效结果; {}", notes.join("; ")))
+}
+
+/// `all` 中单个源的进度
+#[derive(Default)]
+struct SourceSlot {
+    /// 已发出的请求数（首发 + 对冲）
+    attempts: u8,
+    failures: u8,
+    page: Option<SearchPage>,
+    last_err: String,
+}
+
+impl SourceSlot {
+    fn answered(&self) -> bool {
+        self.page.is_some() || (self.attempts > 0 && self.failures >= self.attempts)
+    }
+}
+
 pub fn search_all_paged(keyword: &str, page: u32, _page_size: u32) -> Result<SearchPage, String> {
     let page = if page == 0 { 1 } else { page };
     let fetch_limit = LX_AGG_SOURCE_LIMIT;
-    let kw = keyword.to_string();
-
-    let (r_kw, r_kg, r_tx, r_wy, r_mg) = std::thread::scope(|s| {
-        let a = kw.clone();
-        let h_kw = s.spawn(move || search_kuwo_music_paged(&a, page, fetch_limit));
-        let b = kw.clone();
-        let h_kg = s.spawn(move || search_kugou_music_paged(&b, page, fetch_limit));
-        let c = kw.clone();
-        let h_tx = s.spawn(move || search_qq_music_paged(&c, page, fetch_limit));
-        let d = kw.clone();
-        let h_wy = s.spawn(move || search_netease_music_paged(&d, page, fetch_limit));
-        let e = kw.clone();
-        let h_mg = s.spawn(move || search_migu_music_paged(&e, page, fetch_limit));
-        let thread_err = || Err("搜索线程异常".to_string());
-        (
-            h_kw.join().unwrap_or_else(|_| thread_err()),
-            h_kg.join().unwrap_or_else(|_| thread_err()),
-            h_tx.join().unwrap_or_else(|_| thread_err()),
-            h_wy.join().unwrap_or_else(|_| thread_err()),
-            h_mg.join().unwrap_or_else(|_| thread_err()),
-        )
-    });
+    let t = tuning();
+    let start = Instant::now();
+    let hedge_at = start + t.hedge_after;
+    let deadline = start + HTTP_SEARCH_TIMEOUT + Duration::from_secs(1);
+    let canceled = Canceled::new();
+    let (tx, rx) = mpsc::channel::<SourceReply>();
+    let mut slots: Vec<SourceSlot> = (0..SOURCE_ORDER.len()).map(|_| SourceSlot::default()).collect();
+    let mut hedged = false;
+    let mut quorum_at: Option<Instant> = None;
+
+    for (i, slot) in slots.iter_mut().enumerate() {
+        launch_source(i, keyword, page, fetch_limit, &canceled, &tx);
+        slot.attempts = 1;
+    }
 
-    let mut err_notes: Vec<String> = Vec::new();
-    let p_kw = match r_kw {
-        Ok(p) => p,
-        Err(e) => {
-            err_notes.push(format!("kw: {}", e));
-            empty_search_page(page, fetch_limit)
+    loop {
+        if slots.iter().all(|s| s.answered()) {
+            break;
         }
-    };
-    let p_kg = match r_kg {
-        Ok(p) => p,
-        Err(e) => {
-            err_notes.push(format!("kg: {}", e));
-            empty_search_page(page, fetch_limit)
+        let now = Instant::now();
+        if now >= deadline {
+            break;
         }
-    };
-    let p_tx = match r_tx {
-        Ok(p) => p,
-        Err(e) => {
-            err_notes.push(format!("tx: {}", e));
-            empty_search_page(page, fetch_limit)
+        if let Some(q) = quorum_at {
+            if now >= q + t.quorum_grace {
+                break;
+            }
         }
-    };
-    let p_wy = match r_wy {
-        Ok(p) => p,
-        Err(e) => {
-            err_notes.push(format!("wy: {}", e));
-            empty_search_page(page, fetch_limit)
+        // 对冲：到点仍未返回的源各补发一次，两次请求谁先成功用谁
+        if !hedged && now >= hedge_at {
+            hedged = true;
+            for (i, slot) in slots.iter_mut().enumerate() {
+                if !slot.answered() {
+                    launch_source(i, keyword, page, fetch_limit, &canceled, &tx);
+                    slot.attempts += 1;
+                }
+            }
+            continue;
         }
-    };
-    let p_mg = match r_mg {
-        Ok(p) => p,
-        Err(e) => {
-            err_notes.push(format!("mg: {}", e));
-            empty_search_page(page, fetch_limit)
+        let mut wake = deadline;
+        if let Some(q) = quorum_at {
+            wake = wake.min(q + t.quorum_grace);
         }
-    };
+        if !hedged {
+            wake = wake.min(hedge_at);
+        }
+        match rx.recv_timeout(wake.saturating_duration_since(now)) {
+            Ok((i, r)) => {
+                let slot = &mut slots[i];
+                if slot.page.is_some() {
+                    continue;
+                }
+                match r {
+                    Ok(sp) => slot.page = Some(sp),
+                    Err(e) => {
+                        slot.failures += 1;
+                        slot.last_err = e;
+                    }
+                }
+                let with_songs = slots
+                    .iter()
+                    .filter(|s| s.page.as_ref().is_some_and(|p| !p.songs.is_empty()))
+                    .count();
+                if quorum_at.is_none() && with_songs >= t.quorum {
+                    quorum_at = Some(Instant::now());
+                }
+            }
+            Err(RecvTimeoutError::Timeout) => continue,
+            Err(RecvTimeoutError::Disconnected) => break,
+        }
+    }
+    canceled.cancel();
 
-    let ordered = [
-        (p_kw.songs, p_kw.total),
-        (p_kg.songs, p_kg.total),
-        (p_tx.songs, p_tx.total),
-        (p_wy.songs, p_wy.total),
-        (p_mg.songs, p_mg.total),
-    ];
-    let (songs, total, max_page) = merge_all_sources_lx(keyword, page, fetch_limit, &ordered);
+    let mut err_notes: Vec<String> = Vec::new();
+    let ordered: Vec<(Vec<SongInfo>, usize)> = slots
+        .into_iter()
+        .enumerate()
+        .map(|(i, slot)| match slot.page {
+            Some(p) => (p.songs, p.total),
+            None => {
+                if slot.failures >= slot.attempts {
+                    err_notes.push(format!("{}: {}", SOURCE_ORDER[i], slot.last_err));
+                } else {
+                    err_notes.push(format!("{}: 未在收尾前返回", SOURCE_ORDER[i]));
+                }
+                (Vec::new(), 0)
+            }
+        })
+        .collect();
+    let (songs, total, max_page) = merge_all_sources_lx(keyword, page, fetch_limit, ordered);
 
     if songs.is_empty() {
         let mut msg = String::from("聚合搜索无结果");
@@ -792,7 +904,7 @@ pub fn search_all_paged(keyword: &str, page: u32, _page_size: u32) -> Result<Sea
 /// 
 /// # 参数
 /// - keyword: 搜索关键词
-/// - platform: 单源 tx/wy/kw/kg/mg；`auto` 顺序 kw→kg→tx→wy→mg（lx，单次 HTTP 15s、总≤75s）；`all` 多源并发（lx 每源 limit=30、合并/去重/相似度排序，HTTP 15s）
+/// - platform: 单源 tx/wy/kw/kg/mg；`auto` 顺序 kw→kg→tx→wy→mg（lx，单次 HTTP 15s、总≤75s）；`all` 多源并发（lx 每源 limit=30、合并/去重/相似度排序，HTTP 15s；凑够 quorum 个源即收尾，见 `SearchTuning`）
 /// 
 /// # 返回
 /// 成功时返回歌曲列表，失败时返回错误信息
@@ -816,13 +928,8 @@ pub fn search_music_paged(keyword: &str, platform: &str, page: u32, page_size: u
     }
     
     match platform {
-        "tx" => search_qq_music_paged(keyword, page, page_size),
-        "wy" => search_netease_music_paged(keyword, page, page_size),
-        "kw" => search_kuwo_music_paged(keyword, page, page_size),
-        "kg" => search_kugou_music_paged(keyword, page, page_size),
-        "mg" => search_migu_music_paged(keyword, page, page_size),
         "auto" => search_priority_paged(keyword, page, page_size),
         "all" => search_all_paged(keyword, page, page_size),
-        _ => unreachable!("平台验证已通过"),
+        _ => search_source_paged(platform, keyword, page, page_size),
     }
 }
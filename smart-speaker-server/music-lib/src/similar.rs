@@ -0,0 +1,280 @@
+//! 相似度模块 - lx `common/utils/common.ts` 的 `similar`，供聚合搜索结果排序
+//!
+//! 编辑距离按字符计算，结果与逐格 DP 完全一致。关键词不超过 64 个字符时用 Myers 位并行算法，
+//! 候选串每个字符只做一组 u64 运算；更长时退回单行 DP，行缓冲按线程复用。打分过程不分配内存。
+use std::cell::RefCell;
+
+/// Myers 算法一个机器字能容纳的模式串长度
+const MYERS_MAX_CHARS: usize = 64;
+
+thread_local! {
+    static DP_ROW: RefCell<Vec<usize>> = const { RefCell::new(Vec::new()) };
+}
+
+/// 模式串中每个字符出现位置的位图（Myers 的 Peq 表），放在栈上；
+/// 关键词通常只有几个到十几个不同字符，线性查找比哈希更快
+struct PatternMasks {
+    chars: [char; MYERS_MAX_CHARS],
+    masks: [u64; MYERS_MAX_CHARS],
+    distinct: usize,
+    len: usize,
+}
+
+impl PatternMasks {
+    fn build(pattern: &str) -> Option<Self> {
+        let mut pm = PatternMasks {
+            chars: ['\0'; MYERS_MAX_CHARS],
+            masks: [0; MYERS_MAX_CHARS],
+            distinct: 0,
+            len: 0,
+        };
+        for c in pattern.chars() {
+            if pm.len == MYERS_MAX_CHARS {
+                return None;
+            }
+            let bit = 1u64 << pm.len;
+            match pm.chars[..pm.distinct].iter().position(|&x| x == c) {
+                Some(k) => pm.masks[k] |= bit,
+                None => {
+                    pm.chars[pm.distinct] = c;
+                    pm.masks[pm.distinct] = bit;
+                    pm.distinct += 1;
+                }
+            }
+            pm.len += 1;
+        }
+        Some(pm)
+    }
+
+    fn mask(&self, c: char) -> u64 {
+        match self.chars[..self.distinct].iter().position(|&x| x == c) {
+            Some(k) => self.masks[k],
+            None => 0,
+        }
+    }
+
+    /// Myers / Hyyrö 位并行编辑距离（全局对齐），返回 (距离, text 字符数)
+    fn distance(&self, text: &str) -> (usize, usize) {
+        let m = self.len;
+        let mut n = 0usize;
+        if m == 0 {
+            return (text.chars().count(), text.chars().count());
+        }
+        let last = 1u64 << (m - 1);
+        let mut pv: u64 = !0;
+        let mut mv: u64 = 0;
+        let mut score = m;
+        for c in text.chars() {
+            n += 1;
+            let eq = self.mask(c);
+            let xv = eq | mv;
+            let xh = ((eq & pv).wrapping_add(pv) ^ pv) | eq;
+            let mut ph = mv | !(xh | pv);
+            let mut mh = pv & xh;
+            if ph & last != 0 {
+                score += 1;
+            } else if mh & last != 0 {
+                score -= 1;
+            }
+            // 第 0 行 D[0][j] = j，每列上边界 +1
+            ph = (ph << 1) | 1;
+            mh <<= 1;
+            pv = mh | !(xv | ph);
+            mv = ph & xv;
+        }
+        (score, n)
+    }
+}
+
+/// 单行 DP 编辑距离，行缓冲复用；用于超过 64 字符的关键词
+fn dp_distance(a: &str, b: &str) -> usize {
+    let bl = b.chars().count();
+    DP_ROW.with(|row| {
+        let mut dp = row.borrow_mut();
+        dp.clear();
+        dp.extend(0..=bl);
+        for (i, ca) in a.chars().enumerate() {
+            let mut prev = dp[0];
+            dp[0] = i + 1;
+            for (j, cb) in b.chars().enumerate() {
+                let tmp = dp[j + 1];
+                let cost = usize::from(ca != cb);
+                dp[j + 1] = (dp[j + 1] + 1).min(dp[j] + 1).min(prev + cost);
+                prev = tmp;
+            }
+        }
+        dp[bl]
+    })
+}
+
+/// 固定关键词、对多个候选打分：关键词的位图只建一次
+pub struct Similar<'a> {
+    keyword: &'a str,
+    keyword_chars: usize,
+    masks: Option<PatternMasks>,
+}
+
+impl<'a> Similar<'a> {
+    pub fn new(keyword: &'a str) -> Self {
+        let keyword = keyword.trim();
+        Similar {
+            keyword,
+            keyword_chars: keyword.chars().count(),
+            masks: PatternMasks::build(keyword),
+        }
+    }
+
+    /// 同 lx `similar(keyword, candidate)`：1 - 编辑距离 / 较长串（按字节比较长短）的字符数
+    pub fn score(&self, candidate: &str) -> f64 {
+        let b = candidate.trim();
+        if self.keyword.is_empty() || b.is_empty() {
+            return 0.0;
+        }
+        let (dist, b_chars) = match &self.masks {
+            Some(pm) => pm.distance(b),
+            None => (dp_distance(self.keyword, b), b.chars().count()),
+        };
+        let long_chars = if self.keyword.len() > b.len() {
+            self.keyword_chars
+        } else {
+            b_chars
+        };
+        if long_chars == 0 {
+            return 0.0;
+        }
+        1.0 - (dist as f64 / long_chars as f64)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// 逐格 DP 参考实现，按字符计算
+    fn naive_distance(a: &str, b: &str) -> usize {
+        let a: Vec<char> = a.chars().collect();
+        let b: Vec<char> = b.chars().collect();
+        let mut d = vec![vec![0usize; b.len() + 1]; a.len() + 1];
+        for (i, row) in d.iter_mut().enumerate() {
+            row[0] = i;
+        }
+        for j in 0..=b.len() {
+            d[0][j] = j;
+        }
+        for i in 1..=a.len() {
+            for j in 1..=b.len() {
+                let cost = usize::from(a[i - 1] != b[j - 1]);
+                d[i][j] = (d[i - 1][j] + 1).min(d[i][j - 1] + 1).min(d[i - 1][j - 1] + cost);
+            }
+        }
+        d[a.len()][b.len()]
+    }
+
+    fn naive_score(keyword: &str, candidate: &str) -> f64 {
+        let a = keyword.trim();
+        let b = candidate.trim();
+        if a.is_empty() || b.is_empty() {
+            return 0.0;
+        }
+        let long = if a.len() > b.len() { a } else { b };
+        1.0 - naive_distance(a, b) as f64 / long.chars().count() as f64
+    }
+
+    fn check(keyword: &str, candidate: &str) {
+        let expect = naive_distance(keyword, candidate);
+        match PatternMasks::build(keyword) {
+            Some(pm) => assert_eq!(pm.distance(candidate).0, expect, "myers {keyword:?} / {candidate:?}"),
+            None => assert!(keyword.chars().count() > MYERS_MAX_CHARS),
+        }
+        assert_eq!(dp_distance(keyword, candidate), expect, "dp {keyword:?} / {candidate:?}");
+        assert_eq!(
+            Similar::new(keyword).score(candidate),
+            naive_score(keyword, candidate),
+            "score {keyword:?} / {candidate:?}"
+        );
+    }
+
+    const SAMPLES: &[&str] = &[
+        "",
+        "a",
+        "kitten",
+        "sitting",
+        "Hello World",
+        "hello world",
+        "周杰伦",
+        "周杰伦 晴天",
+        "晴天",
+        "七里香",
+        "稻香 周杰伦",
+        "林俊杰 江南",
+        "Jay Chou 晴天",
+        "夜曲（Live）",
+        "あいうえお",
+    ];
+
+    #[test]
+    fn ascii_and_cjk_match_naive() {
+        for a in SAMPLES {
+            for b in SAMPLES {
+                check(a, b);
+            }
+        }
+    }
+
+    #[test]
+    fn empty_strings() {
+        assert_eq!(PatternMasks::build("").unwrap().distance("晴天").0, 2);
+        assert_eq!(PatternMasks::build("晴天").unwrap().distance("").0, 2);
+        assert_eq!(Similar::new("").score("晴天"), 0.0);
+        assert_eq!(Similar::new("晴天").score("   "), 0.0);
+        check("", "");
+    }
+
+    #[test]
+    fn exactly_64_chars_uses_myers() {
+        let ascii: String = "abcdefgh".repeat(8);
+        let cjk: String = "周杰伦晴天七里香".repeat(8);
+        assert_eq!(ascii.chars().count(), MYERS_MAX_CHARS);
+        assert_eq!(cjk.chars().count(), MYERS_MAX_CHARS);
+        assert!(PatternMasks::build(&ascii).is_some());
+        assert!(PatternMasks::build(&cjk).is_some());
+        check(&ascii, &ascii);
+        check(&ascii, &"abcdefgx".repeat(8));
+        check(&ascii, "abc");
+        check(&cjk, &cjk);
+        check(&cjk, "周杰伦 晴天");
+        check(&cjk, &"周杰伦晴天七里香".repeat(9));
+        check("晴天", &cjk);
+    }
+
+    #[test]
+    fn over_64_chars_falls_back_to_dp() {
+        let ascii: String = "abcdefgh".repeat(8) + "z";
+        let cjk: String = "周杰伦晴天七里香".repeat(10);
+        assert!(PatternMasks::build(&ascii).is_none());
+        assert!(PatternMasks::build(&cjk).is_none());
+        check(&ascii, &ascii);
+        check(&ascii, &"abcdefgh".repeat(8));
+        check(&cjk, "周杰伦");
+        check(&cjk, &"周杰伦晴天七里".repeat(11));
+        check("周杰伦", &cjk);
+    }
+
+    /// 固定种子的伪随机串，覆盖 0..=70 个字符、含重复字符与 ASCII/CJK 混排
+    #[test]
+    fn pseudo_random_match_naive() {
+        const ALPHABET: &[char] = &['a', 'b', 'c', ' ', '周', '杰', '伦', '晴', '天'];
+        let mut seed: u64 = 0x2545_f491_4f6c_dd1d;
+        let mut next = move |bound: usize| {
+            seed = seed.wrapping_mul(6364136223846793005).wrapping_add(1442695040888963407);
+            ((seed >> 33) as usize) % bound
+        };
+        for _ in 0..400 {
+            let la = next(71);
+            let lb = next(71);
+            let a: String = (0..la).map(|_| ALPHABET[next(ALPHABET.len())]).collect();
+            let b: String = (0..lb).map(|_| ALPHABET[next(ALPHABET.len())]).collect();
+            check(&a, &b);
+        }
+    }
+}
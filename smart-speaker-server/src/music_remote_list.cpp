@@ -1,6 +1,5 @@
 #include "music_downloader.h"
 #include "music_remote_list.h"
-#include "runtime_config.h"
 
 #include <algorithm>
 #include <cstring>
@@ -262,65 +261,31 @@ void music_remote_apply_source_hints(std::string &keyword, std::string &platform
     collapse_spaces(keyword);
 }
 
-bool music_remote_list_music_page(const std::string &keyword, int page, int page_size, Json::Value &music,
-                                  int &out_total, int &out_total_pages)
+bool music_remote_list_prepare(const std::string &keyword, std::string &kw, std::string &plat)
 {
-    music_search_result_t res;
-    music_result_t mr;
-    const char *qual;
-    size_t i;
-    std::string kw = keyword;
-    std::string plat;
-    const ServerRuntimeConfig &rt = server_runtime_config();
-
-    memset(&res, 0, sizeof(res));
-    if (page <= 0 || page_size <= 0 || keyword.empty()) {
+    if (keyword.empty() || !music_api_configured()) {
         return false;
     }
-    if (!music_api_configured()) {
-        return false;
-    }
-
+    kw = keyword;
     plat = "all";
     music_remote_apply_source_hints(kw, plat, "all");
-    if (kw.empty()) {
-        return false;
-    }
-
-    mr = music_search_page(kw.c_str(), plat.c_str(), (uint32_t)page, (uint32_t)page_size, &res);
-    if (mr != Ok) {
-        return false;
-    }
+    return !kw.empty();
+}
 
-    out_total = (int)res.total;
-    out_total_pages = (int)res.total_pages;
-    qual = rt.legacy_quality.c_str();
+void music_remote_list_fill_items(const music_search_result_t &res, Json::Value &music)
+{
+    size_t i;
 
+    music = Json::Value(Json::arrayValue);
     for (i = 0; i < res.count; ++i) {
-        music_info_t *info = &res.results[i];
+        const music_info_t *info = &res.results[i];
         Json::Value item(Json::objectValue);
-        char *url = NULL;
 
         item["singer"] = std::string(info->artist);
         item["song"] = std::string(info->name);
         item["path"] = "";
         item["source"] = std::string(info->source);
         item["song_id"] = std::string(info->id);
-
-        if (i == 0) {
-            url = music_get_url(info->source, info->id, qual);
-            if (url != NULL && url[0] != '\0') {
-                item["play_url"] = std::string(url);
-                music_free_string(url);
-            } else {
-                if (url != NULL) {
-                    music_free_string(url);
-                }
-            }
-        }
         music.append(item);
     }
-
-    music_free_search_result(&res);
-    return true;
 }
@@ -1,5 +1,6 @@
 #include "music_runtime_init.h"
 #include "music_downloader.h"
+#include "runtime_config.h"
 
 #include <cerrno>
 #include <cstdio>
@@ -92,8 +93,26 @@ struct MusicToml {
     std::string lx_script_import_url;
     std::string lx_script_download_url_template;
     std::string lx_script_save_path;
+    // music-lib 共享 HTTP 客户端的连接池参数，0 为 music-lib 默认值
+    unsigned http_pool_max_idle_per_host;
+    unsigned http_pool_idle_timeout_secs;
+    unsigned http_connect_timeout_secs;
+    unsigned http_tcp_keepalive_secs;
+    // 聚合 / 顺序搜索调度，0 为 music-lib 默认值
+    unsigned search_quorum;
+    unsigned search_hedge_after_ms;
+    unsigned search_quorum_grace_ms;
+    bool search_priority_race;
+    // 断点续传分段 / 重试，0 为 music-lib 默认值
+    unsigned download_segments;
+    unsigned download_max_retries;
+    // 在线歌曲本地缓存：容量 0 为关闭，目录留空即本地曲库目录（离线模式可直接搜到）
+    unsigned cache_max_mb;
+    std::string cache_dir;
 };
 
+bool g_cache_enabled = false;
+
 const char *kMusicTomlRel = "data/config/music.toml";
 const char *kMusicServiceTomlRel = "data/config/music-service.toml";
 
@@ -109,6 +128,23 @@ void write_default_music_toml(const std::string &path)
         << "lx_script_save_path = \"data/music-source/lx.js\"\n";
 }
 
+void apply_toml_uint(unsigned &dst, const std::string &value, const std::string &key)
+{
+    std::string v = trim_copy(value);
+    char *end = NULL;
+    unsigned long n;
+    if (v.empty()) {
+        return;
+    }
+    errno = 0;
+    n = strtoul(v.c_str(), &end, 10);
+    if (errno != 0 || end == v.c_str() || *end != '\0' || n > 86400) {
+        std::cerr << "music: " << key << " = " << v << " 无效，使用默认值" << std::endl;
+        return;
+    }
+    dst = (unsigned)n;
+}
+
 void load_music_toml(const std::string &path, MusicToml &out)
 {
     std::ifstream in(path.c_str());
@@ -119,6 +155,18 @@ void load_music_toml(const std::string &path, MusicToml &out)
     out.lx_script_import_url.clear();
     out.lx_script_download_url_template.clear();
     out.lx_script_save_path.clear();
+    out.http_pool_max_idle_per_host = 0;
+    out.http_pool_idle_timeout_secs = 0;
+    out.http_connect_timeout_secs = 0;
+    out.http_tcp_keepalive_secs = 0;
+    out.search_quorum = 0;
+    out.search_hedge_after_ms = 0;
+    out.search_quorum_grace_ms = 0;
+    out.search_priority_race = false;
+    out.download_segments = 0;
+    out.download_max_retries = 0;
+    out.cache_max_mb = 0;
+    out.cache_dir.clear();
 
     while (std::getline(in, line)) {
         std::string raw = trim_copy(line);
@@ -143,6 +191,31 @@ void load_music_toml(const std::string &path, MusicToml &out)
             apply_toml_string(out.lx_script_download_url_template, value);
         } else if (key == "lx_script_save_path") {
             apply_toml_string(out.lx_script_save_path, value);
+        } else if (key == "http_pool_max_idle_per_host") {
+            apply_toml_uint(out.http_pool_max_idle_per_host, value, key);
+        } else if (key == "http_pool_idle_timeout_secs") {
+            apply_toml_uint(out.http_pool_idle_timeout_secs, value, key);
+        } else if (key == "http_connect_timeout_secs") {
+            apply_toml_uint(out.http_connect_timeout_secs, value, key);
+        } else if (key == "http_tcp_keepalive_secs") {
+            apply_toml_uint(out.http_tcp_keepalive_secs, value, key);
+        } else if (key == "search_quorum") {
+            apply_toml_uint(out.search_quorum, value, key);
+        } else if (key == "search_hedge_after_ms") {
+            apply_toml_uint(out.search_hedge_after_ms, value, key);
+        } else if (key == "search_quorum_grace_ms") {
+            apply_toml_uint(out.search_quorum_grace_ms, value, key);
+        } else if (key == "search_priority_race") {
+            std::string v = trim_copy(value);
+            out.search_priority_race = (v == "true" || v == "1");
+        } else if (key == "download_segments") {
+            apply_toml_uint(out.download_segments, value, key);
+        } else if (key == "download_max_retries") {
+            apply_toml_uint(out.download_max_retries, value, key);
+        } else if (key == "cache_max_mb") {
+            apply_toml_uint(out.cache_max_mb, value, key);
+        } else if (key == "cache_dir") {
+            apply_toml_string(out.cache_dir, value);
         }
     }
 }
@@ -350,6 +423,11 @@ void sync_music_service_toml(const std::string &path, const MusicToml &m)
 
 }  // namespace
 
+int music_runtime_cache_enabled(void)
+{
+    return g_cache_enabled ? 1 : 0;
+}
+
 int music_runtime_init(void)
 {
     std::string base = executable_dir();
@@ -369,6 +447,19 @@ int music_runtime_init(void)
 
     MusicToml m;
     load_music_toml(music_toml, m);
+    // 在任何搜索/取链之前定好连接池参数，之后整个进程共用一个客户端
+    music_http_configure(m.http_pool_max_idle_per_host, m.http_pool_idle_timeout_secs,
+                         m.http_connect_timeout_secs, m.http_tcp_keepalive_secs);
+    music_search_configure(m.search_quorum, m.search_hedge_after_ms, m.search_quorum_grace_ms,
+                           m.search_priority_race ? 1 : 0);
+    music_download_configure(m.download_segments, m.download_max_retries);
+    if (m.cache_max_mb > 0) {
+        std::string dir = m.cache_dir.empty() ? server_runtime_config().music_root : m.cache_dir;
+        g_cache_enabled = music_cache_configure(dir.c_str(), (uint64_t)m.cache_max_mb * 1024 * 1024) == Ok;
+        if (!g_cache_enabled) {
+            std::cerr << "music: 缓存目录 " << dir << " 不可用，在线歌曲不做本地缓存" << std::endl;
+        }
+    }
     if (m.lx_script_save_path.empty()) {
         m.lx_script_save_path = "data/music-source/lx.js";
     }
@@ -2,6 +2,14 @@
 #include "server.h"
 
 #include <ctime>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+
+/* 订阅连接的 TCP keepalive：空闲 30 秒后探测，每 10 秒一次，连续 3 次无应答内核判定断开 */
+#define APP_KEEPALIVE_IDLE 30
+#define APP_KEEPALIVE_INTERVAL 10
+#define APP_KEEPALIVE_COUNT 3
 
 namespace {
 
@@ -32,6 +40,40 @@ void sync_cached_snapshots_to_app(PlayerInfo_t *player, Server *s)
     }
 }
 
+/* 开启 keepalive 后，手机直接断网等收不到 FIN 的情况也会以 BEV_EVENT_ERROR 报到 event_cb */
+void enable_app_keepalive(struct bufferevent *bev)
+{
+    evutil_socket_t fd = bufferevent_getfd(bev);
+    int on = 1;
+    if (fd < 0) {
+        return;
+    }
+    if (setsockopt(fd, SOL_SOCKET, SO_KEEPALIVE, &on, sizeof(on)) != 0) {
+        Server::debug("开启 keepalive 失败");
+        return;
+    }
+#ifdef TCP_KEEPIDLE
+    {
+        int idle = APP_KEEPALIVE_IDLE;
+        int interval = APP_KEEPALIVE_INTERVAL;
+        int count = APP_KEEPALIVE_COUNT;
+        (void)setsockopt(fd, IPPROTO_TCP, TCP_KEEPIDLE, &idle, sizeof(idle));
+        (void)setsockopt(fd, IPPROTO_TCP, TCP_KEEPINTVL, &interval, sizeof(interval));
+        (void)setsockopt(fd, IPPROTO_TCP, TCP_KEEPCNT, &count, sizeof(count));
+    }
+#endif
+}
+
+PlayerInfo_t *find_player_by_app_bev(std::list<PlayerInfo_t> *list, struct bufferevent *bev)
+{
+    for (auto it = list->begin(); it != list->end(); it++) {
+        if (it->m_app_bev == bev) {
+            return &(*it);
+        }
+    }
+    return nullptr;
+}
+
 }  // namespace
 
 void PlayerInfo::player_timer_cb(evutil_socket_t fd, short events, void *arg)
@@ -43,11 +85,13 @@ void PlayerInfo::player_timer_cb(evutil_socket_t fd, short events, void *arg)
     for (auto it = p->m_player_list->begin(); it != p->m_player_list->end();) {
         bool erase_current = false;
 
-        if (time(NULL) - it->m_app_last_time > TIMEOUT && !it->m_appid.empty()) {
+        const time_t app_timeout = it->m_app_subscribed ? APP_PING_TIMEOUT : TIMEOUT;
+        if (time(NULL) - it->m_app_last_time > app_timeout && !it->m_appid.empty()) {
             Server::debug("[超时的APP] APPID：%s", it->m_appid.c_str());
             it->m_appid.clear();
+            it->m_app_subscribed = false;
             if (it->m_app_bev != nullptr) {
-                bufferevent_free(it->m_app_bev);
+                Server::server_release_bev(it->m_app_bev);
                 it->m_app_bev = nullptr;
             }
         }
@@ -55,11 +99,11 @@ void PlayerInfo::player_timer_cb(evutil_socket_t fd, short events, void *arg)
         if (time(NULL) - it->m_device_last_time > TIMEOUT) {
             Server::debug("[有音箱超时了] 音箱ID：%s", it->m_deviceid.c_str());
             if (it->m_device_bev != nullptr) {
-                bufferevent_free(it->m_device_bev);
+                Server::server_release_bev(it->m_device_bev);
                 it->m_device_bev = nullptr;
             }
             if (it->m_app_bev != nullptr) {
-                bufferevent_free(it->m_app_bev);
+                Server::server_release_bev(it->m_app_bev);
                 it->m_app_bev = nullptr;
             }
             erase_current = true;
@@ -128,6 +172,8 @@ void PlayerInfo::player_device_update_infolist(struct bufferevent *bev, const Js
     auto it = m_player_list->begin();
     for (; it != m_player_list->end(); it++) {
         if (deviceid == it->m_deviceid) {
+            /* 设备每秒上报一次，内容没变就不必再推给应用端 */
+            bool changed = (report != it->m_last_device_report);
             it->m_cur_singer = cur_singer;
             it->m_cur_music = cur_music;
             it->m_state = state;
@@ -137,7 +183,7 @@ void PlayerInfo::player_device_update_infolist(struct bufferevent *bev, const Js
             it->m_device_bev = bev;
             it->m_last_device_report = report;
 
-            if (it->m_app_bev != nullptr) {
+            if (it->m_app_bev != nullptr && changed) {
                 s->server_send_data(it->m_app_bev, report);
             }
             is_exist = true;
@@ -155,6 +201,7 @@ void PlayerInfo::player_device_update_infolist(struct bufferevent *bev, const Js
         player_info.m_cur_mode = cur_mode;
         player_info.m_device_last_time = time(NULL);
         player_info.m_app_last_time = 0;
+        player_info.m_app_subscribed = false;
         player_info.m_last_device_report = report;
         player_info.m_device_bev = bev;
         player_info.m_app_bev = nullptr;
@@ -174,6 +221,7 @@ void PlayerInfo::player_app_update_infolist(struct bufferevent *bev, const Json:
             it->m_app_last_time = time(NULL);
             it->m_app_bev = bev;
             it->m_appid = appid;
+            it->m_app_subscribed = false;
             if (need_sync) {
                 sync_cached_snapshots_to_app(&(*it), s);
             }
@@ -182,6 +230,68 @@ void PlayerInfo::player_app_update_infolist(struct bufferevent *bev, const Json:
     }
 }
 
+void PlayerInfo::player_app_subscribe(struct bufferevent *bev, const Json::Value &json, Server *s)
+{
+    Json::Value result(Json::objectValue);
+    std::string deviceid = json_string_or_empty(json, "deviceid");
+    std::string appid = json_string_or_empty(json, "appid");
+
+    result["cmd"] = "reply_app_subscribe";
+    result["deviceid"] = deviceid;
+    result["ping_interval"] = APP_PING_TIMEOUT / 3;
+
+    auto it = m_player_list->begin();
+    for (; it != m_player_list->end(); it++) {
+        if (deviceid == it->m_deviceid) {
+            break;
+        }
+    }
+    if (it == m_player_list->end()) {
+        result["result"] = "offline";
+        s->server_send_data(bev, result);
+        return;
+    }
+
+    /* 重新订阅（重登录）直接改绑到新连接，推送只发给最近订阅的一方 */
+    it->m_app_bev = bev;
+    it->m_appid = appid;
+    it->m_app_last_time = time(NULL);
+    it->m_app_subscribed = true;
+    enable_app_keepalive(bev);
+
+    result["result"] = "success";
+    s->server_send_data(bev, result);
+    sync_cached_snapshots_to_app(&(*it), s);
+    Server::debug("[APP订阅] APPID：%s 音箱ID：%s", appid.c_str(), deviceid.c_str());
+}
+
+void PlayerInfo::player_app_ping(struct bufferevent *bev, const Json::Value &json, Server *s)
+{
+    Json::Value result(Json::objectValue);
+    PlayerInfo_t *player = find_player_by_app_bev(m_player_list, bev);
+    (void)json;
+
+    result["cmd"] = "pong";
+    if (player == nullptr) {
+        /* 订阅已因设备下线或超时失效，应用端据此重新订阅 */
+        result["result"] = "offline";
+    } else {
+        player->m_app_last_time = time(NULL);
+        result["result"] = "success";
+    }
+    s->server_send_data(bev, result);
+}
+
+/* 应用端发来的任何帧都算存活（搜索、控制命令等），不只认 ping；
+ * 不是应用端连接（如音箱）时什么也不做 */
+void PlayerInfo::player_app_touch(struct bufferevent *bev)
+{
+    PlayerInfo_t *player = find_player_by_app_bev(m_player_list, bev);
+    if (player != nullptr) {
+        player->m_app_last_time = time(NULL);
+    }
+}
+
 void PlayerInfo::player_device_update_music_list(struct bufferevent *bev, const Json::Value &report, Server *s)
 {
     for (auto it = m_player_list->begin(); it != m_player_list->end(); it++) {
@@ -3,6 +3,7 @@
 #include "music_service_client.h"
 #include "music_downloader.h"
 #include "music_remote_list.h"
+#include "music_runtime_init.h"
 #include "runtime_config.h"
 
 #include <algorithm>
@@ -18,6 +19,7 @@
 #include <event2/buffer.h>
 #include <event2/listener.h>
 #include <iostream>
+#include <map>
 #include <netinet/in.h>
 #include <random>
 #include <strings.h>
@@ -429,91 +431,6 @@ bool normalize_music_service_items(Json::Value &items, const char *fallback_kind
     return true;
 }
 
-bool reply_music_search_song(Server *server, struct bufferevent *bev, const Json::Value &root,
-                             const std::string &cmd)
-{
-    Json::Value reply(Json::objectValue);
-    Json::Value items(Json::arrayValue);
-    music_search_result_t res;
-    std::string keyword = json_string_or_empty(root, "keyword");
-    std::string platform = json_string_or_empty(root, "source");
-    int page = json_int_from_numeric_member(root, "page", 1);
-    int page_size = json_int_from_numeric_member(root, "page_size", DEFAULT_PAGE_SIZE);
-    fill_music_service_reply_cmd(reply, cmd);
-
-    if (page <= 0) {
-        page = 1;
-    }
-    if (page_size <= 0) {
-        page_size = DEFAULT_PAGE_SIZE;
-    }
-
-    trim_keyword(keyword);
-    trim_keyword(platform);
-    if (platform.empty()) {
-        platform = "all";
-    }
-    music_remote_apply_source_hints(keyword, platform, platform);
-    if (keyword.empty() || music_remote_keyword_is_vague(keyword)) {
-        reply["result"] = "fail";
-        reply["kind"] = "song";
-        reply["items"] = items;
-        reply["page"] = page;
-        reply["total"] = 0;
-        reply["total_pages"] = 0;
-        reply["online_search_enabled"] = music_api_configured();
-        return server->server_send_data(bev, reply);
-    }
-    if (!music_api_configured()) {
-        reply["result"] = "fail";
-        reply["kind"] = "song";
-        reply["items"] = items;
-        reply["page"] = page;
-        reply["total"] = 0;
-        reply["total_pages"] = 0;
-        reply["online_search_enabled"] = false;
-        return server->server_send_data(bev, reply);
-    }
-
-    memset(&res, 0, sizeof(res));
-    if (music_search_page(keyword.c_str(), platform.c_str(), (uint32_t)page, (uint32_t)page_size, &res) != Ok) {
-        reply["result"] = "fail";
-        reply["kind"] = "song";
-        reply["items"] = items;
-        reply["page"] = page;
-        reply["total"] = 0;
-        reply["total_pages"] = 0;
-        reply["online_search_enabled"] = true;
-        Server::debug("[music.search.song] source=%s keyword=%s result=fail", platform.c_str(), keyword.c_str());
-        return server->server_send_data(bev, reply);
-    }
-
-    for (size_t i = 0; i < res.count; ++i) {
-        const music_info_t *info = &res.results[i];
-        Json::Value item(Json::objectValue);
-        item["kind"] = "song";
-        item["source"] = std::string(info->source);
-        item["id"] = std::string(info->id);
-        item["title"] = std::string(info->name);
-        item["subtitle"] = std::string(info->artist);
-        item["cover"] = "";
-        items.append(item);
-    }
-
-    reply["result"] = items.size() > 0 ? "ok" : "empty";
-    reply["kind"] = "song";
-    reply["items"] = items;
-    reply["page"] = static_cast<int>(res.page);
-    reply["total"] = static_cast<int>(res.total);
-    reply["total_pages"] = static_cast<int>(res.total_pages);
-    reply["online_search_enabled"] = true;
-    debug_music_items_preview(cmd.c_str(), keyword, items, reply["result"]);
-    Server::debug("[music.search.song] source=%s keyword=%s total=%u page=%u page_size=%u",
-                  platform.c_str(), keyword.c_str(), res.total, res.page, res.page_size);
-    music_free_search_result(&res);
-    return server->server_send_data(bev, reply);
-}
-
 bool proxy_music_service_list(Server *server, struct bufferevent *bev, const Json::Value &root,
                               const std::string &cmd, const char *path, const char *kind)
 {
@@ -668,11 +585,324 @@ bool reply_music_transport_report(Server *server, struct bufferevent *bev, const
     return server->server_send_data(bev, reply);
 }
 
+/* 在线搜索 / 取链交给 music-lib 工作线程，完成后在事件循环里回复；
+ * 连接断开时取消其未完成的任务，回调里不会再碰已释放的 bufferevent */
+struct PendingMusicReply {
+    Server *server;
+    struct bufferevent *bev;
+    std::string keyword;
+    std::string source;
+    std::string song_id;
+    std::string cmd;
+    int page;
+    int page_size;
+    Json::Value music;
+    int total;
+    int total_pages;
+};
+
+std::map<music_job_t, PendingMusicReply *> g_music_jobs;
+
+PendingMusicReply *new_pending_music_reply(Server *server, struct bufferevent *bev)
+{
+    PendingMusicReply *p = new PendingMusicReply();
+    p->server = server;
+    p->bev = bev;
+    p->page = 1;
+    p->page_size = DEFAULT_PAGE_SIZE;
+    p->total = 0;
+    p->total_pages = 0;
+    return p;
+}
+
+/** job 为 0（提交失败）时返回 false，p 仍归调用方 */
+bool track_music_job(music_job_t job, PendingMusicReply *p)
+{
+    if (job == 0) {
+        return false;
+    }
+    g_music_jobs[job] = p;
+    return true;
+}
+
+PendingMusicReply *take_music_job(const music_completion_t *c)
+{
+    std::map<music_job_t, PendingMusicReply *>::iterator it = g_music_jobs.find(c->job);
+    PendingMusicReply *p;
+    if (it == g_music_jobs.end()) {
+        return NULL;
+    }
+    p = it->second;
+    g_music_jobs.erase(it);
+    if (p->bev == NULL) {
+        // 任务完成时连接已关闭，结果丢弃
+        delete p;
+        return NULL;
+    }
+    return p;
+}
+
+void cancel_music_jobs_for(struct bufferevent *bev)
+{
+    std::map<music_job_t, PendingMusicReply *>::iterator it = g_music_jobs.begin();
+    while (it != g_music_jobs.end()) {
+        if (it->second->bev != bev) {
+            ++it;
+        } else if (music_job_cancel(it->first)) {
+            delete it->second;
+            g_music_jobs.erase(it++);
+        } else {
+            // 已完成、回调排在队列里取消不掉：只解除连接，回调里 take_music_job 会丢弃结果
+            it->second->bev = NULL;
+            ++it;
+        }
+    }
+}
+
+bool reply_list_music(Server *server, struct bufferevent *bev, const Json::Value &music, int page, int total,
+                      int total_pages, bool online_search_enabled)
+{
+    Json::Value reply(Json::objectValue);
+    reply["cmd"] = "reply_list_music";
+    reply["result"] = "ok";
+    reply["music"] = music;
+    reply["page"] = page;
+    reply["total_pages"] = total_pages;
+    reply["total"] = total;
+    reply["online_search_enabled"] = online_search_enabled;
+    return server->server_send_data(bev, reply);
+}
+
+void on_music_cached(const music_completion_t *c, void *user_data)
+{
+    (void)user_data;
+    if (c->status == Ok && c->path != NULL) {
+        Server::debug("[music_cache] 已缓存 %s", c->path);
+    }
+}
+
+/* 在线播放的歌曲在后台落到本地缓存，断网后本地曲库仍能搜到；未启用缓存时不做任何事 */
+void cache_played_music(const char *play_url, const char *singer, const char *song)
+{
+    if (!music_runtime_cache_enabled() || play_url == NULL || play_url[0] == '\0') {
+        return;
+    }
+    (void)music_cache_store_async(play_url, singer, song, server_runtime_config().legacy_quality.c_str(),
+                                  on_music_cached, NULL);
+}
+
+void on_play_url_done(const music_completion_t *c, void *user_data)
+{
+    PendingMusicReply *p = take_music_job(c);
+    Json::Value reply(Json::objectValue);
+    (void)user_data;
+
+    if (p == NULL) {
+        return;
+    }
+    reply["cmd"] = "reply_get_play_url";
+    if (c->status == Ok && c->url != NULL && c->url[0] != '\0') {
+        reply["result"] = "ok";
+        reply["play_url"] = std::string(c->url);
+        Server::debug("[get_play_url] source=%s song_id=%s play_url=%s", p->source.c_str(), p->song_id.c_str(),
+                      c->url);
+    } else {
+        reply["result"] = "fail";
+    }
+    p->server->server_send_data(p->bev, reply);
+    delete p;
+}
+
+void on_resolve_music_done(const music_completion_t *c, void *user_data)
+{
+    PendingMusicReply *p = take_music_job(c);
+    Json::Value reply(Json::objectValue);
+    const music_resolve_result_t *r = &c->resolve;
+    (void)user_data;
+
+    if (p == NULL) {
+        return;
+    }
+    reply["cmd"] = "reply_resolve_music";
+    if (c->status != Ok || r->play_url == NULL) {
+        reply["result"] = "fail";
+    } else {
+        reply["result"] = "ok";
+        reply["online_search_enabled"] = true;
+        reply["play_url"] = std::string(r->play_url);
+        reply["source"] = std::string(r->source);
+        reply["song_id"] = std::string(r->song_id);
+        reply["singer"] = std::string(r->singer);
+        reply["song"] = std::string(r->song);
+        Server::debug("[resolve_music] keyword=%s singer=%s song=%s play_url=%s", p->keyword.c_str(), r->singer,
+                      r->song, r->play_url);
+        cache_played_music(r->play_url, r->singer, r->song);
+    }
+    p->server->server_send_data(p->bev, reply);
+    delete p;
+}
+
+void on_list_music_url_done(const music_completion_t *c, void *user_data)
+{
+    PendingMusicReply *p = take_music_job(c);
+    (void)user_data;
+
+    if (p == NULL) {
+        return;
+    }
+    if (c->status == Ok && c->url != NULL && c->url[0] != '\0' && p->music.size() > 0) {
+        p->music[0]["play_url"] = std::string(c->url);
+        Server::debug("[list_music] keyword=%s singer=%s song=%s play_url=%s", p->keyword.c_str(),
+                      p->music[0]["singer"].asCString(), p->music[0]["song"].asCString(), c->url);
+        cache_played_music(c->url, p->music[0]["singer"].asCString(), p->music[0]["song"].asCString());
+    }
+    reply_list_music(p->server, p->bev, p->music, p->page, p->total, p->total_pages, true);
+    delete p;
+}
+
+void on_list_music_search_done(const music_completion_t *c, void *user_data)
+{
+    PendingMusicReply *p = take_music_job(c);
+    const music_info_t *first;
+    (void)user_data;
+
+    if (p == NULL) {
+        return;
+    }
+    if (c->status != Ok || c->search.count == 0) {
+        fill_list_music_from_local_keyword(p->keyword, p->music, p->page, p->page_size, p->total, p->total_pages);
+        reply_list_music(p->server, p->bev, p->music, p->page, p->total, p->total_pages, true);
+        delete p;
+        return;
+    }
+    music_remote_list_fill_items(c->search, p->music);
+    p->total = (int)c->search.total;
+    p->total_pages = (int)c->search.total_pages;
+
+    // 只为首条取链：整页逐条取链会成倍消耗音源 Key 的调用额度，其余条目点播时再 get_play_url
+    first = &c->search.results[0];
+    if (!track_music_job(music_get_url_async(first->source, first->id, server_runtime_config().legacy_quality.c_str(),
+                                             on_list_music_url_done, NULL),
+                         p)) {
+        reply_list_music(p->server, p->bev, p->music, p->page, p->total, p->total_pages, true);
+        delete p;
+    }
+}
+
+bool reply_music_search_song_fail(Server *server, struct bufferevent *bev, const std::string &cmd, int page,
+                                  bool online_search_enabled)
+{
+    Json::Value reply(Json::objectValue);
+    fill_music_service_reply_cmd(reply, cmd);
+    reply["result"] = "fail";
+    reply["kind"] = "song";
+    reply["items"] = Json::Value(Json::arrayValue);
+    reply["page"] = page;
+    reply["total"] = 0;
+    reply["total_pages"] = 0;
+    reply["online_search_enabled"] = online_search_enabled;
+    return server->server_send_data(bev, reply);
+}
+
+void on_music_search_song_done(const music_completion_t *c, void *user_data)
+{
+    PendingMusicReply *p = take_music_job(c);
+    Json::Value reply(Json::objectValue);
+    Json::Value items(Json::arrayValue);
+    const music_search_result_t *res = &c->search;
+    (void)user_data;
+
+    if (p == NULL) {
+        return;
+    }
+    if (c->status != Ok) {
+        Server::debug("[music.search.song] source=%s keyword=%s result=fail", p->source.c_str(), p->keyword.c_str());
+        reply_music_search_song_fail(p->server, p->bev, p->cmd, p->page, true);
+        delete p;
+        return;
+    }
+
+    for (size_t i = 0; i < res->count; ++i) {
+        const music_info_t *info = &res->results[i];
+        Json::Value item(Json::objectValue);
+        item["kind"] = "song";
+        item["source"] = std::string(info->source);
+        item["id"] = std::string(info->id);
+        item["title"] = std::string(info->name);
+        item["subtitle"] = std::string(info->artist);
+        item["cover"] = "";
+        items.append(item);
+    }
+
+    fill_music_service_reply_cmd(reply, p->cmd);
+    reply["result"] = items.size() > 0 ? "ok" : "empty";
+    reply["kind"] = "song";
+    reply["items"] = items;
+    reply["page"] = static_cast<int>(res->page);
+    reply["total"] = static_cast<int>(res->total);
+    reply["total_pages"] = static_cast<int>(res->total_pages);
+    reply["online_search_enabled"] = true;
+    debug_music_items_preview(p->cmd.c_str(), p->keyword, items, reply["result"]);
+    Server::debug("[music.search.song] source=%s keyword=%s total=%u page=%u page_size=%u",
+                  p->source.c_str(), p->keyword.c_str(), res->total, res->page, res->page_size);
+    p->server->server_send_data(p->bev, reply);
+    delete p;
+}
+
+/* 分页搜索交给 music-lib 工作线程，结果在 on_music_search_song_done 里回复，不阻塞事件循环 */
+bool reply_music_search_song(Server *server, struct bufferevent *bev, const Json::Value &root,
+                             const std::string &cmd)
+{
+    PendingMusicReply *p;
+    std::string keyword = json_string_or_empty(root, "keyword");
+    std::string platform = json_string_or_empty(root, "source");
+    int page = json_int_from_numeric_member(root, "page", 1);
+    int page_size = json_int_from_numeric_member(root, "page_size", DEFAULT_PAGE_SIZE);
+
+    if (page <= 0) {
+        page = 1;
+    }
+    if (page_size <= 0) {
+        page_size = DEFAULT_PAGE_SIZE;
+    }
+
+    trim_keyword(keyword);
+    trim_keyword(platform);
+    if (platform.empty()) {
+        platform = "all";
+    }
+    music_remote_apply_source_hints(keyword, platform, platform);
+    if (keyword.empty() || music_remote_keyword_is_vague(keyword)) {
+        return reply_music_search_song_fail(server, bev, cmd, page, music_api_configured());
+    }
+    if (!music_api_configured()) {
+        return reply_music_search_song_fail(server, bev, cmd, page, false);
+    }
+
+    p = new_pending_music_reply(server, bev);
+    p->cmd = cmd;
+    p->keyword = keyword;
+    p->source = platform;
+    p->page = page;
+    p->page_size = page_size;
+    if (track_music_job(music_search_page_async(keyword.c_str(), platform.c_str(), (uint32_t)page,
+                                                (uint32_t)page_size, on_music_search_song_done, NULL),
+                        p)) {
+        return true;
+    }
+    delete p;
+    Server::debug("[music.search.song] source=%s keyword=%s 提交搜索任务失败", platform.c_str(), keyword.c_str());
+    return reply_music_search_song_fail(server, bev, cmd, page, true);
+}
+
 }  // namespace
 
 Server::Server()
-    : m_eventbase(event_base_new()), m_database(new Database()), m_player_info(NULL), m_ok(false)
+    : m_eventbase(event_base_new()), m_database(new Database()), m_player_info(NULL), m_music_event(NULL),
+      m_ok(false)
 {
+    int music_fd;
+
     if (m_eventbase == NULL || m_database == NULL) {
         return;
     }
@@ -687,6 +917,17 @@ Server::Server()
     }
     debug("数据库初始化表成功！");
 
+    music_fd = music_async_init(0);
+    if (music_fd < 0) {
+        Server::debug("music-lib 异步任务初始化失败");
+        return;
+    }
+    m_music_event = event_new(m_eventbase, music_fd, EV_READ | EV_PERSIST, music_async_cb, this);
+    if (m_music_event == NULL || event_add(m_music_event, NULL) != 0) {
+        Server::debug("注册 music-lib 完成通知失败");
+        return;
+    }
+
     m_player_info = new PlayerInfo();
     m_player_info->player_start_timer(this);
     m_ok = true;
@@ -704,6 +945,10 @@ Server::~Server()
         m_database = NULL;
         std::cout << "数据库已断开连接" << std::endl;
     }
+    if (m_music_event != NULL) {
+        event_free(m_music_event);
+        m_music_event = NULL;
+    }
     if (m_eventbase != NULL) {
         event_base_free(m_eventbase);
         m_eventbase = NULL;
@@ -787,6 +1032,7 @@ void Server::read_cb(struct bufferevent *bev, void *ctx)
         }
 
         cmd = json_string_or_empty(root, "cmd");
+        s->m_player_info->player_app_touch(bev);
     if (cmd == "get_music") {
         s->debug("[消息类型] 嵌入式端获取音乐列表");
         s->server_get_music(bev, root);
@@ -842,6 +1088,11 @@ void Server::read_cb(struct bufferevent *bev, void *ctx)
     } else if (cmd == "upload_music_list") {
         s->debug("[消息类型] 嵌入式端上传音乐列表");
         s->m_player_info->player_device_update_music_list(bev, root, s);
+    } else if (cmd == "app_subscribe") {
+        s->debug("[消息类型] 应用端订阅设备");
+        s->m_player_info->player_app_subscribe(bev, root, s);
+    } else if (cmd == "ping") {
+        s->m_player_info->player_app_ping(bev, root, s);
     } else if (cmd == "app_report") {
         s->m_player_info->player_app_update_infolist(bev, root, s);
     } else if (cmd == "app_register") {
@@ -909,6 +1160,7 @@ bool Server::server_app_option(struct bufferevent *bev, Json::Value &root)
          it++) {
         if (it->m_app_bev == bev) {
             is_online = true;
+            it->m_app_last_time = time(NULL);
             break;
         }
     }
@@ -1030,19 +1282,15 @@ bool Server::server_get_play_url(struct bufferevent *bev, const Json::Value &roo
         return server_send_data(bev, reply);
     }
     const std::string &qual = server_runtime_config().legacy_quality;
-    char *url = music_get_url(src.c_str(), sid.c_str(), qual.c_str());
-    if (url != NULL && url[0] != '\0') {
-        reply["result"] = "ok";
-        reply["play_url"] = std::string(url);
-        Server::debug("[get_play_url] source=%s song_id=%s play_url=%s", src.c_str(), sid.c_str(), url);
-        music_free_string(url);
-    } else {
+    PendingMusicReply *p = new_pending_music_reply(this, bev);
+    p->source = src;
+    p->song_id = sid;
+    if (!track_music_job(music_get_url_async(src.c_str(), sid.c_str(), qual.c_str(), on_play_url_done, NULL), p)) {
+        delete p;
         reply["result"] = "fail";
-        if (url != NULL) {
-            music_free_string(url);
-        }
+        return server_send_data(bev, reply);
     }
-    return server_send_data(bev, reply);
+    return true;
 }
 
 bool Server::server_resolve_music(struct bufferevent *bev, const Json::Value &root)
@@ -1060,8 +1308,6 @@ bool Server::server_resolve_music(struct bufferevent *bev, const Json::Value &ro
         reply["online_search_enabled"] = false;
         return server_send_data(bev, reply);
     }
-    music_resolve_result_t r;
-    memset(&r, 0, sizeof(r));
     const ServerRuntimeConfig &cfg = server_runtime_config();
     std::string plat = cfg.legacy_platform;
     music_remote_apply_source_hints(kw, plat, cfg.legacy_platform);
@@ -1069,21 +1315,16 @@ bool Server::server_resolve_music(struct bufferevent *bev, const Json::Value &ro
         reply["result"] = "fail";
         return server_send_data(bev, reply);
     }
-    if (music_resolve_keyword(kw.c_str(), plat.c_str(), cfg.legacy_quality.c_str(), &r) != Ok) {
+    PendingMusicReply *p = new_pending_music_reply(this, bev);
+    p->keyword = kw;
+    if (!track_music_job(music_resolve_keyword_async(kw.c_str(), plat.c_str(), cfg.legacy_quality.c_str(),
+                                                     on_resolve_music_done, NULL),
+                         p)) {
+        delete p;
         reply["result"] = "fail";
         return server_send_data(bev, reply);
     }
-    reply["result"] = "ok";
-    reply["online_search_enabled"] = true;
-    reply["play_url"] = std::string(r.play_url);
-    reply["source"] = std::string(r.source);
-    reply["song_id"] = std::string(r.song_id);
-    reply["singer"] = std::string(r.singer);
-    reply["song"] = std::string(r.song);
-    Server::debug("[resolve_music] keyword=%s singer=%s song=%s play_url=%s", kw.c_str(), r.singer, r.song,
-                  r.play_url);
-    music_free_resolve_result(&r);
-    return server_send_data(bev, reply);
+    return true;
 }
 
 bool Server::server_list_music(struct bufferevent *bev, const Json::Value &root)
@@ -1135,26 +1376,22 @@ bool Server::server_list_music(struct bufferevent *bev, const Json::Value &root)
             music = Json::Value(Json::arrayValue);
         } else {
             reply["online_search_enabled"] = true;
-            int remote_total = 0;
-            int remote_tp = 0;
-            if (music_remote_list_music_page(keyword, page, page_size, music, remote_total, remote_tp) &&
-                music.size() > 0) {
-                total = remote_total;
-                total_pages = remote_tp;
-                for (Json::ArrayIndex i = 0; i < music.size(); ++i) {
-                    const Json::Value &it = music[i];
-                    if (it.isMember("play_url") && it["play_url"].isString()) {
-                        const std::string &pu = it["play_url"].asString();
-                        if (!pu.empty()) {
-                            Server::debug("[list_music] keyword=%s singer=%s song=%s play_url=%s",
-                                          keyword.c_str(), it["singer"].asCString(),
-                                          it["song"].asCString(), pu.c_str());
-                        }
-                    }
+            std::string kw;
+            std::string plat;
+            if (music_remote_list_prepare(keyword, kw, plat)) {
+                // 远程搜索 → 首条取链 → 回复，均在 music-lib 工作线程完成后回到事件循环；失败时回退本地
+                PendingMusicReply *p = new_pending_music_reply(this, bev);
+                p->keyword = keyword;
+                p->page = page;
+                p->page_size = page_size;
+                if (track_music_job(music_search_page_async(kw.c_str(), plat.c_str(), (uint32_t)page,
+                                                            (uint32_t)page_size, on_list_music_search_done, NULL),
+                                    p)) {
+                    return true;
                 }
-            } else {
-                fill_list_music_from_local_keyword(keyword, music, page, page_size, total, total_pages);
+                delete p;
             }
+            fill_list_music_from_local_keyword(keyword, music, page, page_size, total, total_pages);
         }
     }
 
@@ -1248,24 +1485,35 @@ static void server_flush_bev_output_best_effort(struct bufferevent *bev)
     }
 }
 
+void Server::server_release_bev(struct bufferevent *bev)
+{
+    if (bev == NULL) {
+        return;
+    }
+    cancel_music_jobs_for(bev);
+    bufferevent_free(bev);
+}
+
 void Server::event_cb(struct bufferevent *bev, short what, void *ctx)
 {
     Server *s = (Server *)ctx;
-    if (what & BEV_EVENT_EOF) {
+    /* BEV_EVENT_ERROR 包括 keepalive 探测失败（ETIMEDOUT），按断开处理 */
+    if (what & (BEV_EVENT_EOF | BEV_EVENT_ERROR)) {
+        cancel_music_jobs_for(bev);
         auto plist = s->m_player_info->player_get_m_player_list();
         for (auto it = plist->begin(); it != plist->end(); it++) {
             if (it->m_app_bev == bev) {
                 Server::debug("[有APP下线了] APPID：%s", it->m_appid.c_str());
                 it->m_appid.clear();
                 if (it->m_app_bev != nullptr) {
-                    bufferevent_free(it->m_app_bev);
+                    server_release_bev(it->m_app_bev);
                     it->m_app_bev = nullptr;
                 }
                 break;
             } else if (it->m_device_bev == bev) {
                 Server::debug("[有音箱下线了] 音箱ID：%s", it->m_deviceid.c_str());
                 if (it->m_device_bev != nullptr) {
-                    bufferevent_free(it->m_device_bev);
+                    server_release_bev(it->m_device_bev);
                     it->m_device_bev = nullptr;
                 }
                 if (it->m_app_bev != nullptr) {
@@ -1274,7 +1522,7 @@ void Server::event_cb(struct bufferevent *bev, short what, void *ctx)
                     json["cmd"] = "device_offline";
                     s->server_send_data(app_bev, json);
                     server_flush_bev_output_best_effort(app_bev);
-                    bufferevent_free(app_bev);
+                    server_release_bev(app_bev);
                     it->m_app_bev = nullptr;
                 }
                 plist->erase(it);
@@ -1284,6 +1532,14 @@ void Server::event_cb(struct bufferevent *bev, short what, void *ctx)
     }
 }
 
+void Server::music_async_cb(evutil_socket_t fd, short what, void *ctx)
+{
+    (void)fd;
+    (void)what;
+    (void)ctx;
+    music_async_dispatch();
+}
+
 void Server::debug(const char *s, ...)
 {
     va_list args;
@@ -0,0 +1,139 @@
+#!/usr/bin/env python3
+"""本地 HTTP 替身：用于测试 music-lib 的断点续传 / 分段下载 / 缓存，不依赖真实音源。
+
+用法：
+    python3 tests/range_http_standin.py [--port 8765] [--size 5242880] [--file 路径]
+                                        [--drop-after 字节数] [--drop-times 次数]
+                                        [--no-range] [--etag 值]
+
+任意路径都返回同一份内容（默认按 --size 生成的确定性字节，也可用 --file 指定真实音频）。
+--drop-after 让前 --drop-times 个响应发出指定字节后直接断开连接，模拟弱网中断；
+--no-range 忽略 Range 头、总是回 200，用于验证不支持分段时的回退；
+修改 --etag 后重启替身，可验证 If-Range 不匹配时客户端整体重下。
+"""
+import argparse
+import hashlib
+import re
+import threading
+from http.server import BaseHTTPRequestHandler, ThreadingHTTPServer
+
+
+def make_payload(size):
+    chunk = bytes(range(256)) * 256
+    data = bytearray()
+    while len(data) < size:
+        data.extend(chunk)
+    return bytes(data[:size])
+
+
+class State:
+    def __init__(self, args):
+        if args.file:
+            with open(args.file, "rb") as f:
+                self.payload = f.read()
+        else:
+            self.payload = make_payload(args.size)
+        self.etag = '"%s"' % (args.etag or hashlib.md5(self.payload).hexdigest())
+        self.no_range = args.no_range
+        self.drop_after = args.drop_after
+        self.drops_left = args.drop_times
+        self.lock = threading.Lock()
+
+    def take_drop(self):
+        with self.lock:
+            if self.drop_after <= 0 or self.drops_left <= 0:
+                return 0
+            self.drops_left -= 1
+            return self.drop_after
+
+
+def parse_range(header, total):
+    m = re.fullmatch(r"bytes=(\d+)-(\d*)", header.strip())
+    if m is None:
+        return None
+    start = int(m.group(1))
+    end = int(m.group(2)) if m.group(2) else total - 1
+    if start >= total or end < start:
+        return None
+    return start, min(end, total - 1)
+
+
+class Handler(BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    state = None
+
+    def do_HEAD(self):
+        self.respond(send_body=False)
+
+    def do_GET(self):
+        self.respond(send_body=True)
+
+    def respond(self, send_body):
+        st = self.state
+        total = len(st.payload)
+        rng = self.headers.get("Range")
+        if_range = self.headers.get("If-Range")
+        start, end, status = 0, total - 1, 200
+        if rng and not st.no_range and (if_range is None or if_range == st.etag):
+            parsed = parse_range(rng, total)
+            if parsed is None:
+                self.send_response(416)
+                self.send_header("Content-Range", "bytes */%d" % total)
+                self.send_header("Content-Length", "0")
+                self.end_headers()
+                return
+            start, end = parsed
+            status = 206
+
+        self.send_response(status)
+        self.send_header("Content-Type", "audio/mpeg")
+        self.send_header("Content-Length", str(end - start + 1))
+        self.send_header("ETag", st.etag)
+        if not st.no_range:
+            self.send_header("Accept-Ranges", "bytes")
+        if status == 206:
+            self.send_header("Content-Range", "bytes %d-%d/%d" % (start, end, total))
+        self.end_headers()
+        if not send_body:
+            return
+
+        body = st.payload[start:end + 1]
+        drop = st.take_drop()
+        try:
+            if drop > 0 and drop < len(body):
+                self.wfile.write(body[:drop])
+                self.wfile.flush()
+                self.log_message("模拟断线：%s 发出 %d/%d 字节后断开", rng or "全量", drop, len(body))
+                self.close_connection = True
+                self.connection.shutdown(2)
+                return
+            self.wfile.write(body)
+        except (BrokenPipeError, ConnectionResetError):
+            # 客户端拿到 200 后放弃断点、分段读满即关闭，都属正常
+            self.close_connection = True
+
+
+def main():
+    parser = argparse.ArgumentParser(description="支持 Range 的本地下载替身")
+    parser.add_argument("--port", type=int, default=8765)
+    parser.add_argument("--size", type=int, default=5 * 1024 * 1024)
+    parser.add_argument("--file", default="")
+    parser.add_argument("--drop-after", type=int, default=0)
+    parser.add_argument("--drop-times", type=int, default=1)
+    parser.add_argument("--no-range", action="store_true")
+    parser.add_argument("--etag", default="")
+    args = parser.parse_args()
+
+    Handler.state = State(args)
+    server = ThreadingHTTPServer(("127.0.0.1", args.port), Handler)
+    print("range 替身已启动: http://127.0.0.1:%d/song.mp3 (%d 字节, md5=%s)"
+          % (args.port, len(Handler.state.payload), hashlib.md5(Handler.state.payload).hexdigest()),
+          flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
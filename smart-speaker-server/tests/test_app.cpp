@@ -71,11 +71,16 @@ int main()
         return 1;
     }
 
-    root["cmd"] = "app_report";
+    root["cmd"] = "app_subscribe";
     root["appid"] = "0001";
     root["deviceid"] = "0001";
     server_send_data(sockfd, root);
-    printf("app_report 已发送\n");
+    printf("app_subscribe 已发送\n");
+
+    Json::Value ping(Json::objectValue);
+    ping["cmd"] = "ping";
+    server_send_data(sockfd, ping);
+    printf("ping 已发送\n");
 
     close(sockfd);
     return 0;